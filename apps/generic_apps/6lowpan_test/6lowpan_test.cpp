@@ -49,6 +49,7 @@ public:
 		timer_ = &wiselib::FacetProvider<Os, Os::Timer>::get_facet( value );
 		debug_ = &wiselib::FacetProvider<Os, Os::Debug>::get_facet( value );
 		uart_ = &wiselib::FacetProvider<Os, Uart>::get_facet( value );
+		clock_ = &wiselib::FacetProvider<Os, Os::Clock>::get_facet( value );
 		
 	#ifdef ISENSE
 
@@ -63,7 +64,7 @@ public:
 		debug_->debug( "Booting with ID: %llx\n", (long long unsigned)(radio_->id()));
 	#endif
 		
-		ipv6_stack_.init(*radio_, *debug_, *timer_, *uart_);
+		ipv6_stack_.init(*radio_, *debug_, *timer_, *uart_, *clock_);
 		
 		callback_id = ipv6_stack_.icmpv6.reg_recv_callback<lowpanApp,&lowpanApp::receive_echo_reply>( this );
 		callback_id = ipv6_stack_.udp.reg_recv_callback<lowpanApp,&lowpanApp::receive_radio_message>( this );
@@ -176,6 +177,7 @@ private:
 	Os::Timer::self_pointer_t timer_;
 	Os::Debug::self_pointer_t debug_;
 	Uart::self_pointer_t uart_;
+	Os::Clock::self_pointer_t clock_;
 };
 // --------------------------------------------------------------------------
 wiselib::WiselibApplication<Os, lowpanApp> example_app;
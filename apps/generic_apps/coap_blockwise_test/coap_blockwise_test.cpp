@@ -0,0 +1,402 @@
+/*
+ * Round trip checks for the block-wise transfers of CoapServiceStatic
+ * (radio/coap/coap_service_static.h): Block2 downloads of every size
+ * between two services, and Block1 uploads in order, out of order, from
+ * two clients and with malformed block options.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include "util/pstl/static_string.h"
+#include "radio/coap/coap_service_static.h"
+
+/// Frames on the air, delivered in order by App::pump()
+struct Frame {
+	enum { MAX_LENGTH = 160 };
+	::uint16_t from;
+	::uint16_t to;
+	::size_t length;
+	::uint8_t data[MAX_LENGTH];
+};
+
+enum { MAX_FRAMES = 64 };
+Frame air[MAX_FRAMES];
+int air_size = 0;
+
+/// Radio of one node, sending puts the frame on the air
+struct LinkRadio {
+	typedef ::uint16_t node_id_t;
+	typedef ::size_t size_t;
+	typedef ::uint8_t block_data_t;
+	typedef ::uint8_t message_id_t;
+	typedef delegate3<void, node_id_t, size_t, block_data_t*> receive_delegate_t;
+	enum {
+		NULL_NODE_ID = 0,
+		BROADCAST_ADDRESS = 0xffff
+	};
+
+	node_id_t id_;
+	receive_delegate_t receive_;
+
+	node_id_t id() { return id_; }
+	int enable_radio() { return Os::SUCCESS; }
+	int disable_radio() { return Os::SUCCESS; }
+
+	template<class T, void (T::*TMethod)(node_id_t, size_t, block_data_t*)>
+	int reg_recv_callback(T* obj) {
+		receive_ = receive_delegate_t::from_method<T, TMethod>(obj);
+		return 0;
+	}
+	int unreg_recv_callback(int) { return Os::SUCCESS; }
+
+	int send(node_id_t to, size_t length, block_data_t* data) {
+		if(air_size == MAX_FRAMES || length > Frame::MAX_LENGTH) { return Os::ERR_UNSPEC; }
+		Frame& f = air[air_size++];
+		f.from = id_;
+		f.to = to;
+		f.length = length;
+		memcpy(f.data, data, length);
+		return Os::SUCCESS;
+	}
+};
+
+/// Deterministic random numbers for the message IDs, tokens and timeouts
+struct LinkRand {
+	::uint32_t seed_;
+	void srand(::uint32_t seed) { seed_ = seed; }
+	::uint32_t operator()(::uint32_t max = 0xffffffffUL) {
+		seed_ = seed_ * 1103515245UL + 12345UL;
+		return max ? (seed_ >> 8) % max : 0;
+	}
+};
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			SERVER = 1,
+			CLIENT = 2,
+			OTHER_CLIENT = 3,
+			MAX_CONTENT = 4000,
+			BLOCK = 1 << (COAP_BLOCK_SZX + 4)
+		};
+
+		typedef FakeTimer<Os, 64> Timer;
+		typedef CoapServiceStatic<Os, LinkRadio, Timer, LinkRand> Coap;
+		typedef Coap::coap_packet_t Packet;
+		typedef Coap::ReceivedMessage ReceivedMessage;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			server_radio_.id_ = SERVER;
+			client_radio_.id_ = CLIENT;
+			server_.init(server_radio_, timer_, server_rand_);
+			client_.init(client_radio_, timer_, client_rand_);
+			server_.enable_radio();
+			client_.enable_radio();
+			int idx = server_.reg_block_resource_callback<App, &App::read>(StaticString("data"), this, COAP_CONTENT_TYPE_APPLICATION_OCTET_STREAM);
+			CHECK(idx >= 0);
+			int result = server_.set_block_write_callback<App, &App::write>(idx, this);
+			CHECK(result == Coap::SUCCESS);
+			msg_id_ = 1000;
+
+			test_block2();
+			test_block2_larger_blocks();
+			test_block1();
+			test_block1_sequence();
+			test_block_option_length();
+
+			finish("coap_blockwise_test");
+		}
+
+		/// Every representation arrives complete, each block is read once
+		void test_block2() {
+			static const ::size_t sizes[] = { 0, 1, BLOCK - 1, BLOCK, BLOCK + 1, 3 * BLOCK, 1000, MAX_CONTENT };
+			for(unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+				content_length_ = sizes[s];
+				reads_ = 0;
+				received_length_ = 0;
+				done_ = 0;
+				failed_ = 0;
+				memset(received_, 0, sizeof(received_));
+
+				int transfer = client_.get_blockwise<App, &App::block>(SERVER, StaticString("data"), StaticString(""), this);
+				CHECK(transfer >= 0);
+				pump();
+
+				CHECK(done_ == 1 && failed_ == 0);
+				CHECK(received_length_ == sizes[s]);
+				bool same = true;
+				for(::size_t i = 0; i < sizes[s]; i++) {
+					same = same && received_[i] == content(i);
+				}
+				CHECK(same);
+				// the window may ask for blocks behind the end
+				CHECK(reads_ <= (int) (sizes[s] / BLOCK + 1 + COAP_BLOCK_WINDOW));
+			}
+			// the watchdog stops with the transfers
+			timer_.advance(3 * COAP_BLOCK_TIMEOUT);
+			CHECK(failed_ == 0);
+		}
+
+		/// A client asking for larger blocks gets the first of our blocks it contains
+		void test_block2_larger_blocks() {
+			content_length_ = 1000;
+			Packet request;
+			request_packet(request, COAP_CODE_GET);
+			request.set_option(COAP_OPT_BLOCK2, CoapBlockOption(1, false, COAP_BLOCK_SZX + 2).value());
+			Packet response;
+			CHECK(exchange(CLIENT, request, response) == COAP_CODE_CONTENT);
+			CoapBlockOption block = block_option(response, COAP_OPT_BLOCK2);
+			CHECK(block.num() == 4 && block.szx() == COAP_BLOCK_SZX && block.more());
+			CHECK(response.data_length() == BLOCK && response.data()[0] == content(4 * BLOCK));
+		}
+
+		void test_block1() {
+			static const ::size_t sizes[] = { 1, BLOCK, BLOCK + 1, 5 * BLOCK + 10 };
+			for(unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+				reset_upload();
+				::size_t blocks = (sizes[s] + BLOCK - 1) / BLOCK;
+				for(::size_t n = 0; n < blocks; n++) {
+					bool more = n + 1 < blocks;
+					CoapCode code = upload(CLIENT, n, more, more ? BLOCK : sizes[s] - n * BLOCK);
+					CHECK(code == (more ? COAP_CODE_CONTINUE : COAP_CODE_CHANGED));
+				}
+				CHECK(written_length_ == sizes[s] && writes_ == (int) blocks && last_written_);
+				bool same = true;
+				for(::size_t i = 0; i < sizes[s]; i++) {
+					same = same && written_[i] == content(i);
+				}
+				CHECK(same);
+			}
+
+			// without Block1 the request is the whole representation
+			reset_upload();
+			Packet request;
+			request_packet(request, COAP_CODE_PUT);
+			::uint8_t data[10];
+			for(int i = 0; i < 10; i++) { data[i] = content(i); }
+			request.set_data(data, 10);
+			Packet response;
+			CHECK(exchange(CLIENT, request, response) == COAP_CODE_CHANGED);
+			CHECK(written_length_ == 10 && last_written_);
+
+			// larger blocks than ours are refused with our block size
+			reset_upload();
+			request_packet(request, COAP_CODE_PUT);
+			request.set_option(COAP_OPT_BLOCK1, CoapBlockOption(0, true, COAP_BLOCK_SZX + 1).value());
+			CHECK(exchange(CLIENT, request, response) == COAP_CODE_REQUEST_ENTITY_TOO_LARGE);
+			CHECK(block_option(response, COAP_OPT_BLOCK1).szx() == COAP_BLOCK_SZX);
+			CHECK(writes_ == 0);
+		}
+
+		/// The blocks of an upload have to arrive in order
+		void test_block1_sequence() {
+			// a lost block
+			reset_upload();
+			CHECK(upload(CLIENT, 0, true, BLOCK) == COAP_CODE_CONTINUE);
+			CHECK(upload(CLIENT, 2, true, BLOCK) == COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+			CHECK(writes_ == 1);
+			// the upload goes on with the expected block
+			CHECK(upload(CLIENT, 1, true, BLOCK) == COAP_CODE_CONTINUE);
+			CHECK(upload(CLIENT, 2, false, 5) == COAP_CODE_CHANGED);
+			CHECK(writes_ == 3 && written_length_ == 2 * BLOCK + 5);
+
+			// nothing continues a finished upload
+			CHECK(upload(CLIENT, 3, false, 5) == COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+			// nor an upload that was never started
+			reset_upload();
+			CHECK(upload(OTHER_CLIENT, 1, true, BLOCK) == COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+			CHECK(writes_ == 0);
+
+			// an other client can not continue the upload
+			CHECK(upload(CLIENT, 0, true, BLOCK) == COAP_CODE_CONTINUE);
+			CHECK(upload(OTHER_CLIENT, 1, true, BLOCK) == COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+			CHECK(upload(CLIENT, 1, true, BLOCK) == COAP_CODE_CONTINUE);
+			// but it can take the resource over with block 0
+			CHECK(upload(OTHER_CLIENT, 0, true, BLOCK) == COAP_CODE_CONTINUE);
+			CHECK(upload(CLIENT, 2, false, 1) == COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+			CHECK(upload(OTHER_CLIENT, 1, false, 1) == COAP_CODE_CHANGED);
+
+			// a smaller block size in the middle of the upload
+			reset_upload();
+			CHECK(upload(CLIENT, 0, true, BLOCK) == COAP_CODE_CONTINUE);
+			CHECK(upload(CLIENT, 2, true, BLOCK / 2, COAP_BLOCK_SZX - 1) == COAP_CODE_CONTINUE);
+			CHECK(upload(CLIENT, 3, false, 1, COAP_BLOCK_SZX - 1) == COAP_CODE_CHANGED);
+			CHECK(written_length_ == BLOCK + BLOCK / 2 + 1);
+
+			// an error of the resource ends the upload
+			reset_upload();
+			write_code_ = COAP_CODE_FORBIDDEN;
+			CHECK(upload(CLIENT, 0, true, BLOCK) == COAP_CODE_FORBIDDEN);
+			write_code_ = COAP_CODE_CHANGED;
+			CHECK(upload(CLIENT, 1, true, BLOCK) == COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+
+			// a short block which is not the last one
+			reset_upload();
+			CHECK(upload(CLIENT, 0, true, BLOCK - 1) == COAP_CODE_BAD_REQUEST);
+			CHECK(writes_ == 0);
+		}
+
+		/// Block options are at most three bytes long
+		void test_block_option_length() {
+			reset_upload();
+			Packet request;
+			request_packet(request, COAP_CODE_PUT);
+			request.set_option(COAP_OPT_BLOCK1, CoapBlockOption(0x100000, true, COAP_BLOCK_SZX).value());
+			Packet response;
+			CHECK(exchange(CLIENT, request, response) == COAP_CODE_BAD_OPTION);
+			CHECK(writes_ == 0);
+
+			request_packet(request, COAP_CODE_GET);
+			request.set_option(COAP_OPT_BLOCK2, CoapBlockOption(0x100000, false, COAP_BLOCK_SZX).value());
+			CHECK(exchange(CLIENT, request, response) == COAP_CODE_BAD_OPTION);
+
+			// the largest three byte block number is fine
+			reset_upload();
+			request_packet(request, COAP_CODE_PUT);
+			request.set_option(COAP_OPT_BLOCK1, CoapBlockOption(0xfffff, false, 0).value());
+			CHECK(exchange(CLIENT, request, response) == COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+		}
+
+		// -----------------------------------------------------------------
+		// the resource
+
+		::size_t read(ReceivedMessage&, ::size_t offset, ::uint8_t* buffer, ::size_t length) {
+			reads_++;
+			::size_t n = 0;
+			for(::size_t i = offset; i < content_length_ && n < length; i++) {
+				buffer[n++] = content(i);
+			}
+			return n;
+		}
+
+		CoapCode write(ReceivedMessage&, ::size_t offset, ::uint8_t* data, ::size_t length, bool more) {
+			writes_++;
+			if(offset + length <= MAX_CONTENT) {
+				memcpy(written_ + offset, data, length);
+			}
+			written_length_ = offset + length;
+			last_written_ = !more;
+			return write_code_;
+		}
+
+		// the client
+		void block(int status, ::size_t offset, ReceivedMessage* message) {
+			if(status == Coap::BLOCK_DATA) {
+				Packet& p = message->message();
+				if(offset + p.data_length() <= MAX_CONTENT) {
+					memcpy(received_ + offset, p.data(), p.data_length());
+				}
+			}
+			else if(status == Coap::BLOCK_DONE) {
+				done_++;
+				received_length_ = offset;
+			}
+			else {
+				failed_++;
+			}
+		}
+
+	private:
+		static ::uint8_t content(::size_t i) { return (::uint8_t) (i * 31 + 7); }
+
+		/// Delivers the frames until the air is empty
+		void pump() {
+			for(int guard = 0; air_size > 0 && guard < 100000; guard++) {
+				Frame f = air[0];
+				air_size--;
+				memmove(air, air + 1, air_size * sizeof(Frame));
+				LinkRadio& to = (f.to == SERVER) ? server_radio_ : client_radio_;
+				to.receive_(f.from, f.length, f.data);
+			}
+		}
+
+		void request_packet(Packet& request, CoapCode code) {
+			request = Packet();
+			request.set_type(COAP_MSG_TYPE_CON);
+			request.set_code(code);
+			request.set_msg_id(msg_id_++);
+			request.set_uri_path(StaticString("data"));
+		}
+
+		/// Sends a request to the server from any node, returns the code of the answer
+		int exchange(::uint16_t from, Packet& request, Packet& response) {
+			air_size = 0;
+			::uint8_t buffer[Frame::MAX_LENGTH];
+			::size_t length = request.serialize(buffer);
+			server_radio_.receive_(from, length, buffer);
+			if(air_size != 1 || air[0].to != from) { return -1; }
+			response.parse_message(air[0].data, air[0].length);
+			air_size = 0;
+			return response.code();
+		}
+
+		int upload(::uint16_t from, ::uint32_t num, bool more, ::size_t length, ::uint8_t szx = COAP_BLOCK_SZX) {
+			Packet request;
+			request_packet(request, COAP_CODE_PUT);
+			request.set_option(COAP_OPT_BLOCK1, CoapBlockOption(num, more, szx).value());
+			::size_t offset = num * CoapBlockOption::block_size(szx);
+			::uint8_t data[BLOCK];
+			for(::size_t i = 0; i < length; i++) { data[i] = content(offset + i); }
+			request.set_data(data, length);
+			Packet response;
+			int code = exchange(from, request, response);
+			// the answer tells which block it is for
+			if(code != COAP_CODE_REQUEST_ENTITY_INCOMPLETE && code != COAP_CODE_BAD_REQUEST) {
+				CoapBlockOption block = block_option(response, COAP_OPT_BLOCK1);
+				CHECK(block.num() == num && block.more() == more);
+			}
+			return code;
+		}
+
+		CoapBlockOption block_option(Packet& packet, CoapOptionNum option) {
+			::uint32_t value = 0;
+			CHECK(packet.get_option(option, value) == Packet::SUCCESS);
+			return CoapBlockOption(value);
+		}
+
+		void reset_upload() {
+			writes_ = 0;
+			written_length_ = 0;
+			last_written_ = false;
+			write_code_ = COAP_CODE_CHANGED;
+		}
+
+		LinkRadio server_radio_;
+		LinkRadio client_radio_;
+		LinkRand server_rand_;
+		LinkRand client_rand_;
+		Timer timer_;
+		Coap server_;
+		Coap client_;
+		::uint16_t msg_id_;
+
+		::size_t content_length_;
+		int reads_;
+		::uint8_t received_[MAX_CONTENT];
+		::size_t received_length_;
+		int done_;
+		int failed_;
+
+		::uint8_t written_[MAX_CONTENT];
+		::size_t written_length_;
+		int writes_;
+		bool last_written_;
+		CoapCode write_code_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
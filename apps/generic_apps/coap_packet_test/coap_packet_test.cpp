@@ -0,0 +1,467 @@
+/*
+ * Round trip checks for the serialized CoAP messages
+ * (radio/coap/coap_packet_builder.h, radio/coap/coap_packet_view.h):
+ * random messages are built into a buffer, parsed in place and copied
+ * into a CoapPacketStatic, which has to serialize the same bytes.
+ * Also the fenceposts, the end of options marker, the errors of the
+ * builder, truncated messages and the fenceposts of CoapPacketStatic
+ * while options are set and removed in any order.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include "util/pstl/static_string.h"
+#include "radio/coap/coap_packet_builder.h"
+#include "radio/coap/coap_packet_static.h"
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			MESSAGES = 2000,
+			BUFFER_SIZE = 512,
+			MAX_OPTIONS = 40,
+			MAX_OPTION_BYTES = 320,
+			MAX_PAYLOAD = 64
+		};
+
+		typedef CoapPacketView<Os, Os::Radio> View;
+		typedef CoapPacketBuilder<Os, Os::Radio> Builder;
+		typedef CoapPacketStatic<Os, Os::Radio, StaticString> Packet;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_round_trip();
+			test_fenceposts();
+			test_many_options();
+			test_builder_errors();
+			test_truncated();
+			test_static_options();
+
+			finish("coap_packet_test");
+		}
+
+		void test_round_trip() {
+			for(int m = 0; m < MESSAGES; m++) {
+				random_message();
+				size_t length = build(buffer_, BUFFER_SIZE);
+				CHECK(length > 0);
+				check_view(buffer_, length);
+
+				// the owned copy serializes the same bytes
+				View view;
+				view.parse(buffer_, length);
+				int status = packet_.parse_message(view);
+				CHECK(status == Packet::SUCCESS);
+				CHECK(packet_.serialize_length() == length);
+				uint8_t copy[BUFFER_SIZE];
+				size_t copy_length = packet_.serialize(copy);
+				CHECK(copy_length == length && memcmp(copy, buffer_, length) == 0);
+
+				// as well as a copy of the copy
+				Packet assigned;
+				assigned = packet_;
+				copy_length = assigned.serialize(copy);
+				CHECK(copy_length == length && memcmp(copy, buffer_, length) == 0);
+			}
+		}
+
+		/// Deltas above 14 are split by fenceposts at the multiples of 14
+		void test_fenceposts() {
+			uint8_t buffer[64];
+			Builder builder(buffer, sizeof(buffer));
+			builder.init(COAP_MSG_TYPE_CON, COAP_CODE_GET, 0x1234);
+			CHECK(builder.add_option(COAP_OPT_CONTENT_TYPE, 0) == Builder::SUCCESS);
+			CHECK(builder.add_option(COAP_OPT_URI_QUERY, (const uint8_t*) "q", 1) == Builder::SUCCESS);
+			CHECK(builder.add_option(COAP_OPT_HL_STATE, (const uint8_t*) "s", 1) == Builder::SUCCESS);
+			size_t length = builder.finish();
+			// 1 -> 15 has a delta of 14, 15 -> 23 does not need a fencepost either
+			static const uint8_t expected[] = { 0x43, 0x01, 0x12, 0x34, 0x10, 0xe1, 'q', 0x81, 's' };
+			CHECK(length == sizeof(expected) && memcmp(buffer, expected, length) == 0);
+
+			builder.init(COAP_MSG_TYPE_NON, COAP_CODE_GET, 1);
+			builder.add_option(COAP_OPT_BLOCK2, 1);
+			length = builder.finish();
+			// fencepost 14, then the delta 3 of BLOCK2
+			static const uint8_t block2[] = { 0x52, 0x01, 0x00, 0x01, 0xe0, 0x31, 0x01 };
+			CHECK(length == sizeof(block2) && memcmp(buffer, block2, length) == 0);
+
+			View view;
+			CHECK(view.parse(buffer, length) == View::SUCCESS);
+			CHECK(view.option_count() == 2);
+			CHECK(view.what_options_are_set() == ((1UL << COAP_OPT_FENCEPOST) | (1UL << COAP_OPT_BLOCK2)));
+			uint32_t value = 0;
+			CHECK(view.get_option(COAP_OPT_BLOCK2, value) == View::SUCCESS && value == 1);
+
+			builder.init(COAP_MSG_TYPE_NON, COAP_CODE_GET, 1);
+			builder.add_option(COAP_OPT_CONTENT_TYPE, 0);
+			builder.add_option(COAP_OPT_HL_STATE, (const uint8_t*) "", 0);
+			length = builder.finish();
+			// 1 -> 23: the fencepost goes to 14, not to 15
+			static const uint8_t hl_state[] = { 0x53, 0x01, 0x00, 0x01, 0x10, 0xd0, 0x90 };
+			CHECK(length == sizeof(hl_state) && memcmp(buffer, hl_state, length) == 0);
+		}
+
+		/// 15 options and more need the end of options marker
+		void test_many_options() {
+			for(int count = 12; count < 20; count++) {
+				char path[2 * 20 + 1];
+				for(int i = 0; i < count; i++) {
+					path[2 * i] = 'a' + i;
+					path[2 * i + 1] = '/';
+				}
+				path[2 * count] = '\0';
+
+				Builder builder(buffer_, BUFFER_SIZE);
+				builder.init(COAP_MSG_TYPE_CON, COAP_CODE_GET, count);
+				CHECK(builder.add_segments(COAP_OPT_URI_PATH, path, '/') == Builder::SUCCESS);
+				builder.set_data((const uint8_t*) "\xf0x", 2);
+				size_t length = builder.finish();
+				CHECK(length == 4 + 2 * count + (count >= 15 ? 1 : 0) + 2);
+				CHECK((buffer_[0] & 0x0f) == (count >= 15 ? 15 : count));
+
+				View view;
+				CHECK(view.parse(buffer_, length) == View::SUCCESS);
+				CHECK(view.option_count() == count);
+				// a payload starting like the marker stays payload
+				CHECK(view.data_length() == 2 && view.data()[0] == 0xf0);
+
+				packet_.parse_message(view);
+				StaticString uri = packet_.uri_path();
+				path[2 * count - 1] = '\0';
+				CHECK(uri == StaticString(path));
+			}
+		}
+
+		void test_builder_errors() {
+			uint8_t buffer[BUFFER_SIZE];
+			Builder builder(buffer, sizeof(buffer));
+
+			builder.init(COAP_MSG_TYPE_CON, COAP_CODE_GET, 1);
+			builder.add_option(COAP_OPT_TOKEN, (const uint8_t*) "t", 1);
+			CHECK(builder.add_option(COAP_OPT_URI_PATH, (const uint8_t*) "p", 1) == Builder::ERR_OPTION_ORDER);
+			// the builder stays in the error state
+			CHECK(builder.add_option(COAP_OPT_ACCEPT, 0) == Builder::ERR_OPTION_ORDER);
+			CHECK(builder.finish() == 0);
+
+			builder.init(COAP_MSG_TYPE_CON, COAP_CODE_GET, 1);
+			builder.add_option(COAP_OPT_TOKEN, (const uint8_t*) "t", 1);
+			CHECK(builder.add_option(COAP_OPT_TOKEN, (const uint8_t*) "u", 1) == Builder::ERR_MULTIPLE_OCCURENCES_OF_OPTION);
+
+			builder.init(COAP_MSG_TYPE_CON, COAP_CODE_GET, 1);
+			CHECK(builder.add_option(COAP_OPT_FENCEPOST, (const uint8_t*) "", 0) == Builder::ERR_UNKNOWN_OPT);
+			builder.init(COAP_MSG_TYPE_CON, COAP_CODE_GET, 1);
+			CHECK(builder.add_option((CoapOptionNum) (COAP_LARGEST_OPTION_NUMBER + 1), (const uint8_t*) "", 0) == Builder::ERR_UNKNOWN_OPT);
+			builder.init(COAP_MSG_TYPE_CON, COAP_CODE_GET, 1);
+			CHECK(builder.add_option(COAP_OPT_URI_PATH, 5) == Builder::ERR_WRONG_TYPE);
+			builder.init(COAP_MSG_TYPE_CON, COAP_CODE_GET, 1);
+			CHECK(builder.add_option(COAP_OPT_PROXY_URI, buffer, COAP_STRING_OPTS_MAXLEN + 1) == Builder::ERR_OPT_TOO_LONG);
+			builder.init(COAP_MSG_TYPE_CON, COAP_CODE_GET, 1);
+			CHECK(builder.add_segments(COAP_OPT_URI_PATH, "a//b", '/') == Builder::ERR_EMPTY_STRING_OPTION);
+
+			// a new message after an error
+			builder.init(COAP_MSG_TYPE_ACK, COAP_CODE_EMPTY, 7);
+			CHECK(builder.status() == Builder::SUCCESS);
+			CHECK(builder.finish() == 4);
+
+			// every buffer shorter than the message
+			for(int m = 0; m < 100; m++) {
+				random_message();
+				size_t length = build(buffer, sizeof(buffer));
+				for(size_t capacity = 0; capacity < length; capacity++) {
+					CHECK(build(buffer, capacity) == 0);
+				}
+				CHECK(build(buffer, length) == length);
+				check_view(buffer, length);
+			}
+		}
+
+		/// Nothing of a truncated message is read behind its end
+		void test_truncated() {
+			for(int m = 0; m < 200; m++) {
+				random_message();
+				size_t length = build(buffer_, BUFFER_SIZE);
+				size_t options_end = length - payload_length_;
+				for(size_t cut = 0; cut < length; cut++) {
+					View view;
+					int status = view.parse(buffer_, cut);
+					if(cut < COAP_START_OF_OPTIONS) {
+						CHECK(status == View::ERR_NOT_COAP);
+						continue;
+					}
+					// cut in the payload
+					if(cut >= options_end) {
+						CHECK(status == View::SUCCESS);
+						CHECK(view.data_length() == cut - options_end);
+					}
+					else {
+						CHECK(status != View::SUCCESS);
+					}
+
+					CHECK(view.options_end() <= buffer_ + cut);
+					for(int number = 0; number < COAP_OPTION_ARRAY_SIZE; number++) {
+						const uint8_t* option = view.option((CoapOptionNum) number);
+						if(option) {
+							CHECK(View::value_start(option) + View::value_length(option) <= buffer_ + cut);
+						}
+					}
+				}
+			}
+		}
+
+		/// CoapPacketStatic against a sorted list of the options it should hold
+		void test_static_options() {
+			static const uint8_t numbers[] = {
+				COAP_OPT_CONTENT_TYPE, COAP_OPT_PROXY_URI, COAP_OPT_ETAG, COAP_OPT_URI_HOST,
+				COAP_OPT_LOCATION_PATH, COAP_OPT_URI_PORT, COAP_OPT_URI_PATH, COAP_OPT_OBSERVE,
+				COAP_OPT_TOKEN, COAP_OPT_ACCEPT, COAP_OPT_URI_QUERY, COAP_OPT_BLOCK2,
+				COAP_OPT_CONDITION, COAP_OPT_BLOCK1, COAP_OPT_HL_STATE
+			};
+			const int count = sizeof(numbers) / sizeof(numbers[0]);
+
+			for(int round = 0; round < 50; round++) {
+				Packet packet;
+				type_ = COAP_MSG_TYPE_NON;
+				code_ = COAP_CODE_GET;
+				msg_id_ = round;
+				packet.set_type((CoapType) type_);
+				packet.set_code((CoapCode) code_);
+				packet.set_msg_id(msg_id_);
+				option_count_ = 0;
+				payload_length_ = 0;
+
+				for(int step = 0; step < 60; step++) {
+					uint8_t number = numbers[next_random() % count];
+					int action = next_random() % 4;
+					Option o;
+					random_value(number, o);
+
+					if(action == 0) {
+						packet.remove_option((CoapOptionNum) number);
+						remove_options(number);
+					}
+					else if(action == 1 || option_count_ >= 30) {
+						if(option_count_ >= 30) {
+							continue;
+						}
+						CHECK(set_option(packet, o, false) == Packet::SUCCESS);
+						remove_options(number);
+						insert_option(o);
+					}
+					else {
+						bool allowed = COAP_OPT_CAN_OCCUR_MULTIPLE[number] || !has_option(number);
+						int status = set_option(packet, o, true);
+						CHECK(status == (allowed ? (int) Packet::SUCCESS : (int) Packet::ERR_MULTIPLE_OCCURENCES_OF_OPTION));
+						if(allowed) {
+							insert_option(o);
+						}
+					}
+
+					size_t length = packet.serialize(buffer_);
+					CHECK(length == packet.serialize_length());
+					check_view(buffer_, length);
+				}
+			}
+		}
+
+	private:
+		struct Option {
+			uint8_t number;
+			uint8_t length;
+			uint8_t value[40];
+			uint32_t uint_value;
+		};
+
+		/// Random options in ascending order, repeated where it is allowed
+		void random_message() {
+			type_ = next_random() % 4;
+			code_ = next_random() % 256;
+			msg_id_ = next_random() ^ (next_random() << 8);
+			option_count_ = 0;
+			int bytes = 0;
+			for(int number = 1; number <= COAP_LARGEST_OPTION_NUMBER; number++) {
+				uint8_t format = COAP_OPTION_FORMAT[number];
+				if(format == COAP_FORMAT_UNKNOWN || number == COAP_OPT_FENCEPOST || next_random() % 3 != 0) { continue; }
+				int repeat = COAP_OPT_CAN_OCCUR_MULTIPLE[number] ? 1 + next_random() % 4 : 1;
+				for(int r = 0; r < repeat && option_count_ < MAX_OPTIONS && bytes < MAX_OPTION_BYTES; r++) {
+					Option& o = options_[option_count_++];
+					o.number = number;
+					if(format == COAP_FORMAT_UINT) {
+						int uint_bytes = next_random() % 5;
+						o.uint_value = uint_bytes ? ((next_random() << 17) ^ next_random()) >> (8 * (4 - uint_bytes)) : 0;
+						o.length = 0;
+						for(uint32_t v = o.uint_value; v; v >>= 8) { o.length++; }
+					}
+					else if(format == COAP_FORMAT_NONE) {
+						o.length = 0;
+					}
+					else {
+						// the long option header starts at 15 bytes
+						o.length = (next_random() % 2) ? next_random() % 15 : 13 + next_random() % 28;
+						for(int i = 0; i < o.length; i++) {
+							o.value[i] = next_random();
+						}
+					}
+					bytes += 2 + o.length;
+				}
+			}
+			payload_length_ = (next_random() % 4) ? next_random() % MAX_PAYLOAD : 0;
+			for(int i = 0; i < payload_length_; i++) {
+				payload_[i] = next_random();
+			}
+		}
+
+		void random_value(uint8_t number, Option& o) {
+			o.number = number;
+			if(COAP_OPTION_FORMAT[number] == COAP_FORMAT_UINT) {
+				o.uint_value = (next_random() % 4) ? 1 + next_random() % 0xfffe : 0x10000 + next_random();
+				o.length = 0;
+				for(uint32_t v = o.uint_value; v; v >>= 8) { o.length++; }
+			}
+			else {
+				// printable, the strings are passed as C strings
+				o.length = 1 + next_random() % ((COAP_OPTION_FORMAT[number] == COAP_FORMAT_STRING) ? 20 : 8);
+				for(int i = 0; i < o.length; i++) {
+					o.value[i] = 'a' + next_random() % 26;
+				}
+			}
+		}
+
+		int set_option(Packet& packet, Option& o, bool add) {
+			CoapOptionNum number = (CoapOptionNum) o.number;
+			uint8_t format = COAP_OPTION_FORMAT[o.number];
+			if(format == COAP_FORMAT_UINT) {
+				return add ? packet.add_option(number, o.uint_value) : packet.set_option(number, o.uint_value);
+			}
+			if(format == COAP_FORMAT_STRING) {
+				char cstr[sizeof(o.value) + 1];
+				memcpy(cstr, o.value, o.length);
+				cstr[o.length] = '\0';
+				StaticString value(cstr);
+				return add ? packet.add_option(number, value) : packet.set_option(number, value);
+			}
+			OpaqueData value(o.value, o.length);
+			return add ? packet.add_option(number, value) : packet.set_option(number, value);
+		}
+
+		bool has_option(uint8_t number) {
+			for(int i = 0; i < option_count_; i++) {
+				if(options_[i].number == number) { return true; }
+			}
+			return false;
+		}
+
+		void remove_options(uint8_t number) {
+			int kept = 0;
+			for(int i = 0; i < option_count_; i++) {
+				if(options_[i].number != number) { options_[kept++] = options_[i]; }
+			}
+			option_count_ = kept;
+		}
+
+		/// Behind the options with the same or smaller number
+		void insert_option(Option& o) {
+			int i = option_count_;
+			for(; i > 0 && options_[i - 1].number > o.number; i--) {
+				options_[i] = options_[i - 1];
+			}
+			options_[i] = o;
+			option_count_++;
+		}
+
+		size_t build(uint8_t* buffer, size_t capacity) {
+			Builder builder(buffer, capacity);
+			builder.init((CoapType) type_, (CoapCode) code_, msg_id_);
+			for(int i = 0; i < option_count_; i++) {
+				Option& o = options_[i];
+				if(COAP_OPTION_FORMAT[o.number] == COAP_FORMAT_UINT) {
+					builder.add_option((CoapOptionNum) o.number, o.uint_value);
+				}
+				else {
+					builder.add_option((CoapOptionNum) o.number, o.value, o.length);
+				}
+			}
+			builder.set_data(payload_, payload_length_);
+			return builder.finish();
+		}
+
+		/// The parsed message is the generated one
+		void check_view(uint8_t* buffer, size_t length) {
+			View view;
+			CHECK(view.parse(buffer, length) == View::SUCCESS);
+			CHECK(view.buffer() == buffer && view.length() == length);
+			CHECK(view.type() == type_ && view.code() == code_ && view.msg_id() == msg_id_);
+			CHECK(view.data_length() == (size_t) payload_length_);
+			CHECK(payload_length_ == 0 || memcmp(view.data(), payload_, payload_length_) == 0);
+			CHECK(payload_length_ != 0 || view.data() == 0);
+
+			uint32_t mask = 0;
+			for(int i = 0; i < option_count_; i++) {
+				Option& o = options_[i];
+				// the view gives the first occurrence
+				if(mask & (1UL << o.number)) { continue; }
+				mask |= 1UL << o.number;
+
+				OpaqueData value;
+				CHECK(view.get_option((CoapOptionNum) o.number, value) == View::SUCCESS);
+				if(COAP_OPTION_FORMAT[o.number] == COAP_FORMAT_UINT) {
+					uint32_t u = 0xdeadbeef;
+					CHECK(view.get_option((CoapOptionNum) o.number, u) == View::SUCCESS);
+					CHECK(u == o.uint_value);
+					CHECK(value.length() == o.length);
+				}
+				else {
+					CHECK(value.length() == o.length && memcmp(value.value(), o.value, o.length) == 0);
+				}
+			}
+
+			// every occurrence, in order, with the fenceposts skipped
+			const uint8_t* position = view.options_begin();
+			uint8_t number = 0;
+			int seen = 0;
+			int headers = 0;
+			while(position < view.options_end() && *position != COAP_END_OF_OPTIONS_MARKER) {
+				number += *position >> 4;
+				headers++;
+				if(number % COAP_OPT_FENCEPOST == 0) {
+					// the fenceposts are reported like the options
+					mask |= 1UL << number;
+				}
+				else {
+					Option& o = options_[seen++];
+					CHECK(number == o.number);
+					CHECK(View::value_length(position) == o.length);
+				}
+				position = View::value_start(position) + View::value_length(position);
+			}
+			CHECK(seen == option_count_);
+			CHECK(headers == view.option_count());
+			CHECK(view.what_options_are_set() == mask);
+		}
+
+		uint8_t type_;
+		uint8_t code_;
+		uint16_t msg_id_;
+		Option options_[MAX_OPTIONS];
+		int option_count_;
+		uint8_t payload_[MAX_PAYLOAD];
+		int payload_length_;
+
+		uint8_t buffer_[BUFFER_SIZE];
+		Packet packet_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
@@ -0,0 +1,463 @@
+/*
+ * Behaviour checks for the Echo neighborhood discovery
+ * (algorithms/neighbor_discovery/echo.h) on a fake timer and broadcast
+ * medium: the digest-only beacons that follow a missed full beacon, the
+ * announced period shift and the timeouts scaled by it, and the receive
+ * stability counted from the sequence numbers, across wraps and reboots.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include <algorithms/neighbor_discovery/echo.h>
+
+/// Echo takes the clock from the OS model
+struct EchoOs : public Os {
+	typedef FakeTimer<Os> Timer;
+	typedef FakeClock<Os, Timer> Clock;
+};
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			NODES = 3,
+			/// Instances of a node, one more for every reboot
+			BOOTS = 8,
+			ALG_ID = 1,
+			BEACON_PERIOD = 1000,
+			TIMEOUT = 9000,
+			SHORT_TIMEOUT = 3000,
+			MAX_PERIOD = BEACON_PERIOD << ECHO_MAX_PERIOD_SHIFT,
+			MAX_LOG = 64
+		};
+
+		typedef EchoOs::Timer Timer;
+		typedef EchoOs::Clock Clock;
+
+		/// Broadcast radio of one node, send() hands the beacon to the medium
+		struct Radio {
+			typedef ::uint16_t node_id_t;
+			typedef ::uint16_t size_t;
+			typedef ::uint8_t block_data_t;
+			typedef ::uint8_t message_id_t;
+			enum {
+				BROADCAST_ADDRESS = 0xffff,
+				NULL_NODE_ID = 0,
+				MAX_MESSAGE_LENGTH = 116
+			};
+
+			struct ExtendedData {
+				::uint16_t link_metric() const { return 0; }
+			};
+
+			typedef delegate4<void, node_id_t, size_t, block_data_t*, ExtendedData const&> recv_delegate_t;
+
+			Radio() : registered_(false) { }
+
+			int enable_radio() { return 0; }
+			node_id_t id() { return id_; }
+
+			template<class T, void (T::*TMethod)(node_id_t, size_t, block_data_t*, ExtendedData const&)>
+			int reg_recv_callback(T* obj) {
+				recv_ = recv_delegate_t::template from_method<T, TMethod>(obj);
+				registered_ = true;
+				return 0;
+			}
+
+			int unreg_recv_callback(int) {
+				registered_ = false;
+				return 0;
+			}
+
+			int send(node_id_t, size_t len, block_data_t* data) {
+				app_->send(id_, len, data);
+				return 0;
+			}
+
+			void receive(node_id_t from, size_t len, block_data_t* data) {
+				if(registered_) { recv_(from, len, data, ExtendedData()); }
+			}
+
+			App* app_;
+			node_id_t id_;
+			recv_delegate_t recv_;
+			bool registered_;
+		};
+
+		typedef Echo<EchoOs, Radio, Timer, Os::Debug> Echo_t;
+		typedef Echo_t::EchoMsg_t Msg;
+		typedef Radio::node_id_t node_id_t;
+
+		/// A node with the events its Echo generated, indexed by the node id
+		struct Node {
+			Node(App* app, node_id_t id) : app_(app), boot(-1) {
+				radio.app_ = app;
+				radio.id_ = id;
+				for(int i = 0; i <= NODES; i++) {
+					new_nb[i] = new_bidi[i] = lost_bidi[i] = dropped[i] = 0;
+					dropped_at[i] = 0;
+				}
+			}
+
+			Echo_t& echo() { return instances[boot]; }
+
+			void on_event(::uint8_t event, node_id_t from, ::uint8_t, ::uint8_t*) {
+				if(event == Echo_t::NEW_NB) { new_nb[from]++; }
+				else if(event == Echo_t::NEW_NB_BIDI) { new_bidi[from]++; }
+				else if(event == Echo_t::LOST_NB_BIDI) { lost_bidi[from]++; }
+				else if(event == Echo_t::DROPPED_NB) {
+					dropped[from]++;
+					dropped_at[from] = app_->timer_->now();
+				}
+			}
+
+			App* app_;
+			Radio radio;
+			Echo_t instances[BOOTS];
+			int boot;
+			int new_nb[NODES + 1];
+			int new_bidi[NODES + 1];
+			int lost_bidi[NODES + 1];
+			int dropped[NODES + 1];
+			::uint32_t dropped_at[NODES + 1];
+		};
+
+		/// A beacon of the traced link
+		struct Delivery {
+			bool full;
+			bool dropped;
+			/// The receiver sees the sender as bidi after the beacon
+			bool bidi;
+		};
+
+		App() : timer_(0), clock_(0) {
+			for(int i = 0; i < NODES; i++) { nodes_[i] = 0; }
+		}
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_missed_full_beacon();
+			test_period_shift();
+			test_seq();
+			reset();
+
+			finish("echo_test");
+		}
+
+		/// A receiver that missed the full beacon waits for the next one
+		void test_missed_full_beacon() {
+			reset();
+			// 1 hears 2 later, then 1's list changes
+			link_[1][0] = false;
+			start(0, TIMEOUT);
+			timer_->advance(100);
+			start(1, TIMEOUT);
+			timer_->advance(5000);
+			CHECK(echo(1).is_neighbor(1) && !echo(1).is_neighbor_bidi(1));
+			CHECK(!echo(0).is_neighbor(2));
+
+			trace_from_ = 0;
+			trace_to_ = 1;
+			link_[1][0] = true;
+			drop_listing_[0][1] = true;
+			timer_->advance(60000);
+			trace_from_ = -1;
+			CHECK(dropped_count_ == 1);
+
+			int dropped = -1;
+			for(int i = 0; i < log_size_ && dropped < 0; i++) {
+				if(log_[i].dropped) { dropped = i; }
+			}
+			CHECK(dropped >= 0);
+			CHECK(log_[dropped].full);
+			// the digest of the new list does not tell which nodes are in it
+			int i = dropped + 1;
+			for(; i < log_size_ && !log_[i].full; i++) {
+				CHECK(!log_[i].bidi);
+			}
+			CHECK(i > dropped + 1);
+			CHECK(i < log_size_ && log_[i].bidi);
+			CHECK(nodes_[1]->new_bidi[1] == 1);
+			CHECK(echo(0).is_neighbor_bidi(2));
+
+			// the known digest keeps the bidi state, lists go out with the full beacons only
+			int beacons[NODES];
+			int full[NODES];
+			for(int n = 0; n < 2; n++) {
+				beacons[n] = beacons_[n];
+				full[n] = full_beacons_[n];
+			}
+			timer_->advance(400000);
+			for(int n = 0; n < 2; n++) {
+				CHECK(beacons_[n] - beacons[n] >= 100);
+				CHECK(full_beacons_[n] - full[n] <= (beacons_[n] - beacons[n]) / ECHO_FULL_BEACON_INTERVAL + 1);
+				CHECK(nodes_[n]->lost_bidi[2 - n] == 0 && nodes_[n]->dropped[2 - n] == 0);
+				CHECK(nodes_[n]->new_bidi[2 - n] == 1);
+			}
+		}
+
+		/// The period doubles in a stable neighborhood, the neighbors scale their timeouts
+		void test_period_shift() {
+			reset();
+			start(0, SHORT_TIMEOUT);
+			timer_->advance(100);
+			start(1, SHORT_TIMEOUT);
+			timer_->advance(60000);
+			CHECK(shift_[0] == ECHO_MAX_PERIOD_SHIFT && shift_[1] == ECHO_MAX_PERIOD_SHIFT);
+			CHECK(echo(0).is_neighbor_bidi(2) && echo(1).is_neighbor_bidi(1));
+
+			// a new neighbor brings the period back to beacon_period
+			min_shift_[0] = min_shift_[1] = ECHO_MAX_PERIOD_SHIFT;
+			start(2, SHORT_TIMEOUT);
+			timer_->advance(MAX_PERIOD);
+			CHECK(min_shift_[0] == 0 && min_shift_[1] == 0);
+			timer_->advance(60000);
+			for(int n = 0; n < NODES; n++) {
+				CHECK(shift_[n] == ECHO_MAX_PERIOD_SHIFT);
+				CHECK(echo(n).bidi_nb_size() == NODES - 1);
+			}
+
+			// 3 falls silent, it is dropped after the timeout of its announced period
+			link_[2][0] = link_[2][1] = false;
+			::uint32_t period = (::uint32_t)BEACON_PERIOD << shift_[2];
+			::uint32_t deadline = sent_at_[2] + SHORT_TIMEOUT + 2 * (period - BEACON_PERIOD);
+			timer_->advance(deadline + MAX_PERIOD - timer_->now());
+			for(int n = 0; n < 2; n++) {
+				CHECK(nodes_[n]->dropped[3] == 1);
+				CHECK(nodes_[n]->dropped_at[3] > deadline && nodes_[n]->dropped_at[3] <= deadline + MAX_PERIOD);
+				CHECK(!echo(n).is_neighbor(3));
+			}
+
+			// 3 comes back, the entry is reused and counts on
+			link_[2][0] = link_[2][1] = true;
+			timer_->advance(60000);
+			for(int n = 0; n < NODES; n++) {
+				CHECK(echo(n).bidi_nb_size() == NODES - 1);
+			}
+			CHECK(nodes_[0]->new_nb[3] == 2 && nodes_[1]->new_nb[3] == 2);
+			CHECK(nodes_[0]->dropped[2] == 0 && nodes_[1]->dropped[1] == 0);
+		}
+
+		/// The receive stability follows the sequence numbers, also when 1 reboots
+		void test_seq() {
+			reset();
+			drop_every_[0][1] = 4;
+			drop_every_[2][1] = 3;
+			for(int n = 0; n < NODES; n++) {
+				start(n, TIMEOUT);
+				timer_->advance(100);
+			}
+			// the sequence numbers wrap
+			timer_->advance(1200000);
+			CHECK(seq_wrapped_);
+
+			// up to about 200 beacons per boot, the last seen number is in either half
+			for(int r = 1; r < BOOTS; r++) {
+				reboot(0, TIMEOUT);
+				timer_->advance(20000 + (::uint32_t)next_random() * 25);
+			}
+			for(int n = 1; n < NODES; n++) {
+				// a reboot is no timeout, the neighbors only see the empty list of 1
+				CHECK(nodes_[n]->dropped[1] == 0);
+				CHECK(nodes_[n]->lost_bidi[1] == BOOTS - 1);
+				CHECK(nodes_[n]->new_bidi[1] == BOOTS);
+				CHECK(echo(n).is_neighbor_bidi(1));
+			}
+			int stability = echo(1).get_nb_receive_stability(1);
+			CHECK(stability >= 70 && stability <= 80);
+		}
+
+		/// The medium, the beacon is checked and delivered to the nodes in range
+		void send(node_id_t id, Radio::size_t len, Radio::block_data_t* data) {
+			int s = id - 1;
+			Msg& msg = *(Msg*)data;
+			::uint32_t now = timer_->now();
+			bool full = msg.nb_list_included();
+
+			if(sent_[s]) {
+				// the previous beacon announced this period
+				CHECK(now - sent_at_[s] == (::uint32_t)BEACON_PERIOD << shift_[s]);
+				::uint8_t next = seq_[s] + 1;
+				CHECK(msg.seq() == next);
+				if(next == 0) { seq_wrapped_ = true; }
+			}
+			else {
+				CHECK(msg.seq() == 1);
+				CHECK(full);
+			}
+			CHECK(msg.period_shift() <= ECHO_MAX_PERIOD_SHIFT);
+			if(full) {
+				CHECK(msg.nb_digest() == msg.nb_list_digest());
+				digest_[s] = msg.nb_digest();
+				full_beacons_[s]++;
+			}
+			else {
+				// the list only changes with a full beacon
+				CHECK(msg.nb_list_size() == 0);
+				CHECK(msg.nb_digest() == digest_[s]);
+			}
+			sent_[s] = true;
+			sent_at_[s] = now;
+			shift_[s] = msg.period_shift();
+			if(shift_[s] < min_shift_[s]) { min_shift_[s] = shift_[s]; }
+			seq_[s] = msg.seq();
+			beacons_[s]++;
+
+			for(int r = 0; r < NODES; r++) {
+				if(r != s && nodes_[r]->boot >= 0) { deliver(s, r, len, data, msg); }
+			}
+		}
+
+	private:
+		void deliver(int s, int r, Radio::size_t len, Radio::block_data_t* data, Msg& msg) {
+			if(!link_[s][r]) { return; }
+			bool traced = (s == trace_from_ && r == trace_to_ && log_size_ < MAX_LOG);
+			bool drop = drop_every_[s][r] && msg.seq() % drop_every_[s][r] == 0;
+			if(drop_listing_[s][r] && msg.nb_list_included() && lists(msg, r + 1)) {
+				drop = true;
+				drop_listing_[s][r] = false;
+			}
+			if(drop) {
+				dropped_count_++;
+				if(traced) {
+					log_[log_size_].full = msg.nb_list_included();
+					log_[log_size_].dropped = true;
+					log_[log_size_++].bidi = false;
+				}
+				return;
+			}
+
+			// what the receiver should have counted, since the first beacon of this boot
+			if(counting_[s][r]) {
+				expected_[s][r] += (::uint8_t)(msg.seq() - last_seq_[s][r]);
+				received_[s][r]++;
+			}
+			else {
+				counting_[s][r] = true;
+				expected_[s][r] = 1;
+				received_[s][r] = 1;
+			}
+			last_seq_[s][r] = msg.seq();
+
+			nodes_[r]->radio.receive(s + 1, len, data);
+
+			int stability = echo(r).get_nb_receive_stability(s + 1);
+			CHECK(stability == (int)(received_[s][r] * 100 / expected_[s][r]));
+			if(traced) {
+				log_[log_size_].full = msg.nb_list_included();
+				log_[log_size_].dropped = false;
+				log_[log_size_++].bidi = echo(r).is_neighbor_bidi(s + 1);
+			}
+		}
+
+		bool lists(Msg& msg, node_id_t id) {
+			for(int i = 0; i < msg.nb_list_size(); i += sizeof(node_id_t)) {
+				if(read<Os, Radio::block_data_t, node_id_t>(msg.payload() + i) == id) { return true; }
+			}
+			return false;
+		}
+
+		/// A fresh network, nodes that are not started do not hear anything
+		void reset() {
+			for(int i = 0; i < NODES; i++) {
+				delete nodes_[i];
+				nodes_[i] = 0;
+			}
+			delete clock_;
+			delete timer_;
+			timer_ = new Timer;
+			clock_ = new Clock;
+			clock_->init(*timer_);
+
+			for(int s = 0; s < NODES; s++) {
+				nodes_[s] = new Node(this, s + 1);
+				sent_[s] = false;
+				shift_[s] = 0;
+				min_shift_[s] = 0;
+				beacons_[s] = 0;
+				full_beacons_[s] = 0;
+				for(int r = 0; r < NODES; r++) {
+					link_[s][r] = true;
+					drop_every_[s][r] = 0;
+					drop_listing_[s][r] = false;
+					counting_[s][r] = false;
+				}
+			}
+			dropped_count_ = 0;
+			seq_wrapped_ = false;
+			trace_from_ = trace_to_ = -1;
+			log_size_ = 0;
+		}
+
+		void start(int n, ::uint16_t timeout) {
+			Node& node = *nodes_[n];
+			node.boot++;
+			Echo_t& e = node.echo();
+			e.init(node.radio, *clock_, *timer_, *debug_, BEACON_PERIOD, timeout);
+			e.reg_event_callback<Node, &Node::on_event>(ALG_ID,
+				Echo_t::NEW_NB | Echo_t::NEW_NB_BIDI | Echo_t::DROPPED_NB | Echo_t::LOST_NB_BIDI, &node);
+			e.enable();
+		}
+
+		/// A new instance takes over the radio, the old one keeps its timer but stays quiet
+		void reboot(int n, ::uint16_t timeout) {
+			Echo_t& old = echo(n);
+			old.unreg_event_callback(ALG_ID);
+			old.disable();
+			sent_[n] = false;
+			for(int i = 0; i < NODES; i++) {
+				counting_[n][i] = false;
+				counting_[i][n] = false;
+			}
+			start(n, timeout);
+		}
+
+		Echo_t& echo(int n) { return nodes_[n]->echo(); }
+
+		Timer* timer_;
+		Clock* clock_;
+		Node* nodes_[NODES];
+
+		bool link_[NODES][NODES];
+		/// Beacons with a sequence number divisible by it are lost
+		::uint8_t drop_every_[NODES][NODES];
+		/// The next full beacon that lists the receiver is lost
+		bool drop_listing_[NODES][NODES];
+		int dropped_count_;
+
+		bool sent_[NODES];
+		::uint32_t sent_at_[NODES];
+		::uint8_t shift_[NODES];
+		/// Smallest shift announced since the test set it
+		::uint8_t min_shift_[NODES];
+		::uint8_t seq_[NODES];
+		::uint16_t digest_[NODES];
+		int beacons_[NODES];
+		int full_beacons_[NODES];
+		bool seq_wrapped_;
+
+		bool counting_[NODES][NODES];
+		::uint8_t last_seq_[NODES][NODES];
+		::uint32_t received_[NODES][NODES];
+		::uint32_t expected_[NODES][NODES];
+
+		int trace_from_;
+		int trace_to_;
+		Delivery log_[MAX_LOG];
+		int log_size_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
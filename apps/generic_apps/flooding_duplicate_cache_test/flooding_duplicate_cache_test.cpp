@@ -0,0 +1,255 @@
+/*
+ * Behaviour checks for the sequence number window and the duplicate cache of
+ * the flooding algorithm (algorithms/routing/flooding/flooding_duplicate_cache.h).
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include <algorithms/routing/flooding/flooding_duplicate_cache.h>
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			STREAM_FIRST = 1000,
+			STREAM_LENGTH = 20000,
+			/// Packets are delivered at most this far behind the newest one
+			MAX_DISPLACEMENT = 24,
+			PENDING = 64
+		};
+
+		typedef FloodingSequenceWindow<uint16_t> Window;
+		typedef FloodingSequenceWindow<uint8_t> Window8;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_window();
+			test_wraparound();
+			test_restart();
+			test_reordered_stream();
+			test_cache_lru();
+			test_cache_hot_origin();
+
+			finish("flooding_duplicate_cache_test");
+		}
+
+		void test_window() {
+			Window w;
+			CHECK(!w.valid());
+			CHECK(w.accept(5));
+			CHECK(!w.accept(5));
+			CHECK(w.valid() && w.highest() == 5);
+
+			// out of order within the window
+			CHECK(w.accept(7));
+			CHECK(w.accept(6));
+			CHECK(!w.accept(6));
+			CHECK(!w.accept(7));
+
+			// 38 - 8 is still inside the window, 7 was seen before
+			CHECK(w.accept(38));
+			CHECK(!w.accept(7));
+			CHECK(w.accept(8));
+			CHECK(!w.accept(8));
+			CHECK(w.highest() == 38);
+
+			// a jump of more than the window forgets everything below it
+			CHECK(w.accept(38 + Window::WINDOW + 10));
+			CHECK(w.accept(38 + 11));
+			CHECK(!w.accept(38 + 11));
+
+			w.reset();
+			CHECK(!w.valid());
+			CHECK(w.accept(38 + 11));
+		}
+
+		void test_wraparound() {
+			Window8 w;
+			for(int i = 0; i < 1000; i++) {
+				CHECK(w.accept((uint8_t)i));
+				CHECK(!w.accept((uint8_t)i));
+			}
+
+			// across the wrap, 0 after 255 is one ahead and not a restart
+			Window8 r;
+			for(int i = 250; i < 256; i++) { CHECK(r.accept((uint8_t)i)); }
+			CHECK(r.accept(0));
+			CHECK(!r.accept(255));
+			CHECK(!r.accept(250));
+			CHECK(r.accept(2));
+			CHECK(r.accept(1));
+			CHECK(!r.accept(1));
+
+			Window u;
+			CHECK(u.accept(65535 - 3));
+			CHECK(u.accept(2));
+			CHECK(u.accept(65535));
+			CHECK(!u.accept(65535 - 3));
+			CHECK(!u.accept(2));
+		}
+
+		void test_restart() {
+			// far behind the window: the originator started over
+			Window w;
+			CHECK(w.accept(1000));
+			CHECK(w.accept(1000 - Window::WINDOW));
+			CHECK(w.highest() == 1000 - Window::WINDOW);
+			CHECK(!w.accept(1000 - Window::WINDOW));
+
+			// the initial number restarts the window once the highest is 2 or more
+			Window r;
+			for(int i = 1; i < 10; i++) { CHECK(r.accept(i)); }
+			CHECK(r.accept(0));
+			CHECK(r.highest() == 0);
+			CHECK(!r.accept(0));
+			CHECK(r.accept(1));
+			CHECK(r.accept(2));
+
+			// unless it was seen within the window, a late copy of the first packet
+			Window d;
+			for(int i = 0; i < 10; i++) { CHECK(d.accept(i)); }
+			CHECK(!d.accept(0));
+			CHECK(d.highest() == 9);
+			CHECK(!d.accept(5));
+			CHECK(d.accept(10));
+			// out of the window it is a restart again
+			for(int i = 11; i < Window::WINDOW + 5; i++) { CHECK(d.accept(i)); }
+			CHECK(d.accept(0));
+			CHECK(d.highest() == 0);
+
+			// but not while the first packets are reordered
+			Window s;
+			CHECK(s.accept(1));
+			CHECK(s.accept(0));
+			CHECK(!s.accept(0));
+			CHECK(!s.accept(1));
+
+			// INIT_SEQ_P selects the number the originator starts with
+			FloodingSequenceWindow<uint16_t, 1> t;
+			CHECK(t.accept(2));
+			CHECK(t.accept(3));
+			CHECK(t.accept(0));
+			CHECK(!t.accept(0));
+			CHECK(t.accept(1));
+			CHECK(t.highest() == 1);
+			CHECK(!t.accept(1));
+		}
+
+		/**
+		 * Every packet of one originator is delivered once or twice, out
+		 * of order but at most MAX_DISPLACEMENT behind the newest packet:
+		 * exactly the first copy of each one has to be accepted.
+		 */
+		void test_reordered_stream() {
+			Window w;
+			uint16_t pending[PENDING];
+			int n_pending = 0;
+			int next = 0;
+			int delivered = 0;
+			int duplicates = 0;
+			memset(seen_, 0, sizeof(seen_));
+
+			while(next < STREAM_LENGTH || n_pending) {
+				// packets that fell too far behind have to be delivered now
+				int i = -1;
+				for(int j = 0; j < n_pending; j++) {
+					if(next - pending[j] >= MAX_DISPLACEMENT) { i = j; break; }
+				}
+
+				if(i < 0 && next < STREAM_LENGTH && (n_pending < 2 || next_random() % 2)) {
+					pending[n_pending++] = next;
+					if(next_random() % 4 == 0 && n_pending < PENDING) { pending[n_pending++] = next; }
+					next++;
+					continue;
+				}
+
+				if(i < 0) { i = next_random() % n_pending; }
+				uint16_t seq = pending[i];
+				pending[i] = pending[--n_pending];
+
+				bool accepted = w.accept((uint16_t)(STREAM_FIRST + seq));
+				CHECK(accepted == !seen_[seq]);
+				if(accepted) { delivered++; }
+				else { duplicates++; }
+				seen_[seq] = true;
+			}
+
+			CHECK(delivered == STREAM_LENGTH);
+			CHECK(duplicates > 0);
+		}
+
+		/// A single bucket: the entry used longest ago is replaced
+		void test_cache_lru() {
+			FloodingDuplicateCache<Os, uint16_t, uint8_t, 4, 4> c;
+			CHECK(c.size() == 0);
+			for(uint16_t o = 1; o <= 4; o++) { CHECK(c.accept(o, 10)); }
+			CHECK(c.size() == 4);
+			CHECK(c.evictions() == 0);
+
+			// 2 is now the least recently used
+			CHECK(!c.accept(1, 10));
+			CHECK(c.accept(5, 10));
+			CHECK(c.size() == 4);
+			CHECK(c.evictions() == 1);
+			CHECK(!c.accept(1, 10));
+			CHECK(!c.accept(3, 10));
+			CHECK(!c.accept(4, 10));
+			CHECK(!c.accept(5, 10));
+
+			// 2 was forgotten, it pushes out 1
+			CHECK(c.accept(2, 10));
+			CHECK(c.evictions() == 2);
+			CHECK(!c.accept(2, 10));
+
+			// an erased originator frees its slot without an eviction
+			c.erase(3);
+			CHECK(c.size() == 3);
+			CHECK(c.accept(3, 10));
+			CHECK(c.size() == 4);
+			CHECK(c.evictions() == 2);
+
+			// the initial number resets the window of a known originator
+			CHECK(c.accept(4, 11));
+			CHECK(c.accept(4, 0));
+			CHECK(c.accept(4, 10));
+
+			c.clear();
+			CHECK(c.size() == 0);
+			CHECK(c.accept(5, 10));
+		}
+
+		/// A frequently flooding originator survives a stream of new ones
+		void test_cache_hot_origin() {
+			FloodingDuplicateCache<Os, uint32_t, uint16_t, 8, 4> c;
+			for(int i = 0; i < 200; i++) {
+				CHECK(c.accept(7, i));
+				CHECK(!c.accept(7, i));
+				c.accept(1000 + i, 0);
+				CHECK(c.size() <= 8);
+			}
+			CHECK(c.size() == 8);
+			CHECK(!c.accept(7, 199));
+			CHECK(c.evictions() > 0);
+
+			c.erase(7);
+			CHECK(c.accept(7, 199));
+		}
+
+	private:
+		bool seen_[STREAM_LENGTH];
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
@@ -0,0 +1,320 @@
+
+/*
+ * Throughput and quality benchmark for the hash functions in algorithms/hash.
+ * PC only, see README for usage and output format.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+typedef Os::block_data_t block_data_t;
+typedef Os::size_t size_type;
+
+#include <util/split_n3.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+	#define HASH_BENCHMARK_HAVE_RDTSC 1
+#else
+	#define HASH_BENCHMARK_HAVE_RDTSC 0
+#endif
+
+#include <algorithms/hash/bernstein.h>
+#include <algorithms/hash/crc16.h>
+#include <algorithms/hash/crc16_sliced.h>
+#include <algorithms/hash/elf.h>
+#include <algorithms/hash/firstchar.h>
+#include <algorithms/hash/fletcher.h>
+#include <algorithms/hash/fnv.h>
+#include <algorithms/hash/jenkins_lookup2.h>
+#include <algorithms/hash/jenkins_lookup3.h>
+#include <algorithms/hash/jenkins_one_at_a_time.h>
+#include <algorithms/hash/kr.h>
+#include <algorithms/hash/larson.h>
+#include <algorithms/hash/modified_bernstein.h>
+#include <algorithms/hash/murmur.h>
+#include <algorithms/hash/novak.h>
+#include <algorithms/hash/sdbm.h>
+#include <algorithms/hash/xxhash.h>
+#include <algorithms/hash/hash_many.h>
+
+class App {
+	public:
+		enum {
+			MAX_LINE_LENGTH = 20480,
+			/// Total number of bytes to hash per throughput measurement
+			THROUGHPUT_BYTES = 64 * 1024 * 1024,
+			LONG_KEY_LENGTH = 4096,
+			AVALANCHE_KEYS = 2000,
+			AVALANCHE_MAX_KEY_LENGTH = 64,
+			BUCKET_BITS = 16
+		};
+
+		void init(Os::AppMainParameter& amp) {
+			bool n3 = (amp.argc > 1) && (strcmp(amp.argv[1], "n3") == 0);
+			only_ = (amp.argc > 2) ? amp.argv[2] : 0;
+			if(amp.argc > 1 && !n3 && strcmp(amp.argv[1], "elements") != 0) {
+				only_ = amp.argv[1];
+			}
+
+			read_corpus(n3);
+			if(keys_.empty()) {
+				std::cerr << "hash_benchmark: no keys on stdin" << std::endl;
+				return;
+			}
+
+			bench< Bernstein<Os, ::uint8_t> >("bernstein8");
+			bench< Bernstein<Os, ::uint16_t> >("bernstein16");
+			bench< Bernstein<Os, ::uint32_t> >("bernstein32");
+			bench< Bernstein<Os, ::uint64_t> >("bernstein64");
+			bench< ModifiedBernstein<Os, ::uint8_t> >("bernstein2_8");
+			bench< ModifiedBernstein<Os, ::uint16_t> >("bernstein2_16");
+			bench< ModifiedBernstein<Os, ::uint32_t> >("bernstein2_32");
+			bench< ModifiedBernstein<Os, ::uint64_t> >("bernstein2_64");
+			bench< Crc16<Os> >("crc16");
+			bench< Crc16Sliced<Os, 1> >("crc16_sliced1");
+			bench< Crc16Sliced<Os, 8> >("crc16_sliced8");
+			bench< Elf<Os> >("elf32");
+			bench< Firstchar<Os> >("firstchar8");
+			bench< Fletcher<Os, ::uint16_t> >("fletcher16");
+			bench< Fnv1<Os, ::uint16_t> >("fnv1_16");
+			bench< Fnv1<Os, ::uint32_t> >("fnv1_32");
+			bench< Fnv1<Os, ::uint64_t> >("fnv1_64");
+			bench< Fnv1a<Os, ::uint16_t> >("fnv1a_16");
+			bench< Fnv1a<Os, ::uint32_t> >("fnv1a_32");
+			bench< Fnv1a<Os, ::uint64_t> >("fnv1a_64");
+			bench< JenkinsLookup2<Os> >("lookup2_32");
+			bench< JenkinsLookup3<Os> >("lookup3_32");
+			bench< JenkinsOneAtATime<Os> >("oneatatime_32");
+			bench< Kr<Os, ::uint8_t> >("kr8");
+			bench< Kr<Os, ::uint16_t> >("kr16");
+			bench< Kr<Os, ::uint32_t> >("kr32");
+			bench< Kr<Os, ::uint64_t> >("kr64");
+			bench< Larson<Os, ::uint8_t> >("larson8");
+			bench< Larson<Os, ::uint16_t> >("larson16");
+			bench< Larson<Os, ::uint32_t> >("larson32");
+			bench< Larson<Os, ::uint64_t> >("larson64");
+			bench< Murmur<Os> >("murmur32");
+			bench< Novak<Os, ::uint8_t> >("novak8");
+			bench< Novak<Os, ::uint16_t> >("novak16");
+			bench< Novak<Os, ::uint32_t> >("novak32");
+			bench< Novak<Os, ::uint64_t> >("novak64");
+			bench< Sdbm<Os, ::uint8_t> >("sdbm8");
+			bench< Sdbm<Os, ::uint16_t> >("sdbm16");
+			bench< Sdbm<Os, ::uint32_t> >("sdbm32");
+			bench< Sdbm<Os, ::uint64_t> >("sdbm64");
+			bench< XxHash64<Os> >("xxhash64");
+		}
+
+	private:
+
+		/**
+		 * Read keys from stdin (one per line or split from N3 statements),
+		 * removing duplicates.
+		 */
+		void read_corpus(bool n3) {
+			static char line[MAX_LINE_LENGTH];
+			SplitN3<Os> splitter;
+
+			while(std::cin.getline(line, MAX_LINE_LENGTH)) {
+				if(n3) {
+					splitter.parse_line(line);
+					for(size_type i = 0; i < splitter.size(); i++) {
+						keys_.push_back(std::string(splitter[i]));
+					}
+				}
+				else if(line[0]) {
+					keys_.push_back(std::string(line));
+				}
+			}
+
+			std::sort(keys_.begin(), keys_.end());
+			keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+
+			key_bytes_ = 0;
+			pointers_.resize(keys_.size());
+			lengths_.resize(keys_.size());
+			for(size_type i = 0; i < keys_.size(); i++) {
+				pointers_[i] = (const block_data_t*)keys_[i].data();
+				lengths_[i] = keys_[i].size();
+				key_bytes_ += keys_[i].size();
+			}
+		}
+
+		static double now_ns() {
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return ts.tv_sec * 1e9 + ts.tv_nsec;
+		}
+
+		static unsigned long long cycles() {
+		#if HASH_BENCHMARK_HAVE_RDTSC
+			return __rdtsc();
+		#else
+			return 0;
+		#endif
+		}
+
+		/**
+		 * Number of keys that share their hash value with at least one other
+		 * key.
+		 */
+		template<typename T>
+		static unsigned long long count_collisions(std::vector<T>& v) {
+			std::sort(v.begin(), v.end());
+			unsigned long long r = 0;
+			for(size_type i = 0; i < v.size(); ) {
+				size_type j = i + 1;
+				while(j < v.size() && v[j] == v[i]) { j++; }
+				if(j - i > 1) { r += j - i; }
+				i = j;
+			}
+			return r;
+		}
+
+		/**
+		 * Expected value of count_collisions() for n keys and a random
+		 * function onto 2^bits values.
+		 */
+		static double expected_collisions(double n, int bits) {
+			double m = ldexp(1.0, bits);
+			return n * -expm1((n - 1.0) * log1p(-1.0 / m));
+		}
+
+		template<typename Hash>
+		void bench(const char *name) {
+			typedef typename Hash::hash_t hash_t;
+			const int bits = 8 * sizeof(hash_t);
+
+			if(only_ && strcmp(only_, name) != 0) { return; }
+
+			size_type n = keys_.size();
+			hash_t sink = 0;
+
+			// Short keys: the corpus itself
+
+			size_type rounds = THROUGHPUT_BYTES / (key_bytes_ + 1) + 1;
+			double t0 = now_ns();
+			unsigned long long c0 = cycles();
+			for(size_type r = 0; r < rounds; r++) {
+				for(size_type i = 0; i < n; i++) {
+					sink ^= Hash::hash(pointers_[i], lengths_[i]);
+				}
+			}
+			unsigned long long c1 = cycles();
+			double t1 = now_ns();
+			double short_cpb = HASH_BENCHMARK_HAVE_RDTSC ? (double)(c1 - c0) / ((double)rounds * key_bytes_) : -1.0;
+			double short_ns = (t1 - t0) / ((double)rounds * n);
+
+			// Batched
+
+			std::vector<hash_t> hashes(n);
+			t0 = now_ns();
+			for(size_type r = 0; r < rounds; r++) {
+				HashMany<Hash>::hash_many(&pointers_[0], &lengths_[0], n, &hashes[0]);
+				sink ^= hashes[r % n];
+			}
+			t1 = now_ns();
+			double batch_ns = (t1 - t0) / ((double)rounds * n);
+
+			// Long keys
+
+			block_data_t long_key[LONG_KEY_LENGTH];
+			for(size_type i = 0; i < LONG_KEY_LENGTH; i++) {
+				long_key[i] = pointers_[i % n][0] ^ (block_data_t)(i * 131);
+			}
+			size_type long_rounds = THROUGHPUT_BYTES / LONG_KEY_LENGTH;
+			t0 = now_ns();
+			c0 = cycles();
+			for(size_type r = 0; r < long_rounds; r++) {
+				long_key[0] = (block_data_t)r;
+				sink ^= Hash::hash(long_key, LONG_KEY_LENGTH);
+			}
+			c1 = cycles();
+			t1 = now_ns();
+			double long_cpb = HASH_BENCHMARK_HAVE_RDTSC ? (double)(c1 - c0) / ((double)long_rounds * LONG_KEY_LENGTH) : -1.0;
+			double long_mbs = ((double)long_rounds * LONG_KEY_LENGTH) / ((t1 - t0) / 1e9) / (1024.0 * 1024.0);
+
+			// Collisions
+
+			for(size_type i = 0; i < n; i++) {
+				hashes[i] = Hash::hash(pointers_[i], lengths_[i]);
+			}
+			std::vector< ::uint32_t> buckets(n);
+			for(size_type i = 0; i < n; i++) {
+				buckets[i] = (::uint32_t)(hashes[i] & ((1UL << BUCKET_BITS) - 1));
+			}
+			unsigned long long collisions = count_collisions(hashes);
+			unsigned long long bucket_collisions = count_collisions(buckets);
+			int bucket_bits = bits < BUCKET_BITS ? bits : (int)BUCKET_BITS;
+
+			// Avalanche
+
+			std::vector<unsigned long long> flips(bits, 0);
+			unsigned long long trials = 0;
+			block_data_t buf[AVALANCHE_MAX_KEY_LENGTH];
+			size_type step = n / AVALANCHE_KEYS + 1;
+			for(size_type i = 0; i < n; i += step) {
+				size_type l = lengths_[i] < AVALANCHE_MAX_KEY_LENGTH ? lengths_[i] : (size_type)AVALANCHE_MAX_KEY_LENGTH;
+				memcpy(buf, pointers_[i], l);
+				hash_t h = Hash::hash(buf, l);
+				for(size_type bit = 0; bit < 8 * l; bit++) {
+					buf[bit / 8] ^= (1 << (bit % 8));
+					hash_t d = h ^ Hash::hash(buf, l);
+					buf[bit / 8] ^= (1 << (bit % 8));
+					for(int j = 0; j < bits; j++) {
+						flips[j] += (d >> j) & 1;
+					}
+					trials++;
+				}
+			}
+			double avalanche_sum = 0.0, avalanche_bias = 0.0;
+			for(int j = 0; j < bits; j++) {
+				double p = trials ? (double)flips[j] / trials : 0.0;
+				avalanche_sum += p;
+				if(fabs(p - 0.5) > avalanche_bias) { avalanche_bias = fabs(p - 0.5); }
+			}
+
+			printf("{\"hash\": \"%s\", \"bits\": %d, \"keys\": %lu, \"key_bytes\": %llu, "
+					"\"short_cpb\": %.3f, \"short_ns_per_key\": %.2f, "
+					"\"long_cpb\": %.3f, \"long_mb_per_s\": %.1f, "
+					"\"batch_ns_per_key\": %.2f, "
+					"\"collisions\": %llu, \"expected_collisions\": %.2f, "
+					"\"bucket_collisions\": %llu, \"expected_bucket_collisions\": %.2f, "
+					"\"avalanche_mean\": %.4f, \"avalanche_bias\": %.4f, "
+					"\"sink\": %u}\n",
+					name, bits, (unsigned long)n, key_bytes_,
+					short_cpb, short_ns, long_cpb, long_mbs, batch_ns,
+					collisions, expected_collisions(n, bits),
+					bucket_collisions, expected_collisions(n, bucket_bits),
+					avalanche_sum / bits, avalanche_bias,
+					(unsigned)(sink & 0x1));
+			fflush(stdout);
+		}
+
+		const char *only_;
+		std::vector<std::string> keys_;
+		std::vector<const block_data_t*> pointers_;
+		std::vector<size_type> lengths_;
+		unsigned long long key_bytes_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
+
@@ -33,6 +33,7 @@ typedef Os::size_t size_type;
 #include <algorithms/hash/murmur.h>
 #include <algorithms/hash/novak.h>
 #include <algorithms/hash/sdbm.h>
+#include <algorithms/hash/xxhash.h>
 
 class App {
 	public:
@@ -82,6 +83,8 @@ class App {
 			else if(strcmp(amp.argv[1], "sdbm16") == 0) { hash_cat< Sdbm<Os, ::uint16_t> >(); }
 			else if(strcmp(amp.argv[1], "sdbm32") == 0) { hash_cat< Sdbm<Os, ::uint32_t> >(); }
 			else if(strcmp(amp.argv[1], "sdbm64") == 0) { hash_cat< Sdbm<Os, ::uint64_t> >(); }
+			else if(strcmp(amp.argv[1], "murmur32") == 0) { hash_cat< Murmur<Os> >(); }
+			else if(strcmp(amp.argv[1], "xxhash64") == 0) { hash_cat< XxHash64<Os> >(); }
 			else {
 				debug_->debug("ALART! hash function '%s' not found!", amp.argv[1]);
 			}
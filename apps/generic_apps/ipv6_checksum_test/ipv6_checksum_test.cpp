@@ -0,0 +1,193 @@
+/*
+ * Behaviour checks for the Internet checksum of the IPv6 packets
+ * (algorithms/6lowpan/ipv6_packet.h): the word-wise sum against a byte by
+ * byte reference on random packets, and the incremental updates against
+ * a full recomputation.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include <algorithms/6lowpan/lowpan_config.h>
+#include <algorithms/6lowpan/ipv6_packet.h>
+
+/// Only the types of the radio are used by the packets
+struct LinkRadio {
+	typedef uint16_t node_id_t;
+	typedef uint16_t size_t;
+	typedef uint8_t block_data_t;
+	typedef uint8_t message_id_t;
+	enum {
+		NULL_NODE_ID = 0,
+		BROADCAST_ADDRESS = 0xffff
+	};
+};
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			PACKETS = 2000,
+			MAX_LENGTH = LOWPAN_IP_PACKET_BUFFER_MAX_SIZE - 40
+		};
+
+		typedef IPv6Packet<Os, LinkRadio, Os::Debug> Packet;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+			packet_.set_debug(*debug_);
+
+			test_full();
+			test_update_word();
+			test_update_address();
+
+			finish("ipv6_checksum_test");
+		}
+
+		/// Every length, alignment of the tail and transport protocol
+		void test_full() {
+			for(int i = 0; i < PACKETS; i++) {
+				uint16_t length = (i < 64) ? i : next_random() % MAX_LENGTH;
+				random_packet(length, (i % 2) ? Packet::UDP : Packet::ICMPV6);
+				uint16_t checksum = packet_.generate_checksum();
+				CHECK(checksum == reference_checksum());
+
+				// a packet carrying its checksum sums up to zero
+				if(length >= checksum_position() + 2) {
+					store_checksum(checksum);
+					CHECK(packet_.generate_checksum() == 0);
+				}
+			}
+
+			// all ones, the sum has to be folded more than once
+			random_packet(MAX_LENGTH, Packet::UDP);
+			memset(packet_.buffer_ + Packet::SOURCE_ADDRESS_BYTE, 0xff, 32);
+			memset(packet_.payload(), 0xff, MAX_LENGTH);
+			CHECK(packet_.generate_checksum() == reference_checksum());
+		}
+
+		/// RFC 1624 on single words, against the sum of the whole data
+		void test_update_word() {
+			enum { WORDS = 32 };
+			uint16_t words[WORDS];
+			for(int i = 0; i < PACKETS; i++) {
+				for(int w = 0; w < WORDS; w++) {
+					words[w] = (next_random() % 8 == 0) ? 0xffff : ((next_random() << 1) ^ next_random());
+				}
+				uint16_t checksum = word_checksum(words, WORDS);
+
+				int changed = next_random() % WORDS;
+				uint16_t old_word = words[changed];
+				words[changed] = (next_random() % 4 == 0) ? 0 : ((next_random() << 1) ^ next_random());
+				checksum = Packet::update_checksum(checksum, old_word, words[changed]);
+				CHECK(same_checksum(checksum, word_checksum(words, WORDS)));
+			}
+		}
+
+		/// A source address filled in later, like the interface manager does
+		void test_update_address() {
+			for(int i = 0; i < PACKETS; i++) {
+				uint8_t transport = (i % 2) ? Packet::UDP : Packet::ICMPV6;
+				random_packet(8 + next_random() % 200, transport);
+				store_checksum(packet_.generate_checksum());
+
+				uint8_t old_source[16];
+				memcpy(old_source, packet_.buffer_ + Packet::SOURCE_ADDRESS_BYTE, 16);
+				for(int b = 0; b < 16; b++) {
+					packet_.buffer_[Packet::SOURCE_ADDRESS_BYTE + b] = (next_random() % 3) ? next_random() : old_source[b];
+				}
+				packet_.update_transport_checksum(old_source, packet_.buffer_ + Packet::SOURCE_ADDRESS_BYTE, 16);
+
+				uint16_t updated = stored_checksum();
+				if(transport == Packet::UDP) {
+					// zero would mean that there is no checksum
+					CHECK(updated != 0);
+				}
+				store_checksum(0);
+				CHECK(same_checksum(updated, packet_.generate_checksum()));
+			}
+		}
+
+	private:
+		void random_packet(uint16_t length, uint8_t transport) {
+			packet_.reset();
+			for(int i = 0; i < 32; i++) {
+				packet_.buffer_[Packet::SOURCE_ADDRESS_BYTE + i] = next_random();
+			}
+			packet_.set_real_length(length);
+			packet_.set_real_next_header(transport);
+			packet_.set_transport_next_header(transport);
+			for(uint16_t i = 0; i < length; i++) {
+				packet_.payload()[i] = next_random();
+			}
+			// the checksum field is zero while the checksum is computed
+			if(length >= checksum_position() + 2) {
+				store_checksum(0);
+			}
+		}
+
+		int checksum_position() {
+			return packet_.transport_next_header() == Packet::UDP ? 6 : 2;
+		}
+
+		void store_checksum(uint16_t checksum) {
+			packet_.template set_payload<uint16_t>(&checksum, checksum_position());
+		}
+
+		uint16_t stored_checksum() {
+			uint8_t* place = packet_.payload() + checksum_position();
+			return (place[0] << 8) | place[1];
+		}
+
+		/// Byte pairs in the network order, folded until nothing is carried
+		uint16_t reference_checksum() {
+			uint32_t sum = 0;
+			uint8_t* b = packet_.buffer_;
+			for(int i = 0; i < 32; i += 2) {
+				sum += (b[Packet::SOURCE_ADDRESS_BYTE + i] << 8) | b[Packet::SOURCE_ADDRESS_BYTE + i + 1];
+			}
+			sum += packet_.real_length();
+			sum += packet_.real_next_header();
+
+			uint16_t length = packet_.transport_length();
+			uint8_t* data = packet_.payload();
+			for(uint16_t i = 0; i < length; i += 2) {
+				sum += (data[i] << 8) | (i + 1 < length ? data[i + 1] : 0);
+			}
+			while(sum >> 16) {
+				sum = (sum & 0xffff) + (sum >> 16);
+			}
+			return ~sum & 0xffff;
+		}
+
+		uint16_t word_checksum(uint16_t* words, int count) {
+			uint32_t sum = 0;
+			for(int i = 0; i < count; i++) {
+				sum += words[i];
+			}
+			while(sum >> 16) {
+				sum = (sum & 0xffff) + (sum >> 16);
+			}
+			return ~sum & 0xffff;
+		}
+
+		/// 0x0000 and 0xffff are the same number in the ones' complement
+		bool same_checksum(uint16_t a, uint16_t b) {
+			return a == b || (a == 0 && b == 0xffff) || (a == 0xffff && b == 0);
+		}
+
+		Packet packet_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
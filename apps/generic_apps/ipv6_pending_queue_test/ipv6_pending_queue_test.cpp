@@ -0,0 +1,249 @@
+/*
+ * Behaviour checks for the queue of the IPv6 packets waiting for a route
+ * (algorithms/6lowpan/ipv6_pending_queue.h): the bounds, the flush after
+ * route notifications, the timeout and the timers armed before a re-init.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+//The pool and queue sizes of the RPL configuration
+#define RPL_DEFINED
+#include <algorithms/6lowpan/lowpan_config.h>
+#include <algorithms/6lowpan/ipv6_packet_pool_manager.h>
+#include <algorithms/6lowpan/ipv6_pending_queue.h>
+
+/// Only the types of the radio are used by the packets
+struct LinkRadio {
+	typedef uint16_t node_id_t;
+	typedef uint16_t size_t;
+	typedef uint8_t block_data_t;
+	typedef uint8_t message_id_t;
+	enum {
+		NULL_NODE_ID = 0,
+		BROADCAST_ADDRESS = 0xffff
+	};
+};
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			DESTINATIONS = 8,
+			MAX_SENT = 32
+		};
+
+		typedef FakeTimer<Os> Timer;
+		typedef IPv6PacketPoolManager<Os, LinkRadio, Os::Debug> Pool;
+		typedef IPv6PendingQueue<Os, uint16_t, Pool, Os::Debug, Timer> Queue;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_bounds();
+			test_flush();
+			test_timeout();
+			test_reinit();
+			test_enqueue_while_flushing();
+
+			finish("ipv6_pending_queue_test");
+		}
+
+		void test_bounds() {
+			reset();
+			CHECK(enqueue(1) >= 0);
+			CHECK(enqueue(1) >= 0);
+			// a third packet for the same destination
+			CHECK(enqueue(1) < 0);
+			for(int d = 2; queue_.size() < LOWPAN_PENDING_QUEUE_SIZE; d++) {
+				CHECK(enqueue(d) >= 0);
+			}
+			CHECK(queue_.size() == LOWPAN_PENDING_QUEUE_SIZE);
+			// a full queue rejects every destination
+			CHECK(queue_.enqueue(100, 0) == Queue::ERR_BUSY);
+
+			queue_.clear();
+			CHECK(queue_.size() == 0);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE);
+		}
+
+		void test_flush() {
+			reset();
+			int a1 = enqueue(1);
+			int b = enqueue(2);
+			int a2 = enqueue(1);
+			int c = enqueue(3);
+
+			// several notifications arm one flush, nothing is sent from the notification
+			routes_[1] = Queue::RESEND_SENT;
+			queue_.route_available();
+			queue_.route_available();
+			CHECK(timer_.pending() == 2);
+			CHECK(sent_count_ == 0);
+
+			timer_.advance(0);
+			CHECK(sent_count_ == 2 && sent_[0] == a1 && sent_[1] == a2);
+			CHECK(queue_.size() == 2);
+			// the sent packets belong to the handler now
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE - 4);
+
+			// a failed discovery drops the packet, the others keep their order
+			routes_[2] = Queue::RESEND_DROP;
+			queue_.route_available();
+			timer_.advance(0);
+			CHECK(queue_.size() == 1);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE - 3);
+			CHECK(!pool_.packet_pool[b].valid && pool_.packet_pool[c].valid);
+
+			routes_[3] = Queue::RESEND_SENT;
+			queue_.route_available();
+			timer_.advance(0);
+			CHECK(sent_count_ == 3 && sent_[2] == c);
+			CHECK(queue_.size() == 0);
+
+			// without waiting packets a notification does nothing
+			int before = timer_.pending();
+			queue_.route_available();
+			CHECK(timer_.pending() == before);
+		}
+
+		void test_timeout() {
+			reset();
+			enqueue(1);
+			timer_.advance(LOWPAN_PENDING_TIMEOUT - 1000);
+			enqueue(2);
+
+			// the first period ends: nothing has waited for a full period yet
+			timer_.advance(1000);
+			CHECK(queue_.size() == 2);
+			enqueue(3);
+
+			// both waited for a full period now, the last one did not
+			timer_.advance(LOWPAN_PENDING_TIMEOUT);
+			CHECK(queue_.size() == 1);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE - 1);
+
+			timer_.advance(LOWPAN_PENDING_TIMEOUT);
+			CHECK(queue_.size() == 0);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE);
+			// the timer stops with the empty queue
+			CHECK(timer_.pending() == 0);
+		}
+
+		/// Timers armed before init() are ignored
+		void test_reinit() {
+			reset();
+			enqueue(1);
+			queue_.route_available();
+			queue_.clear();
+			queue_.init(timer_, *debug_, &pool_);
+
+			timer_.advance(1000);
+			enqueue(1);
+			routes_[1] = Queue::RESEND_SENT;
+			// the old flush and the old timeout have passed without a trace
+			timer_.advance(LOWPAN_PENDING_TIMEOUT - 1000 + 1);
+			CHECK(sent_count_ == 0);
+			CHECK(queue_.size() == 1);
+
+			// it is aged only by its own timer, two periods after it was stored
+			timer_.advance(LOWPAN_PENDING_TIMEOUT + 1000 - 2);
+			CHECK(queue_.size() == 1);
+			timer_.advance(1);
+			CHECK(queue_.size() == 0);
+		}
+
+		/// Sending a waiting packet can store new ones
+		void test_enqueue_while_flushing() {
+			reset();
+			int a = enqueue(1);
+			enqueue(2);
+			int c = enqueue(3);
+			routes_[1] = Queue::RESEND_SENT;
+			routes_[3] = Queue::RESEND_SENT;
+			requeue_ = 4;
+
+			queue_.route_available();
+			timer_.advance(0);
+			CHECK(sent_count_ == 2 && sent_[0] == a && sent_[1] == c);
+			// 2 is still waiting, the packet stored while sending is behind it
+			CHECK(queue_.size() == 2);
+
+			routes_[2] = Queue::RESEND_DROP;
+			routes_[4] = Queue::RESEND_DROP;
+			requeue_ = 0;
+			queue_.route_available();
+			timer_.advance(0);
+			CHECK(queue_.size() == 0);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE - 2);
+		}
+
+		/// The handler of the queue, like IPv6::resend_pending()
+		int resend(uint16_t destination, uint8_t packet_number) {
+			int result = routes_[destination];
+			if(result == Queue::RESEND_SENT) {
+				if(sent_count_ < MAX_SENT) { sent_[sent_count_++] = packet_number; }
+				if(requeue_) {
+					enqueue(requeue_);
+					requeue_ = 0;
+				}
+			}
+			return result;
+		}
+
+	private:
+		void reset() {
+			timer_.advance(10 * LOWPAN_PENDING_TIMEOUT);
+			for(int i = 0; i < IP_PACKET_POOL_SIZE; i++) {
+				pool_.clean_packet_with_number(i);
+			}
+			pool_.init(*debug_);
+			queue_.init(timer_, *debug_, &pool_);
+			queue_.reg_resend_callback<App, &App::resend>(this);
+			for(int i = 0; i < DESTINATIONS; i++) {
+				routes_[i] = Queue::RESEND_WAIT;
+			}
+			sent_count_ = 0;
+			requeue_ = 0;
+		}
+
+		/// Stores a new packet of the pool, returns its number or -1 if it is rejected
+		int enqueue(uint16_t destination) {
+			uint8_t number = pool_.get_unused_packet_with_number();
+			if(number == Pool::NO_FREE_PACKET) { return -1; }
+			if(queue_.enqueue(destination, number) != Queue::SUCCESS) {
+				pool_.clean_packet_with_number(number);
+				return -1;
+			}
+			return number;
+		}
+
+		int free_packets() {
+			int n = 0;
+			for(int i = 0; i < IP_PACKET_POOL_SIZE; i++) {
+				if(!pool_.packet_pool[i].valid) { n++; }
+			}
+			return n;
+		}
+
+		Timer timer_;
+		Pool pool_;
+		Queue queue_;
+		int routes_[DESTINATIONS];
+		uint8_t sent_[MAX_SENT];
+		int sent_count_;
+		uint16_t requeue_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
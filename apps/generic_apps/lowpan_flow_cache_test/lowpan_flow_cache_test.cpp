@@ -0,0 +1,209 @@
+/*
+ * Behaviour checks for the compressed header templates of the outgoing
+ * flows (algorithms/6lowpan/lowpan_flow_cache.h): the fields which make a
+ * hit or a miss, the packets which are not cached and the replacement
+ * order with LOWPAN_FLOW_CACHE_SIZE entries.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include <algorithms/6lowpan/lowpan_config.h>
+#include <algorithms/6lowpan/lowpan_flow_cache.h>
+
+/// Only the types of the radio are used by the packets
+struct LinkRadio {
+	typedef uint16_t node_id_t;
+	typedef uint16_t size_t;
+	typedef uint8_t block_data_t;
+	typedef uint8_t message_id_t;
+	enum {
+		NULL_NODE_ID = 0,
+		BROADCAST_ADDRESS = 0xffff
+	};
+};
+
+class App : public UnitTest<Os> {
+	public:
+		typedef LoWPANFlowCache<Os, LinkRadio, Os::Debug> Cache;
+		typedef Cache::Entry Entry;
+		typedef Cache::IPv6Packet_t Packet;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+			packet_.set_debug(*debug_);
+
+			test_hit();
+			test_miss();
+			test_not_cached();
+			test_eviction();
+
+			finish("lowpan_flow_cache_test");
+		}
+
+		void test_hit() {
+			cache_.clear();
+			flow_packet(1, Packet::UDP);
+			CHECK(cache_.find(&packet_, 10) == 0);
+			Entry* stored = store(10, 5);
+			CHECK(stored != 0);
+			CHECK(stored->source_context == LOWPAN_CONTEXTS_NUMBER && stored->destination_context == LOWPAN_CONTEXTS_NUMBER);
+
+			// the length, the checksum and the data are not part of the flow
+			packet_.set_real_length(200);
+			packet_.payload()[6] ^= 0xff;
+			packet_.payload()[20] ^= 0xff;
+			Entry* found = cache_.find(&packet_, 10);
+			CHECK(found == stored);
+			CHECK(found->header_length == 12 && found->NHC_position == 5);
+			CHECK(found->header[0] == 1 && found->header[11] == 12);
+
+			// ICMPv6 flows without ports
+			flow_packet(2, Packet::ICMPV6);
+			store(10, 0);
+			packet_.payload()[0] ^= 0xff;
+			CHECK(cache_.find(&packet_, 10) != 0);
+			CHECK(cache_.size() == 2);
+		}
+
+		/// Every field of the key and the link-layer destination
+		void test_miss() {
+			static const int fields[] = {
+				0, 1, 2, 3,	// version, traffic class, flow label
+				6, 7,	// next header, hop limit
+				8, 23,	// source address
+				24, 39	// destination address
+			};
+			const int count = sizeof(fields) / sizeof(fields[0]);
+
+			for(int i = 0; i < count; i++) {
+				cache_.clear();
+				flow_packet(3, Packet::UDP);
+				store(10, 5);
+				uint8_t next_header = packet_.real_next_header();
+				packet_.buffer_[fields[i]] ^= 0x01;
+				// keep the packet cacheable when the next header changes
+				if(fields[i] == 6) { packet_.set_real_next_header(next_header == Packet::UDP ? (uint8_t)Packet::ICMPV6 : (uint8_t)Packet::UDP); }
+				CHECK(cache_.find(&packet_, 10) == 0);
+			}
+
+			// the UDP ports
+			for(int port = 0; port < 4; port++) {
+				cache_.clear();
+				flow_packet(3, Packet::UDP);
+				store(10, 5);
+				packet_.payload()[port] ^= 0x80;
+				CHECK(cache_.find(&packet_, 10) == 0);
+			}
+
+			// the elided addresses depend on the next hop
+			cache_.clear();
+			flow_packet(3, Packet::UDP);
+			store(10, 5);
+			CHECK(cache_.find(&packet_, 11) == 0);
+			CHECK(cache_.find(&packet_, LinkRadio::BROADCAST_ADDRESS) == 0);
+			CHECK(cache_.find(&packet_, 10) != 0);
+
+			// an invalidated template, as after an expired context
+			cache_.find(&packet_, 10)->valid = false;
+			CHECK(cache_.find(&packet_, 10) == 0);
+		}
+
+		void test_not_cached() {
+			cache_.clear();
+			// hop by hop extension header
+			flow_packet(4, 0);
+			CHECK(store(10, 0) == 0);
+			CHECK(cache_.find(&packet_, 10) == 0);
+
+			// a too long template
+			flow_packet(4, Packet::UDP);
+			uint8_t header[Cache::HEADER_MAX_LEN + 1];
+			memset(header, 0, sizeof(header));
+			CHECK(cache_.store(&packet_, 10, header, Cache::HEADER_MAX_LEN + 1, 0) == 0);
+			CHECK(cache_.find(&packet_, 10) == 0);
+			CHECK(cache_.size() == 0);
+			CHECK(cache_.store(&packet_, 10, header, Cache::HEADER_MAX_LEN, 0) != 0);
+		}
+
+		/// The oldest stored template is replaced, even if it is used
+		void test_eviction() {
+			cache_.clear();
+			for(int f = 0; f < LOWPAN_FLOW_CACHE_SIZE; f++) {
+				flow_packet(10 + f, Packet::UDP);
+				store(20, 5);
+			}
+			CHECK(cache_.size() == LOWPAN_FLOW_CACHE_SIZE);
+			for(int f = 0; f < LOWPAN_FLOW_CACHE_SIZE; f++) {
+				flow_packet(10 + f, Packet::UDP);
+				CHECK(cache_.find(&packet_, 20) != 0);
+			}
+
+			for(int f = LOWPAN_FLOW_CACHE_SIZE; f < 3 * LOWPAN_FLOW_CACHE_SIZE; f++) {
+				flow_packet(10 + f, Packet::UDP);
+				store(20, 5);
+				// the last LOWPAN_FLOW_CACHE_SIZE flows are kept
+				for(int g = 0; g <= f; g++) {
+					flow_packet(10 + g, Packet::UDP);
+					bool kept = g > f - LOWPAN_FLOW_CACHE_SIZE;
+					CHECK((cache_.find(&packet_, 20) != 0) == kept);
+				}
+				CHECK(cache_.size() == LOWPAN_FLOW_CACHE_SIZE);
+			}
+
+			cache_.clear();
+			CHECK(cache_.size() == 0);
+			flow_packet(10, Packet::UDP);
+			CHECK(cache_.find(&packet_, 20) == 0);
+		}
+
+	private:
+		/// Packet of the flow number, with random payload
+		void flow_packet(uint8_t flow, uint8_t next_header) {
+			packet_.reset();
+			packet_.set_traffic_class(flow);
+			packet_.set_flow_label(flow * 3);
+			packet_.set_hop_limit(64);
+			for(int i = 0; i < 32; i++) {
+				packet_.buffer_[Packet::SOURCE_ADDRESS_BYTE + i] = i;
+			}
+			packet_.buffer_[Packet::DESTINATION_ADDRESS_BYTE + 15] = flow;
+			packet_.set_real_length(40);
+			packet_.set_real_next_header(next_header);
+			packet_.set_transport_next_header(next_header);
+			for(int i = 0; i < 40; i++) {
+				packet_.payload()[i] = next_random();
+			}
+			// the ports of the flow
+			packet_.payload()[0] = 0xf0;
+			packet_.payload()[1] = flow;
+			packet_.payload()[2] = 0xf0;
+			packet_.payload()[3] = 0xb0;
+		}
+
+		/// Stores a 12 byte template numbered from 1 for the actual packet
+		Entry* store(LinkRadio::node_id_t mac, uint8_t NHC_position) {
+			uint8_t header[12];
+			for(int i = 0; i < 12; i++) {
+				header[i] = i + 1;
+			}
+			return cache_.store(&packet_, mac, header, 12, NHC_position);
+		}
+
+		Packet packet_;
+		Cache cache_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
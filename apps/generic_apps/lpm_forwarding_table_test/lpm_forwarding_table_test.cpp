@@ -0,0 +1,271 @@
+/*
+ * Behaviour checks for the longest-prefix-match forwarding table
+ * (algorithms/6lowpan/lpm_forwarding_table.h) against a linear search over
+ * a reference list of routes.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include <algorithms/6lowpan/lpm_forwarding_table.h>
+
+/// Only the address type of the radio is used by the table
+struct Address {
+	uint8_t addr[16];
+};
+
+struct AddressRadio {
+	typedef Address node_id_t;
+};
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			TABLE_SIZE = 32,
+			CHURN_STEPS = 20000,
+			LOOKUPS = 8
+		};
+
+		typedef LpmForwardingTable<Os, AddressRadio, TABLE_SIZE, int> Table;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_fixed();
+			test_full();
+			test_churn();
+
+			finish("lpm_forwarding_table_test");
+		}
+
+		void test_fixed() {
+			Table t;
+			Address null_address, a, b, p;
+			memset(null_address.addr, 0, 16);
+			set_address(a, 0x20, 0x01, 0xab);
+			set_address(b, 0x20, 0x01, 0xac);
+			set_address(p, 0x20, 0x01, 0x00);
+
+			CHECK(t.empty());
+			CHECK(t.lookup(a) == t.end());
+
+			// the map interface stores host routes
+			CHECK(t.insert(Table::value_type(a, 1)).second);
+			CHECK(!t.insert(Table::value_type(a, 5)).second);
+			CHECK(t.find(a) != t.end() && t.find(a)->second == 1);
+			CHECK(t.prefix_length(t.find(a)) == 128);
+			CHECK(t.find(b) == t.end());
+			CHECK(t.lookup(b) == t.end());
+
+			// a /16 prefix covers both, the host route stays the better match
+			CHECK(t.insert_prefix(p, 16, 2).second);
+			CHECK(t.lookup(a)->second == 1);
+			CHECK(t.lookup(b)->second == 2);
+			CHECK(t.find_prefix(p, 16) != t.end());
+			CHECK(t.find_prefix(p, 15) == t.end());
+			CHECK(t.find_prefix(p, 17) == t.end());
+
+			// bits after the prefix length are ignored
+			CHECK(!t.insert_prefix(b, 16, 3).second);
+			CHECK(t.find_prefix(a, 16) == t.find_prefix(p, 16));
+
+			// NULL_NODE_ID is the default route
+			t[null_address] = 4;
+			CHECK(t.find(null_address) != t.end());
+			CHECK(t.prefix_length(t.find(null_address)) == 0);
+			Address other;
+			set_address(other, 0xfe, 0x80, 0x01);
+			CHECK(t.lookup(other) != t.end() && t.lookup(other)->second == 4);
+			CHECK(t.size() == 3);
+
+			// erasing the prefix falls back to the default route
+			t.erase(t.find_prefix(p, 16));
+			CHECK(t.lookup(b)->second == 4);
+			CHECK(t.lookup(a)->second == 1);
+			CHECK(t.size() == 2);
+
+			t.erase(t.find(a));
+			t.erase(t.find(null_address));
+			CHECK(t.empty());
+			CHECK(t.begin() == t.end());
+			CHECK(t.lookup(a) == t.end());
+		}
+
+		void test_full() {
+			Table t;
+			Address a;
+			for(int i = 0; i < TABLE_SIZE; i++) {
+				set_address(a, 0x20, i, i);
+				CHECK(t.insert(Table::value_type(a, i)).second);
+			}
+			CHECK(t.full());
+
+			// existing entries are still found, new ones are rejected
+			set_address(a, 0x20, 3, 3);
+			CHECK(t.insert(Table::value_type(a, 0)).first == t.find(a));
+			set_address(a, 0x21, 0, 0);
+			CHECK(t.insert(Table::value_type(a, 0)).first == t.end());
+			CHECK(t.insert_prefix(a, 8, 0).first == t.end());
+			t[a] = 7;
+			CHECK(t.find(a) == t.end());
+			CHECK(t.size() == TABLE_SIZE);
+
+			// the freed entry and trie nodes can be used again
+			set_address(a, 0x20, 5, 5);
+			t.erase(t.find(a));
+			set_address(a, 0x21, 0, 0);
+			CHECK(t.insert_prefix(a, 8, 9).second);
+			CHECK(t.lookup(a)->second == 9);
+
+			t.clear();
+			CHECK(t.empty());
+			CHECK(t.lookup(a) == t.end());
+		}
+
+		/**
+		 * Random prefixes below a few common bases, so that they nest and
+		 * branch at every level of the trie.
+		 */
+		void test_churn() {
+			Table t;
+			Route routes[TABLE_SIZE];
+			int used = 0;
+
+			for(int step = 0; step < CHURN_STEPS; step++) {
+				Address prefix;
+				uint8_t length;
+				random_prefix(prefix, length);
+				int r = find_route(routes, used, prefix, length);
+
+				if(next_random() % 2) {
+					int value = next_random();
+					Table::iterator e = t.find_prefix(prefix, length);
+					pair<Table::iterator, bool> res = t.insert_prefix(prefix, length, value);
+					if(r >= 0) {
+						CHECK(!res.second && res.first == e && res.first->second == routes[r].value);
+					}
+					else if(used < TABLE_SIZE) {
+						CHECK(res.second && res.first->second == value);
+						routes[used].prefix = prefix;
+						routes[used].length = length;
+						routes[used].value = value;
+						used++;
+					}
+					else {
+						CHECK(res.first == t.end());
+					}
+				}
+				else {
+					Table::iterator it = t.find_prefix(prefix, length);
+					if(r >= 0) {
+						CHECK(it != t.end() && it->second == routes[r].value);
+						t.erase(it);
+						routes[r] = routes[--used];
+					}
+					else {
+						CHECK(it == t.end());
+					}
+				}
+				CHECK(t.size() == (Table::size_type)used);
+
+				for(int i = 0; i < LOOKUPS; i++) {
+					Address address;
+					random_address(address);
+					Table::iterator it = t.lookup(address);
+					int best = longest_match(routes, used, address);
+					if(best < 0) {
+						CHECK(it == t.end());
+					}
+					else {
+						CHECK(it != t.end() && it->second == routes[best].value
+							&& t.prefix_length(it) == routes[best].length);
+					}
+				}
+
+				if(step % 1000 == 0) {
+					int n = 0;
+					for(Table::iterator it = t.begin(); it != t.end(); ++it) {
+						CHECK(t.find_prefix(it->first, t.prefix_length(it)) == it);
+						n++;
+					}
+					CHECK(n == used);
+				}
+			}
+		}
+
+	private:
+		struct Route {
+			Address prefix;
+			uint8_t length;
+			int value;
+		};
+
+		void set_address(Address& a, uint8_t first, uint8_t second, uint8_t last) {
+			memset(a.addr, 0, 16);
+			a.addr[0] = first;
+			a.addr[1] = second;
+			a.addr[15] = last;
+		}
+
+		void random_address(Address& a) {
+			static const uint8_t bases[4][2] = {
+				{ 0x20, 0x01 }, { 0x20, 0x02 }, { 0xfe, 0x80 }, { 0x20, 0x81 }
+			};
+			memset(a.addr, 0, 16);
+			int base = next_random() % 4;
+			a.addr[0] = bases[base][0];
+			a.addr[1] = bases[base][1];
+			// a few varying bits in the middle and at the end of the address
+			a.addr[2] = next_random() % 4;
+			a.addr[8] = next_random() % 2 ? 0x80 : 0;
+			a.addr[15] = next_random() % 8;
+		}
+
+		void random_prefix(Address& prefix, uint8_t& length) {
+			static const uint8_t lengths[] = { 0, 8, 15, 16, 18, 23, 64, 65, 72, 126, 127, 128 };
+			random_address(prefix);
+			length = lengths[next_random() % (sizeof(lengths) / sizeof(lengths[0]))];
+		}
+
+		static bool covers(const Address& prefix, uint8_t length, const Address& address) {
+			for(uint8_t i = 0; i < length; i++) {
+				uint8_t mask = 0x80 >> (i & 7);
+				if((prefix.addr[i >> 3] & mask) != (address.addr[i >> 3] & mask)) { return false; }
+			}
+			return true;
+		}
+
+		/// Index of the route with exactly this prefix, or -1
+		int find_route(Route* routes, int used, const Address& prefix, uint8_t length) {
+			for(int i = 0; i < used; i++) {
+				if(routes[i].length == length && covers(routes[i].prefix, length, prefix)) { return i; }
+			}
+			return -1;
+		}
+
+		/// Index of the longest route that covers the address, or -1
+		int longest_match(Route* routes, int used, const Address& address) {
+			int best = -1;
+			for(int i = 0; i < used; i++) {
+				if(covers(routes[i].prefix, routes[i].length, address)
+						&& (best < 0 || routes[i].length > routes[best].length)) {
+					best = i;
+				}
+			}
+			return best;
+		}
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
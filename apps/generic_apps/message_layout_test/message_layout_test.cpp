@@ -0,0 +1,253 @@
+/*
+ * Behaviour checks for the declarative message layouts
+ * (util/serialization/message_layout.h), the array serialization behind
+ * them and the wire format of the messages built on them.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+typedef Os::block_data_t block_data_t;
+
+#include "../unit_test.h"
+
+#include <util/serialization/message_layout.h>
+#include <algorithms/routing/flooding/flooding_message.h>
+#include <algorithms/routing/aodv/aodv_routing_msg.h>
+#include <algorithms/rdf/inqp/intermediate_result_message.h>
+#include <radio/reliable/reliable_radio_message.h>
+
+/// Radio with 16 bit node ids and lengths, the messages only use its types
+struct LayoutRadio {
+	typedef uint16_t node_id_t;
+	typedef uint16_t size_t;
+	typedef uint8_t block_data_t;
+	typedef uint8_t message_id_t;
+	enum { MAX_MESSAGE_LENGTH = 116 };
+	typedef LayoutRadio Radio;
+};
+
+/// Radio with 32 bit node ids, as seen by IntermediateResultMessage
+struct WideRadio {
+	typedef uint32_t node_id_t;
+	typedef uint8_t message_id_t;
+	enum { MAX_MESSAGE_LENGTH = 116 };
+	typedef WideRadio Radio;
+};
+
+struct LayoutQuery {
+	typedef uint8_t query_id_t;
+	struct BOD {
+		typedef uint16_t operator_id_t;
+	};
+};
+
+struct NoDebug {
+};
+
+typedef uint16_t Path[4];
+
+class App : public UnitTest<Os> {
+	public:
+		typedef LayoutField<uint8_t> IdField;
+		typedef LayoutField<uint32_t, IdField> TimeField;
+		typedef LayoutArray<uint16_t, 5, TimeField> HopsField;
+		typedef LayoutField<uint16_t, HopsField> LengthField;
+		typedef LayoutCheck<LengthField, 20> Header;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			for(int i = 0; i < 10; i++) {
+				payload_[i] = i + 1;
+			}
+
+			test_layout();
+			test_arrays();
+			test_flooding_message();
+			test_aodv_message();
+			test_intermediate_result_message();
+			test_reliable_radio_message();
+
+			finish("message_layout_test");
+		}
+
+		void test_layout() {
+			CHECK(IdField::OFFSET == 0 && IdField::END == 1);
+			CHECK(TimeField::OFFSET == 1 && TimeField::SIZE == 4);
+			CHECK(HopsField::OFFSET == 5 && HopsField::COUNT == 5 && HopsField::SIZE == 10);
+			CHECK(LengthField::OFFSET == 15);
+			CHECK(Header::SIZE == 17 && Header::SPACE == 3);
+
+			block_data_t buf[Header::SIZE + 2];
+			memset(buf, 0xee, sizeof(buf));
+			write_field<Os, IdField>(buf, 0x42);
+			write_field<Os, TimeField>(buf, 0x01020304UL);
+			write_field<Os, LengthField>(buf, 0xa0b0);
+
+			// fields are stored in network byte order at their offsets
+			const block_data_t expected[] = { 0x42, 0x01, 0x02, 0x03, 0x04 };
+			CHECK(memcmp(buf, expected, sizeof(expected)) == 0);
+			CHECK(buf[15] == 0xa0 && buf[16] == 0xb0);
+			CHECK(buf[5] == 0xee && buf[17] == 0xee);
+
+			uint8_t id = read_field<Os, IdField>(buf);
+			uint32_t time = read_field<Os, TimeField>(buf);
+			uint16_t length = read_field<Os, LengthField>(buf);
+			CHECK(id == 0x42);
+			CHECK(time == 0x01020304UL);
+			CHECK(length == 0xa0b0);
+			CHECK(field_data<HopsField>(buf) == buf + 5);
+		}
+
+		/// Every element lands at its own offset, nothing behind the array is touched
+		void test_arrays() {
+			block_data_t buf[Header::SIZE + 2];
+			memset(buf, 0xee, sizeof(buf));
+			uint16_t hops[5] = { 0x0102, 0x0304, 0x0506, 0x0708, 0x090a };
+			write_field_array<Os, HopsField>(buf, hops);
+			for(int i = 0; i < 10; i++) {
+				CHECK(buf[5 + i] == i + 1);
+			}
+			CHECK(buf[4] == 0xee && buf[15] == 0xee);
+
+			uint16_t back[5];
+			read_field_array<Os, HopsField>(buf, back);
+			CHECK(memcmp(hops, back, sizeof(hops)) == 0);
+
+			CHECK(array_round_trip<uint8_t>());
+			CHECK(array_round_trip<uint16_t>());
+			CHECK(array_round_trip<int32_t>());
+			CHECK(array_round_trip<uint64_t>());
+		}
+
+		void test_flooding_message() {
+			typedef FloodingMessage<Os, LayoutRadio> Message;
+			Message m;
+			m.set_msg_id(7);
+			m.set_node_id(0x1234);
+			m.set_dest_id(0xabcd);
+			m.set_seq_nr(0x5566);
+			m.set_payload(10, payload_);
+
+			const block_data_t expected[] = {
+				0x07, 0x12, 0x34, 0xab, 0xcd, 0x55, 0x66, 0x00, 0x0a
+			};
+			CHECK(Message::Header::SIZE == sizeof(expected));
+			CHECK(m.buffer_size() == sizeof(expected) + 10);
+			CHECK(memcmp(&m, expected, sizeof(expected)) == 0);
+			CHECK(memcmp((block_data_t*)&m + sizeof(expected), payload_, 10) == 0);
+			CHECK(m.payload() == (block_data_t*)&m + sizeof(expected));
+
+			CHECK(m.msg_id() == 7 && m.node_id() == 0x1234 && m.dest_id() == 0xabcd);
+			CHECK(m.seq_nr() == 0x5566 && m.payload_size() == 10);
+			CHECK(Message::SEQ_NR_POS == 5 && Message::PAYLOAD_POS == 7);
+		}
+
+		void test_aodv_message() {
+			typedef AODVRoutingMessage<Os, LayoutRadio, Path> Message;
+			Message m(3, 0x1122, 0x3344, 2, 10, payload_);
+			Path p = { 1, 2, 0x0304, 4 };
+			m.set_path(p);
+
+			const block_data_t expected[] = {
+				0x03, 0x02, 0x11, 0x22, 0x33, 0x44,
+				0x00, 0x01, 0x00, 0x02, 0x03, 0x04, 0x00, 0x04,
+				0x0a
+			};
+			CHECK(Message::Header::SIZE == sizeof(expected));
+			CHECK(m.buffer_size() == sizeof(expected) + 10);
+			CHECK(memcmp(&m, expected, sizeof(expected)) == 0);
+			CHECK(memcmp(m.payload(), payload_, 10) == 0);
+
+			Path q;
+			m.path(q);
+			CHECK(memcmp(p, q, sizeof(Path)) == 0);
+			CHECK(m.msg_id() == 3 && m.path_idx() == 2);
+			CHECK(m.source() == 0x1122 && m.destination() == 0x3344);
+			m.dec_path_idx();
+			CHECK(m.path_idx() == 1);
+		}
+
+		void test_intermediate_result_message() {
+			typedef IntermediateResultMessage<Os, WideRadio, LayoutQuery> Message;
+			block_data_t buf[WideRadio::MAX_MESSAGE_LENGTH];
+			memset(buf, 0, sizeof(buf));
+			Message *m = (Message*)buf;
+			m->set_message_id(9);
+			m->set_query_id(4);
+			m->set_operator_id(0x0102);
+			m->set_from(0xdeadbeefUL);
+			m->set_payload_size(3);
+
+			const block_data_t expected[] = { 0x09, 0x04, 0x01, 0x02, 0xde, 0xad, 0xbe, 0xef, 0x03 };
+			CHECK(Message::HEADER_SIZE == sizeof(expected));
+			CHECK(memcmp(buf, expected, sizeof(expected)) == 0);
+			CHECK(m->payload() == buf + Message::HEADER_SIZE);
+			CHECK(m->query_id() == 4 && m->operator_id() == 0x0102);
+			CHECK(m->from() == 0xdeadbeefUL && m->payload_size() == 3);
+		}
+
+		void test_reliable_radio_message() {
+			typedef ReliableRadioMessage_Type<Os, LayoutRadio, NoDebug> Message;
+			Message m;
+			m.set_message_id(0x01020304UL);
+			m.set_counter(5);
+			m.set_payload(10, payload_);
+
+			block_data_t buf[64];
+			memset(buf, 0, sizeof(buf));
+			m.serialize(buf, 2);
+			const block_data_t expected[] = {
+				0x00, 0x00,
+				0x01, 0x02, 0x03, 0x04, 0x05, 0x00, 0x0a
+			};
+			CHECK(Message::HEADER_SIZE == sizeof(expected) - 2);
+			CHECK(m.serial_size() == Message::HEADER_SIZE + 10);
+			CHECK(memcmp(buf, expected, sizeof(expected)) == 0);
+			CHECK(memcmp(buf + sizeof(expected), payload_, 10) == 0);
+
+			Message back;
+			back.de_serialize(buf, 2);
+			CHECK(back.get_message_id() == 0x01020304UL);
+			CHECK(back.get_counter() == 5);
+			CHECK(back.get_payload_size() == 10);
+			CHECK(memcmp(back.get_payload(), payload_, 10) == 0);
+		}
+
+	private:
+		template<typename T>
+		bool array_round_trip() {
+			enum { COUNT = 7 };
+			T values[COUNT], back[COUNT];
+			block_data_t buf[COUNT * sizeof(T) + 1];
+			for(int i = 0; i < COUNT; i++) {
+				values[i] = (T)(i * 0x01030507 + 1);
+			}
+			buf[COUNT * sizeof(T)] = 0xee;
+
+			Os::size_t written = write_array<Os, block_data_t, T>(buf, values, COUNT);
+			Os::size_t read = read_array<Os, block_data_t, T>(buf, back, COUNT);
+			if(written != COUNT * sizeof(T) || read != written || buf[COUNT * sizeof(T)] != 0xee) {
+				return false;
+			}
+			// the same bytes as element by element
+			for(int i = 0; i < COUNT; i++) {
+				if(wiselib::read<Os, block_data_t, T>(buf + i * sizeof(T)) != values[i]) { return false; }
+			}
+			return memcmp(values, back, sizeof(values)) == 0;
+		}
+
+		block_data_t payload_[10];
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
@@ -0,0 +1,250 @@
+/*
+ * Behaviour checks for the neighbor index of the neighbor discovery
+ * (algorithms/neighbor_discovery/neighbor_index.h): lookup, eviction heap and
+ * expiry wheel against a plain neighborhood array that is kept dense the way
+ * Protocol_Type does.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include <algorithms/neighbor_discovery/neighbor_index.h>
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			SIZE = ND_MAX_NEIGHBORS,
+			IDS = 200,
+			CHURN_STEPS = 20000
+		};
+
+		typedef uint16_t node_id_t;
+		typedef NeighborIndex_Type<Os, node_id_t, SIZE> Index;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_fixed();
+			test_churn();
+
+			finish("neighbor_index_test");
+		}
+
+		void test_fixed() {
+			clear();
+			add(10, 50, 1000);
+			add(11, 20 | Index::ACTIVE_KEY, 1000);
+			add(12, 30, 2000);
+			add(13, 40, 3000);
+
+			CHECK(index_.find(12) == 2);
+			CHECK(index_.find(14) == -1);
+			CHECK(index_.active_size() == 1);
+			CHECK(index_.worst() == 2);
+
+			// the last neighbor moves into the freed position
+			erase(2);
+			CHECK(index_.find(12) == -1);
+			CHECK(index_.find(13) == 2);
+			CHECK(index_.worst() == 2);
+
+			index_.set_key(2, 60);
+			CHECK(index_.worst() == 0);
+			index_.set_key(0, 50 | Index::ACTIVE_KEY);
+			index_.set_key(2, 60 | Index::ACTIVE_KEY);
+			CHECK(index_.active_size() == 3);
+			CHECK(index_.worst() == -1);
+
+			// 10 and 11 are due at 1000, 13 moved with its deadline of 3000
+			index_.begin_expiry(999);
+			CHECK(index_.next_expired() == -1);
+			index_.begin_expiry(1001);
+			int a = index_.next_expired();
+			int b = index_.next_expired();
+			CHECK(index_.next_expired() == -1);
+			CHECK((a == 0 && b == 1) || (a == 1 && b == 0));
+
+			// handed out neighbors are not scheduled anymore
+			index_.begin_expiry(3001);
+			CHECK(index_.next_expired() == 2);
+			CHECK(index_.next_expired() == -1);
+			index_.begin_expiry(100000);
+			CHECK(index_.next_expired() == -1);
+		}
+
+		/**
+		 * Random inserts, removals, key changes and deadlines, with a daemon
+		 * pass every period that reschedules or drops the expired neighbors
+		 * like nd_daemon() does.
+		 */
+		void test_churn() {
+			clear();
+			uint32_t now = 0;
+
+			for(int step = 0; step < CHURN_STEPS; step++) {
+				switch(next_random() % 6) {
+					case 0:
+					case 1: {
+						node_id_t id = next_random() % IDS;
+						if(size_ < SIZE && position(id) < 0) {
+							add(id, random_key(), now + next_random() % 4000);
+						}
+						break;
+					}
+					case 2:
+						if(size_) { erase(next_random() % size_); }
+						break;
+					case 3:
+						if(size_) {
+							int pos = next_random() % size_;
+							keys_[pos] = random_key();
+							index_.set_key(pos, keys_[pos]);
+						}
+						break;
+					case 4:
+						if(size_) {
+							int pos = next_random() % size_;
+							reschedule(pos, now + next_random() % 12000);
+						}
+						break;
+					default:
+						now += ND_DAEMON_PERIOD / 2 + next_random() % ND_DAEMON_PERIOD;
+						// now and then the daemon does not run for a while
+						if(next_random() % 50 == 0) { now += 10 * ND_DAEMON_PERIOD; }
+						daemon_pass(now);
+						break;
+				}
+				check_index();
+			}
+		}
+
+	private:
+		void clear() {
+			index_.clear();
+			size_ = 0;
+		}
+
+		void add(node_id_t id, uint16_t key, uint32_t deadline) {
+			ids_[size_] = id;
+			keys_[size_] = key;
+			index_.insert(size_, id, key);
+			reschedule(size_, deadline);
+			size_++;
+		}
+
+		/// Like Protocol_Type::erase_neighbor()
+		void erase(int pos) {
+			int last = size_ - 1;
+			index_.remove(pos);
+			if(pos != last) {
+				ids_[pos] = ids_[last];
+				keys_[pos] = keys_[last];
+				scheduled_[pos] = scheduled_[last];
+				deadlines_[pos] = deadlines_[last];
+				index_.move(last, pos);
+			}
+			size_--;
+		}
+
+		void reschedule(int pos, uint32_t deadline) {
+			scheduled_[pos] = true;
+			deadlines_[pos] = deadline;
+			index_.schedule(pos, deadline);
+		}
+
+		/// Every neighbor that was due is handed out once, no other one
+		void daemon_pass(uint32_t now) {
+			bool due[IDS];
+			memset(due, 0, sizeof(due));
+			for(int i = 0; i < size_; i++) {
+				due[ids_[i]] = scheduled_[i] && (int32_t)(deadlines_[i] - now) < 0;
+			}
+
+			index_.begin_expiry(now);
+			for(int pos = index_.next_expired(); pos >= 0; pos = index_.next_expired()) {
+				CHECK(pos < size_);
+				if(pos >= size_) { break; }
+				node_id_t id = ids_[pos];
+				CHECK(due[id]);
+				due[id] = false;
+				scheduled_[pos] = false;
+
+				switch(next_random() % 4) {
+					case 0:
+						erase(pos);
+						break;
+					case 1:
+						break;
+					default:
+						reschedule(pos, now + ND_DAEMON_PERIOD + next_random() % 3000);
+						break;
+				}
+			}
+
+			for(int i = 0; i < size_; i++) {
+				CHECK(!due[ids_[i]]);
+			}
+		}
+
+		void check_index() {
+			int active = 0;
+			int worst = -1;
+			for(int i = 0; i < size_; i++) {
+				CHECK(index_.find(ids_[i]) == i);
+				if(keys_[i] & Index::ACTIVE_KEY) {
+					active++;
+				}
+				else if(worst < 0 || keys_[i] < keys_[worst]) {
+					worst = i;
+				}
+			}
+			CHECK(index_.active_size() == active);
+
+			int w = index_.worst();
+			if(worst < 0) {
+				CHECK(w == -1);
+			}
+			else {
+				// ties may pick any of the lowest keys
+				CHECK(w >= 0 && w < size_ && keys_[w] == keys_[worst]);
+			}
+
+			node_id_t absent = next_random() % IDS;
+			if(position(absent) < 0) {
+				CHECK(index_.find(absent) == -1);
+			}
+		}
+
+		int position(node_id_t id) {
+			for(int i = 0; i < size_; i++) {
+				if(ids_[i] == id) { return i; }
+			}
+			return -1;
+		}
+
+		uint16_t random_key() {
+			uint16_t key = next_random() % 64;
+			return (next_random() % 3 == 0) ? (key | Index::ACTIVE_KEY) : key;
+		}
+
+		Index index_;
+		node_id_t ids_[SIZE];
+		uint16_t keys_[SIZE];
+		bool scheduled_[SIZE];
+		uint32_t deadlines_[SIZE];
+		int size_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
@@ -0,0 +1,359 @@
+/*
+ * Behaviour checks for the incremental MPR and route maintenance of OLSR
+ * (algorithms/routing/olsr/olsr_routing.h): random topologies are changed
+ * tuple by tuple, after every change the results of update_mprset() and
+ * update_routing_table() are compared with a full recomputation and with
+ * a breadth first search done by the test.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include <map>
+#include <set>
+#include <algorithms/routing/olsr/olsr_routing.h>
+
+/// OlsrRouting uses the static facet interface, with a node pointer as first parameter
+struct LegacyNode { };
+
+struct LegacyRadio {
+	typedef uint16_t node_id_t;
+	typedef uint8_t block_data_t;
+	typedef ::size_t size_t;
+	enum {
+		BROADCAST_ADDRESS = 0xffff,
+		NULL_NODE_ID = 0,
+		MAX_MESSAGE_LENGTH = 116
+	};
+
+	static node_id_t id(LegacyNode*) { return 1; }
+	static void enable(LegacyNode*) { }
+	template<class T, void (T::*TMethod)(node_id_t, size_t, block_data_t*)>
+	static int reg_recv_callback(LegacyNode*, T*) { return 0; }
+	static int send(LegacyNode*, node_id_t, size_t, block_data_t*) { return 0; }
+};
+
+/// The time stands still, the tuples are valid until they are changed
+struct LegacyClock {
+	typedef double time_t;
+	static time_t time(LegacyNode*) { return 100; }
+};
+
+struct LegacyTimer {
+	typedef ::uint32_t millis_t;
+	template<class T, void (T::*TMethod)(void*)>
+	static int set_timer(LegacyNode*, millis_t, T*, void*) { return 0; }
+};
+
+struct LegacyDebug {
+	static void debug(LegacyNode*, const char*, ...) { }
+};
+
+struct LegacyOs {
+	typedef LegacyNode Os;
+	typedef LegacyRadio Radio;
+	typedef LegacyDebug Debug;
+	typedef LegacyTimer Timer;
+	typedef LegacyClock Clock;
+	typedef ::size_t size_t;
+	typedef uint8_t block_data_t;
+	enum {
+		SUCCESS = 0,
+		ERR_UNSPEC = 1
+	};
+	static const Endianness endianness = WISELIB_LITTLE_ENDIAN;
+};
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			/// This node, see LegacyRadio::id()
+			SELF = 1,
+			TOPOLOGIES = 20,
+			STEPS = 400,
+			FIRST_NEIGHBOR = 10,
+			NEIGHBORS = 30
+		};
+
+		typedef uint16_t node_id_t;
+		typedef OlsrRoutingTableValue<LegacyOs, LegacyRadio> Route;
+		typedef std::map<node_id_t, Route> RoutingTable;
+		typedef OlsrRouting<LegacyOs, RoutingTable, LegacyClock, LegacyRadio, LegacyDebug> Olsr;
+		typedef Olsr::OLSR_link_tuple LinkTuple;
+		typedef Olsr::OLSR_nb_tuple NbTuple;
+		typedef Olsr::OLSR_nb2hop_tuple Nb2hopTuple;
+		typedef Olsr::OLSR_topology_tuple TopologyTuple;
+		typedef std::set<node_id_t> NodeSet;
+		typedef std::map<node_id_t, NodeSet> Coverage;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			for(int t = 0; t < TOPOLOGIES; t++) {
+				test_random_topology();
+			}
+			test_removed_link();
+
+			finish("olsr_routing_test");
+		}
+
+		/// A random walk over the tuple sets, the results are checked after every step
+		void test_random_topology() {
+			Olsr* olsr = new Olsr;
+			int neighbors = 5 + next_random() % 20;
+			for(int i = 0; i < neighbors; i++) {
+				add_neighbor(*olsr, FIRST_NEIGHBOR + i, random_willingness());
+			}
+			update(*olsr);
+
+			for(int step = 0; step < STEPS; step++) {
+				random_change(*olsr);
+				update(*olsr);
+			}
+			delete olsr;
+		}
+
+		/// A route over a removed 2-hop link is moved to the remaining one
+		void test_removed_link() {
+			Olsr* olsr = new Olsr;
+			add_neighbor(*olsr, 10, OLSR_WILL_DEFAULT);
+			add_neighbor(*olsr, 11, OLSR_WILL_DEFAULT);
+			Nb2hopTuple* over_10 = add_nb2hop(*olsr, 10, 20);
+			update(*olsr);
+			add_nb2hop(*olsr, 11, 20);
+			add_topology(*olsr, 20, 30);
+			update(*olsr);
+
+			RoutingTable::iterator route = olsr->routing_table().find(30);
+			CHECK(route != olsr->routing_table().end() && route->second.hops == 3);
+			node_id_t first_next = route->second.next_addr;
+
+			// whichever neighbour carried the route, 20 stays reachable over the other
+			if(first_next == 10) {
+				olsr->rm_nb2hop_tuple(over_10);
+				olsr->nb2hop_pool_.free(over_10);
+			}
+			else {
+				remove_nb2hop(*olsr, 11, 20);
+			}
+			update(*olsr);
+			route = olsr->routing_table().find(30);
+			CHECK(route != olsr->routing_table().end() && route->second.hops == 3 && route->second.next_addr != first_next);
+			// the remaining neighbour is selected for the 2-hop neighbour
+			node_id_t other = (first_next == 10) ? 11 : 10;
+			CHECK(olsr->mprset().count(other) == 1);
+			delete olsr;
+		}
+
+	private:
+		/// Brings the incremental state up to date and compares it
+		void update(Olsr& olsr) {
+			olsr.update_mprset();
+			olsr.update_routing_table();
+			check_mprset(olsr, olsr.mprset());
+			check_routes(olsr);
+
+			// a full recomputation has to agree, the incremental state is restored afterwards
+			Olsr::mprset_t incremental_mprs = olsr.mprset();
+			RoutingTable incremental_routes = olsr.routing_table();
+			olsr.mpr_computation();
+			olsr.routing_table_computation();
+			check_mprset(olsr, olsr.mprset());
+
+			RoutingTable& full = olsr.routing_table();
+			CHECK(full.size() == incremental_routes.size());
+			for(RoutingTable::iterator it = full.begin(); it != full.end(); it++) {
+				RoutingTable::iterator same = incremental_routes.find(it->first);
+				CHECK(same != incremental_routes.end() && same->second.hops == it->second.hops);
+			}
+			olsr.mprset() = incremental_mprs;
+			olsr.routing_table() = incremental_routes;
+		}
+
+		/// The MPRs are symmetric neighbours, the WILL_ALWAYS ones included, and cover the strict 2-hop neighbourhood
+		void check_mprset(Olsr& olsr, Olsr::mprset_t& mprs) {
+			NodeSet symmetric = symmetric_neighbors(olsr);
+			for(Olsr::mprset_t::iterator it = mprs.begin(); it != mprs.end(); it++) {
+				CHECK(symmetric.count(*it) == 1);
+			}
+			for(Olsr::nbset_t::iterator it = olsr.nbset().begin(); it != olsr.nbset().end(); it++) {
+				if((*it)->status() == OLSR_STATUS_SYM && (*it)->willingness() == OLSR_WILL_ALWAYS) {
+					CHECK(mprs.count((*it)->nb_node_addr()) == 1);
+				}
+			}
+
+			Coverage coverage = strict_nb2hops(olsr, symmetric);
+			for(Coverage::iterator it = coverage.begin(); it != coverage.end(); it++) {
+				bool covered = false;
+				for(NodeSet::iterator over = it->second.begin(); over != it->second.end(); over++) {
+					if(mprs.count(*over)) { covered = true; }
+				}
+				CHECK(covered);
+			}
+		}
+
+		/// Shortest paths of a breadth first search over the tuple sets
+		void check_routes(Olsr& olsr) {
+			NodeSet symmetric = symmetric_neighbors(olsr);
+			Coverage coverage = strict_nb2hops(olsr, symmetric);
+			std::map<node_id_t, unsigned> distance;
+			for(NodeSet::iterator it = symmetric.begin(); it != symmetric.end(); it++) {
+				distance[*it] = 1;
+			}
+			for(Coverage::iterator it = coverage.begin(); it != coverage.end(); it++) {
+				distance[it->first] = 2;
+			}
+			for(unsigned h = 2; ; h++) {
+				bool added = false;
+				for(Olsr::topologyset_t::iterator it = olsr.topologyset().begin(); it != olsr.topologyset().end(); it++) {
+					node_id_t dest = (*it)->dest_addr();
+					node_id_t last = (*it)->last_addr();
+					if(dest != SELF && !distance.count(dest) && distance.count(last) && distance[last] == h) {
+						distance[dest] = h + 1;
+						added = true;
+					}
+				}
+				if(!added) { break; }
+			}
+
+			RoutingTable& routes = olsr.routing_table();
+			CHECK(routes.size() == distance.size());
+			for(std::map<node_id_t, unsigned>::iterator it = distance.begin(); it != distance.end(); it++) {
+				RoutingTable::iterator route = routes.find(it->first);
+				CHECK(route != routes.end() && route->second.hops == it->second);
+				if(route != routes.end()) {
+					CHECK(symmetric.count(route->second.next_addr) == 1);
+				}
+			}
+		}
+
+		NodeSet symmetric_neighbors(Olsr& olsr) {
+			NodeSet symmetric;
+			for(Olsr::nbset_t::iterator it = olsr.nbset().begin(); it != olsr.nbset().end(); it++) {
+				if((*it)->status() == OLSR_STATUS_SYM) { symmetric.insert((*it)->nb_node_addr()); }
+			}
+			return symmetric;
+		}
+
+		/// N2 of RFC 3626 with the neighbours reaching every member
+		Coverage strict_nb2hops(Olsr& olsr, NodeSet& symmetric) {
+			Coverage coverage;
+			for(Olsr::nb2hopset_t::iterator it = olsr.nb2hopset().begin(); it != olsr.nb2hopset().end(); it++) {
+				NbTuple* over = olsr.find_sym_nb_tuple((*it)->nb_node_addr());
+				node_id_t addr = (*it)->nb2hop_addr();
+				if(!over || over->willingness() == OLSR_WILL_NEVER || addr == SELF || symmetric.count(addr)) { continue; }
+				coverage[addr].insert((*it)->nb_node_addr());
+			}
+			return coverage;
+		}
+
+		void random_change(Olsr& olsr) {
+			int action = next_random() % 100;
+			if(action < 35) {
+				node_id_t over = FIRST_NEIGHBOR + next_random() % NEIGHBORS;
+				node_id_t addr = SELF + next_random() % 60;
+				if(addr != over && olsr.find_nb_tuple(over) && !olsr.find_nb2hop_tuple(over, addr)) {
+					add_nb2hop(olsr, over, addr);
+				}
+			}
+			else if(action < 55) {
+				if(olsr.nb2hopset().size()) {
+					Nb2hopTuple* tuple = olsr.nb2hopset()[next_random() % olsr.nb2hopset().size()];
+					olsr.rm_nb2hop_tuple(tuple);
+					olsr.nb2hop_pool_.free(tuple);
+				}
+			}
+			else if(action < 75) {
+				node_id_t last = FIRST_NEIGHBOR + next_random() % 80;
+				node_id_t dest = SELF + next_random() % 100;
+				if(last != dest && !olsr.find_topology_tuple(dest, last) && !olsr.topology_pool_.full()) {
+					add_topology(olsr, last, dest);
+				}
+			}
+			else if(action < 90) {
+				if(olsr.topologyset().size()) {
+					TopologyTuple* tuple = olsr.topologyset()[next_random() % olsr.topologyset().size()];
+					olsr.rm_topology_tuple(tuple);
+					olsr.topology_pool_.free(tuple);
+				}
+			}
+			else if(action < 93) {
+				// a lost neighbour, it may come back with an other willingness
+				if(olsr.linkset().size()) {
+					LinkTuple* link = olsr.linkset()[next_random() % olsr.linkset().size()];
+					node_id_t addr = link->nb_node_addr();
+					olsr.erase_nb2hop_tuples(addr);
+					olsr.rm_link_tuple(link);
+					olsr.link_pool_.free(link);
+					if(next_random() % 2) { add_neighbor(olsr, addr, random_willingness()); }
+				}
+			}
+			else if(action < 97) {
+				// the link becomes asymmetric or symmetric again
+				if(olsr.linkset().size()) {
+					LinkTuple* link = olsr.linkset()[next_random() % olsr.linkset().size()];
+					link->sym_time() = (link->sym_time() > LegacyClock::time(0)) ? 0 : 1e9;
+					olsr.updated_link_tuple(link);
+				}
+			}
+			else {
+				node_id_t addr = FIRST_NEIGHBOR + next_random() % NEIGHBORS;
+				if(!olsr.find_link_tuple(addr)) { add_neighbor(olsr, addr, random_willingness()); }
+			}
+		}
+
+		uint8_t random_willingness() {
+			int r = next_random() % 10;
+			return r == 0 ? OLSR_WILL_NEVER : r == 1 ? OLSR_WILL_ALWAYS : r == 2 ? OLSR_WILL_HIGH : OLSR_WILL_DEFAULT;
+		}
+
+		void add_neighbor(Olsr& olsr, node_id_t addr, uint8_t willingness) {
+			LinkTuple* link = olsr.link_pool_.alloc();
+			link->nb_node_addr() = addr;
+			link->local_node_addr() = SELF;
+			link->sym_time() = 1e9;
+			link->asym_time() = 1e9;
+			link->time() = 1e9;
+			link->lost_time() = 0;
+			olsr.add_link_tuple(link, willingness);
+		}
+
+		Nb2hopTuple* add_nb2hop(Olsr& olsr, node_id_t over, node_id_t addr) {
+			Nb2hopTuple* tuple = olsr.nb2hop_pool_.alloc();
+			if(!tuple) { return 0; }
+			tuple->nb_node_addr() = over;
+			tuple->nb2hop_addr() = addr;
+			tuple->time() = 1e9;
+			olsr.add_nb2hop_tuple(tuple);
+			return tuple;
+		}
+
+		void remove_nb2hop(Olsr& olsr, node_id_t over, node_id_t addr) {
+			Nb2hopTuple* tuple = olsr.find_nb2hop_tuple(over, addr);
+			olsr.rm_nb2hop_tuple(tuple);
+			olsr.nb2hop_pool_.free(tuple);
+		}
+
+		void add_topology(Olsr& olsr, node_id_t last, node_id_t dest) {
+			TopologyTuple* tuple = olsr.topology_pool_.alloc();
+			tuple->dest_addr() = dest;
+			tuple->last_addr() = last;
+			tuple->seq() = 1;
+			tuple->time() = 1e9;
+			olsr.add_topology_tuple(tuple);
+		}
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
@@ -0,0 +1,165 @@
+/*
+ * Round trip and order checks for the shared-prefix codec
+ * (algorithms/codecs/prefix_codec.h).
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+typedef Os::block_data_t block_data_t;
+typedef Os::size_t size_type;
+
+#include "../unit_test.h"
+
+#include <algorithms/codecs/prefix_codec.h>
+
+// Small buckets, so that most prefixes are front-coded against their predecessor
+typedef PrefixCodec<Os, 16, 1024, 4> Codec;
+// Table that only holds a few short prefixes
+typedef PrefixCodec<Os, 4, 24, 4> SmallCodec;
+
+const char* uris[] = {
+	"<http://www.w3.org/1999/02/22-rdf-syntax-ns#type>",
+	"<http://www.w3.org/2000/01/rdf-schema#label>",
+	"<http://www.w3.org/2000/01/rdf-schema#comment>",
+	"<http://purl.oclc.org/NET/ssnx/ssn#Sensor>",
+	"<http://purl.oclc.org/NET/ssnx/ssn#observes>",
+	"<http://purl.oclc.org/NET/ssnx/meteo/phenomena#Temperature>",
+	"<http://spitfire-project.eu/sensor/room42/temp>",
+	"<http://spitfire-project.eu/sensor/room42>",
+	"<http://spitfire-project.eu/sensor/>",
+	"\"21.5\"^^<http://www.w3.org/2001/XMLSchema#float>",
+	"\"no namespace at all\"",
+	"_:b0",
+	"",
+	0
+};
+
+class App : public UnitTest<Os> {
+	public:
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_round_trip();
+			test_order();
+			test_table_limits();
+			test_long_bucket_entry();
+
+			finish("prefix_codec_test");
+		}
+
+		void test_round_trip() {
+			Codec::reset();
+			for(int i = 0; uris[i]; i++) {
+				Codec::learn((block_data_t*)uris[i]);
+			}
+			CHECK(Codec::prefixes() > 0);
+
+			// learning a namespace twice does not add it again
+			size_type n = Codec::prefixes();
+			CHECK(!Codec::learn((block_data_t*)uris[0]));
+			CHECK(Codec::prefixes() == n);
+
+			for(int i = 0; uris[i]; i++) {
+				block_data_t *e = Codec::encode((block_data_t*)uris[i]);
+				block_data_t *d = Codec::decode(e);
+				CHECK(strcmp((char*)d, uris[i]) == 0);
+				// encoded values are non-empty and never longer than code byte + input
+				CHECK(e[0] != 0);
+				CHECK(strlen((char*)e) <= strlen(uris[i]) + 1);
+
+				// encoding is canonical
+				block_data_t *e2 = Codec::encode((block_data_t*)uris[i]);
+				CHECK(Codec::equals(e, e2));
+				Codec::free_result(e2);
+				Codec::free_result(d);
+				Codec::free_result(e);
+			}
+
+			// the table is frozen by the first encode()
+			CHECK(!Codec::add_prefix("<http://late.example.org/", 25));
+		}
+
+		void test_order() {
+			// still frozen with the prefixes of test_round_trip()
+			for(int i = 0; uris[i]; i++) {
+				block_data_t *a = Codec::encode((block_data_t*)uris[i]);
+				for(int j = 0; uris[j]; j++) {
+					block_data_t *b = Codec::encode((block_data_t*)uris[j]);
+					int expected = sign(unsigned_strcmp(uris[i], uris[j]));
+					CHECK(sign(Codec::compare(a, b)) == expected);
+					CHECK(Codec::equals(a, b) == (expected == 0));
+					Codec::free_result(b);
+				}
+				Codec::free_result(a);
+			}
+		}
+
+		void test_table_limits() {
+			SmallCodec::reset();
+			CHECK(SmallCodec::add_prefix("<http://a.org/", 14));
+			// duplicates and empty prefixes are rejected
+			CHECK(!SmallCodec::add_prefix("<http://a.org/", 14));
+			CHECK(!SmallCodec::add_prefix("<http://a.org/", 0));
+			// 16 of the 24 table bytes are used, this one needs 14 more
+			CHECK(!SmallCodec::add_prefix("<http://example.org/", 20));
+			CHECK(SmallCodec::prefixes() == 1);
+			CHECK(SmallCodec::add_prefix("<http://b.org/", 14));
+			CHECK(SmallCodec::prefixes() == 2);
+			CHECK(SmallCodec::table_used() == 24);
+
+			// a failed insertion leaves the table usable
+			const char *v = "<http://b.org/x>";
+			block_data_t *e = SmallCodec::encode((block_data_t*)v);
+			CHECK(e[0] == SmallCodec::CODE_FIRST_PREFIX + 1);
+			block_data_t *d = SmallCodec::decode(e);
+			CHECK(strcmp((char*)d, v) == 0);
+			SmallCodec::free_result(d);
+			SmallCodec::free_result(e);
+		}
+
+		void test_long_bucket_entry() {
+			// A short prefix that follows a long one in its bucket has to be
+			// expanded through the long one
+			const char *long_prefix = "<http://example.org/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa/";
+			Codec::reset();
+			CHECK(Codec::add_prefix(long_prefix, strlen(long_prefix)));
+			CHECK(Codec::add_prefix("<http://z/", 10));
+
+			const char *v = "<http://z/x>";
+			block_data_t *e = Codec::encode((block_data_t*)v);
+			CHECK(e[0] == Codec::CODE_FIRST_PREFIX + 1);
+			block_data_t *d = Codec::decode(e);
+			CHECK(strcmp((char*)d, v) == 0);
+			Codec::free_result(d);
+
+			char w[160];
+			strcpy(w, long_prefix);
+			strcat(w, "q>");
+			block_data_t *e2 = Codec::encode((block_data_t*)w);
+			CHECK(e2[0] == Codec::CODE_FIRST_PREFIX);
+			CHECK(Codec::compare(e, e2) > 0);
+			CHECK(Codec::compare(e2, e) < 0);
+			Codec::free_result(e2);
+			Codec::free_result(e);
+		}
+
+	private:
+		static int sign(int x) { return (x > 0) - (x < 0); }
+
+		static int unsigned_strcmp(const char* a, const char* b) {
+			while(*a && *a == *b) { a++; b++; }
+			return (int)(unsigned char)*a - (int)(unsigned char)*b;
+		}
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
@@ -0,0 +1,230 @@
+/*
+ * Behaviour checks for the reassembling slots of the 6LoWPAN layer
+ * (algorithms/6lowpan/reassembling_manager.h): fragments in any order,
+ * duplicate and overlapping fragments, late fragments and the timeouts.
+ * The byte accounting of the LoWPAN receive path is done by the test.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+//The pool of the RPL configuration, several datagrams can be reassembled at once
+#define RPL_DEFINED
+#include <algorithms/6lowpan/lowpan_config.h>
+#include <algorithms/6lowpan/reassembling_manager.h>
+
+/// Only the types of the radio are used by the packets
+struct LinkRadio {
+	typedef uint16_t node_id_t;
+	typedef uint16_t size_t;
+	typedef uint8_t block_data_t;
+	typedef uint8_t message_id_t;
+	enum {
+		NULL_NODE_ID = 0,
+		BROADCAST_ADDRESS = 0xffff
+	};
+};
+
+class App : public UnitTest<Os> {
+	public:
+		typedef FakeTimer<Os> Timer;
+		typedef LoWPANReassemblingManager<Os, LinkRadio, Os::Debug, Timer> Manager;
+		typedef Manager::Slot Slot;
+		typedef Manager::Packet_Pool_Mgr_t Pool;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_order();
+			test_overlap();
+			test_late_fragments();
+			test_timeout();
+			test_full();
+
+			finish("reassembling_manager_test");
+		}
+
+		/// Fragments of interleaved datagrams arrive in any order
+		void test_order() {
+			reset();
+			// 300 bytes: 0..95, 96..191, 192..287, 288..299
+			static const uint8_t offsets[] = { 24, 36, 0, 12 };
+			static const uint16_t sizes[] = { 96, 12, 96, 96 };
+
+			Slot* a = 0;
+			Slot* b = 0;
+			for(int i = 0; i < 4; i++) {
+				CHECK(!complete(a));
+				a = receive(1, 5, 300, offsets[i], sizes[i]);
+				CHECK(a != 0);
+				// the same tag from an other sender is an other datagram
+				b = receive(2, 5, 300, offsets[3 - i], sizes[3 - i]);
+				CHECK(b != 0 && b != a);
+			}
+			CHECK(complete(a) && complete(b));
+			CHECK(a->ip_packet != b->ip_packet);
+
+			// so is the same tag with an other size
+			Slot* c = receive(1, 5, 200, 0, 96);
+			CHECK(c != 0 && c != a && c != b);
+			CHECK(!complete(c));
+		}
+
+		void test_overlap() {
+			reset();
+			Slot* s = receive(1, 7, 300, 12, 96);
+			CHECK(s != 0);
+
+			// a retransmission, and fragments reaching into the received one
+			CHECK(receive(1, 7, 300, 12, 96) == 0);
+			CHECK(receive(1, 7, 300, 4, 96) == 0);
+			CHECK(receive(1, 7, 300, 23, 8) == 0);
+			CHECK(s->received_datagram_size == 96);
+
+			// the neighbours on both sides fit exactly
+			CHECK(receive(1, 7, 300, 24, 96) == s);
+			CHECK(receive(1, 7, 300, 36, 12) == s);
+			CHECK(receive(1, 7, 300, 0, 96) == s);
+			CHECK(complete(s));
+
+			// beyond the end of the IP packet buffer
+			Slot* t = receive(3, 1, 1280, 0, 96);
+			CHECK(t != 0);
+			CHECK(!t->is_it_new_offset(159, 2));
+			CHECK(t->is_it_new_offset(159, 1));
+			CHECK(!t->is_it_new_offset(200));
+		}
+
+		/// Fragments of a finished or timed out datagram do not start a new one
+		void test_late_fragments() {
+			reset();
+			Slot* s = receive(1, 9, 100, 0, 96);
+			receive(1, 9, 100, 12, 4);
+			CHECK(complete(s));
+			manager_.finish_reassembling(s);
+			pool_.clean_packet(s->ip_packet);
+
+			CHECK(manager_.find_reassembling(1, 9, 100) == 0);
+			CHECK(manager_.start_new_reassembling(100, 1, 9) == 0);
+			// the next datagram of the sender and the same tag of others are fine
+			CHECK(receive(1, 10, 100, 0, 96) != 0);
+			CHECK(receive(2, 9, 100, 0, 96) != 0);
+		}
+
+		void test_timeout() {
+			reset();
+			Slot* s = receive(1, 3, 300, 0, 96);
+			timer_.advance(LOWPAN_REASSEMBLING_TIMEOUT / 2);
+			Slot* t = receive(2, 3, 300, 0, 96);
+			Slot* u = receive(4, 3, 100, 0, 96);
+			receive(4, 3, 100, 12, 4);
+			CHECK(complete(u));
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE - 3);
+
+			// only the first process runs out
+			timer_.advance(LOWPAN_REASSEMBLING_TIMEOUT / 2);
+			CHECK(!s->valid && t->valid);
+			CHECK(manager_.find_reassembling(1, 3, 300) == 0);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE - 2);
+			// its late fragments are dropped
+			CHECK(receive(1, 3, 300, 12, 96) == 0);
+
+			// a complete datagram is left to the upper layer
+			timer_.advance(LOWPAN_REASSEMBLING_TIMEOUT);
+			CHECK(!t->valid && u->valid);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE - 1);
+
+			// the timer of a cancelled process does not hit the next one in the slot
+			manager_.finish_reassembling(u);
+			pool_.clean_packet(u->ip_packet);
+			Slot* v = receive(5, 1, 300, 0, 96);
+			timer_.advance(LOWPAN_REASSEMBLING_TIMEOUT / 2);
+			manager_.cancel_reassembling(v);
+			Slot* w = receive(5, 2, 300, 0, 96);
+			CHECK(w == v);
+			timer_.advance(LOWPAN_REASSEMBLING_TIMEOUT / 2);
+			CHECK(w->valid);
+			timer_.advance(LOWPAN_REASSEMBLING_TIMEOUT / 2);
+			CHECK(!w->valid);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE);
+		}
+
+		/// One packet of the pool is never taken by a reassembling
+		void test_full() {
+			reset();
+			for(int i = 0; i < LOWPAN_REASSEMBLING_SLOTS; i++) {
+				CHECK(receive(10 + i, 1, 300, 0, 96) != 0);
+			}
+			CHECK(receive(100, 1, 300, 0, 96) == 0);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE - LOWPAN_REASSEMBLING_SLOTS);
+
+			// without a free packet nothing is started either
+			timer_.advance(LOWPAN_REASSEMBLING_TIMEOUT);
+			CHECK(free_packets() == IP_PACKET_POOL_SIZE);
+			while(pool_.get_unused_packet() != 0) { }
+			CHECK(receive(100, 1, 300, 0, 96) == 0);
+		}
+
+	private:
+		void reset() {
+			timer_.advance(10 * LOWPAN_REASSEMBLING_TIMEOUT);
+			for(int i = 0; i < IP_PACKET_POOL_SIZE; i++) {
+				pool_.clean_packet_with_number(i);
+			}
+			pool_.init(*debug_);
+			manager_.init(timer_, *debug_, &pool_);
+		}
+
+		/**
+		 * Like the receive path of the LoWPAN layer: registers the fragment
+		 * at the 8 octet offset with the given payload size.
+		 * \return the slot or NULL if the fragment is dropped
+		 */
+		Slot* receive(uint16_t sender, uint16_t tag, uint16_t size, uint8_t offset, uint16_t bytes) {
+			uint8_t units = offset ? (bytes + 7) / 8 : 1;
+			Slot* slot = manager_.find_reassembling(sender, tag, size);
+			if(slot) {
+				if(!slot->is_it_new_offset(offset, units)) { return 0; }
+			}
+			else {
+				slot = manager_.start_new_reassembling(size, sender, tag);
+				if(!slot) { return 0; }
+				if(!slot->is_it_new_offset(offset, units)) {
+					manager_.cancel_reassembling(slot);
+					return 0;
+				}
+			}
+			slot->received_datagram_size += bytes;
+			return slot;
+		}
+
+		bool complete(Slot* slot) {
+			return slot && slot->valid && slot->received_datagram_size == slot->datagram_size;
+		}
+
+		int free_packets() {
+			int n = 0;
+			for(int i = 0; i < IP_PACKET_POOL_SIZE; i++) {
+				if(!pool_.packet_pool[i].valid) { n++; }
+			}
+			return n;
+		}
+
+		Timer timer_;
+		Pool pool_;
+		Manager manager_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
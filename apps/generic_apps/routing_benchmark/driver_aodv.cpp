@@ -0,0 +1,66 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+/*
+ * AODV (algorithms/routing/aodv). Data messages do not carry the payload,
+ * they are recognized by their header.
+ */
+
+#include "routing_benchmark.h"
+#include "algorithms/routing/aodv/aodv_routing.h"
+
+namespace wiselib {
+
+	namespace {
+		typedef AODVRoutingTableValue<SimOs::Radio, 8> AodvTableValue;
+		typedef AODVRouting<SimOs, std::map<SimOs::Radio::node_id_t, AodvTableValue>,
+				SimOs::Radio, SimOs::Debug> Aodv;
+
+		class AodvDriver
+			: public RoutingDriver<Aodv>
+		{
+			public:
+				typedef Aodv::RouteDiscoveryMessage RouteDiscoveryMessage;
+
+				const char* name() { return "aodv"; }
+
+				bool data_message(size_t len, const block_data_t* data, node_id_t receiver,
+						node_id_t& source, bool& delivered) {
+					if(len <= RouteDiscoveryMessage::PAYLOAD_POS || data[0] != DATA) { return false; }
+					source = read<SimOs, block_data_t, ::uint16_t>((block_data_t*)data + RouteDiscoveryMessage::SOURCE_POS);
+					delivered = (read<SimOs, block_data_t, ::uint16_t>((block_data_t*)data + RouteDiscoveryMessage::DEST_POS) == receiver);
+					return true;
+				}
+
+			protected:
+				void start(Aodv& routing, SimNode& node) {
+					routing.init(node.radio(), node.timer(), node.debug());
+					routing.enable_radio();
+				}
+		};
+	}
+
+	BenchmarkDriver* create_aodv_driver() {
+		return new AodvDriver;
+	}
+
+} // namespace wiselib
+
@@ -0,0 +1,62 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+/*
+ * DSDV (algorithms/routing/dsdv) on a StaticArrayRoutingTable, the payload
+ * is carried.
+ */
+
+#include "routing_benchmark.h"
+#include "internal_interface/routing_table/routing_table_static_array.h"
+#include "algorithms/routing/dsdv/dsdv_routing.h"
+
+/// Entries of the routing table, should not be less than the number of nodes
+#ifndef ROUTING_BENCHMARK_DSDV_TABLE_SIZE
+#define ROUTING_BENCHMARK_DSDV_TABLE_SIZE 1024
+#endif
+
+namespace wiselib {
+
+	namespace {
+		typedef StaticArrayRoutingTable<SimOs, SimOs::Radio, ROUTING_BENCHMARK_DSDV_TABLE_SIZE,
+				DsdvRoutingTableValue<SimOs, SimOs::Radio> > DsdvTable;
+		typedef DsdvRouting<SimOs, DsdvTable, SimOs::Radio, SimOs::Timer, SimOs::Debug> Dsdv;
+
+		class DsdvDriver
+			: public RoutingDriver<Dsdv>
+		{
+			public:
+				const char* name() { return "dsdv"; }
+
+			protected:
+				void start(Dsdv& routing, SimNode& node) {
+					routing.init(node.radio(), node.timer(), node.debug());
+					routing.enable_radio();
+				}
+		};
+	}
+
+	BenchmarkDriver* create_dsdv_driver() {
+		return new DsdvDriver;
+	}
+
+} // namespace wiselib
+
@@ -0,0 +1,72 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+/*
+ * DYMO (algorithms/routing/dymo). Data messages do not carry the payload,
+ * they are recognized by their header.
+ */
+
+#include "routing_benchmark.h"
+#include "util/allocators/malloc_free_allocator.h"
+
+// Needed by util/pstl/list_dynamic.h which comes with dymo_routing.h
+typedef wiselib::MallocFreeAllocator<wiselib::SimOs> Allocator;
+Allocator& get_allocator();
+
+#include "algorithms/routing/dymo/dymo_routing.h"
+
+namespace wiselib {
+
+	namespace {
+		typedef DYMORoutingTableValue<SimOs::Radio, 8> DymoTableValue;
+		typedef DYMORouting<SimOs, std::map<SimOs::Radio::node_id_t, DymoTableValue>,
+				SimOs::Radio, SimOs::Debug> Dymo;
+
+		class DymoDriver
+			: public RoutingDriver<Dymo>
+		{
+			public:
+				typedef Dymo::RouteDiscoveryMessage RouteDiscoveryMessage;
+
+				const char* name() { return "dymo"; }
+
+				bool data_message(size_t len, const block_data_t* data, node_id_t receiver,
+						node_id_t& source, bool& delivered) {
+					if(len <= RouteDiscoveryMessage::PAYLOAD_POS || data[0] != DYMO_DATA) { return false; }
+					source = read<SimOs, block_data_t, ::uint16_t>((block_data_t*)data + RouteDiscoveryMessage::SOURCE_POS);
+					delivered = (read<SimOs, block_data_t, ::uint16_t>((block_data_t*)data + RouteDiscoveryMessage::DEST_POS) == receiver);
+					return true;
+				}
+
+			protected:
+				void start(Dymo& routing, SimNode& node) {
+					routing.init(node.radio(), node.timer(), node.debug());
+					routing.enable_radio();
+				}
+		};
+	}
+
+	BenchmarkDriver* create_dymo_driver() {
+		return new DymoDriver;
+	}
+
+} // namespace wiselib
+
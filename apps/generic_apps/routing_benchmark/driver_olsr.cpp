@@ -0,0 +1,55 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+/*
+ * OLSR (algorithms/routing/olsr), uses the static facet interface. The
+ * payload is carried.
+ */
+
+#include "routing_benchmark.h"
+#include "algorithms/routing/olsr/olsr_routing.h"
+
+namespace wiselib {
+
+	namespace {
+		typedef OlsrRouting<SimOs, std::map< ::uint16_t, OlsrRoutingTableValue<SimOs, SimOs::Radio> >,
+				SimLegacyClockModel<SimOs>, SimOs::Radio, SimOs::Debug> Olsr;
+
+		class OlsrDriver
+			: public RoutingDriver<Olsr>
+		{
+			public:
+				const char* name() { return "olsr"; }
+
+			protected:
+				void start(Olsr& routing, SimNode& node) {
+					routing.set_os(&node);
+					routing.enable();
+				}
+		};
+	}
+
+	BenchmarkDriver* create_olsr_driver() {
+		return new OlsrDriver;
+	}
+
+} // namespace wiselib
+
@@ -0,0 +1,108 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+/*
+ * RPL (algorithms/routing/rpl) inside the 6LoWPAN stack with node 1 as the
+ * DODAG root. Data is sent over UDP to the global address of the
+ * destination, the payload is carried.
+ */
+
+#include "routing_benchmark.h"
+
+#define RPL_DEFINED
+#include "algorithms/6lowpan/ipv6_stack.h"
+
+namespace wiselib {
+
+	namespace {
+		typedef IPv6Stack<SimOs, SimOs::Radio, SimOs::Debug, SimOs::Timer, SimOs::Uart, SimOs::Clock> Stack;
+		typedef IPv6Address<SimOs::Radio, SimOs::Debug> IPv6Address_t;
+		typedef UDPSocket<IPv6Address_t> UDPSocket_t;
+
+		enum {
+			LOCAL_PORT = 61616,
+			REMOTE_PORT = 61617
+		};
+
+		class RplDriver
+			: public BenchmarkDriver
+		{
+			public:
+				~RplDriver() { shutdown(); }
+
+				const char* name() { return "rpl"; }
+
+				size_t instance_size() { return sizeof(Stack); }
+
+				void boot(SimNode& node) {
+					if(stacks_.size() < node.id()) {
+						SimAllocationScope scope;
+						stacks_.resize(node.id(), 0);
+					}
+					Stack* stack = new Stack;
+					stacks_[node.id() - 1] = stack;
+
+					stack->init(node.radio(), node.debug(), node.timer(), node.uart(), node.clock());
+					int callback_id = stack->udp.reg_recv_callback<RplDriver, &RplDriver::receive>(this);
+					stack->udp.listen(REMOTE_PORT, callback_id);
+					stack->rpl.set_dodag_root(node.id() == 1);
+					stack->rpl.start();
+				}
+
+				void send(SimNode& node, node_id_t destination, size_t len, block_data_t* data) {
+					if(node.id() > stacks_.size() || !stacks_[node.id() - 1]) { return; }
+
+					::uint8_t global_prefix[8];
+					global_prefix[0] = 0xAA;
+					global_prefix[1] = 0xAA;
+					memset(global_prefix + 2, 0, 6);
+
+					IPv6Address_t address;
+					address.set_prefix(global_prefix);
+					address.prefix_length = 64;
+					address.set_long_iid(&destination, true);
+
+					stacks_[node.id() - 1]->udp.send(UDPSocket_t(LOCAL_PORT, REMOTE_PORT, address), len, data);
+				}
+
+				void shutdown() {
+					for(size_t i = 0; i < stacks_.size(); i++) {
+						delete stacks_[i];
+					}
+					SimAllocationScope scope;
+					std::vector<Stack*>().swap(stacks_);
+				}
+
+			private:
+				void receive(UDPSocket_t socket, ::uint16_t len, block_data_t* data) {
+					delivered(len, data);
+				}
+
+				std::vector<Stack*> stacks_;
+		};
+	}
+
+	BenchmarkDriver* create_rpl_driver() {
+		return new RplDriver;
+	}
+
+} // namespace wiselib
+
@@ -0,0 +1,67 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+/*
+ * TORA (algorithms/routing/tora). Data messages carry neither the payload
+ * nor the originator and are broadcast with the next hop inside, they are
+ * recognized by their header.
+ */
+
+#include "routing_benchmark.h"
+#include "algorithms/routing/tora/tora_routing.h"
+
+namespace wiselib {
+
+	namespace {
+		typedef ToraRouting<SimOs, std::map<SimOs::Radio::node_id_t, ToraRoutingTableValue<SimOs, SimOs::Radio> >,
+				SimOs::Radio, SimOs::Debug> Tora;
+
+		class ToraDriver
+			: public RoutingDriver<Tora>
+		{
+			public:
+				typedef Tora::RoutingMessage RoutingMessage;
+
+				const char* name() { return "tora"; }
+
+				bool data_message(size_t len, const block_data_t* data, node_id_t receiver,
+						node_id_t& source, bool& delivered) {
+					if(len <= RoutingMessage::PAYLOAD_POS || data[0] != DATA) { return false; }
+					source = SimOs::Radio::NULL_NODE_ID;
+					delivered = (read<SimOs, block_data_t, ::uint16_t>((block_data_t*)data + RoutingMessage::NEXT_NOD_POS) == receiver)
+						&& (read<SimOs, block_data_t, ::uint16_t>((block_data_t*)data + RoutingMessage::DEST_POS) == receiver);
+					return true;
+				}
+
+			protected:
+				void start(Tora& routing, SimNode& node) {
+					routing.init(node.radio(), node.timer(), node.debug());
+					routing.enable_radio();
+				}
+		};
+	}
+
+	BenchmarkDriver* create_tora_driver() {
+		return new ToraDriver;
+	}
+
+} // namespace wiselib
+
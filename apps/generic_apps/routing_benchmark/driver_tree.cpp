@@ -0,0 +1,57 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+/*
+ * Tree routing (algorithms/routing/tree) towards node 1, the payload is
+ * carried.
+ */
+
+#include "routing_benchmark.h"
+#include "algorithms/routing/tree/tree_routing.h"
+
+namespace wiselib {
+
+	namespace {
+		typedef TreeRouting<SimOs, SimOs::Radio, SimOs::Timer, SimOs::Debug> Tree;
+
+		class TreeDriver
+			: public RoutingDriver<Tree>
+		{
+			public:
+				const char* name() { return "tree"; }
+
+				bool sink_only() { return true; }
+
+			protected:
+				void start(Tree& routing, SimNode& node) {
+					routing.init(node.radio(), node.timer(), node.debug());
+					routing.set_sink(node.id() == 1);
+					routing.enable_radio();
+				}
+		};
+	}
+
+	BenchmarkDriver* create_tree_driver() {
+		return new TreeDriver;
+	}
+
+} // namespace wiselib
+
@@ -0,0 +1,586 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+/*
+ * Benchmark for the routing algorithms in algorithms/routing on synthetic
+ * topologies. All nodes are simulated in this process (sim_os_model.h),
+ * see README for usage and output format.
+ */
+
+#include <external_interface/external_interface.h>
+typedef wiselib::OSMODEL Os;
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <new>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+
+#include "routing_benchmark.h"
+
+using namespace wiselib;
+
+// ----------------------------------------------------------------------
+// Heap accounting: everything allocated outside of a SimAllocationScope
+// is attributed to the algorithm under test.
+// ----------------------------------------------------------------------
+
+namespace {
+	struct HeapStats {
+		size_t in_use;
+		size_t peak;
+		unsigned long long allocations;
+	};
+
+	HeapStats heap_stats = { 0, 0, 0 };
+
+	/// Keeps the user data aligned like malloc() does
+	union AllocationHeader {
+		struct {
+			size_t size;
+			bool counted;
+		} info;
+		max_align_t align;
+	};
+
+	void* counted_alloc(size_t n) {
+		AllocationHeader* h = (AllocationHeader*)malloc(sizeof(AllocationHeader) + n);
+		if(!h) { throw std::bad_alloc(); }
+		h->info.size = n;
+		h->info.counted = (sim_allocation_depth() == 0);
+		if(h->info.counted) {
+			heap_stats.in_use += n;
+			heap_stats.allocations++;
+			if(heap_stats.in_use > heap_stats.peak) { heap_stats.peak = heap_stats.in_use; }
+		}
+		return h + 1;
+	}
+
+	void counted_free(void* p) {
+		if(!p) { return; }
+		AllocationHeader* h = (AllocationHeader*)p - 1;
+		if(h->info.counted) { heap_stats.in_use -= h->info.size; }
+		free(h);
+	}
+}
+
+void* operator new(size_t n) { return counted_alloc(n); }
+void* operator new[](size_t n) { return counted_alloc(n); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+
+// ----------------------------------------------------------------------
+
+namespace {
+	/// Swallows the output of algorithms that write to std::cout
+	class NullBuffer : public std::streambuf {
+		protected:
+			int overflow(int c) { return c; }
+	};
+
+	typedef SimWorld::sim_time_t sim_time_t;
+	typedef BenchmarkDriver::node_id_t node_id_t;
+	typedef BenchmarkDriver::block_data_t block_data_t;
+
+	enum {
+		/// Marks the payload of the benchmark, followed by the packet index
+		PACKET_MAGIC = 0x52424e4b,
+		PACKET_TAG_LENGTH = 8,
+		SINK = 1
+	};
+
+	const sim_time_t SECOND = 1000000;
+
+	struct Options {
+		std::string topology;
+		std::string protocols;
+		std::string pattern;
+		double duration;
+		double warmup;
+		double drain;
+		::uint32_t flows;
+		::uint32_t interval;
+		::uint32_t payload;
+		double range;
+		double loss;
+		::uint32_t seed;
+		bool verbose;
+
+		Options()
+			: topology("grid:100"), protocols("aodv,dymo,dsdv,olsr,tora,tree"), pattern("p2p"),
+			duration(120.0), warmup(30.0), drain(5.0), flows(10), interval(1000), payload(16),
+			range(0.0), loss(0.0), seed(1), verbose(false) {
+		}
+	};
+
+	struct Position {
+		double x, y;
+	};
+
+	struct Flow {
+		node_id_t source;
+		node_id_t destination;
+		sim_time_t first_send;
+		sim_time_t first_delivery;
+		bool connected;
+		::uint32_t last_packet;
+		bool has_packet;
+	};
+
+	struct Packet {
+		::uint32_t flow;
+		sim_time_t sent;
+		sim_time_t delivered;
+		bool is_delivered;
+	};
+
+	double percentile(std::vector<double> v, double p) {
+		if(v.empty()) { return -1; }
+		std::sort(v.begin(), v.end());
+		size_t idx = (size_t)(p * (v.size() - 1) + 0.5);
+		return v[idx];
+	}
+
+	double mean(const std::vector<double>& v) {
+		if(v.empty()) { return -1; }
+		double sum = 0;
+		for(size_t i = 0; i < v.size(); i++) { sum += v[i]; }
+		return sum / v.size();
+	}
+
+	/**
+	 * One run of one algorithm: sets up the world, runs it and collects
+	 * the statistics.
+	 */
+	class Run
+		: public SimRadioObserver
+	{
+		public:
+			Run(const Options& options, BenchmarkDriver& driver, const std::vector<Position>& positions,
+					const std::vector<Flow>& flows, double range)
+				: options_(options), driver_(driver), flows_(flows), range_(range),
+				control_frames_(0), control_bytes_(0), data_frames_(0), data_bytes_(0),
+				duplicates_(0), delivered_(0) {
+				SimAllocationScope scope;
+				world_.set_range(range);
+				world_.set_loss(options.loss);
+				world_.set_seed(options.seed);
+				world_.set_verbose(options.verbose);
+				world_.set_observer(this);
+				for(size_t i = 0; i < positions.size(); i++) {
+					world_.add_node(positions[i].x, positions[i].y);
+				}
+				world_.connect();
+				payload_.resize(options.payload < PACKET_TAG_LENGTH ? PACKET_TAG_LENGTH : options.payload);
+				for(size_t i = 0; i < payload_.size(); i++) { payload_[i] = (block_data_t)(0xa5 ^ i); }
+				driver_.set_delivery_callback(
+						BenchmarkDriver::delivery_delegate_t::from_method<Run, &Run::on_delivery>(this));
+			}
+
+			void run() {
+				size_t heap_before = heap_stats.in_use;
+				heap_stats.peak = heap_stats.in_use;
+
+				{
+					SimAllocationScope scope;
+					for(size_t i = 0; i < world_.size(); i++) {
+						world_.schedule(world_.random() % 1000000,
+								SimWorld::timer_delegate_t::from_method<Run, &Run::boot>(this), (void*)i);
+					}
+					sim_time_t start = (sim_time_t)(options_.warmup * SECOND);
+					for(size_t i = 0; i < flows_.size(); i++) {
+						world_.schedule(start + world_.random() % ((sim_time_t)options_.interval * 1000),
+								SimWorld::timer_delegate_t::from_method<Run, &Run::send>(this), (void*)i);
+					}
+				}
+
+				clock_t cpu_start = clock();
+				world_.run_until((sim_time_t)(options_.duration * SECOND));
+				cpu_ = (double)(clock() - cpu_start) / CLOCKS_PER_SEC;
+
+				heap_in_use_ = heap_stats.in_use - heap_before;
+				heap_peak_ = heap_stats.peak - heap_before;
+				driver_.shutdown();
+			}
+
+			void print(const char* topology) {
+				SimAllocationScope scope;
+				size_t nodes = world_.size();
+				double duration = options_.duration;
+
+				::uint32_t connected = 0;
+				std::vector<double> setup;
+				for(size_t i = 0; i < flows_.size(); i++) {
+					if(!flows_[i].connected) { continue; }
+					connected++;
+					setup.push_back((flows_[i].first_delivery - flows_[i].first_send) / 1000.0);
+				}
+				std::vector<double> latency;
+				::uint32_t sent = 0, delivered = 0;
+				for(size_t i = 0; i < packets_.size(); i++) {
+					sent++;
+					if(packets_[i].is_delivered) {
+						delivered++;
+						latency.push_back((packets_[i].delivered - packets_[i].sent) / 1000.0);
+					}
+				}
+
+				printf("{\"protocol\": \"%s\", \"topology\": \"%s\", \"nodes\": %u, \"degree\": %.2f, \"range\": %.3f"
+						", \"duration_s\": %.1f, \"flows\": %u, \"pattern\": \"%s\"",
+						driver_.name(), topology, (unsigned)nodes, world_.degree(), range_,
+						duration, (unsigned)flows_.size(), driver_.sink_only() ? "sink" : options_.pattern.c_str());
+				printf(", \"packets_sent\": %u, \"packets_delivered\": %u, \"delivery_ratio\": %.4f, \"duplicates\": %u",
+						sent, delivered, sent ? (double)delivered / sent : 0.0, duplicates_);
+				printf(", \"flows_connected\": %u, \"route_setup_ms_mean\": %.1f, \"route_setup_ms_p50\": %.1f"
+						", \"route_setup_ms_p95\": %.1f, \"latency_ms_mean\": %.2f",
+						connected, mean(setup), percentile(setup, 0.5), percentile(setup, 0.95), mean(latency));
+				printf(", \"control_frames\": %llu, \"control_bytes\": %llu, \"data_frames\": %llu, \"data_bytes\": %llu"
+						", \"control_frames_per_node_per_s\": %.4f",
+						control_frames_, control_bytes_, data_frames_, data_bytes_,
+						nodes ? control_frames_ / (double)nodes / duration : 0.0);
+				printf(", \"instance_bytes\": %u, \"heap_bytes_per_node\": %.1f, \"heap_peak_bytes_per_node\": %.1f",
+						(unsigned)driver_.instance_size(),
+						nodes ? (double)heap_in_use_ / nodes : 0.0, nodes ? (double)heap_peak_ / nodes : 0.0);
+				printf(", \"cpu_s\": %.3f, \"events\": %llu, \"ns_per_event\": %.1f",
+						cpu_, (unsigned long long)world_.events(),
+						world_.events() ? cpu_ * 1e9 / world_.events() : 0.0);
+				printf(", \"losses\": %llu, \"oversized\": %llu, \"unreachable\": %llu}\n",
+						(unsigned long long)world_.losses(), (unsigned long long)world_.oversized(),
+						(unsigned long long)world_.unreachable());
+				fflush(stdout);
+			}
+
+			// SimRadioObserver
+			void on_send(SimNode& node, ::uint16_t to, size_t len, const ::uint8_t* data) {
+				SimAllocationScope scope;
+				node_id_t source;
+				bool delivered;
+				if(find_tag(len, data) >= 0 || driver_.data_message(len, data, SimOs::Radio::NULL_NODE_ID, source, delivered)) {
+					data_frames_++;
+					data_bytes_ += len;
+				}
+				else {
+					control_frames_++;
+					control_bytes_ += len;
+				}
+			}
+
+			void on_receive(SimNode& node, ::uint16_t from, size_t len, const ::uint8_t* data) {
+				SimAllocationScope scope;
+				node_id_t source = SimOs::Radio::NULL_NODE_ID;
+				bool delivered = false;
+				if(!driver_.data_message(len, data, node.id(), source, delivered) || !delivered) { return; }
+
+				// No packet tag, credit the latest packet of a matching flow
+				Packet* best = 0;
+				for(size_t i = 0; i < flows_.size(); i++) {
+					Flow& f = flows_[i];
+					if(f.destination != node.id() || !f.has_packet) { continue; }
+					if(source != SimOs::Radio::NULL_NODE_ID && source != f.source) { continue; }
+					Packet& p = packets_[f.last_packet];
+					if(!p.is_delivered && (!best || p.sent > best->sent)) { best = &p; }
+				}
+				if(best) {
+					record_delivery(*best);
+				}
+				else {
+					duplicates_++;
+				}
+			}
+
+		private:
+			void boot(void* userdata) {
+				driver_.boot(world_.node((size_t)userdata));
+			}
+
+			void send(void* userdata) {
+				size_t idx = (size_t)userdata;
+				sim_time_t stop = (sim_time_t)((options_.duration - options_.drain) * SECOND);
+				if(world_.now() >= stop) { return; }
+
+				Flow& f = flows_[idx];
+				{
+					SimAllocationScope scope;
+					Packet p;
+					p.flow = idx;
+					p.sent = world_.now();
+					p.is_delivered = false;
+					packets_.push_back(p);
+					if(!f.has_packet) { f.first_send = p.sent; }
+					f.last_packet = packets_.size() - 1;
+					f.has_packet = true;
+
+					::uint32_t magic = PACKET_MAGIC;
+					::uint32_t index = f.last_packet;
+					memcpy(&payload_[0], &magic, 4);
+					memcpy(&payload_[4], &index, 4);
+
+					world_.schedule((sim_time_t)options_.interval * 1000,
+							SimWorld::timer_delegate_t::from_method<Run, &Run::send>(this), userdata);
+				}
+				driver_.send(*world_.node_by_id(f.source), f.destination, payload_.size(), &payload_[0]);
+			}
+
+			void on_delivery(size_t len, block_data_t* data) {
+				SimAllocationScope scope;
+				if(len < PACKET_TAG_LENGTH) { return; }
+				::uint32_t magic, index;
+				memcpy(&magic, data, 4);
+				memcpy(&index, data + 4, 4);
+				if(magic != PACKET_MAGIC || index >= packets_.size()) { return; }
+				if(packets_[index].is_delivered) {
+					duplicates_++;
+					return;
+				}
+				record_delivery(packets_[index]);
+			}
+
+			void record_delivery(Packet& p) {
+				p.is_delivered = true;
+				p.delivered = world_.now();
+				delivered_++;
+				Flow& f = flows_[p.flow];
+				if(!f.connected) {
+					f.connected = true;
+					f.first_delivery = p.delivered;
+				}
+			}
+
+			/// @return Offset of the packet tag in the frame, -1 if there is none
+			int find_tag(size_t len, const ::uint8_t* data) {
+				::uint32_t magic = PACKET_MAGIC;
+				for(size_t i = 0; i + PACKET_TAG_LENGTH <= len; i++) {
+					if(memcmp(data + i, &magic, 4) == 0) { return i; }
+				}
+				return -1;
+			}
+
+			const Options& options_;
+			BenchmarkDriver& driver_;
+			SimWorld world_;
+			std::vector<Flow> flows_;
+			std::vector<Packet> packets_;
+			std::vector<block_data_t> payload_;
+			double range_;
+
+			unsigned long long control_frames_, control_bytes_, data_frames_, data_bytes_;
+			::uint32_t duplicates_;
+			::uint32_t delivered_;
+			double cpu_;
+			size_t heap_in_use_, heap_peak_;
+	};
+}
+
+// ----------------------------------------------------------------------
+
+class App {
+	public:
+		void init(Os::AppMainParameter& amp) {
+			for(int i = 1; i < amp.argc; i++) {
+				if(!parse_option(amp.argv[i])) {
+					fprintf(stderr, "unknown argument '%s', see README\n", amp.argv[i]);
+					return;
+				}
+			}
+			if(options_.interval == 0) { options_.interval = 1; }
+
+			NullBuffer null_buffer;
+			std::streambuf* cout_buffer = std::cout.rdbuf();
+			if(!options_.verbose) {
+				std::cout.rdbuf(&null_buffer);
+			}
+
+			if(build_topology()) {
+				std::string protocols = options_.protocols + ",";
+				size_t begin = 0, end;
+				while((end = protocols.find(',', begin)) != std::string::npos) {
+					std::string name = protocols.substr(begin, end - begin);
+					begin = end + 1;
+					if(!name.empty()) {
+						run(name);
+					}
+				}
+			}
+
+			std::cout.rdbuf(cout_buffer);
+		}
+
+	private:
+		bool parse_option(const char* arg) {
+			const char* eq = strchr(arg, '=');
+			if(!eq) { return false; }
+			std::string key(arg, eq - arg);
+			const char* value = eq + 1;
+
+			if(key == "topology") { options_.topology = value; }
+			else if(key == "protocols") { options_.protocols = value; }
+			else if(key == "pattern") { options_.pattern = value; }
+			else if(key == "duration") { options_.duration = atof(value); }
+			else if(key == "warmup") { options_.warmup = atof(value); }
+			else if(key == "drain") { options_.drain = atof(value); }
+			else if(key == "flows") { options_.flows = atoi(value); }
+			else if(key == "interval") { options_.interval = atoi(value); }
+			else if(key == "payload") { options_.payload = atoi(value); }
+			else if(key == "range") { options_.range = atof(value); }
+			else if(key == "loss") { options_.loss = atof(value); }
+			else if(key == "seed") { options_.seed = atoi(value); }
+			else if(key == "verbose") { options_.verbose = atoi(value) != 0; }
+			else { return false; }
+			return true;
+		}
+
+		/// Creates the node positions, the range and the flows
+		bool build_topology() {
+			SimAllocationScope scope;
+			SimWorld rand;
+			rand.set_seed(options_.seed);
+
+			const std::string& t = options_.topology;
+			if(t.compare(0, 5, "grid:") == 0) {
+				::uint32_t n = atoi(t.c_str() + 5);
+				::uint32_t side = (::uint32_t)ceil(sqrt((double)n));
+				for(::uint32_t i = 0; i < n; i++) {
+					Position p = { (double)(i % side), (double)(i / side) };
+					positions_.push_back(p);
+				}
+				range_ = (options_.range > 0) ? options_.range : 1.0;
+			}
+			else if(t.compare(0, 7, "random:") == 0) {
+				::uint32_t n = atoi(t.c_str() + 7);
+				const char* colon = strchr(t.c_str() + 7, ':');
+				double degree = colon ? atof(colon + 1) : 8.0;
+				range_ = (options_.range > 0) ? options_.range : 1.0;
+				// Side of the square that gives the expected mean degree
+				double side = sqrt(n * M_PI * range_ * range_ / (degree > 0 ? degree : 8.0));
+				for(::uint32_t i = 0; i < n; i++) {
+					Position p = { side * (rand.random() / 4294967296.0), side * (rand.random() / 4294967296.0) };
+					positions_.push_back(p);
+				}
+			}
+			else {
+				std::ifstream in(t.c_str());
+				if(!in) {
+					fprintf(stderr, "can not read topology file '%s'\n", t.c_str());
+					return false;
+				}
+				std::string line;
+				while(std::getline(in, line)) {
+					if(line.empty() || line[0] == '#') { continue; }
+					std::istringstream fields(line);
+					Position p;
+					if(fields >> p.x >> p.y) { positions_.push_back(p); }
+				}
+				range_ = (options_.range > 0) ? options_.range : 1.0;
+			}
+
+			if(positions_.size() < 2 || positions_.size() >= SimOs::Radio::BROADCAST_ADDRESS) {
+				fprintf(stderr, "need 2 to %u nodes, got %u\n",
+						(unsigned)SimOs::Radio::BROADCAST_ADDRESS - 1, (unsigned)positions_.size());
+				return false;
+			}
+
+			make_flows(rand, false, p2p_flows_);
+			make_flows(rand, true, sink_flows_);
+			return true;
+		}
+
+		/**
+		 * Picks the flows at random, sources are distinct and so are the
+		 * destinations unless all of them go to the sink.
+		 */
+		void make_flows(SimWorld& rand, bool to_sink, std::vector<Flow>& flows) {
+			::uint32_t n = positions_.size();
+			::uint32_t count = options_.flows;
+			if(count > n / 2) { count = n / 2; }
+
+			std::vector<bool> used(n + 1, false);
+			used[SINK] = to_sink;
+			while(flows.size() < count) {
+				Flow f;
+				f.source = 1 + rand.random() % n;
+				f.destination = to_sink ? (node_id_t)SINK : (node_id_t)(1 + rand.random() % n);
+				if(used[f.source] || f.source == f.destination || (!to_sink && used[f.destination])) { continue; }
+				used[f.source] = true;
+				if(!to_sink) { used[f.destination] = true; }
+				f.first_send = 0;
+				f.first_delivery = 0;
+				f.connected = false;
+				f.last_packet = 0;
+				f.has_packet = false;
+				flows.push_back(f);
+			}
+		}
+
+		void run(const std::string& name) {
+			BenchmarkDriver* driver;
+			{
+				SimAllocationScope scope;
+				driver = create_driver(name);
+			}
+			if(!driver) {
+				fprintf(stderr, "unknown protocol '%s'\n", name.c_str());
+				return;
+			}
+
+			bool sink = driver->sink_only() || options_.pattern == "sink";
+			Run* r;
+			{
+				SimAllocationScope scope;
+				r = new Run(options_, *driver, positions_, sink ? sink_flows_ : p2p_flows_, range_);
+			}
+			r->run();
+			r->print(options_.topology.c_str());
+
+			SimAllocationScope scope;
+			delete r;
+			delete driver;
+		}
+
+		BenchmarkDriver* create_driver(const std::string& name) {
+			if(name == "aodv") { return create_aodv_driver(); }
+			if(name == "dymo") { return create_dymo_driver(); }
+			if(name == "dsdv") { return create_dsdv_driver(); }
+			if(name == "olsr") { return create_olsr_driver(); }
+			if(name == "tora") { return create_tora_driver(); }
+			if(name == "rpl") { return create_rpl_driver(); }
+			if(name == "tree") { return create_tree_driver(); }
+			return 0;
+		}
+
+		Options options_;
+		std::vector<Position> positions_;
+		std::vector<Flow> p2p_flows_;
+		std::vector<Flow> sink_flows_;
+		double range_;
+};
+
+App app;
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
@@ -0,0 +1,175 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+#ifndef ROUTING_BENCHMARK_H
+#define ROUTING_BENCHMARK_H
+
+// pc_wiselib_application.h defines main(), which only routing_benchmark.cpp
+// may pull in (it includes external_interface.h before this header). Keep
+// it out of the drivers, which reach it through the algorithms' includes.
+#ifndef PC_WISELIB_APPLICATION_H
+#define PC_WISELIB_APPLICATION_H
+#endif
+
+// The standard headers have to come before util/meta.h (pulled in by some
+// of the algorithms), it redefines static_assert
+#include <assert.h>
+#include <algorithm>
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "sim_os_model.h"
+
+namespace wiselib {
+
+	typedef SimOsModel SimOs;
+
+	/*
+	 * Every routing algorithm is driven through a BenchmarkDriver that
+	 * lives in a translation unit of its own (driver_*.cpp), several of
+	 * the algorithms declare the same names (e.g. DATA) in namespace
+	 * wiselib and can not be compiled together.
+	 */
+	class BenchmarkDriver {
+		public:
+			typedef SimOs::Radio::node_id_t node_id_t;
+			typedef SimOs::size_t size_t;
+			typedef SimOs::block_data_t block_data_t;
+
+			/// Called with the payload whenever it is handed to the application
+			typedef delegate2<void, size_t, block_data_t*> delivery_delegate_t;
+
+			virtual ~BenchmarkDriver() { }
+
+			void set_delivery_callback(delivery_delegate_t callback) { delivery_ = callback; }
+
+			virtual const char* name() = 0;
+
+			/// Size of one instance of the algorithm in bytes
+			virtual size_t instance_size() = 0;
+
+			/// Creates and starts the instance on the given node
+			virtual void boot(SimNode& node) = 0;
+
+			/// Sends data from node to destination
+			virtual void send(SimNode& node, node_id_t destination, size_t len, block_data_t* data) = 0;
+
+			/// Destroys all instances
+			virtual void shutdown() = 0;
+
+			/// Can only route towards the sink (the node with id 1)
+			virtual bool sink_only() { return false; }
+
+			/**
+			 * For algorithms that do not put the application payload into
+			 * their data messages: tells whether a frame is a data message.
+			 * If so, source is set to the originator (NULL_NODE_ID if the
+			 * message does not carry it) and delivered tells whether the
+			 * message reached its destination when it is received by
+			 * receiver.
+			 *
+			 * Algorithms that do carry the payload keep the default, their
+			 * data is recognized by the packet tag of the benchmark and the
+			 * delivery is reported through the delivery callback.
+			 */
+			virtual bool data_message(size_t len, const block_data_t* data, node_id_t receiver,
+					node_id_t& source, bool& delivered) {
+				return false;
+			}
+
+		protected:
+			void delivered(size_t len, block_data_t* data) {
+				if(delivery_) { delivery_(len, data); }
+			}
+
+		private:
+			delivery_delegate_t delivery_;
+	};
+
+	/**
+	 * Keeps one instance of Routing_P per node, start() sets it up.
+	 */
+	template<typename Routing_P>
+	class RoutingDriver
+		: public BenchmarkDriver
+	{
+		public:
+			typedef Routing_P Routing;
+
+			~RoutingDriver() { shutdown(); }
+
+			size_t instance_size() { return sizeof(Routing); }
+
+			void boot(SimNode& node) {
+				if(instances_.size() < node.id()) {
+					SimAllocationScope scope;
+					instances_.resize(node.id(), 0);
+				}
+				Routing* routing = new Routing;
+				instances_[node.id() - 1] = routing;
+				start(*routing, node);
+				routing->template reg_recv_callback<RoutingDriver, &RoutingDriver::receive>(this);
+			}
+
+			void send(SimNode& node, node_id_t destination, size_t len, block_data_t* data) {
+				if(Routing* routing = instance(node)) {
+					routing->send(destination, len, data);
+				}
+			}
+
+			void shutdown() {
+				for(size_t i = 0; i < instances_.size(); i++) {
+					delete instances_[i];
+				}
+				SimAllocationScope scope;
+				std::vector<Routing*>().swap(instances_);
+			}
+
+		protected:
+			virtual void start(Routing& routing, SimNode& node) = 0;
+
+			void receive(node_id_t from, size_t len, block_data_t* data) {
+				delivered(len, data);
+			}
+
+			Routing* instance(SimNode& node) {
+				return (node.id() <= instances_.size()) ? instances_[node.id() - 1] : 0;
+			}
+
+		private:
+			std::vector<Routing*> instances_;
+	};
+
+	BenchmarkDriver* create_aodv_driver();
+	BenchmarkDriver* create_dymo_driver();
+	BenchmarkDriver* create_dsdv_driver();
+	BenchmarkDriver* create_olsr_driver();
+	BenchmarkDriver* create_tora_driver();
+	BenchmarkDriver* create_rpl_driver();
+	BenchmarkDriver* create_tree_driver();
+
+} // namespace wiselib
+
+#endif // ROUTING_BENCHMARK_H
@@ -0,0 +1,707 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+// vim: set noexpandtab ts=4 sw=4:
+
+#ifndef ROUTING_BENCHMARK_SIM_OS_MODEL_H
+#define ROUTING_BENCHMARK_SIM_OS_MODEL_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <queue>
+
+#include "external_interface/default_return_values.h"
+#include "util/base_classes/radio_base.h"
+#include "util/delegates/delegate.hpp"
+#include "util/serialization/endian.h"
+#include "algorithms/rand/kiss.h"
+
+namespace wiselib {
+
+	/*
+	 * Discrete event simulation of a whole network inside one process.
+	 *
+	 * Every node gets its own set of facets (SimNode). They all share one
+	 * SimWorld which owns the clock, a single event queue for timers and
+	 * frame receptions, and the unit disk topology. A frame sent by a node
+	 * occupies its radio for the air time, then it is received by all
+	 * neighbours (broadcast) or by the addressed neighbour (unicast).
+	 * Collisions are not modelled, receptions may be dropped with a fixed
+	 * probability instead.
+	 *
+	 * Besides the usual instance based facet interface the facets offer
+	 * the old static interface that takes an Os* (the SimNode) as first
+	 * parameter, as used by e.g. OlsrRouting.
+	 */
+
+	class SimNode;
+	class SimWorld;
+
+	/// Nesting depth of SimAllocationScope
+	inline int& sim_allocation_depth() {
+		static int depth = 0;
+		return depth;
+	}
+
+	/**
+	 * Marks memory allocated while the scope is alive as belonging to the
+	 * simulation, not to the algorithm under test (see the memory
+	 * statistics of the benchmark).
+	 */
+	class SimAllocationScope {
+		public:
+			SimAllocationScope() { sim_allocation_depth()++; }
+			~SimAllocationScope() { sim_allocation_depth()--; }
+	};
+
+	// ----------------------------------------------------------------------
+
+	/// Observer of the radio traffic, used to collect the statistics
+	class SimRadioObserver {
+		public:
+			virtual ~SimRadioObserver() { }
+			/// A node transmits a frame (once per broadcast)
+			virtual void on_send(SimNode& node, ::uint16_t to, size_t len, const ::uint8_t* data) = 0;
+			/// A frame arrives at a node, before it is passed to the receivers
+			virtual void on_receive(SimNode& node, ::uint16_t from, size_t len, const ::uint8_t* data) = 0;
+	};
+
+	// ----------------------------------------------------------------------
+
+	class SimWorld {
+		public:
+			typedef ::uint64_t sim_time_t; ///< Microseconds since start
+			typedef delegate1<void, void*> timer_delegate_t;
+
+			enum { MAX_FRAME_LENGTH = 127 };
+
+			enum { NO_FRAME = -1 };
+
+			SimWorld()
+				: now_(0), seq_(0), range_(1.0), loss_(0.0), bitrate_(250000),
+				frame_overhead_(11), verbose_(false), observer_(0),
+				links_(0), events_(0), receptions_(0), losses_(0), unreachable_(0), oversized_(0),
+				rand_state_(1) {
+			}
+
+			~SimWorld();
+
+			///@name Setup
+			///@{
+			void set_range(double r) { range_ = r; }
+			/// Probability that a single reception is lost
+			void set_loss(double p) { loss_ = p; }
+			void set_bitrate(::uint32_t bits_per_second) { bitrate_ = bits_per_second; }
+			void set_verbose(bool v) { verbose_ = v; }
+			void set_seed(::uint32_t seed) { rand_state_ = seed ? seed : 1; }
+			void set_observer(SimRadioObserver* o) { observer_ = o; }
+
+			/// Adds a node, ids are assigned in order starting with 1
+			SimNode& add_node(double x, double y);
+
+			/// Computes the neighbourhoods, call after all nodes are added
+			void connect();
+			///@}
+
+			size_t size() { return nodes_.size(); }
+			SimNode& node(size_t idx) { return *nodes_[idx]; }
+			/// @return The node with the given id, 0 if there is none
+			SimNode* node_by_id(::uint16_t id) {
+				return (id >= 1 && id <= nodes_.size()) ? nodes_[id - 1] : 0;
+			}
+
+			sim_time_t now() { return now_; }
+			bool verbose() { return verbose_; }
+			/// xorshift32, only used for the medium and for seeding the nodes
+			::uint32_t random() {
+				rand_state_ ^= rand_state_ << 13;
+				rand_state_ ^= rand_state_ >> 17;
+				rand_state_ ^= rand_state_ << 5;
+				return rand_state_;
+			}
+
+			/// Calls callback(userdata) after delay_us
+			void schedule(sim_time_t delay_us, timer_delegate_t callback, void* userdata) {
+				SimAllocationScope scope;
+				Event e;
+				e.at = now_ + delay_us;
+				e.seq = seq_++;
+				e.callback = callback;
+				e.userdata = userdata;
+				e.frame = NO_FRAME;
+				e.node = 0;
+				queue_.push(e);
+			}
+
+			/// Hands a frame to the medium, @return false if it can not be sent
+			bool transmit(SimNode& sender, ::uint16_t to, size_t len, const ::uint8_t* data);
+
+			/// Processes all events up to (and including) time t
+			void run_until(sim_time_t t) {
+				while(!queue_.empty() && queue_.top().at <= t) {
+					Event e = queue_.top();
+					queue_.pop();
+					now_ = e.at;
+					events_++;
+					if(e.frame == NO_FRAME) {
+						e.callback(e.userdata);
+					}
+					else {
+						deliver(e);
+					}
+				}
+				now_ = t;
+			}
+
+			///@name Statistics of the medium
+			///@{
+			::uint64_t events() { return events_; }
+			::uint64_t receptions() { return receptions_; }
+			::uint64_t losses() { return losses_; }
+			/// Unicasts to a node that is not a neighbour
+			::uint64_t unreachable() { return unreachable_; }
+			/// Frames longer than MAX_FRAME_LENGTH, they are not sent
+			::uint64_t oversized() { return oversized_; }
+			/// Mean number of neighbours
+			double degree() {
+				return nodes_.empty() ? 0.0 : (double)links_ / nodes_.size();
+			}
+			///@}
+
+		private:
+			struct Event {
+				sim_time_t at;
+				::uint64_t seq;
+				timer_delegate_t callback;
+				void* userdata;
+				::int32_t frame;
+				::uint32_t node;
+			};
+
+			struct Later {
+				bool operator()(const Event& a, const Event& b) const {
+					return (a.at != b.at) ? (a.at > b.at) : (a.seq > b.seq);
+				}
+			};
+
+			/// A frame in the air, shared by all its receptions
+			struct Frame {
+				::uint8_t data[MAX_FRAME_LENGTH];
+				::uint16_t len;
+				::uint16_t from;
+				::uint32_t refs;
+			};
+
+			void deliver(Event& e);
+
+			::int32_t alloc_frame() {
+				if(!free_frames_.empty()) {
+					::int32_t f = free_frames_.back();
+					free_frames_.pop_back();
+					return f;
+				}
+				frames_.push_back(Frame());
+				return frames_.size() - 1;
+			}
+
+			void release_frame(::int32_t f) {
+				if(--frames_[f].refs == 0) {
+					free_frames_.push_back(f);
+				}
+			}
+
+			sim_time_t now_;
+			::uint64_t seq_;
+			std::priority_queue<Event, std::vector<Event>, Later> queue_;
+			std::vector<Frame> frames_;
+			std::vector< ::int32_t> free_frames_;
+			std::vector<SimNode*> nodes_;
+
+			double range_;
+			double loss_;
+			::uint32_t bitrate_;
+			::uint32_t frame_overhead_;
+			bool verbose_;
+			SimRadioObserver* observer_;
+
+			::uint64_t links_;
+			::uint64_t events_;
+			::uint64_t receptions_;
+			::uint64_t losses_;
+			::uint64_t unreachable_;
+			::uint64_t oversized_;
+			::uint32_t rand_state_;
+			/// Scratch copy handed to the receivers, they may modify it
+			::uint8_t rx_buffer_[MAX_FRAME_LENGTH];
+	};
+
+	// ----------------------------------------------------------------------
+
+	template<typename OsModel_P> class SimRadioModel;
+	template<typename OsModel_P> class SimTimerModel;
+	template<typename OsModel_P> class SimClockModel;
+	template<typename OsModel_P> class SimLegacyClockModel;
+	template<typename OsModel_P> class SimDebug;
+	template<typename OsModel_P> class SimUartModel;
+
+	class SimOsModel
+		: public DefaultReturnValues<SimOsModel>
+	{
+		public:
+			/// For algorithms using the static facet interface
+			typedef SimNode Os;
+
+			typedef ::size_t size_t;
+			typedef ::uint8_t block_data_t;
+
+			typedef SimRadioModel<SimOsModel> Radio;
+			typedef SimTimerModel<SimOsModel> Timer;
+			typedef SimClockModel<SimOsModel> Clock;
+			typedef SimDebug<SimOsModel> Debug;
+			typedef SimUartModel<SimOsModel> Uart;
+			typedef Kiss<SimOsModel> Rand;
+
+			static const Endianness endianness = WISELIB_ENDIANNESS;
+	};
+
+	// ----------------------------------------------------------------------
+
+	template<typename OsModel_P>
+	class SimRadioModel
+		: public RadioBase<OsModel_P, ::uint16_t, typename OsModel_P::size_t, typename OsModel_P::block_data_t>
+	{
+		public:
+			typedef OsModel_P OsModel;
+			typedef typename OsModel::Os Os;
+			typedef RadioBase<OsModel_P, ::uint16_t, typename OsModel_P::size_t, typename OsModel_P::block_data_t> Base;
+
+			typedef SimRadioModel<OsModel> self_type;
+			typedef self_type* self_pointer_t;
+
+			typedef ::uint16_t node_id_t;
+			typedef typename OsModel::size_t size_t;
+			typedef typename OsModel::block_data_t block_data_t;
+			typedef ::uint8_t message_id_t;
+
+			enum ErrorCodes {
+				SUCCESS = OsModel::SUCCESS,
+				ERR_UNSPEC = OsModel::ERR_UNSPEC
+			};
+
+			enum SpecialNodeIds {
+				BROADCAST_ADDRESS = 0xffff, ///< All nodes in communication range
+				NULL_NODE_ID      = 0       ///< Unknown/No node id
+			};
+
+			enum Restrictions {
+				MAX_MESSAGE_LENGTH = SimWorld::MAX_FRAME_LENGTH ///< Maximal number of bytes in payload
+			};
+
+			SimRadioModel() : world_(0), node_(0), id_(NULL_NODE_ID), enabled_(false) { }
+
+			void init(SimWorld& world, SimNode& node, node_id_t id) {
+				world_ = &world;
+				node_ = &node;
+				id_ = id;
+			}
+
+			int send(node_id_t to, size_t len, block_data_t* data) {
+				if(!enabled_ || !world_->transmit(*node_, to, len, data)) { return ERR_UNSPEC; }
+				return SUCCESS;
+			}
+
+			node_id_t id() { return id_; }
+			int enable_radio() { enabled_ = true; return SUCCESS; }
+			int disable_radio() { enabled_ = false; return SUCCESS; }
+			bool enabled() { return enabled_; }
+
+			using Base::reg_recv_callback;
+			using Base::notify_receivers;
+
+			///@name Static facet interface
+			///@{
+			static int send(Os* os, node_id_t to, size_t len, block_data_t* data) {
+				return os->radio().send(to, len, data);
+			}
+
+			static node_id_t id(Os* os) { return os->radio().id(); }
+			static void enable(Os* os) { os->radio().enable_radio(); }
+			static void disable(Os* os) { os->radio().disable_radio(); }
+
+			template<class T, void (T::*TMethod)(node_id_t, size_t, block_data_t*)>
+			static int reg_recv_callback(Os* os, T* obj) {
+				return os->radio().template reg_recv_callback<T, TMethod>(obj);
+			}
+			///@}
+
+		private:
+			SimWorld* world_;
+			SimNode* node_;
+			node_id_t id_;
+			bool enabled_;
+	};
+
+	// ----------------------------------------------------------------------
+
+	template<typename OsModel_P>
+	class SimTimerModel {
+		public:
+			typedef OsModel_P OsModel;
+			typedef typename OsModel::Os Os;
+
+			typedef SimTimerModel<OsModel> self_type;
+			typedef self_type* self_pointer_t;
+
+			typedef ::uint32_t millis_t;
+
+			enum ErrorCodes {
+				SUCCESS = OsModel::SUCCESS
+			};
+
+			SimTimerModel() : world_(0) { }
+
+			void init(SimWorld& world) { world_ = &world; }
+
+			template<typename T, void (T::*TMethod)(void*)>
+			int set_timer(millis_t millis, T* obj, void* userdata) {
+				world_->schedule((SimWorld::sim_time_t)millis * 1000,
+						SimWorld::timer_delegate_t::template from_method<T, TMethod>(obj), userdata);
+				return SUCCESS;
+			}
+
+			template<typename T, void (T::*TMethod)(void*)>
+			static int set_timer(Os* os, millis_t millis, T* obj, void* userdata) {
+				return os->timer().template set_timer<T, TMethod>(millis, obj, userdata);
+			}
+
+		private:
+			SimWorld* world_;
+	};
+
+	// ----------------------------------------------------------------------
+
+	template<typename OsModel_P>
+	class SimClockModel {
+		public:
+			typedef OsModel_P OsModel;
+
+			typedef SimClockModel<OsModel> self_type;
+			typedef self_type* self_pointer_t;
+
+			typedef ::uint64_t time_t;
+			typedef ::uint16_t micros_t;
+			typedef ::uint16_t millis_t;
+			typedef ::uint32_t seconds_t;
+
+			enum States {
+				READY = OsModel::READY,
+				NO_VALUE = OsModel::NO_VALUE,
+				INACTIVE = OsModel::INACTIVE
+			};
+
+			SimClockModel() : world_(0) { }
+
+			void init(SimWorld& world) { world_ = &world; }
+
+			int state() { return READY; }
+			time_t time() { return world_->now(); }
+			micros_t microseconds(time_t t) { return t % 1000; }
+			millis_t milliseconds(time_t t) { return (t / 1000) % 1000; }
+			seconds_t seconds(time_t t) { return t / 1000000; }
+
+		private:
+			SimWorld* world_;
+	};
+
+	/**
+	 * Clock for algorithms using the static facet interface, time is
+	 * a double in seconds.
+	 */
+	template<typename OsModel_P>
+	class SimLegacyClockModel {
+		public:
+			typedef OsModel_P OsModel;
+			typedef typename OsModel::Os Os;
+
+			typedef double time_t;
+
+			static time_t time(Os* os) { return os->clock().time() / 1000000.0; }
+	};
+
+	// ----------------------------------------------------------------------
+
+	template<typename OsModel_P>
+	class SimDebug {
+		public:
+			typedef OsModel_P OsModel;
+			typedef typename OsModel::Os Os;
+
+			typedef SimDebug<OsModel> self_type;
+			typedef self_type* self_pointer_t;
+
+			SimDebug() : world_(0), id_(0) { }
+
+			void init(SimWorld& world, ::uint16_t id) {
+				world_ = &world;
+				id_ = id;
+			}
+
+			void debug(const char* msg, ...) {
+				if(!world_->verbose()) { return; }
+				va_list fmtargs;
+				va_start(fmtargs, msg);
+				print(msg, fmtargs);
+				va_end(fmtargs);
+			}
+
+			static void debug(Os* os, const char* msg, ...) {
+				if(!os->debug().verbose()) { return; }
+				va_list fmtargs;
+				va_start(fmtargs, msg);
+				os->debug().print(msg, fmtargs);
+				va_end(fmtargs);
+			}
+
+			void print(const char* msg, va_list args) {
+				fprintf(stderr, "%10.6f %5u ", world_->now() / 1000000.0, id_);
+				vfprintf(stderr, msg, args);
+				if(msg[0] && msg[strlen(msg) - 1] != '\n') {
+					fputc('\n', stderr);
+				}
+			}
+
+			bool verbose() { return world_->verbose(); }
+
+		private:
+			SimWorld* world_;
+			::uint16_t id_;
+	};
+
+	// ----------------------------------------------------------------------
+
+	/// Serial line that is not connected
+	template<typename OsModel_P>
+	class SimUartModel {
+		public:
+			typedef OsModel_P OsModel;
+
+			typedef SimUartModel<OsModel> self_type;
+			typedef self_type* self_pointer_t;
+
+			typedef typename OsModel::size_t size_t;
+			typedef typename OsModel::block_data_t block_data_t;
+
+			enum ErrorCodes {
+				SUCCESS = OsModel::SUCCESS
+			};
+
+			int enable_serial_comm() { return SUCCESS; }
+			int disable_serial_comm() { return SUCCESS; }
+			int write(size_t len, block_data_t* buf) { return SUCCESS; }
+
+			template<class T, void (T::*TMethod)(size_t, block_data_t*)>
+			int reg_read_callback(T* obj) { return 0; }
+			int unreg_read_callback(int idx) { return SUCCESS; }
+	};
+
+	// ----------------------------------------------------------------------
+
+	class SimNode {
+		public:
+			typedef SimOsModel::Radio Radio;
+			typedef SimOsModel::Timer Timer;
+			typedef SimOsModel::Clock Clock;
+			typedef SimOsModel::Debug Debug;
+			typedef SimOsModel::Uart Uart;
+			typedef SimOsModel::Rand Rand;
+
+			typedef Radio::node_id_t node_id_t;
+
+			SimNode(SimWorld& world, node_id_t id, double x, double y)
+				: x_(x), y_(y), busy_until_(0) {
+				radio_.init(world, *this, id);
+				timer_.init(world);
+				clock_.init(world);
+				debug_.init(world, id);
+				rand_.srand(0x9e3779b9UL * id + world.random());
+			}
+
+			node_id_t id() { return radio_.id(); }
+			double x() { return x_; }
+			double y() { return y_; }
+
+			Radio& radio() { return radio_; }
+			Timer& timer() { return timer_; }
+			Clock& clock() { return clock_; }
+			Debug& debug() { return debug_; }
+			Uart& uart() { return uart_; }
+			Rand& rand() { return rand_; }
+
+			/// Indices (not ids) of the nodes within range
+			std::vector< ::uint32_t>& neighbours() { return neighbours_; }
+
+			/// End of the transmission currently on air
+			SimWorld::sim_time_t& busy_until() { return busy_until_; }
+
+		private:
+			Radio radio_;
+			Timer timer_;
+			Clock clock_;
+			Debug debug_;
+			Uart uart_;
+			Rand rand_;
+
+			double x_, y_;
+			SimWorld::sim_time_t busy_until_;
+			std::vector< ::uint32_t> neighbours_;
+	};
+
+	// ----------------------------------------------------------------------
+	// ----------------------------------------------------------------------
+	// ----------------------------------------------------------------------
+
+	inline SimWorld::~SimWorld() {
+		for(size_t i = 0; i < nodes_.size(); i++) {
+			delete nodes_[i];
+		}
+	}
+
+	inline SimNode& SimWorld::add_node(double x, double y) {
+		SimAllocationScope scope;
+		nodes_.push_back(new SimNode(*this, nodes_.size() + 1, x, y));
+		return *nodes_.back();
+	}
+
+	inline void SimWorld::connect() {
+		SimAllocationScope scope;
+		// Bucket the nodes into cells of the size of the range so only the
+		// 3x3 surrounding cells need to be checked for each node
+		double min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+		for(size_t i = 0; i < nodes_.size(); i++) {
+			SimNode& n = *nodes_[i];
+			if(i == 0 || n.x() < min_x) { min_x = n.x(); }
+			if(i == 0 || n.y() < min_y) { min_y = n.y(); }
+			if(i == 0 || n.x() > max_x) { max_x = n.x(); }
+			if(i == 0 || n.y() > max_y) { max_y = n.y(); }
+		}
+		size_t cols = (size_t)((max_x - min_x) / range_) + 1;
+		size_t rows = (size_t)((max_y - min_y) / range_) + 1;
+		std::vector< std::vector< ::uint32_t> > cells(cols * rows);
+		for(size_t i = 0; i < nodes_.size(); i++) {
+			size_t cx = (size_t)((nodes_[i]->x() - min_x) / range_);
+			size_t cy = (size_t)((nodes_[i]->y() - min_y) / range_);
+			cells[cy * cols + cx].push_back(i);
+		}
+
+		links_ = 0;
+		for(size_t i = 0; i < nodes_.size(); i++) {
+			SimNode& n = *nodes_[i];
+			n.neighbours().clear();
+			long cx = (long)((n.x() - min_x) / range_);
+			long cy = (long)((n.y() - min_y) / range_);
+			for(long y = cy - 1; y <= cy + 1; y++) {
+				for(long x = cx - 1; x <= cx + 1; x++) {
+					if(x < 0 || y < 0 || x >= (long)cols || y >= (long)rows) { continue; }
+					std::vector< ::uint32_t>& cell = cells[y * cols + x];
+					for(size_t k = 0; k < cell.size(); k++) {
+						if(cell[k] == i) { continue; }
+						SimNode& m = *nodes_[cell[k]];
+						double dx = m.x() - n.x(), dy = m.y() - n.y();
+						if(dx * dx + dy * dy <= range_ * range_) {
+							n.neighbours().push_back(cell[k]);
+						}
+					}
+				}
+			}
+			links_ += n.neighbours().size();
+		}
+	}
+
+	inline bool SimWorld::transmit(SimNode& sender, ::uint16_t to, size_t len, const ::uint8_t* data) {
+		SimAllocationScope scope;
+		if(len > MAX_FRAME_LENGTH) {
+			oversized_++;
+			return false;
+		}
+		if(observer_) {
+			observer_->on_send(sender, to, len, data);
+		}
+
+		// The radio sends one frame after the other
+		sim_time_t start = (sender.busy_until() > now_) ? sender.busy_until() : now_;
+		sim_time_t air = ((len + frame_overhead_) * 8 * (sim_time_t)1000000) / bitrate_;
+		sender.busy_until() = start + air;
+
+		bool broadcast = (to == SimOsModel::Radio::BROADCAST_ADDRESS);
+		bool addressed = false;
+		::int32_t f = NO_FRAME;
+		std::vector< ::uint32_t>& nbs = sender.neighbours();
+		for(size_t i = 0; i < nbs.size() && (broadcast || !addressed); i++) {
+			SimNode& receiver = *nodes_[nbs[i]];
+			if(!broadcast && to != receiver.id()) { continue; }
+			addressed = true;
+			if(loss_ > 0.0 && random() % 1000000 < (::uint32_t)(loss_ * 1000000)) {
+				losses_++;
+				continue;
+			}
+			if(f == NO_FRAME) {
+				f = alloc_frame();
+				memcpy(frames_[f].data, data, len);
+				frames_[f].len = len;
+				frames_[f].from = sender.id();
+				frames_[f].refs = 0;
+			}
+			frames_[f].refs++;
+
+			Event e;
+			e.at = start + air;
+			e.seq = seq_++;
+			e.userdata = 0;
+			e.frame = f;
+			e.node = nbs[i];
+			queue_.push(e);
+		}
+		if(!broadcast && !addressed) {
+			unreachable_++;
+		}
+		return true;
+	}
+
+	inline void SimWorld::deliver(Event& e) {
+		Frame& frame = frames_[e.frame];
+		SimNode& receiver = *nodes_[e.node];
+		size_t len = frame.len;
+		::uint16_t from = frame.from;
+		memcpy(rx_buffer_, frame.data, len);
+		release_frame(e.frame);
+
+		if(!receiver.radio().enabled()) { return; }
+		receptions_++;
+		if(observer_) {
+			observer_->on_receive(receiver, from, len, rx_buffer_);
+		}
+		receiver.radio().notify_receivers(from, len, rx_buffer_);
+	}
+
+} // namespace wiselib
+
+#endif // ROUTING_BENCHMARK_SIM_OS_MODEL_H
@@ -0,0 +1,335 @@
+/*
+ * Behaviour checks for the downward route table of the RPL root
+ * (algorithms/routing/rpl/rpl_downward_routes.h): the lookups in both modes
+ * of operation, the lollipop ordering of the path sequences, the expiry on
+ * the timer wheel, the full table and random churn against a reference
+ * list. The routing itself is compiled with RPL_ROOT_ROUTE_TABLE as well.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#define RPL_DEFINED
+#define RPL_ROOT_ROUTE_TABLE
+#include <algorithms/6lowpan/ipv6_stack.h>
+
+typedef IPv6Stack<Os, Os::Radio, Os::Debug, Os::Timer, Os::Uart, Os::Clock> Stack;
+typedef Stack::IPv6_t IPv6_t;
+typedef Stack::RPL_t RPL;
+
+// The parts of the routing which use the table, they are only built with RPL_ROOT_ROUTE_TABLE
+template uint8_t RPL::start();
+template void RPL::receive(RPL::node_id_t, RPL::size_t, RPL::block_data_t*);
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			SIZE = 16,
+			WHEEL_SLOTS = 8,
+			MAX_HOPS = 4,
+			TARGETS = 24,
+			CHURN_STEPS = 20000
+		};
+
+		typedef RPLDownwardRoutes<Os, IPv6_t, SIZE, WHEEL_SLOTS, MAX_HOPS> Routes;
+		typedef IPv6_t::node_id_t Address;
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_storing();
+			test_lollipop();
+			test_expiry();
+			test_full();
+			test_non_storing();
+			test_churn();
+
+			finish("rpl_downward_routes_test");
+		}
+
+		void test_storing() {
+			routes_.init(address(1), true);
+			Address hop;
+
+			CHECK(routes_.update(address(10), address(2), 10, 100) == Routes::SUCCESS);
+			CHECK(routes_.next_hop(address(10), hop) && hop == address(2));
+			CHECK(routes_.size() == 1);
+
+			// the target moved to another branch
+			CHECK(routes_.update(address(10), address(3), 11, 100) == Routes::SUCCESS);
+			CHECK(routes_.next_hop(address(10), hop) && hop == address(3));
+			CHECK(routes_.update(address(10), address(2), 10, 100) == Routes::ERR_STALE);
+			CHECK(routes_.next_hop(address(10), hop) && hop == address(3));
+
+			// a No-Path from the old branch does not drop the new route
+			CHECK(routes_.update(address(10), address(2), 11, 0) == Routes::ERR_STALE);
+			CHECK(routes_.contains(address(10)));
+			CHECK(routes_.update(address(10), address(3), 12, 0) == Routes::SUCCESS);
+			CHECK(!routes_.contains(address(10)));
+			CHECK(routes_.size() == 0);
+
+			// a No-Path for an unknown target stores nothing
+			CHECK(routes_.update(address(11), address(2), 1, 0) == Routes::SUCCESS);
+			CHECK(routes_.size() == 0);
+			CHECK(!routes_.next_hop(address(11), hop));
+			CHECK(!routes_.remove(address(11)));
+
+			CHECK(routes_.update(address(11), address(2), 1, 100) == Routes::SUCCESS);
+			CHECK(routes_.remove(address(11)));
+			CHECK(!routes_.contains(address(11)));
+		}
+
+		/// RFC 6550 7.2, the new sequence is accepted if it is not older
+		void test_lollipop() {
+			// the same sequence refreshes the route
+			CHECK(accepted(10, 10));
+			CHECK(accepted(10, 20));
+			CHECK(!accepted(10, 5));
+			// too far apart to be compared, the new one wins
+			CHECK(accepted(10, 40));
+
+			// the linear part after a reboot
+			CHECK(accepted(240, 241));
+			CHECK(!accepted(241, 240));
+			// from the linear part into the circular part
+			CHECK(accepted(250, 5));
+			CHECK(!accepted(130, 5));
+			// a reboot restarts in the linear part
+			CHECK(accepted(5, 240));
+			CHECK(!accepted(5, 250));
+
+			// the circular part wraps around
+			CHECK(accepted(125, 2));
+			CHECK(accepted(127, 0));
+		}
+
+		void test_expiry() {
+			routes_.init(address(1), true);
+			routes_.update(address(10), address(2), 1, 3);
+			routes_.update(address(11), address(2), 1, 3 + WHEEL_SLOTS);
+			routes_.update(address(12), address(2), 1, Routes::INFINITE_LIFETIME);
+			routes_.update(address(13), address(2), 1, 3);
+
+			tick(2);
+			CHECK(routes_.contains(address(10)));
+			// a refresh moves the expiry
+			routes_.update(address(13), address(2), 1, 3);
+			tick(1);
+			CHECK(!routes_.contains(address(10)));
+			// the same slot of the wheel, one round later
+			CHECK(routes_.contains(address(11)));
+			CHECK(routes_.contains(address(13)));
+			tick(1);
+			CHECK(routes_.contains(address(13)));
+			tick(1);
+			CHECK(!routes_.contains(address(13)));
+
+			tick(WHEEL_SLOTS - 3);
+			CHECK(routes_.contains(address(11)));
+			tick(1);
+			CHECK(!routes_.contains(address(11)));
+
+			// a route which does not expire any more
+			routes_.update(address(14), address(2), 1, 2);
+			routes_.update(address(14), address(2), 1, Routes::INFINITE_LIFETIME);
+			tick(10 * WHEEL_SLOTS);
+			CHECK(routes_.contains(address(12)));
+			CHECK(routes_.contains(address(14)));
+			CHECK(routes_.size() == 2);
+		}
+
+		void test_full() {
+			routes_.init(address(1), true);
+			for(int i = 0; i < SIZE; i++) {
+				CHECK(routes_.update(address(100 + i), address(2), 1, 100) == Routes::SUCCESS);
+			}
+			CHECK(routes_.full());
+			CHECK(routes_.update(address(99), address(2), 1, 100) == Routes::ERR_NOMEM);
+			CHECK(!routes_.contains(address(99)));
+
+			// the stored routes can still be updated
+			CHECK(routes_.update(address(100), address(3), 2, 100) == Routes::SUCCESS);
+			Address hop;
+			CHECK(routes_.next_hop(address(100), hop) && hop == address(3));
+
+			// every route is found through the collisions of the hash
+			for(int i = 0; i < SIZE; i++) {
+				CHECK(routes_.contains(address(100 + i)));
+			}
+
+			CHECK(routes_.remove(address(105)));
+			CHECK(!routes_.full());
+			CHECK(routes_.update(address(99), address(2), 1, 100) == Routes::SUCCESS);
+			CHECK(routes_.size() == SIZE);
+		}
+
+		/// The entries hold the DAO parents, the first hop is the child of the root
+		void test_non_storing() {
+			routes_.init(address(1), false);
+			Address hop;
+
+			routes_.update(address(10), address(1), 1, 100);
+			routes_.update(address(11), address(10), 1, 100);
+			routes_.update(address(12), address(11), 1, 100);
+			CHECK(routes_.next_hop(address(10), hop) && hop == address(10));
+			CHECK(routes_.next_hop(address(11), hop) && hop == address(10));
+			CHECK(routes_.next_hop(address(12), hop) && hop == address(10));
+
+			// the cached first hop follows a new parent further up
+			routes_.update(address(20), address(1), 1, 100);
+			routes_.update(address(11), address(20), 2, 100);
+			CHECK(routes_.next_hop(address(12), hop) && hop == address(20));
+
+			// the path breaks with a parent that is gone
+			routes_.remove(address(20));
+			CHECK(!routes_.next_hop(address(12), hop));
+			CHECK(!routes_.next_hop(address(11), hop));
+			CHECK(routes_.next_hop(address(10), hop) && hop == address(10));
+
+			// the parents form a loop
+			routes_.update(address(30), address(31), 1, 100);
+			routes_.update(address(31), address(30), 1, 100);
+			CHECK(!routes_.next_hop(address(30), hop));
+
+			// at most MAX_HOPS from the root
+			routes_.update(address(40), address(1), 1, 100);
+			for(int i = 1; i <= MAX_HOPS; i++) {
+				routes_.update(address(40 + i), address(40 + i - 1), 1, 100);
+			}
+			CHECK(routes_.next_hop(address(40 + MAX_HOPS - 1), hop) && hop == address(40));
+			CHECK(!routes_.next_hop(address(40 + MAX_HOPS), hop));
+
+			// the No-Path comes from the root's view, the parent is not compared
+			CHECK(routes_.update(address(10), address(99), 2, 0) == Routes::SUCCESS);
+			CHECK(!routes_.contains(address(10)));
+		}
+
+		/// Random updates, removals and ticks against a list of the expected routes
+		void test_churn() {
+			routes_.init(address(1), true);
+			now_ = 0;
+			for(int t = 0; t < TARGETS; t++) {
+				expected_[t].present = false;
+				expected_[t].sequence = 0;
+			}
+
+			for(int step = 0; step < CHURN_STEPS; step++) {
+				int t = next_random() % TARGETS;
+				Expected& e = expected_[t];
+				int op = next_random() % 8;
+
+				if(op < 4) {
+					uint8_t via = 2 + next_random() % 3;
+					uint32_t lifetime = 1 + next_random() % (3 * WHEEL_SLOTS);
+					if(next_random() % 16 == 0) { lifetime = Routes::INFINITE_LIFETIME; }
+					uint8_t sequence = e.present ? ((e.sequence + (op == 0 ? 0 : 1)) & 0x7F) : e.sequence;
+					int result = routes_.update(address(100 + t), address(via), sequence, lifetime);
+					if(e.present || expected_size() < SIZE) {
+						CHECK(result == Routes::SUCCESS);
+						e.present = true;
+						e.via = via;
+						e.sequence = sequence;
+						e.expires = (lifetime == Routes::INFINITE_LIFETIME) ? lifetime : now_ + lifetime;
+					}
+					else {
+						CHECK(result == Routes::ERR_NOMEM);
+					}
+				}
+				else if(op == 4 && e.present && e.sequence > 0) {
+					int result = routes_.update(address(100 + t), address(e.via), e.sequence - 1, 100);
+					CHECK(result == Routes::ERR_STALE);
+				}
+				else if(op == 5 && e.present) {
+					// a No-Path from another branch, then from the current one
+					int result = routes_.update(address(100 + t), address(e.via + 1), e.sequence, 0);
+					CHECK(result == Routes::ERR_STALE);
+					result = routes_.update(address(100 + t), address(e.via), e.sequence, 0);
+					CHECK(result == Routes::SUCCESS);
+					e.present = false;
+				}
+				else if(op == 6) {
+					bool removed = routes_.remove(address(100 + t));
+					CHECK(removed == e.present);
+					e.present = false;
+				}
+				else {
+					routes_.tick();
+					now_++;
+					for(int i = 0; i < TARGETS; i++) {
+						if(expected_[i].present && expected_[i].expires == now_) { expected_[i].present = false; }
+					}
+				}
+
+				check_routes();
+			}
+		}
+
+	private:
+		struct Expected {
+			bool present;
+			uint8_t via;
+			uint8_t sequence;
+			uint32_t expires;
+		};
+
+		/// Global address of the DODAG, the interface identifier ends with n
+		Address address(int n) {
+			uint8_t bytes[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0x02, 0, 0, 0xff, 0xfe, 0, 0, 0 };
+			bytes[14] = n >> 8;
+			bytes[15] = n & 0xFF;
+			Address a;
+			a.set_address(bytes);
+			return a;
+		}
+
+		/// Whether a DAO with sequence b is accepted for a route stored with sequence a
+		bool accepted(uint8_t a, uint8_t b) {
+			routes_.init(address(1), true);
+			routes_.update(address(10), address(2), a, 100);
+			return routes_.update(address(10), address(3), b, 100) == Routes::SUCCESS;
+		}
+
+		void tick(int ticks) {
+			for(int i = 0; i < ticks; i++) {
+				routes_.tick();
+			}
+		}
+
+		int expected_size() {
+			int n = 0;
+			for(int t = 0; t < TARGETS; t++) {
+				if(expected_[t].present) { n++; }
+			}
+			return n;
+		}
+
+		void check_routes() {
+			CHECK(routes_.size() == expected_size());
+			for(int t = 0; t < TARGETS; t++) {
+				Address hop;
+				bool found = routes_.next_hop(address(100 + t), hop);
+				CHECK(found == expected_[t].present);
+				if(found && expected_[t].present) {
+					CHECK(hop == address(expected_[t].via));
+				}
+			}
+		}
+
+		Routes routes_;
+		Expected expected_[TARGETS];
+		uint32_t now_;
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
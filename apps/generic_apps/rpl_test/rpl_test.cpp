@@ -18,7 +18,7 @@ typedef Os::Uart Uart;
 
 typedef wiselib::IPv6Address<Radio, Os::Debug> IPv6Address_t;
 typedef wiselib::UDPSocket<IPv6Address_t> UDPSocket_t;
-typedef wiselib::IPv6Stack<Os, Radio, Os::Debug, Os::Timer, Uart/*, Os::Clock*/> IPv6_stack_t;
+typedef wiselib::IPv6Stack<Os, Radio, Os::Debug, Os::Timer, Uart, Os::Clock> IPv6_stack_t;
 
 class RPLTest
 {
@@ -35,10 +35,10 @@ public:
 		timer_ = &wiselib::FacetProvider<Os, Os::Timer>::get_facet( value );
 		debug_ = &wiselib::FacetProvider<Os, Os::Debug>::get_facet( value );
 		uart_ = &wiselib::FacetProvider<Os, Uart>::get_facet( value );
-		//clock_ = &wiselib::FacetProvider<Os, Os::Clock>::get_facet( value );
+		clock_ = &wiselib::FacetProvider<Os, Os::Clock>::get_facet( value );
 		debug_->debug( "Booting with ID: %x\n", radio_->id());
 		
-		ipv6_stack_.init(*radio_, *debug_, *timer_, *uart_/*, *clock_*/);
+		ipv6_stack_.init(*radio_, *debug_, *timer_, *uart_, *clock_);
 
 		send_count = 0;
 
@@ -222,7 +222,7 @@ private:
 	Os::Timer::self_pointer_t timer_;
 	Os::Debug::self_pointer_t debug_;
 	Uart::self_pointer_t uart_;
-	//Os::Clock::self_pointer_t clock_;
+	Os::Clock::self_pointer_t clock_;
 
    
 };
@@ -0,0 +1,335 @@
+/*
+ * Behaviour checks for the Trickle engine
+ * (algorithms/protocols/trickle/trickle_timer.h) on a fake timer and clock:
+ * the transmission point and the doubling of every interval, suppression,
+ * resets, several instances on one timer and callbacks that change the
+ * instances while the engine dispatches.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+
+#include "../unit_test.h"
+
+#include <algorithms/protocols/trickle/trickle_timer.h>
+#include <algorithms/rand/kiss.h>
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			INSTANCES = 3,
+			RUNS = 50
+		};
+
+		typedef FakeTimer<Os> Timer;
+		typedef FakeClock<Os, Timer> Clock;
+		typedef Kiss<Os> Rand;
+		typedef TrickleTimer<Os, Timer, Clock, Rand, INSTANCES> Trickle;
+		typedef Timer::millis_t millis_t;
+
+		/// What the callbacks of an instance expect and do
+		struct Probe {
+			int id;
+			millis_t imin;
+			millis_t imax;
+			::uint32_t start;
+			millis_t i;
+			bool transmitted;
+			int transmits;
+			int ends;
+			/// Instances changed from the transmit callback
+			Probe* reset_on_transmit;
+			Probe* start_on_transmit;
+			bool stop_on_interval;
+		};
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+			clock_.init(timer_);
+			rand_.srand(7);
+
+			test_intervals();
+			test_suppression();
+			test_inconsistent();
+			test_stale_timer();
+			test_instances();
+			test_reentrancy();
+			test_destruct();
+
+			finish("trickle_timer_test");
+		}
+
+		/// t in [I/2, I), the interval doubles up to Imax
+		void test_intervals() {
+			for(int run = 0; run < RUNS; run++) {
+				reset();
+				millis_t imin = 50 + next_random() % 200;
+				::uint8_t doublings = next_random() % 5;
+				Probe& p = add(0, imin, doublings, 0);
+				start(p);
+
+				millis_t end = timer_.now() + (imin << doublings) * 6;
+				while(timer_.now() < end) {
+					timer_.advance(1 + next_random() % imin);
+					// one timer for the instance, nothing stale
+					CHECK(timer_.pending() == 1);
+				}
+				CHECK(trickle_.interval(p.id) == p.imax);
+				CHECK(p.ends >= doublings + 3);
+				CHECK(p.transmits == p.ends || p.transmits == p.ends + 1);
+			}
+		}
+
+		/// No transmission when c >= k, k == 0 never suppresses
+		void test_suppression() {
+			reset();
+			Probe& p = add(0, 100, 0, 2);
+			start(p);
+
+			// t is at 50 at the earliest
+			timer_.advance(40);
+			trickle_.consistent(p.id);
+			trickle_.consistent(p.id);
+			CHECK(trickle_.counter(p.id) == 2);
+			timer_.advance(60);
+			CHECK(p.ends == 1 && p.transmits == 0);
+			CHECK(trickle_.counter(p.id) == 0);
+
+			timer_.advance(40);
+			trickle_.consistent(p.id);
+			timer_.advance(60);
+			CHECK(p.ends == 2 && p.transmits == 1);
+
+			trickle_.set_parameters(p.id, 100, 0, 0);
+			timer_.advance(40);
+			for(int i = 0; i < 5; i++) {
+				trickle_.consistent(p.id);
+			}
+			timer_.advance(60);
+			CHECK(p.ends == 3 && p.transmits == 2);
+		}
+
+		void test_inconsistent() {
+			reset();
+			Probe& p = add(0, 100, 3, 0);
+			start(p);
+
+			// nothing to do at Imin
+			millis_t point = trickle_.transmission_point(p.id);
+			int pending = timer_.pending();
+			inconsistent(p);
+			CHECK(trickle_.transmission_point(p.id) == point);
+			CHECK(p.start == timer_.now());
+			CHECK(timer_.pending() == pending);
+
+			timer_.advance(100 + 200 + 10);
+			CHECK(trickle_.interval(p.id) == 400);
+			inconsistent(p);
+			CHECK(trickle_.interval(p.id) == 100);
+			int ends = p.ends;
+			timer_.advance(100);
+			CHECK(p.ends == ends + 1);
+
+			// a stopped instance keeps quiet and starts again at Imin
+			timer_.advance(200);
+			trickle_.stop(p.id);
+			CHECK(!trickle_.running(p.id));
+			ends = p.ends;
+			int transmits = p.transmits;
+			timer_.advance(2000);
+			CHECK(p.ends == ends && p.transmits == transmits);
+			CHECK(trickle_.interval(p.id) == 400);
+			inconsistent(p);
+			CHECK(trickle_.interval(p.id) == 100);
+			start(p);
+			timer_.advance(100);
+			CHECK(p.ends == ends + 1 && p.transmits == transmits + 1);
+		}
+
+		/// The timer armed before a reset is ignored when it fires
+		void test_stale_timer() {
+			reset();
+			Probe& p = add(0, 100, 3, 0);
+			start(p);
+			timer_.advance(100 + 200 + 1);
+			CHECK(trickle_.interval(p.id) == 400);
+
+			::uint32_t old_deadline = p.start + trickle_.transmission_point(p.id);
+			inconsistent(p);
+			CHECK(timer_.pending() == 2);
+			timer_.advance(old_deadline - timer_.now());
+			// a stale timer that was served would have armed a second one
+			CHECK(timer_.pending() == 1);
+			CHECK(p.transmits == p.ends || p.transmits == p.ends + 1);
+		}
+
+		/// Random resets of several instances sharing the timer
+		void test_instances() {
+			reset();
+			millis_t imins[INSTANCES] = { 60, 150, 400 };
+			int set_count = timer_.set_count();
+			for(int i = 0; i < INSTANCES; i++) {
+				start(add(i, imins[i], 2, 0));
+			}
+			// the later deadlines reuse the timer armed for the first one
+			CHECK(timer_.set_count() == set_count + 1);
+
+			for(int step = 0; step < 2000; step++) {
+				timer_.advance(1 + next_random() % 100);
+				if(next_random() % 10 == 0) {
+					Probe& p = probes_[next_random() % INSTANCES];
+					// the others keep their intervals and transmission points
+					Probe& other = probes_[(p.id + 1) % INSTANCES];
+					::uint32_t other_start = other.start;
+					millis_t other_point = trickle_.transmission_point(other.id);
+					inconsistent(p);
+					CHECK(other.start == other_start);
+					CHECK(trickle_.transmission_point(other.id) == other_point);
+				}
+			}
+			for(int i = 0; i < INSTANCES; i++) {
+				CHECK(probes_[i].ends > 0);
+			}
+		}
+
+		/// Callbacks start, reset and stop instances while the engine dispatches
+		void test_reentrancy() {
+			reset();
+			Probe& a = add(0, 100, 4, 0);
+			Probe& b = add(1, 100, 4, 0);
+			// c transmits before b after the callback below
+			Probe& c = add(2, 60, 0, 0);
+			start(a);
+			start(b);
+			timer_.advance(100 + 200 + 400 + 1);
+			CHECK(trickle_.interval(b.id) == 800);
+
+			a.reset_on_transmit = &b;
+			a.start_on_transmit = &c;
+			int transmits = a.transmits;
+			int set_count = timer_.set_count();
+			for(int ms = 0; ms < 1600 && a.transmits == transmits; ms++) {
+				set_count = timer_.set_count();
+				timer_.advance(1);
+			}
+			CHECK(a.transmits == transmits + 1);
+			CHECK(trickle_.running(c.id));
+			CHECK(trickle_.interval(b.id) == 100);
+			// one timer for all of them, armed when the dispatching ended
+			CHECK(timer_.set_count() == set_count + 1);
+			CHECK(timer_.pending() == 1);
+			a.reset_on_transmit = 0;
+			a.start_on_transmit = 0;
+
+			int b_ends = b.ends;
+			int c_ends = c.ends;
+			timer_.advance(100);
+			CHECK(b.ends == b_ends + 1 && c.ends >= c_ends + 1);
+
+			a.stop_on_interval = true;
+			timer_.advance(1600);
+			CHECK(!trickle_.running(a.id));
+			int a_ends = a.ends;
+			timer_.advance(3200);
+			CHECK(a.ends == a_ends);
+			CHECK(trickle_.running(b.id) && trickle_.running(c.id));
+		}
+
+		/// The timer that is out after destruct() fires into the void
+		void test_destruct() {
+			reset();
+			Probe& p = add(0, 100, 0, 0);
+			start(p);
+			trickle_.destruct();
+			timer_.advance(1000);
+			CHECK(p.transmits == 0 && p.ends == 0);
+			CHECK(timer_.pending() == 0);
+		}
+
+		void on_transmit(void* userdata) {
+			Probe& p = *(Probe*)userdata;
+			::uint32_t elapsed = timer_.now() - p.start;
+			CHECK(!p.transmitted);
+			CHECK(elapsed >= p.i / 2 && elapsed < p.i);
+			CHECK(elapsed == trickle_.transmission_point(p.id));
+			p.transmitted = true;
+			p.transmits++;
+
+			if(p.reset_on_transmit) { inconsistent(*p.reset_on_transmit); }
+			if(p.start_on_transmit) { start(*p.start_on_transmit); }
+		}
+
+		void on_interval(void* userdata) {
+			Probe& p = *(Probe*)userdata;
+			CHECK(timer_.now() == p.start + p.i);
+			millis_t expected = (2 * p.i > p.imax) ? p.imax : 2 * p.i;
+			CHECK(trickle_.interval(p.id) == expected);
+			p.start = timer_.now();
+			p.i = expected;
+			p.transmitted = false;
+			p.ends++;
+
+			if(p.stop_on_interval) { trickle_.stop(p.id); }
+		}
+
+	private:
+		/// A fresh engine, the timers of the previous one have fired
+		void reset() {
+			trickle_.destruct();
+			timer_.advance(100000);
+			trickle_.init(timer_, clock_, rand_);
+		}
+
+		Probe& add(int slot, millis_t imin, ::uint8_t doublings, ::uint8_t k) {
+			Probe& p = probes_[slot];
+			p.id = trickle_.add<App, &App::on_transmit, &App::on_interval>(imin, doublings, k, this, &p);
+			CHECK(p.id == slot);
+			p.imin = imin;
+			p.imax = imin << doublings;
+			p.i = imin;
+			p.transmits = 0;
+			p.ends = 0;
+			p.reset_on_transmit = 0;
+			p.start_on_transmit = 0;
+			p.stop_on_interval = false;
+			return p;
+		}
+
+		void start(Probe& p) {
+			bool was_running = trickle_.running(p.id);
+			trickle_.start(p.id);
+			if(!was_running) { begin(p); }
+		}
+
+		/// A running instance which is not at Imin starts a new interval
+		void inconsistent(Probe& p) {
+			bool restarts = trickle_.running(p.id) && trickle_.interval(p.id) != p.imin;
+			trickle_.inconsistent(p.id);
+			if(restarts) { begin(p); }
+			else { p.i = trickle_.interval(p.id); }
+		}
+
+		void begin(Probe& p) {
+			p.start = timer_.now();
+			p.i = trickle_.interval(p.id);
+			p.transmitted = false;
+		}
+
+		Timer timer_;
+		Clock clock_;
+		Rand rand_;
+		Trickle trickle_;
+		Probe probes_[INSTANCES];
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
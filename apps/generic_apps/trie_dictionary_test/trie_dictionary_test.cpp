@@ -0,0 +1,208 @@
+/*
+ * Behaviour checks for the trie dictionary (util/tuple_store/trie_dictionary.h)
+ * against a small reference table.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+typedef Os::block_data_t block_data_t;
+typedef Os::size_t size_type;
+
+#include "../unit_test.h"
+
+#include <util/tuple_store/trie_dictionary.h>
+
+typedef TrieDictionary<Os> Dictionary;
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			VALUES = 64,
+			MAX_VALUE_LENGTH = 640,
+			CHURN_STEPS = 20000
+		};
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			make_values();
+			test_fixed();
+			test_churn();
+
+			finish("trie_dictionary_test");
+		}
+
+		/**
+		 * Values that share prefixes, are prefixes of each other and have
+		 * labels longer than a single node can hold.
+		 */
+		void make_values() {
+			const char *prefixes[] = {
+				"<http://example.org/", "<http://example.org/a/",
+				"<http://www.w3.org/1999/02/22-rdf-syntax-ns#", "\"", "<http://x/"
+			};
+			for(int i = 0; i < VALUES; i++) {
+				strcpy(values_[i], prefixes[i % 5]);
+				size_type l = strlen(values_[i]);
+				size_type extra = (i % 9 == 0) ? 300 + i : i % 7;
+				for(size_type j = 0; j < extra; j++) {
+					values_[i][l++] = 'a' + (i * 7 + j * (i % 3 + 1)) % 4;
+				}
+				values_[i][l] = '\0';
+			}
+			// exact duplicates are handled by the reference counts
+			strcpy(values_[VALUES - 1], values_[VALUES - 2]);
+		}
+
+		void test_fixed() {
+			Dictionary d;
+			d.init();
+
+			const char *words[] = {
+				"<http://a/", "<http://a/b", "<http://a/bc", "<http://a/bd", "<http://ab", "x", 0
+			};
+			Dictionary::key_type keys[6];
+			for(int i = 0; words[i]; i++) {
+				keys[i] = d.insert((block_data_t*)words[i]);
+				CHECK(keys[i] != Dictionary::NULL_KEY);
+			}
+			CHECK(d.size() == 6);
+
+			// keys stay valid while the trie is split around them
+			for(int i = 0; words[i]; i++) {
+				CHECK(d.find((block_data_t*)words[i]) == keys[i]);
+				CHECK(value_is(d, keys[i], words[i]));
+				CHECK(d.count(keys[i]) == 1);
+			}
+			CHECK(d.find((block_data_t*)"<http://a") == Dictionary::NULL_KEY);
+			CHECK(d.find((block_data_t*)"<http://a/bcd") == Dictionary::NULL_KEY);
+			CHECK(d.find((block_data_t*)"y") == Dictionary::NULL_KEY);
+
+			// inserting again counts references
+			CHECK(d.insert((block_data_t*)"<http://a/b") == keys[1]);
+			CHECK(d.count(keys[1]) == 2);
+			CHECK(d.size() == 6);
+			CHECK(d.erase(keys[1]) == 1);
+			CHECK(d.find((block_data_t*)"<http://a/b") == keys[1]);
+
+			// erasing an inner value keeps the values below it
+			d.erase(keys[1]);
+			CHECK(d.find((block_data_t*)"<http://a/b") == Dictionary::NULL_KEY);
+			CHECK(d.find((block_data_t*)"<http://a/bc") == keys[2]);
+			CHECK(d.find((block_data_t*)"<http://a/bd") == keys[3]);
+			CHECK(d.size() == 5);
+
+			// erasing a leaf merges its parent, the others keep their keys
+			d.erase(keys[3]);
+			CHECK(d.find((block_data_t*)"<http://a/bc") == keys[2]);
+			CHECK(value_is(d, keys[2], "<http://a/bc"));
+			CHECK(d.size() == 4);
+
+			check_iteration(d);
+			d.destruct();
+		}
+
+		void test_churn() {
+			Dictionary d;
+			d.init();
+
+			int refs[VALUES];
+			Dictionary::key_type keys[VALUES];
+			for(int i = 0; i < VALUES; i++) {
+				refs[i] = 0;
+				keys[i] = Dictionary::NULL_KEY;
+			}
+
+			for(int step = 0; step < CHURN_STEPS; step++) {
+				int i = next_random() % VALUES;
+				// the same string under two indices shares the key
+				int same = find_same(i, refs);
+
+				if(next_random() % 3) {
+					Dictionary::key_type k = d.insert((block_data_t*)values_[i]);
+					if(same >= 0) { CHECK(k == keys[same]); }
+					else if(refs[i]) { CHECK(k == keys[i]); }
+					keys[i] = k;
+					refs[i]++;
+				}
+				else if(refs[i]) {
+					CHECK(d.find((block_data_t*)values_[i]) == keys[i]);
+					d.erase(keys[i]);
+					refs[i]--;
+				}
+				else if(same < 0) {
+					CHECK(d.find((block_data_t*)values_[i]) == Dictionary::NULL_KEY);
+				}
+
+				if(step % 1000 == 0) {
+					size_type distinct = 0;
+					for(int j = 0; j < VALUES; j++) {
+						if(!refs[j]) { continue; }
+						if(find_same(j, refs) < 0 || find_same(j, refs) > j) { distinct++; }
+						int total = refs[j];
+						int other = find_same(j, refs);
+						if(other >= 0) { total += refs[other]; }
+						CHECK(d.count(keys[j]) == (size_type)total);
+						CHECK(value_is(d, keys[j], values_[j]));
+					}
+					CHECK(d.size() == distinct);
+					check_iteration(d);
+				}
+			}
+
+			for(int i = 0; i < VALUES; i++) {
+				while(refs[i]--) { d.erase(keys[i]); }
+			}
+			CHECK(d.size() == 0);
+			CHECK(d.begin_keys() == d.end_keys());
+			d.destruct();
+		}
+
+	private:
+		/// The iteration visits every value once, in byte-wise order
+		void check_iteration(Dictionary& d) {
+			size_type n = 0;
+			block_data_t *last = 0;
+			for(Dictionary::iterator it = d.begin_keys(); it != d.end_keys(); ++it) {
+				block_data_t *v = d.get_value(*it);
+				CHECK(d.find(v) == *it);
+				if(last) {
+					CHECK(strcmp((char*)last, (char*)v) < 0);
+					d.free_value(last);
+				}
+				last = v;
+				n++;
+			}
+			if(last) { d.free_value(last); }
+			CHECK(n == d.size());
+		}
+
+		bool value_is(Dictionary& d, Dictionary::key_type k, const char* expected) {
+			block_data_t *v = d.get_value(k);
+			bool r = strcmp((char*)v, expected) == 0;
+			d.free_value(v);
+			return r;
+		}
+
+		/// Another index with the same string that is in the dictionary, or -1
+		int find_same(int i, int* refs) {
+			for(int j = 0; j < VALUES; j++) {
+				if(j != i && refs[j] && strcmp(values_[i], values_[j]) == 0) { return j; }
+			}
+			return -1;
+		}
+
+		char values_[VALUES][MAX_VALUE_LENGTH];
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
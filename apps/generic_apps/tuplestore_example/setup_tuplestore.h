@@ -175,6 +175,12 @@ class Tuple {
 	 * 		Dictionary implementation based on a PATRICIA Trie (aka Radix Trie),
 	 * 		This stores common prefixes only once, useful if tuple elements
 	 * 		exhibit common prefixes, e.g. because they are URIs.
+	 * 		
+	 * TrieDictionary:
+	 * 		Byte-wise compressed trie with sorted child arrays. Like
+	 * 		PrescillaDictionary it stores shared prefixes only once, but
+	 * 		lookup walks bytes rather than bits and keys stay valid when
+	 * 		the trie is split or merged.
 	 */
 	#include <util/pstl/unbalanced_tree_dictionary.h>
 	typedef UnbalancedTreeDictionary<Os> Dictionary;
@@ -182,6 +188,9 @@ class Tuple {
 	//#include <util/tuple_store/prescilla_dictionary.h>
 	//typedef PrescillaDictionary<Os> Dictionary;
 
+	//#include <util/tuple_store/trie_dictionary.h>
+	//typedef TrieDictionary<Os> Dictionary;
+
 	
 #else
 	// ---- TupleStore instantiation on BLOCK MEMORY
@@ -255,6 +264,16 @@ typedef TupleStore<
 // Don't use a codec
 //typedef TupleStoreT CodecTupleStoreT;
 
+// Use shared-prefix codec (call PrefixCodec<Os>::learn() on some sample URIs
+// before inserting the first tuple)
+//#include <algorithms/codecs/prefix_codec.h>
+//#include <util/tuple_store/codec_tuplestore.h>
+//typedef CodecTupleStore<
+		//Os, TupleStoreT,
+		//PrefixCodec<Os> /* use this codec */,
+		//BIN(111) /* Use codec on these columns */
+	//> CodecTupleStoreT;
+
 // Use Huffman codec
 #include <algorithms/codecs/huffman_codec.h>
 #include <util/tuple_store/codec_tuplestore.h>
@@ -0,0 +1,157 @@
+/*
+ * Harness shared by the *_test apps. An app derives from UnitTest, calls
+ * init_test() first, checks with CHECK() and ends with finish(), which
+ * prints the number of checks and failures. Every failed check is printed
+ * with its line, on PC the exit status is the number of failed checks.
+ * FakeTimer stands in for the timer facet of algorithms that set timers,
+ * FakeClock for the clock facet of algorithms that read the time.
+ */
+
+#ifndef GENERIC_APPS_UNIT_TEST_H
+#define GENERIC_APPS_UNIT_TEST_H
+
+#include <external_interface/external_interface.h>
+#include "util/delegates/delegate.hpp"
+
+#include <string.h>
+#include <stdlib.h>
+
+#define CHECK(X) check((X), #X, __LINE__)
+
+namespace wiselib {
+
+	template<typename OsModel_P>
+	class UnitTest {
+		public:
+			typedef OsModel_P Os;
+
+			void init_test(typename Os::AppMainParameter& amp, ::uint32_t seed = 42) {
+				debug_ = &wiselib::FacetProvider<Os, typename Os::Debug>::get_facet(amp);
+				checks_ = 0;
+				failed_ = 0;
+				seed_ = seed;
+			}
+
+			void check(bool ok, const char* what, int line) {
+				checks_++;
+				if(!ok) {
+					failed_++;
+					debug_->debug("FAILED line %d: %s", line, what);
+				}
+			}
+
+			void finish(const char* name) {
+				debug_->debug("%s: %d checks, %d failed", name, checks_, failed_);
+				#ifdef PC
+					exit(failed_);
+				#endif
+			}
+
+			/// Deterministic pseudo random numbers in [0, 0x7fff]
+			::uint32_t next_random() {
+				seed_ = seed_ * 1103515245UL + 12345UL;
+				return (seed_ >> 16) & 0x7fff;
+			}
+
+		protected:
+			typename Os::Debug::self_pointer_t debug_;
+
+		private:
+			::uint32_t seed_;
+			int checks_;
+			int failed_;
+	};
+
+	/**
+	 * Timer facet with a manual clock: set_timer() only records the callback,
+	 * advance() moves the time forward and runs the callbacks that became
+	 * due, earliest first. Callbacks may set new timers.
+	 */
+	template<typename OsModel_P, int SIZE_P = 32>
+	class FakeTimer {
+		public:
+			typedef OsModel_P OsModel;
+			typedef FakeTimer<OsModel_P, SIZE_P> self_type;
+			typedef self_type* self_pointer_t;
+			typedef ::uint32_t millis_t;
+			typedef delegate1<void, void*> timer_delegate_t;
+
+			enum ErrorCodes {
+				SUCCESS = OsModel::SUCCESS,
+				ERR_UNSPEC = OsModel::ERR_UNSPEC
+			};
+
+			FakeTimer() : now_(0), size_(0), set_count_(0) { }
+
+			template<typename T, void (T::*TMethod)(void*)>
+			int set_timer(millis_t millis, T* obj, void* userdata) {
+				if(size_ == SIZE_P) { return ERR_UNSPEC; }
+				timers_[size_].due = now_ + millis;
+				timers_[size_].callback = timer_delegate_t::template from_method<T, TMethod>(obj);
+				timers_[size_].userdata = userdata;
+				size_++;
+				set_count_++;
+				return SUCCESS;
+			}
+
+			void advance(millis_t millis) {
+				millis_t end = now_ + millis;
+				while(true) {
+					int next = -1;
+					for(int i = 0; i < size_; i++) {
+						if(timers_[i].due <= end && (next < 0 || timers_[i].due < timers_[next].due)) { next = i; }
+					}
+					if(next < 0) { break; }
+
+					Entry e = timers_[next];
+					timers_[next] = timers_[--size_];
+					now_ = e.due;
+					e.callback(e.userdata);
+				}
+				now_ = end;
+			}
+
+			millis_t now() { return now_; }
+			int pending() { return size_; }
+			/// Number of timers set so far
+			int set_count() { return set_count_; }
+
+		private:
+			struct Entry {
+				millis_t due;
+				timer_delegate_t callback;
+				void* userdata;
+			};
+
+			millis_t now_;
+			Entry timers_[SIZE_P];
+			int size_;
+			int set_count_;
+	};
+
+	/**
+	 * Clock facet reading the time of a FakeTimer, time_t counts ms.
+	 */
+	template<typename OsModel_P, typename Timer_P>
+	class FakeClock {
+		public:
+			typedef OsModel_P OsModel;
+			typedef FakeClock<OsModel_P, Timer_P> self_type;
+			typedef self_type* self_pointer_t;
+			typedef ::uint32_t time_t;
+
+			FakeClock() : timer_(0) { }
+
+			void init(Timer_P& timer) { timer_ = &timer; }
+
+			time_t time() { return timer_->now(); }
+			::uint32_t seconds(time_t t) { return t / 1000; }
+			::uint16_t milliseconds(time_t t) { return t % 1000; }
+
+		private:
+			Timer_P* timer_;
+	};
+
+}
+
+#endif // GENERIC_APPS_UNIT_TEST_H
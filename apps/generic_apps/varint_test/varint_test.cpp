@@ -0,0 +1,315 @@
+/*
+ * Behaviour checks for the protobuf varint coding (util/protobuf/varint.h)
+ * and the in-place field reader (util/protobuf/field_reader.h). Known
+ * encodings, round trips through the fast and the checked path, truncated and
+ * malformed input.
+ */
+
+#include <external_interface/external_interface.h>
+using namespace wiselib;
+typedef OSMODEL Os;
+#include "util/allocators/malloc_free_allocator.h"
+typedef MallocFreeAllocator<Os> Allocator;
+Allocator& get_allocator();
+typedef Os::block_data_t block_data_t;
+
+#include "../unit_test.h"
+
+#include <util/protobuf/varint.h>
+#include <util/protobuf/message.h>
+#include <util/protobuf/field_reader.h>
+
+typedef block_data_t* buffer_t;
+typedef protobuf::VarInt<Os, buffer_t, uint32_t> VarInt32;
+typedef protobuf::VarInt<Os, buffer_t, uint64_t> VarInt64;
+typedef protobuf::VarIntChecked<Os, buffer_t, uint32_t> Checked32;
+typedef protobuf::VarIntChecked<Os, buffer_t, uint64_t> Checked64;
+typedef protobuf::Message<Os, buffer_t, uint32_t> Message32;
+typedef protobuf::FieldReader<Os> Reader;
+
+class App : public UnitTest<Os> {
+	public:
+		enum {
+			ROUND_TRIPS = 20000,
+			BUFFER_SIZE = 64,
+			PACKED = 100
+		};
+
+		void init(Os::AppMainParameter& amp) {
+			init_test(amp);
+
+			test_known();
+			test_round_trip();
+			test_truncated();
+			test_malformed();
+			test_packed();
+			test_field_reader();
+
+			finish("varint_test");
+		}
+
+		void test_known() {
+			const block_data_t e0[] = { 0x00 };
+			const block_data_t e1[] = { 0x01 };
+			const block_data_t e127[] = { 0x7f };
+			const block_data_t e128[] = { 0x80, 0x01 };
+			const block_data_t e300[] = { 0xac, 0x02 };
+			const block_data_t e16384[] = { 0x80, 0x80, 0x01 };
+			const block_data_t emax32[] = { 0xff, 0xff, 0xff, 0xff, 0x0f };
+			const block_data_t emax64[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 };
+
+			CHECK(encodes_32(0, e0, sizeof(e0)));
+			CHECK(encodes_32(1, e1, sizeof(e1)));
+			CHECK(encodes_32(127, e127, sizeof(e127)));
+			CHECK(encodes_32(128, e128, sizeof(e128)));
+			CHECK(encodes_32(300, e300, sizeof(e300)));
+			CHECK(encodes_32(16384, e16384, sizeof(e16384)));
+			CHECK(encodes_32(0xffffffffUL, emax32, sizeof(emax32)));
+			CHECK(encodes_64(0xffffffffffffffffULL, emax64, sizeof(emax64)));
+
+			// 64 bit values keep their upper half
+			const block_data_t e2_32[] = { 0x80, 0x80, 0x80, 0x80, 0x10 };
+			CHECK(encodes_64(0x100000000ULL, e2_32, sizeof(e2_32)));
+		}
+
+		/// Fast and checked path agree on the bytes and the values
+		void test_round_trip() {
+			for(int i = 0; i < ROUND_TRIPS; i++) {
+				uint64_t v = random_value();
+				block_data_t fast[BUFFER_SIZE], checked[BUFFER_SIZE];
+				buffer_t p = fast, p_end = fast + BUFFER_SIZE;
+				buffer_t q = checked, q_end = checked + BUFFER_SIZE;
+
+				CHECK(VarInt64::write(p, p_end, v));
+				CHECK(Checked64::write(q, q_end, v));
+				CHECK(p - fast == q - checked);
+				CHECK((size_t)(p - fast) == VarInt64::size(v));
+				CHECK(memcmp(fast, checked, p - fast) == 0);
+
+				uint64_t out = 0, out_checked = 0;
+				buffer_t r = fast, r_end = fast + BUFFER_SIZE;
+				CHECK(VarInt64::read(r, r_end, out) && out == v && r == p);
+				r = fast;
+				r_end = p;
+				CHECK(Checked64::read(r, r_end, out_checked) && out_checked == v && r == p);
+
+				// the same bytes with exactly the value's length behind them
+				r = fast;
+				CHECK(VarInt64::read(r, r_end, out) && out == v && r == p);
+
+				uint32_t v32 = (uint32_t)v;
+				uint32_t out32 = 0;
+				p = fast;
+				p_end = fast + BUFFER_SIZE;
+				CHECK(VarInt32::write(p, p_end, v32));
+				CHECK((size_t)(p - fast) == VarInt32::size(v32));
+				r = fast;
+				r_end = fast + BUFFER_SIZE;
+				CHECK(VarInt32::read(r, r_end, out32) && out32 == v32 && r == p);
+			}
+		}
+
+		/// Every proper prefix of an encoding fails, as does a short buffer
+		void test_truncated() {
+			for(int i = 0; i < 200; i++) {
+				uint64_t v = random_value();
+				block_data_t buf[BUFFER_SIZE];
+				buffer_t p = buf, p_end = buf + BUFFER_SIZE;
+				VarInt64::write(p, p_end, v);
+				size_t length = p - buf;
+
+				for(size_t l = 0; l < length; l++) {
+					uint64_t out;
+					buffer_t r = buf, r_end = buf + l;
+					CHECK(!VarInt64::read(r, r_end, out));
+					r = buf;
+					CHECK(!Checked64::read(r, r_end, out));
+
+					block_data_t small[BUFFER_SIZE];
+					buffer_t w = small, w_end = small + l;
+					CHECK(!VarInt64::write(w, w_end, v));
+				}
+			}
+		}
+
+		void test_malformed() {
+			// longer than ten bytes
+			block_data_t too_long[BUFFER_SIZE];
+			memset(too_long, 0x80, sizeof(too_long));
+			uint64_t out64;
+			buffer_t r = too_long, r_end = too_long + BUFFER_SIZE;
+			CHECK(!VarInt64::read(r, r_end, out64));
+			r = too_long;
+			CHECK(!Checked64::read(r, r_end, out64));
+
+			// padded with zero groups it still decodes, in the fast path too
+			block_data_t padded[BUFFER_SIZE];
+			memset(padded, 0, sizeof(padded));
+			padded[0] = 0x81;
+			padded[1] = 0x80;
+			padded[2] = 0x00;
+			uint32_t out32;
+			r = padded;
+			r_end = padded + BUFFER_SIZE;
+			CHECK(VarInt32::read(r, r_end, out32) && out32 == 1 && r == padded + 3);
+
+			// a ten byte value is read into 32 bits, the upper bits are dropped
+			block_data_t wide[BUFFER_SIZE];
+			memset(wide, 0, sizeof(wide));
+			buffer_t w = wide, w_end = wide + BUFFER_SIZE;
+			VarInt64::write(w, w_end, 0xfedcba9876543210ULL);
+			r = wide;
+			r_end = wide + BUFFER_SIZE;
+			CHECK(VarInt32::read(r, r_end, out32) && out32 == 0x76543210UL && r == w);
+			r = wide;
+			r_end = w;
+			CHECK(Checked32::read(r, r_end, out32) && out32 == 0x76543210UL && r == w);
+		}
+
+		void test_packed() {
+			uint32_t values[PACKED], out[PACKED];
+			for(int i = 0; i < PACKED; i++) {
+				values[i] = (uint32_t)random_value();
+			}
+
+			block_data_t buf[PACKED * 5 + 16];
+			buffer_t p = buf, p_end = buf + sizeof(buf);
+			CHECK(Message32::write_packed(p, p_end, 7, values, PACKED));
+			buffer_t end = p;
+
+			uint32_t field;
+			size_t count;
+			buffer_t r = buf;
+			CHECK(Message32::read_packed(r, end, field, out, PACKED, count));
+			CHECK(field == 7 && count == PACKED && r == end);
+			CHECK(memcmp(values, out, sizeof(values)) == 0);
+
+			// too many values for out
+			r = buf;
+			CHECK(!Message32::read_packed(r, end, field, out, PACKED - 1, count));
+
+			// the length runs past the buffer
+			r = buf;
+			buffer_t short_end = end - 1;
+			CHECK(!Message32::read_packed(r, short_end, field, out, PACKED, count));
+
+			// an empty field
+			p = buf;
+			CHECK(Message32::write_packed(p, p_end, 3, values, 0));
+			CHECK(p - buf == 2);
+			r = buf;
+			CHECK(Message32::read_packed(r, p, field, out, PACKED, count) && count == 0);
+		}
+
+		void test_field_reader() {
+			block_data_t buf[BUFFER_SIZE * 2];
+			buffer_t p = buf, p_end = buf + sizeof(buf);
+
+			// 1: varint 300, 2: "abc", 3: { 1: 5, 2: "x" }, 4: fixed32, 5: packed { 1, 300 }
+			VarInt32::write(p, p_end, 1 << 3 | Reader::WIRE_VARINT);
+			VarInt32::write(p, p_end, 300);
+			VarInt32::write(p, p_end, 2 << 3 | Reader::WIRE_LENGTH_DELIMITED);
+			VarInt32::write(p, p_end, 3);
+			memcpy(p, "abc", 3);
+			p += 3;
+			const block_data_t nested[] = { 1 << 3, 5, 2 << 3 | 2, 1, 'x' };
+			VarInt32::write(p, p_end, 3 << 3 | Reader::WIRE_LENGTH_DELIMITED);
+			VarInt32::write(p, p_end, sizeof(nested));
+			memcpy(p, nested, sizeof(nested));
+			p += sizeof(nested);
+			VarInt32::write(p, p_end, 4 << 3 | Reader::WIRE_FIXED32);
+			memcpy(p, "\x01\x02\x03\x04", 4);
+			p += 4;
+			VarInt32::write(p, p_end, 5 << 3 | Reader::WIRE_LENGTH_DELIMITED);
+			VarInt32::write(p, p_end, 3);
+			VarInt32::write(p, p_end, 1);
+			VarInt32::write(p, p_end, 300);
+			buffer_t end = p;
+
+			Reader reader(buf, end);
+			CHECK(reader.next() && reader.field() == 1 && reader.wire_type() == Reader::WIRE_VARINT);
+			CHECK(reader.value() == 300);
+			CHECK(reader.next() && reader.field() == 2 && reader.length() == 3);
+			CHECK(memcmp(reader.data(), "abc", 3) == 0);
+			CHECK(reader.data() > buf && reader.data() < end);
+
+			CHECK(reader.next() && reader.field() == 3);
+			Reader inner = reader.message();
+			CHECK(inner.next() && inner.field() == 1 && inner.value() == 5);
+			CHECK(inner.next() && inner.field() == 2 && inner.length() == 1 && inner.data()[0] == 'x');
+			CHECK(!inner.next() && inner.done() && !inner.error());
+
+			CHECK(reader.next() && reader.field() == 4 && reader.length() == 4);
+			CHECK(reader.data()[3] == 4);
+
+			uint32_t values[4];
+			size_t count;
+			CHECK(reader.next() && reader.field() == 5);
+			CHECK(reader.packed(values, 4, count) && count == 2 && values[0] == 1 && values[1] == 300);
+			CHECK(!reader.next() && !reader.error());
+			CHECK(reader.position() == (size_t)(end - buf));
+
+			Reader finder(buf, end);
+			CHECK(finder.find(4) && finder.length() == 4);
+			CHECK(!finder.find(1) && !finder.error());
+
+			// every truncation of the message is noticed
+			for(buffer_t cut = buf; cut < end; cut++) {
+				Reader t(buf, cut);
+				while(t.next()) { }
+				// a cut between two fields is just a shorter message
+				CHECK(t.error() || t.position() == (size_t)(cut - buf));
+			}
+			Reader t(buf, end - 1);
+			while(t.next()) { }
+			CHECK(t.error());
+
+			// groups (wire type 3) are not supported
+			const block_data_t group[] = { 1 << 3 | 3, 0 };
+			Reader g((buffer_t)group, (buffer_t)group + sizeof(group));
+			CHECK(!g.next() && g.error());
+			CHECK(!g.next());
+		}
+
+	private:
+		bool encodes_32(uint32_t v, const block_data_t* expected, size_t length) {
+			// a tight buffer takes the checked path, a large one the fast path
+			return encodes_32_in(v, expected, length, length) && encodes_32_in(v, expected, length, BUFFER_SIZE);
+		}
+
+		bool encodes_32_in(uint32_t v, const block_data_t* expected, size_t length, size_t space) {
+			block_data_t buf[BUFFER_SIZE];
+			memset(buf, 0, sizeof(buf));
+			buffer_t p = buf, p_end = buf + space;
+			if(!VarInt32::write(p, p_end, v)) { return false; }
+			if((size_t)(p - buf) != length || VarInt32::size(v) != length || memcmp(buf, expected, length) != 0) { return false; }
+			uint32_t out;
+			buffer_t r = buf, r_end = buf + space;
+			return VarInt32::read(r, r_end, out) && out == v && r == p;
+		}
+
+		bool encodes_64(uint64_t v, const block_data_t* expected, size_t length) {
+			block_data_t buf[BUFFER_SIZE];
+			buffer_t p = buf, p_end = buf + BUFFER_SIZE;
+			if(!VarInt64::write(p, p_end, v)) { return false; }
+			if((size_t)(p - buf) != length || memcmp(buf, expected, length) != 0) { return false; }
+			uint64_t out;
+			buffer_t r = buf, r_end = buf + BUFFER_SIZE;
+			return VarInt64::read(r, r_end, out) && out == v && r == p;
+		}
+
+		/// Values of every length, small ones more often
+		uint64_t random_value() {
+			uint64_t v = ((uint64_t)next_random() << 45) ^ ((uint64_t)next_random() << 30)
+				^ ((uint64_t)next_random() << 15) ^ next_random() ^ ((uint64_t)next_random() << 60);
+			return v >> (next_random() % 64);
+		}
+};
+
+App app;
+Allocator allocator_;
+Allocator& get_allocator() { return allocator_; }
+
+void application_main(Os::AppMainParameter& amp) {
+	app.init(amp);
+}
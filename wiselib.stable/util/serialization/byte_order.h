@@ -0,0 +1,123 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+#ifndef __WISELIB_UTIL_SERIALIZATION_BYTE_ORDER_H
+#define __WISELIB_UTIL_SERIALIZATION_BYTE_ORDER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+#define WISELIB_HAS_BUILTIN_BSWAP
+#endif
+
+namespace wiselib
+{
+
+   inline uint16_t byte_swap16( uint16_t value )
+   {
+      return (uint16_t)((value << 8) | (value >> 8));
+   }
+   // -----------------------------------------------------------------------
+   inline uint32_t byte_swap32( uint32_t value )
+   {
+#ifdef WISELIB_HAS_BUILTIN_BSWAP
+      return __builtin_bswap32( value );
+#else
+      return (value << 24) | ((value << 8) & 0x00ff0000UL) |
+         ((value >> 8) & 0x0000ff00UL) | (value >> 24);
+#endif
+   }
+   // -----------------------------------------------------------------------
+   inline uint64_t byte_swap64( uint64_t value )
+   {
+#ifdef WISELIB_HAS_BUILTIN_BSWAP
+      return __builtin_bswap64( value );
+#else
+      return ((uint64_t)byte_swap32( (uint32_t)value ) << 32) |
+         byte_swap32( (uint32_t)(value >> 32) );
+#endif
+   }
+   // -----------------------------------------------------------------------
+   // -----------------------------------------------------------------------
+   // -----------------------------------------------------------------------
+   /** Copies Size_P bytes from source to target in reversed order. Neither
+    *  pointer has to be aligned. The sizes of the integer types are loaded
+    *  into a register with memcpy and swapped there, other sizes are
+    *  reversed byte by byte.
+    */
+   template <int Size_P>
+   struct ReversedCopy
+   {
+      static inline void copy( void *target, const void *source )
+      {
+         const unsigned char *src = (const unsigned char*)source;
+         unsigned char *dst = (unsigned char*)target;
+         for ( int i = 0; i < Size_P; i++ )
+            dst[Size_P - 1 - i] = src[i];
+      }
+   };
+   // -----------------------------------------------------------------------
+   template <>
+   struct ReversedCopy<1>
+   {
+      static inline void copy( void *target, const void *source )
+      {
+         *(unsigned char*)target = *(const unsigned char*)source;
+      }
+   };
+   // -----------------------------------------------------------------------
+   template <>
+   struct ReversedCopy<2>
+   {
+      static inline void copy( void *target, const void *source )
+      {
+         uint16_t value;
+         memcpy( &value, source, 2 );
+         value = byte_swap16( value );
+         memcpy( target, &value, 2 );
+      }
+   };
+   // -----------------------------------------------------------------------
+   template <>
+   struct ReversedCopy<4>
+   {
+      static inline void copy( void *target, const void *source )
+      {
+         uint32_t value;
+         memcpy( &value, source, 4 );
+         value = byte_swap32( value );
+         memcpy( target, &value, 4 );
+      }
+   };
+   // -----------------------------------------------------------------------
+   template <>
+   struct ReversedCopy<8>
+   {
+      static inline void copy( void *target, const void *source )
+      {
+         uint64_t value;
+         memcpy( &value, source, 8 );
+         value = byte_swap64( value );
+         memcpy( target, &value, 8 );
+      }
+   };
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 
 #include <string.h>
 #include "util/serialization/endian.h"
+#include "util/serialization/byte_order.h"
 
 namespace wiselib
 {
@@ -41,16 +42,14 @@ namespace wiselib
       // --------------------------------------------------------------------
       static inline size_t write( BlockData *target, Type& value )
       {
-         for ( unsigned int i = 0; i < sizeof(Type); i++ )
-            target[sizeof(Type) - 1 - i] = *((BlockData*)&value + i);
+         ReversedCopy<sizeof(Type)>::copy( target, &value );
          return sizeof(Type);
       }
       // --------------------------------------------------------------------
-      static Type_P read( BlockData *target )
+      static inline Type_P read( BlockData *target )
       {
          Type value;
-         for ( unsigned int i = 0; i < sizeof(Type); i++ )
-            *((BlockData*)&value + i) = target[sizeof(Type) - 1 - i];
+         ReversedCopy<sizeof(Type)>::copy( &value, target );
          return value;
       }
 
@@ -73,16 +72,14 @@ namespace wiselib
       // --------------------------------------------------------------------
       static inline size_t write( BlockData *target, Type& value )
       {
-         for ( unsigned int i = 0; i < sizeof(Type); i++ )
-            target[i] = *((BlockData*)&value + i);
+         memcpy( target, &value, sizeof(Type) );
          return sizeof(Type);
       }
       // --------------------------------------------------------------------
-      static Type_P read( BlockData *target )
+      static inline Type_P read( BlockData *target )
       {
          Type value;
-         for ( unsigned int i = 0; i < sizeof(Type); i++ )
-            *((BlockData*)&value + i) = target[i];
+         memcpy( &value, target, sizeof(Type) );
          return value;
       }
 
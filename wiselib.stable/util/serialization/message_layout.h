@@ -0,0 +1,152 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+#ifndef __WISELIB_UTIL_SERIALIZATION_MESSAGE_LAYOUT_H
+#define __WISELIB_UTIL_SERIALIZATION_MESSAGE_LAYOUT_H
+
+#include "util/serialization/simple_types.h"
+
+namespace wiselib
+{
+
+   /** Start of a message layout. A layout is a chain of fields, each one
+    *  names the field in front of it, offsets and sizes are enum constants
+    *  and cost nothing at run time:
+    *
+    *  \code
+    *  typedef LayoutField<message_id_t> MsgIdField;
+    *  typedef LayoutField<node_id_t, MsgIdField> SourceField;
+    *  typedef LayoutArray<block_data_t, 8, SourceField> KeyField;
+    *  typedef LayoutCheck<KeyField, Radio::MAX_MESSAGE_LENGTH> Header;
+    *
+    *  node_id_t source()
+    *  { return read_field<OsModel, SourceField>( buffer ); }
+    *  \endcode
+    */
+   struct LayoutBegin
+   {
+      enum { END = 0 };
+   };
+   // -----------------------------------------------------------------------
+   /** A value of Type_P, serialized through Serialization, right behind
+    *  Prev_P.
+    */
+   template <typename Type_P,
+             typename Prev_P = LayoutBegin>
+   struct LayoutField
+   {
+      typedef Type_P Type;
+      typedef Prev_P Prev;
+
+      enum
+      {
+         OFFSET = Prev::END,
+         SIZE = sizeof(Type),
+         END = OFFSET + SIZE
+      };
+   };
+   // -----------------------------------------------------------------------
+   /** Count_P values of Type_P right behind Prev_P, read and written in one
+    *  go through ArraySerialization.
+    */
+   template <typename Type_P,
+             int Count_P,
+             typename Prev_P = LayoutBegin>
+   struct LayoutArray
+   {
+      typedef Type_P Type;
+      typedef Prev_P Prev;
+
+      enum
+      {
+         OFFSET = Prev::END,
+         COUNT = Count_P,
+         SIZE = Count_P * sizeof(Type),
+         END = OFFSET + SIZE
+      };
+   };
+   // -----------------------------------------------------------------------
+   template <bool Fits_P>
+   struct LayoutSizeCheck;
+
+   template <>
+   struct LayoutSizeCheck<true>
+   {
+      enum { OK = 1 };
+   };
+   // -----------------------------------------------------------------------
+   /** Ends a layout. Does not compile (LayoutSizeCheck<false> is
+    *  incomplete) if the fields up to Last_P do not fit in Capacity_P bytes.
+    */
+   template <typename Last_P,
+             int Capacity_P>
+   struct LayoutCheck
+   {
+      enum
+      {
+         SIZE = Last_P::END + LayoutSizeCheck<(int)Last_P::END <= Capacity_P>::OK - 1,
+         SPACE = Capacity_P - SIZE
+      };
+   };
+   // -----------------------------------------------------------------------
+   // -----------------------------------------------------------------------
+   // -----------------------------------------------------------------------
+   template<typename OsModel_P,
+            typename Field_P,
+            typename BlockData_P>
+   inline typename Field_P::Type read_field( BlockData_P *buffer )
+   {
+      return read<OsModel_P, BlockData_P, typename Field_P::Type>( buffer + Field_P::OFFSET );
+   }
+   // -----------------------------------------------------------------------
+   template<typename OsModel_P,
+            typename Field_P,
+            typename BlockData_P>
+   inline typename OsModel_P::size_t write_field( BlockData_P *buffer, typename Field_P::Type value )
+   {
+      return write<OsModel_P, BlockData_P, typename Field_P::Type>( buffer + Field_P::OFFSET, value );
+   }
+   // -----------------------------------------------------------------------
+   /** Pointer to the bytes of a field, e.g. for raw data or a payload.
+    */
+   template<typename Field_P,
+            typename BlockData_P>
+   inline BlockData_P* field_data( BlockData_P *buffer )
+   {
+      return buffer + Field_P::OFFSET;
+   }
+   // -----------------------------------------------------------------------
+   template<typename OsModel_P,
+            typename Field_P,
+            typename BlockData_P>
+   inline void read_field_array( BlockData_P *buffer, typename Field_P::Type *values )
+   {
+      read_array<OsModel_P, BlockData_P, typename Field_P::Type>( buffer + Field_P::OFFSET, values, Field_P::COUNT );
+   }
+   // -----------------------------------------------------------------------
+   template<typename OsModel_P,
+            typename Field_P,
+            typename BlockData_P>
+   inline void write_field_array( BlockData_P *buffer, typename Field_P::Type *values )
+   {
+      write_array<OsModel_P, BlockData_P, typename Field_P::Type>( buffer + Field_P::OFFSET, values, Field_P::COUNT );
+   }
+
+}
+
+#endif
@@ -19,13 +19,16 @@
 #ifndef __WISELIB_UTIL_SERIALIZATION_SERIALIZATION_H
 #define __WISELIB_UTIL_SERIALIZATION_SERIALIZATION_H
 
+#include <string.h>
 #include "util/serialization/endian.h"
+#include "util/serialization/byte_order.h"
 
 namespace wiselib
 {
 
    /** Following implementation assumes "Little Endian". A specialization for
-    *  "Big Endian" is also available.
+    *  "Big Endian" is also available. Values are stored in big endian (network
+    *  byte order), so the bytes are reversed here.
     */
    template <typename OsModel_P,
              Endianness,
@@ -41,16 +44,14 @@ namespace wiselib
       // --------------------------------------------------------------------
       static inline size_t write( BlockData *target, Type& value )
       {
-         for ( unsigned int i = 0; i < sizeof(Type); i++ )
-            target[sizeof(Type) - 1 - i] = *((BlockData*)&value + i);
+         ReversedCopy<sizeof(Type)>::copy( target, &value );
          return sizeof(Type);
       }
       // --------------------------------------------------------------------
-      static Type read( BlockData *target )
+      static inline Type read( BlockData *target )
       {
          Type value;
-         for ( unsigned int i = 0; i < sizeof(Type); i++ )
-            *((BlockData*)&value + i) = target[sizeof(Type) - 1 - i];
+         ReversedCopy<sizeof(Type)>::copy( &value, target );
          return value;
       }
 
@@ -72,16 +73,14 @@ namespace wiselib
       // --------------------------------------------------------------------
       static inline size_t write( BlockData *target, Type& value )
       {
-         for ( unsigned int i = 0; i < sizeof(Type); i++ )
-            target[i] = *((BlockData*)&value + i);
+         memcpy( target, &value, sizeof(Type) );
          return sizeof(Type);
       }
       // --------------------------------------------------------------------
-      static Type read( BlockData *target )
+      static inline Type read( BlockData *target )
       {
          Type value;
-         for ( unsigned int i = 0; i < sizeof(Type); i++ )
-            *((BlockData*)&value + i) = target[i];
+         memcpy( &value, target, sizeof(Type) );
          return value;
       }
 
@@ -89,6 +88,98 @@ namespace wiselib
    // -----------------------------------------------------------------------
    // -----------------------------------------------------------------------
    // -----------------------------------------------------------------------
+   /** Serialization of count consecutive values, element by element through
+    *  Serialization. As in the pair serialization every value is expected to
+    *  take sizeof(Type) bytes, write and read both step by that size. Types
+    *  whose memory image equals their serialized form are specialized below
+    *  to a single memcpy.
+    */
+   template <typename OsModel_P,
+             Endianness Endianness_P,
+             typename BlockData_P,
+             typename Type_P>
+   struct ArraySerialization
+   {
+      typedef OsModel_P OsModel;
+      typedef BlockData_P BlockData;
+      typedef Type_P Type;
+      typedef Serialization<OsModel, Endianness_P, BlockData, Type> Element;
+
+      typedef typename OsModel::size_t size_t;
+      // --------------------------------------------------------------------
+      static inline size_t write( BlockData *target, Type *values, size_t count )
+      {
+         for ( size_t i = 0; i < count; i++ )
+            Element::write( target + i * sizeof(Type), values[i] );
+         return count * sizeof(Type);
+      }
+      // --------------------------------------------------------------------
+      static inline size_t read( BlockData *target, Type *values, size_t count )
+      {
+         for ( size_t i = 0; i < count; i++ )
+            values[i] = Element::read( target + i * sizeof(Type) );
+         return count * sizeof(Type);
+      }
+
+   };
+   // -----------------------------------------------------------------------
+   template <typename OsModel_P,
+             typename BlockData_P,
+             typename Type_P>
+   struct RawArraySerialization
+   {
+      typedef OsModel_P OsModel;
+      typedef BlockData_P BlockData;
+      typedef Type_P Type;
+
+      typedef typename OsModel::size_t size_t;
+      // --------------------------------------------------------------------
+      static inline size_t write( BlockData *target, Type *values, size_t count )
+      {
+         memcpy( target, values, count * sizeof(Type) );
+         return count * sizeof(Type);
+      }
+      // --------------------------------------------------------------------
+      static inline size_t read( BlockData *target, Type *values, size_t count )
+      {
+         memcpy( values, target, count * sizeof(Type) );
+         return count * sizeof(Type);
+      }
+
+   };
+   // -----------------------------------------------------------------------
+   template <typename OsModel_P, Endianness Endianness_P, typename BlockData_P>
+   struct ArraySerialization<OsModel_P, Endianness_P, BlockData_P, uint8_t>
+      : public RawArraySerialization<OsModel_P, BlockData_P, uint8_t>
+   {};
+   // -----------------------------------------------------------------------
+   template <typename OsModel_P, Endianness Endianness_P, typename BlockData_P>
+   struct ArraySerialization<OsModel_P, Endianness_P, BlockData_P, int8_t>
+      : public RawArraySerialization<OsModel_P, BlockData_P, int8_t>
+   {};
+   // -----------------------------------------------------------------------
+   template <typename OsModel_P, typename BlockData_P>
+   struct ArraySerialization<OsModel_P, WISELIB_BIG_ENDIAN, BlockData_P, uint16_t>
+      : public RawArraySerialization<OsModel_P, BlockData_P, uint16_t>
+   {};
+   // -----------------------------------------------------------------------
+   template <typename OsModel_P, typename BlockData_P>
+   struct ArraySerialization<OsModel_P, WISELIB_BIG_ENDIAN, BlockData_P, int16_t>
+      : public RawArraySerialization<OsModel_P, BlockData_P, int16_t>
+   {};
+   // -----------------------------------------------------------------------
+   template <typename OsModel_P, typename BlockData_P>
+   struct ArraySerialization<OsModel_P, WISELIB_BIG_ENDIAN, BlockData_P, uint32_t>
+      : public RawArraySerialization<OsModel_P, BlockData_P, uint32_t>
+   {};
+   // -----------------------------------------------------------------------
+   template <typename OsModel_P, typename BlockData_P>
+   struct ArraySerialization<OsModel_P, WISELIB_BIG_ENDIAN, BlockData_P, int32_t>
+      : public RawArraySerialization<OsModel_P, BlockData_P, int32_t>
+   {};
+   // -----------------------------------------------------------------------
+   // -----------------------------------------------------------------------
+   // -----------------------------------------------------------------------
    template<typename OsModel_P,
             typename BlockData_P,
             typename Type_P>
@@ -112,6 +203,28 @@ namespace wiselib
    {
       return Serialization<OsModel_P, OsModel_P::endianness, BlockData_P, Type_P>::write( target, value );
    }
+   // -----------------------------------------------------------------------
+   /** Writes count values, returns the number of bytes written.
+    */
+   template<typename OsModel_P,
+            typename BlockData_P,
+            typename Type_P>
+   inline typename OsModel_P::size_t write_array( BlockData_P *target, Type_P *values,
+                                                  typename OsModel_P::size_t count )
+   {
+      return ArraySerialization<OsModel_P, OsModel_P::endianness, BlockData_P, Type_P>::write( target, values, count );
+   }
+   // -----------------------------------------------------------------------
+   /** Reads count values, returns the number of bytes read.
+    */
+   template<typename OsModel_P,
+            typename BlockData_P,
+            typename Type_P>
+   inline typename OsModel_P::size_t read_array( BlockData_P *target, Type_P *values,
+                                                 typename OsModel_P::size_t count )
+   {
+      return ArraySerialization<OsModel_P, OsModel_P::endianness, BlockData_P, Type_P>::read( target, values, count );
+   }
 
 }
 
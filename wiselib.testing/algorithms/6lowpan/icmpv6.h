@@ -2212,6 +2212,11 @@ namespace wiselib
 		//copy 8 or 16 bytes
 		memcpy( radio_ip_->interface_manager_->radio_lowpan_->context_mgr_.contexts[CID].prefix.addr, payload + act_pos, (length - 1) * 8 );
 		
+		#if LOWPAN_FLOW_CACHE_SIZE > 0
+		//The compressed header templates could use the old context
+		radio_ip_->interface_manager_->radio_lowpan_->flow_cache_clear();
+		#endif
+		
 		#ifdef ND_DEBUG
 		debug().debug(" ND processed context information (CID:  %i ).", CID);
 		#endif
@@ -213,26 +213,34 @@ namespace wiselib
 				//Use the link-local address if no global address defined
 				if( !global_address_found )
 					ip_packet->set_source_address(prefix_list[selected_interface][0].ip_address);
+				
+				//The source address is part of the pseudo header
+				if( ip_packet->checksum_valid )
+					ip_packet->update_transport_checksum( source_ip.addr, ip_packet->buffer_ + ip_packet->SOURCE_ADDRESS_BYTE, 16 );
 			}
 			
 			/*
 				Generate checksum
+				If it is already valid (forwarded packet) it is not recalculated
 			*/
 // 			uint8_t* transport_payload = ip_packet->payload();
 			
-			if( /*((transport_payload[2] << 8 ) | transport_payload[3] ) == 0 && */ ip_packet->transport_next_header() == Radio_LoWPAN::ICMPV6 )
+			if( !(ip_packet->checksum_valid) )
 			{
-				uint16_t checksum = 0;
-				ip_packet->template set_payload<uint16_t>( &checksum, 2 );
-				checksum = ip_packet->generate_checksum();
-				ip_packet->template set_payload<uint16_t>( &checksum, 2 );
-			}
-			else if( /*((transport_payload[6] << 8 ) | transport_payload[7] ) == 0 && */ ip_packet->transport_next_header() == Radio_LoWPAN::UDP )
-			{
-				uint16_t checksum = 0;
-				ip_packet->template set_payload<uint16_t>( &checksum, 6 );
-				checksum = ip_packet->generate_checksum();
-				ip_packet->template set_payload<uint16_t>( &checksum, 6 );
+				if( /*((transport_payload[2] << 8 ) | transport_payload[3] ) == 0 && */ ip_packet->transport_next_header() == Radio_LoWPAN::ICMPV6 )
+				{
+					uint16_t checksum = 0;
+					ip_packet->template set_payload<uint16_t>( &checksum, 2 );
+					checksum = ip_packet->generate_checksum();
+					ip_packet->template set_payload<uint16_t>( &checksum, 2 );
+				}
+				else if( /*((transport_payload[6] << 8 ) | transport_payload[7] ) == 0 && */ ip_packet->transport_next_header() == Radio_LoWPAN::UDP )
+				{
+					uint16_t checksum = 0;
+					ip_packet->template set_payload<uint16_t>( &checksum, 6 );
+					checksum = ip_packet->generate_checksum();
+					ip_packet->template set_payload<uint16_t>( &checksum, 6 );
+				}
 			}
 			
 			//Send the packet to the selected interface
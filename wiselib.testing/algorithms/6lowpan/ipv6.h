@@ -33,6 +33,7 @@
 
 	#ifdef LOWPAN_ROUTE_OVER
 	#include "algorithms/6lowpan/simple_queryable_routing.h"
+	#include "algorithms/6lowpan/ipv6_pending_queue.h"
 	#endif
 	
 	//For the EH callback
@@ -42,10 +43,6 @@
 	//The max number of TLV values in the EH Hop-By-Hop
 	#define MAX_EH_HOHO_TLV 4
 
-	//Delays for the routing polling
-	#define CREATION_IN_PROGRESS_DELAY 1000
-	#define ROUTING_BUSY_DELAY 1500
-
 	namespace wiselib
 	{
 		/**
@@ -121,6 +118,9 @@
 		#endif
 
 		typedef wiselib::IPv6PacketPoolManager<OsModel, Radio, Debug> Packet_Pool_Mgr_t;
+		#ifdef LOWPAN_ROUTE_OVER
+		typedef IPv6PendingQueue<OsModel, node_id_t, Packet_Pool_Mgr_t, Debug, Timer> Pending_Queue_t;
+		#endif
 		typedef typename Packet_Pool_Mgr_t::Packet Packet;
 		
 		typedef NDStorage<Radio, Debug> NDStorage_t;
@@ -166,6 +166,7 @@
 			ERR_UNSPEC = OsModel::ERR_UNSPEC,
 			ERR_NOTIMPL = OsModel::ERR_NOTIMPL,
 			ERR_HOSTUNREACH = OsModel::ERR_HOSTUNREACH,
+			ERR_BUSY = OsModel::ERR_BUSY,
 			ROUTING_CALLED = Radio_LoWPAN::ROUTING_CALLED
 		};
 		// --------------------------------------------------------------------
@@ -214,6 +215,9 @@
 			
 			#ifdef LOWPAN_ROUTE_OVER
 			routing_.init( *timer_, *debug_, *radio_ );
+			routing_.template reg_route_callback<self_type, &self_type::route_available>( this );
+			pending_.init( *timer_, *debug_, packet_pool_mgr_ );
+			pending_.template reg_resend_callback<self_type, &self_type::resend_pending>( this );
 			#endif
 			
 			flow_label_ = 0;
@@ -482,10 +486,30 @@
 
 		#ifdef LOWPAN_ROUTE_OVER
 		/**
-		* Pollig function, it will be called by the timer, and this function tries to resend the actual packet
-		* \param p_number The number of the packet in the PacketPool
+		* Packets waiting for the routing in FIFO order
+		* These are sent by the route notifications of the routing instead of polling
+		*/
+		Pending_Queue_t pending_;
+		
+		/**
+		* Store a packet until the routing finishes
+		* \param destination The IP address of the destination
+		* \param packet_number The number of the packet in the PacketPool
+		* \return ROUTING_CALLED if it is stored, ERR_BUSY if there is no place for it
+		*/
+		int enqueue_pending( node_id_t destination, size_t packet_number );
+		
+		/**
+		* Route notification from the routing, the waiting packets are offered to resend_pending()
+		* \param destination The destination of the changed route, NULL_NODE_ID if any can be affected
+		*/
+		void route_available( node_id_t destination );
+		
+		/**
+		* Send a waiting packet if it has a route now, called by the pending queue
+		* \return one of the Pending_Queue_t::ResendResults
 		*/
-		void routing_polling( void* p_number );
+		int resend_pending( node_id_t destination, uint8_t packet_number );
 		#endif
 		
 		/**
@@ -647,6 +671,12 @@
 		if ( interface_manager_->disable_radios() != SUCCESS )
 			return ERR_UNSPEC;
 		interface_manager_->unregister_callbacks();
+		
+		#ifdef LOWPAN_ROUTE_OVER
+		//Drop the waiting packets
+		routing_.unreg_route_callback();
+		pending_.clear();
+		#endif
 		return SUCCESS;
 	}
 	
@@ -736,6 +766,9 @@
 				//Set the new transport position
 				message->TRANSPORT_POS += HOHO_header_size + HOHO_header_padding;
 				
+				//The layout changed, a checksum kept from a forwarded packet is stale
+				message->checksum_valid = false;
+				
 				//HOHO next header will be set after this block
 				
 				//Because of the previous calculation it has to result an integer
@@ -874,9 +907,8 @@
 			char str[43];
 			debug().debug( "IPv6 layer: No route to %s in the forwarding table, the routing algorithm is working!", destination.get_address(str) );
 			#endif
-			//set timer for polling
-			timer().template set_timer<self_type, &self_type::routing_polling>( CREATION_IN_PROGRESS_DELAY, this, (void*)packet_number);
-			return ROUTING_CALLED;
+			//Wait for the route notification
+			return enqueue_pending( destination, packet_number );
 		}
 		//The algorithm is working on another path
 		else if ( routing_result == Routing_t::ROUTING_BUSY)
@@ -885,9 +917,8 @@
 			char str[43];
 			debug().debug( "IPv6 layer: No route to %s in the forwarding table, and the routing algorithm is busy, discovery will be started soon!", destination.get_address(str) );
 			#endif
-			//set timer for polling
-			timer().template set_timer<self_type, &self_type::routing_polling>( ROUTING_BUSY_DELAY, this, (void*)packet_number);
-			return ROUTING_CALLED;
+			//Wait for the route notification, the discovery is started when the actual one is finished
+			return enqueue_pending( destination, packet_number );
 		}
 		//The algorithm is failed, it will be dropped
 		else // Routing_t::NO_ROUTE_TO_HOST
@@ -896,7 +927,7 @@
 			char str[43];
 			debug().debug( "IPv6 layer: No route to %s and the algorithm failed, packet dropped!", destination.get_address(str) );
 			#endif
-			//It will be dropped by the caller (Upper layer's send or routing_polling())
+			//It will be dropped by the caller (Upper layer's send or route_available())
 			return ERR_HOSTUNREACH;
 		}
 	#endif
@@ -1095,6 +1126,10 @@
 			message->remote_ll_address = Radio_P::NULL_NODE_ID;
 			message->target_interface = NUMBER_OF_INTERFACES;
 			
+			//The checksum of the originator is kept, the hop limit is not covered by it.
+			//send() clears the flag again if it inserts extension headers.
+			message->checksum_valid = true;
+			
 			if( send( destination, packet_number, NULL ) != ROUTING_CALLED )
 				packet_pool_mgr_->clean_packet( message );
 		}
@@ -1131,28 +1166,74 @@
 		typename Debug_P,
 		typename Timer_P,
 		typename InterfaceManager_P>
-	void 
+	int
 	IPv6<OsModel_P, Radio_LoWPAN_P, Radio_P, Debug_P, Timer_P, InterfaceManager_P>::
-	routing_polling( void* p_number )
+	enqueue_pending( node_id_t destination, size_t packet_number )
 	{
-		int packet_number = (int)p_number;
-
-		//tests: valid entry
-		if( packet_pool_mgr_->packet_pool[packet_number].valid == true )
+		if( pending_.enqueue( destination, packet_number ) != SUCCESS )
 		{
 			#ifdef IPv6_LAYER_DEBUG
-			debug().debug( "IPv6 layer: Routing algorithm polling, try to send waiting packet (%i).", (int)p_number);
+			debug().debug( "IPv6 layer: Pending queue is full, packet (%i) dropped!", (int)packet_number );
 			#endif
-			
-			node_id_t dest;
-			packet_pool_mgr_->packet_pool[packet_number].destination_address(dest);
-				
+			//It will be dropped by the caller
+			return ERR_BUSY;
+		}
+		return ROUTING_CALLED;
+	}
+	
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_LoWPAN_P,
+		typename Radio_P,
+		typename Debug_P,
+		typename Timer_P,
+		typename InterfaceManager_P>
+	void
+	IPv6<OsModel_P, Radio_LoWPAN_P, Radio_P, Debug_P, Timer_P, InterfaceManager_P>::
+	route_available( node_id_t destination )
+	{
+		#ifdef IPv6_LAYER_DEBUG
+		char str[43];
+		debug().debug( "IPv6 layer: Route notification for %s, %i waiting packet(s).", destination.get_address(str), pending_.size() );
+		#endif
+		
+		pending_.route_available();
+	}
+	
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_LoWPAN_P,
+		typename Radio_P,
+		typename Debug_P,
+		typename Timer_P,
+		typename InterfaceManager_P>
+	int
+	IPv6<OsModel_P, Radio_LoWPAN_P, Radio_P, Debug_P, Timer_P, InterfaceManager_P>::
+	resend_pending( node_id_t destination, uint8_t packet_number )
+	{
+		node_id_t next_hop;
+		uint8_t target_interface;
+		
+		//The discovery is started for the first destination without route,
+		//the others get ROUTING_BUSY and wait for the next notification
+		int routing_result = routing_.find( destination, target_interface, next_hop );
+		
+		if( routing_result == Routing_t::ROUTE_AVAILABLE )
+		{
 			//Set the packet unused when transmitted
-			//The result can be ROUTING_CALLED if there were more then one requests for the routing algorithm
-			//or if the algorithm is still working
-			if( send( dest, packet_number, NULL ) != ROUTING_CALLED )
+			if( interface_manager_->send_to_interface( next_hop, packet_number, NULL, target_interface ) != ROUTING_CALLED )
 				packet_pool_mgr_->clean_packet( &(packet_pool_mgr_->packet_pool[packet_number]) );
+			return Pending_Queue_t::RESEND_SENT;
+		}
+		else if( routing_result == Routing_t::NO_ROUTE_TO_HOST )
+		{
+			#ifdef IPv6_LAYER_DEBUG
+			char str[43];
+			debug().debug( "IPv6 layer: No route to %s and the algorithm failed, packet dropped!", destination.get_address(str) );
+			#endif
+			return Pending_Queue_t::RESEND_DROP;
 		}
+		return Pending_Queue_t::RESEND_WAIT;
 	}
 	#endif
 	
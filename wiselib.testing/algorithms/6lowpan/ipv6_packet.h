@@ -30,6 +30,13 @@
 #include "algorithms/6lowpan/ipv6_address.h"
 #include "util/serialization/bitwise_serialization.h"
 
+#if defined(PC) && defined(__SSE2__)
+	#include <emmintrin.h>
+	#define IPV6_CHECKSUM_USE_SSE2 1
+#else
+	#define IPV6_CHECKSUM_USE_SSE2 0
+#endif
+
 
 /*
   IPv6 Header
@@ -85,10 +92,20 @@ namespace wiselib
 		
 		///Constructor
 		IPv6Packet()
+		{
+			reset();
+		}
+		
+		/**
+		* Set the packet to the default, empty state
+		* The pool calls this in place when a packet is reused
+		*/
+		void reset()
 		{
 			memset(buffer_, 0, LOWPAN_IP_PACKET_BUFFER_MAX_SIZE);
 			
 			valid = false;
+			checksum_valid = false;
 			ND_installation_message = false;
 			remote_ll_address = Radio::NULL_NODE_ID;
 			target_interface = NUMBER_OF_INTERFACES;
@@ -394,6 +411,12 @@ namespace wiselib
 		*/
 		bool valid;
 		
+		/**
+		* Indicates that the transport layer checksum in the buffer is correct (e.g. the packet
+		* is forwarded), so it only has to be updated if a covered field is changed
+		*/
+		bool checksum_valid;
+		
 		/**
 		* Indicates that this is from the Uart but this is an ND setter message for a borer router
 		*/
@@ -415,15 +438,46 @@ namespace wiselib
 		*/
 		uint16_t generate_checksum();
 		
+		/** \brief Incremental checksum update (RFC 1624)
+		* \param checksum the old checksum
+		* \param old_word the old value of the changed 16-bit word
+		* \param new_word the new value of the changed 16-bit word
+		* \return the new checksum
+		*/
+		static uint16_t update_checksum( uint16_t checksum, uint16_t old_word, uint16_t new_word )
+		{
+			//HC' = ~(~HC + ~m + m')
+			uint32_t sum = (uint16_t)~checksum;
+			sum += (uint16_t)~old_word;
+			sum += new_word;
+			sum = (sum & 0xFFFF) + (sum >> 16);
+			sum = (sum & 0xFFFF) + (sum >> 16);
+			return ~sum;
+		}
+		
+		/** \brief Update the checksum in the transport header after a covered field changed
+		* \param old_data the old content of the field
+		* \param new_data the new content of the field
+		* \param len length of the field, it must be even and start at an even position
+		* (e.g. an address of the pseudo header)
+		*/
+		void update_transport_checksum( uint8_t* old_data, uint8_t* new_data, uint16_t len );
+		
 	private:
 		
 		/** \brief Helper function for the checksum generation
+		* Adds the data to the accumulator word by word in the native byte order,
+		* the result has to be folded and converted with checksum_finalize()
 		* \param len length of the data
-		* \param data pointer to the first byte
-		* \param sum target accumulator
-		* \param start_odd if the previous value was not full 32 bytes
+		* \param data pointer to the first byte, it must be at an even position in the summed data
+		* \param sum the accumulator
+		* \return the new accumulator
+		*/
+		static uint64_t checksum_serialize( uint16_t len, const uint8_t* data, uint64_t sum );
+		
+		/** \brief Fold the accumulator to 16 bits in the network byte order
 		*/
-		void checksum_serialize( uint16_t len, uint8_t* data, uint32_t& sum, bool start_odd );
+		static uint16_t checksum_finalize( uint64_t sum );
 		
 		Debug& debug()
 		{ return *debug_; }
@@ -444,37 +498,66 @@ namespace wiselib
 		uint16_t len = transport_length();
 		uint8_t* data = payload();
 		
-		uint32_t sum = 0;
+		uint64_t sum = 0;
 		
 		/* PSEUDO HEADER */
 		
-		checksum_serialize( 16, buffer_ + SOURCE_ADDRESS_BYTE, sum, false );
-		checksum_serialize( 16, buffer_ + DESTINATION_ADDRESS_BYTE, sum, false );
+		//Source and destination addresses
+		sum = checksum_serialize( 32, buffer_ + SOURCE_ADDRESS_BYTE, sum );
 		
-		uint8_t tmp[4];
+		uint8_t tmp[8];
 		tmp[0] = 0;
 		tmp[1] = 0;
 		
 		//Upper-layer length
 		tmp[2] = buffer_[LENGTH_BYTE];
 		tmp[3] = buffer_[LENGTH_BYTE + 1];
-		checksum_serialize( 4, tmp, sum, false );
 		
 		//Next header
-		tmp[2] = 0;
-		tmp[3] = buffer_[NEXT_HEADER_BYTE];
-		checksum_serialize( 4, tmp, sum, false );
+		tmp[4] = 0;
+		tmp[5] = 0;
+		tmp[6] = 0;
+		tmp[7] = buffer_[NEXT_HEADER_BYTE];
+		sum = checksum_serialize( 8, tmp, sum );
 		
 		/* PSEUDO END */
 		
 		/* Payload */
-		checksum_serialize( len, data, sum, false );
+		sum = checksum_serialize( len, data, sum );
 		
-		
-		//uint32_t --> uint16_t
-		sum = (sum & 0xFFFF) + (sum >> 16);
-	 
-		return ( sum ^ 0xFFFF );
+		return ( checksum_finalize( sum ) ^ 0xFFFF );
+	}
+	
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_P,
+		typename Debug_P>
+	void
+	IPv6Packet<OsModel_P, Radio_P, Debug_P>::
+	update_transport_checksum( uint8_t* old_data, uint8_t* new_data, uint16_t len )
+	{
+		uint8_t* checksum_place;
+		if( transport_next_header() == UDP )
+			checksum_place = payload() + 6;
+		else if( transport_next_header() == ICMPV6 )
+			checksum_place = payload() + 2;
+		else
+			return;
+		
+		uint16_t checksum = ( checksum_place[0] << 8 ) | checksum_place[1];
+		for( uint16_t i = 0; i + 1 < len; i += 2 )
+			checksum = update_checksum( checksum,
+				( old_data[i] << 8 ) | old_data[i + 1],
+				( new_data[i] << 8 ) | new_data[i + 1] );
+		
+		//A zero UDP checksum means no checksum, the ones' complement equivalent is used
+		if( checksum == 0 && transport_next_header() == UDP )
+			checksum = 0xFFFF;
+		
+		checksum_place[0] = checksum >> 8;
+		checksum_place[1] = checksum & 0xFF;
 	}
 	
 	// -----------------------------------------------------------------------
@@ -483,26 +566,83 @@ namespace wiselib
 	template<typename OsModel_P,
 	typename Radio_P,
 	typename Debug_P>
-	void
+	uint64_t
 	IPv6Packet<OsModel_P, Radio_P, Debug_P>::
-	checksum_serialize( uint16_t len, uint8_t* data, uint32_t& sum, bool start_odd )
+	checksum_serialize( uint16_t len, const uint8_t* data, uint64_t sum )
 	{
-		if ((start_odd) && (len > 0))  {
-			sum += (uint16_t)*data++;
-			len--;
+		//The ones' complement sum does not depend on the byte order, so the
+		//words are added as they are loaded and the result is swapped at the end (RFC 1071)
+	#if IPV6_CHECKSUM_USE_SSE2
+		//16 bytes per step, the 16-bit words are widened to 32-bit lanes,
+		//which can't overflow for the length of an IP packet
+		if( len >= 16 )
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i acc = zero;
+			while( len >= 16 )
+			{
+				__m128i v = _mm_loadu_si128( (const __m128i*)data );
+				acc = _mm_add_epi32( acc, _mm_unpacklo_epi16( v, zero ) );
+				acc = _mm_add_epi32( acc, _mm_unpackhi_epi16( v, zero ) );
+				data += 16;
+				len -= 16;
+			}
+			uint32_t lanes[4];
+			_mm_storeu_si128( (__m128i*)lanes, acc );
+			sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
 		}
+	#endif
 		
-		while( len > 1 )
+		while( len >= 4 )
 		{
-			sum += ((uint16_t)*data++) << 8;
-			sum += (uint16_t)*data++;
+			uint32_t word;
+			memcpy( &word, data, 4 );
+			sum += word;
+			data += 4;
+			len -= 4;
+		}
+		
+		if( len >= 2 )
+		{
+			uint16_t word;
+			memcpy( &word, data, 2 );
+			sum += word;
+			data += 2;
 			len -= 2;
 		}
+		
 		// if there is a byte left then add it (padded with zero)
-		if ( len > 0 )
+		if( len > 0 )
 		{
-			sum += ((uint16_t)*data++) << 8;
+			uint8_t tmp[2] = { *data, 0 };
+			uint16_t word;
+			memcpy( &word, tmp, 2 );
+			sum += word;
 		}
+		return sum;
+	}
+	
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+	typename Radio_P,
+	typename Debug_P>
+	uint16_t
+	IPv6Packet<OsModel_P, Radio_P, Debug_P>::
+	checksum_finalize( uint64_t sum )
+	{
+		//uint64_t --> uint16_t
+		sum = (sum & 0xFFFFFFFF) + (sum >> 32);
+		sum = (sum & 0xFFFFFFFF) + (sum >> 32);
+		sum = (sum & 0xFFFF) + (sum >> 16);
+		sum = (sum & 0xFFFF) + (sum >> 16);
+		sum = (sum & 0xFFFF) + (sum >> 16);
+		
+		uint16_t result = sum;
+		if( OsModel::endianness == WISELIB_LITTLE_ENDIAN )
+			result = ( result << 8 ) | ( result >> 8 );
+		return result;
 	}
 	
 }
@@ -33,6 +33,8 @@ namespace wiselib
 	/** \brief This manager deals with the packets stored in the system
 	* Because dynamic memory allocation is forbidden, a predefined number of packets are avalible,
 	* and a packet must be freed up after the usage.
+	*
+	* The unused packets are chained in a free list, so getting and cleaning a packet is O(1).
 	*/
 	template<typename OsModel_P,
 		typename Radio_P,
@@ -54,7 +56,10 @@ namespace wiselib
 				for( int i = 0; i < IP_PACKET_POOL_SIZE; i++ )
 				{
 					packet_pool[i].valid = false;
+					next_free_[i] = i + 1;
 				}
+				next_free_[IP_PACKET_POOL_SIZE - 1] = NO_FREE_PACKET;
+				free_head_ = 0;
 			}
 		
 		// -----------------------------------------------------------------
@@ -81,6 +86,14 @@ namespace wiselib
 			return &(packet_pool[i]);
 		}
 		
+		/**
+		* Get the number of a packet
+		*/
+		uint8_t get_packet_number( Packet* target )
+		{
+			return target - packet_pool;
+		}
+		
 		// -----------------------------------------------------------------		
 		
 		/**
@@ -89,18 +102,19 @@ namespace wiselib
 		*/
 		uint8_t get_unused_packet_with_number()
 		{
-			for( int i = 0; i < IP_PACKET_POOL_SIZE; i++ )
+			uint8_t i = free_head_;
+			if( i == NO_FREE_PACKET )
 			{
-				if( packet_pool[i].valid == false )
-				{
-					packet_pool[i] = Packet();
-					packet_pool[i].valid = true;
-					
-					return i;
-				}
+				debug().debug( "IP packet pool manager: ERROR - no free packet\n" );
+				return NO_FREE_PACKET;
 			}
-			debug().debug( "IP packet pool manager: ERROR - no free packet\n" );
-			return NO_FREE_PACKET;
+			free_head_ = next_free_[i];
+			
+			//Reset in place, the buffer is not copied from a temporary
+			packet_pool[i].reset();
+			packet_pool[i].valid = true;
+			
+			return i;
 		}
 		
 		/**
@@ -121,8 +135,14 @@ namespace wiselib
 		*/
 		void clean_packet_with_number( uint8_t i )
 		{
+			//Already unused, it must not be chained into the free list twice
+			if( !packet_pool[i].valid )
+				return;
+			
 			//Turn it to be invalid, content will be cleaned at the next time of usage
-			packet_pool[i].valid = false;;
+			packet_pool[i].valid = false;
+			next_free_[i] = free_head_;
+			free_head_ = i;
 		}
 		
 		/**
@@ -130,8 +150,7 @@ namespace wiselib
 		*/
 		void clean_packet( Packet* target )
 		{
-			//Turn it to be invalid, content will be cleaned at the next time of usage
-			target->valid = false;
+			clean_packet_with_number( get_packet_number( target ) );
 		}
 		
 		/**
@@ -145,6 +164,16 @@ namespace wiselib
 		Debug& debug()
 		{ return *debug_; }
 		
+		/**
+		* Next unused packet in the free list, for every unused packet
+		*/
+		uint8_t next_free_[IP_PACKET_POOL_SIZE];
+		
+		/**
+		* First unused packet, NO_FREE_PACKET if the pool is empty
+		*/
+		uint8_t free_head_;
+		
 	};
 
 }
@@ -0,0 +1,290 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+/*
+* File: ipv6_pending_queue.h
+* Class(es): IPv6PendingQueue
+*/
+
+#ifndef __ALGORITHMS_6LOWPAN_IPV6_PENDING_QUEUE_H__
+#define __ALGORITHMS_6LOWPAN_IPV6_PENDING_QUEUE_H__
+
+#include "util/delegates/delegate.hpp"
+
+namespace wiselib
+{
+	/** \brief Packets of the IPv6 layer waiting for a route
+	*
+	* The packets are kept in FIFO order, at most LOWPAN_PENDING_QUEUE_SIZE of them and
+	* LOWPAN_PENDING_PER_DESTINATION for the same destination. A route notification
+	* schedules a flush, which offers every waiting packet to the resend handler of the
+	* owner. A single timer for the whole queue drops the packets that waited a full
+	* LOWPAN_PENDING_TIMEOUT period, in case the routing never answers.
+	*/
+	template<typename OsModel_P,
+		typename Node_P,
+		typename Packet_Pool_Mgr_P,
+		typename Debug_P,
+		typename Timer_P>
+	class IPv6PendingQueue
+	{
+	public:
+		typedef OsModel_P OsModel;
+		typedef Node_P node_id_t;
+		typedef Packet_Pool_Mgr_P Packet_Pool_Mgr_t;
+		typedef Debug_P Debug;
+		typedef Timer_P Timer;
+
+		typedef IPv6PendingQueue<OsModel, node_id_t, Packet_Pool_Mgr_t, Debug, Timer> self_type;
+
+		/**
+		* Offers a waiting packet for sending, returns one of the ResendResults
+		*/
+		typedef delegate2<int, node_id_t, uint8_t> resend_delegate_t;
+
+		enum ErrorCodes
+		{
+			SUCCESS = OsModel::SUCCESS,
+			ERR_BUSY = OsModel::ERR_BUSY
+		};
+
+		enum ResendResults
+		{
+			RESEND_SENT,	///< The packet is removed, the handler took care of it
+			RESEND_WAIT,	///< There is no route yet, the packet stays in the queue
+			RESEND_DROP	///< The packet is removed and set unused in the pool
+		};
+
+		// -----------------------------------------------------------------
+		///Constructor
+		IPv6PendingQueue()
+		: size_( 0 ),
+		timer_set_( false ),
+		flush_set_( false ),
+		epoch_( 0 )
+		{}
+
+		// -----------------------------------------------------------------
+
+		/**
+		* Initialize the queue, get instances
+		* The packets of a previous use are forgotten without cleaning them
+		*/
+		void init( Timer& timer, Debug& debug, Packet_Pool_Mgr_t* p_mgr )
+		{
+			timer_ = &timer;
+			debug_ = &debug;
+			packet_pool_mgr_ = p_mgr;
+			size_ = 0;
+			//Timers armed before a re-init still fire, they are ignored by the epoch
+			epoch_++;
+			timer_set_ = false;
+			flush_set_ = false;
+		}
+
+		/** \brief Register the handler which sends the waiting packets
+		* Usage: pending_.template reg_resend_callback<self_type, &self_type::resend_pending>( this );
+		*/
+		template<class T, int (T::*TMethod)(node_id_t, uint8_t)>
+		void reg_resend_callback( T* obj_pnt )
+		{
+			resend_ = resend_delegate_t::template from_method<T, TMethod>( obj_pnt );
+		}
+
+		// -----------------------------------------------------------------
+
+		/**
+		* Store a packet until the routing finishes
+		* \param destination The IP address of the destination
+		* \param packet_number The number of the packet in the PacketPool
+		* \return SUCCESS if it is stored, ERR_BUSY if there is no place for it
+		*/
+		int enqueue( node_id_t destination, uint8_t packet_number )
+		{
+			//Bound the memory used by one destination, the older packets are kept
+			uint8_t same_destination = 0;
+			for( uint8_t i = 0; i < size_; i++ )
+				if( pending_[i].destination == destination )
+					same_destination++;
+
+			if( size_ >= LOWPAN_PENDING_QUEUE_SIZE || same_destination >= LOWPAN_PENDING_PER_DESTINATION )
+				return ERR_BUSY;
+
+			pending_[size_].destination = destination;
+			pending_[size_].packet_number = packet_number;
+			pending_[size_].age = 0;
+			size_++;
+
+			//One timer for the whole queue, only for the case when the routing never answers
+			if( !timer_set_ )
+			{
+				timer_set_ = true;
+				timer().template set_timer<self_type, &self_type::timeout>( LOWPAN_PENDING_TIMEOUT, this, (void*)( size_t )( epoch_ ) );
+			}
+			return SUCCESS;
+		}
+
+		/**
+		* Route notification from the routing, it schedules flush()
+		* The routing calls it from its receive handlers, so nothing is sent from here.
+		* Several notifications before the flush are served by one pass.
+		*/
+		void route_available()
+		{
+			if( size_ > 0 && !flush_set_ )
+			{
+				flush_set_ = true;
+				timer().template set_timer<self_type, &self_type::flush>( 0, this, (void*)( size_t )( epoch_ ) );
+			}
+		}
+
+		/**
+		* Drop every waiting packet
+		*/
+		void clear()
+		{
+			while( size_ > 0 )
+				remove( 0, true );
+		}
+
+		/**
+		* Number of the waiting packets
+		*/
+		uint8_t size()
+		{
+			return size_;
+		}
+
+		// -----------------------------------------------------------------
+
+		/**
+		* Offer every waiting packet to the resend handler, called by the timer
+		* Every packet is checked because of the prefix and default routes,
+		* the packets with routes are sent in one batch in FIFO order.
+		*/
+		void flush( void* epoch )
+		{
+			//Armed before a re-init
+			if( (uint8_t)( size_t )( epoch ) != epoch_ )
+				return;
+			flush_set_ = false;
+
+			uint8_t i = 0;
+			while( i < size_ )
+			{
+				//The entry is taken out while the handler runs, sending can enqueue other packets
+				PendingPacket p = pending_[i];
+				remove( i, false );
+				int result = resend_( p.destination, p.packet_number );
+
+				if( result == RESEND_DROP )
+					packet_pool_mgr_->clean_packet_with_number( p.packet_number );
+				else if( result == RESEND_WAIT )
+				{
+					//Put back to its place, the handler has not sent anything so there is room for it
+					for( uint8_t j = size_; j > i; j-- )
+						pending_[j] = pending_[j - 1];
+					pending_[i++] = p;
+					size_++;
+				}
+			}
+		}
+
+		/**
+		* Drop the packets for which the routing did not answer in time, called by the timer
+		*/
+		void timeout( void* epoch )
+		{
+			//Armed before a re-init
+			if( (uint8_t)( size_t )( epoch ) != epoch_ )
+				return;
+			timer_set_ = false;
+
+			//Drop the packets which waited at least a full period
+			uint8_t i = 0;
+			while( i < size_ )
+			{
+				if( pending_[i].age > 0 )
+				{
+					#ifdef IPv6_LAYER_DEBUG
+					debug().debug( "IPv6 layer: Waiting packet (%i) timed out, dropped!", pending_[i].packet_number );
+					#endif
+					remove( i, true );
+				}
+				else
+					pending_[i++].age++;
+			}
+
+			if( size_ > 0 )
+			{
+				timer_set_ = true;
+				timer().template set_timer<self_type, &self_type::timeout>( LOWPAN_PENDING_TIMEOUT, this, epoch );
+			}
+		}
+
+	private:
+		/**
+		* \brief Packet waiting for a route
+		*/
+		struct PendingPacket
+		{
+			node_id_t destination;
+			uint8_t packet_number;
+			///Number of expired timeout periods
+			uint8_t age;
+		};
+
+		/**
+		* Remove an entry from the queue, the order of the others is kept
+		* \param clean if it is true the packet is set unused in the PacketPool
+		*/
+		void remove( uint8_t index, bool clean )
+		{
+			if( clean )
+				packet_pool_mgr_->clean_packet_with_number( pending_[index].packet_number );
+
+			size_--;
+			for( uint8_t i = index; i < size_; i++ )
+				pending_[i] = pending_[i + 1];
+		}
+
+		Timer& timer()
+		{
+			return *timer_;
+		}
+
+		Debug& debug()
+		{
+			return *debug_;
+		}
+
+		typename Timer::self_pointer_t timer_;
+		typename Debug::self_pointer_t debug_;
+		Packet_Pool_Mgr_t* packet_pool_mgr_;
+		resend_delegate_t resend_;
+
+		PendingPacket pending_[LOWPAN_PENDING_QUEUE_SIZE];
+		uint8_t size_;
+		bool timer_set_;
+		bool flush_set_;
+		///Passed to the queue's timers, incremented by init() to invalidate the armed ones
+		uint8_t epoch_;
+	};
+}
+#endif
@@ -73,7 +73,8 @@ namespace wiselib
 		typename Radio_P,
 		typename Debug_P,
 		typename Timer_P,
-		typename Uart_P>
+		typename Uart_P,
+		typename Clock_P = typename OsModel_P::Clock>
 	class IPv6Stack
 	{
 	public:
@@ -83,8 +84,9 @@ namespace wiselib
 		typedef Debug_P Debug;
 		typedef Timer_P Timer;
 		typedef Uart_P Uart;
+		typedef Clock_P Clock;
 		
-		typedef IPv6Stack<OsModel, Radio, Debug, Timer, Uart> self_type;
+		typedef IPv6Stack<OsModel, Radio, Debug, Timer, Uart, Clock> self_type;
 		
 		typedef wiselib::UartRadio<OsModel, Radio, Debug, Timer, Uart> UartRadio_t;
 		typedef wiselib::LoWPAN<OsModel, Radio, Debug, Timer, UartRadio_t> LoWPAN_t;
@@ -98,7 +100,7 @@ namespace wiselib
 		typedef wiselib::IPv6PacketPoolManager<OsModel, Radio, Debug> Packet_Pool_Mgr_t;
 
 		#ifdef RPL_DEFINED
-		typedef wiselib::RPLRouting<OsModel, IPv6_t, Radio, Debug, Timer/*, Clock*/> RPL_t;	
+		typedef wiselib::RPLRouting<OsModel, IPv6_t, Radio, Debug, Timer, Clock> RPL_t;	
 		#endif
 		
 		enum ErrorCodes
@@ -114,12 +116,13 @@ namespace wiselib
 		* This function initializes the - layers of the stack: 6LoWPAN, UartRadio, IPv6, UDP, ICMPv6
 		*				- managers of the stack: PacketPoolManager, InterfaceManager
 		*/
-		void init( Radio& radio, Debug& debug, Timer& timer, Uart& uart)
+		void init( Radio& radio, Debug& debug, Timer& timer, Uart& uart, Clock& clock )
 		{
 			radio_ = &radio;
 			debug_ = &debug;
 			timer_ = &timer;
 			uart_ = &uart;
+			clock_ = &clock;
 			
 			debug_->debug( "IPv6 stack init: %llx", (long long unsigned)(radio_->id()));
 			
@@ -160,7 +163,7 @@ namespace wiselib
 
 			#ifdef RPL_DEFINED
 			//Init RPLRouting
-			rpl.init( ipv6, *radio_, *debug_, *timer_, &packet_pool_mgr);
+			rpl.init( ipv6, *radio_, *debug_, *timer_, *clock_, &packet_pool_mgr);
 									
 			//Just register callback, not enable IP radio
 			if( SUCCESS != rpl.enable_radio() )
@@ -183,6 +186,7 @@ namespace wiselib
 		typename Debug::self_pointer_t debug_;
 		typename Timer::self_pointer_t timer_;
 		typename Uart::self_pointer_t uart_;
+		typename Clock::self_pointer_t clock_;
 		
 		LoWPAN_t lowpan;
 		UartRadio_t uart_radio;
@@ -33,6 +33,7 @@
 #include "algorithms/6lowpan/ipv6_packet_pool_manager.h"
 #include "algorithms/6lowpan/nd_storage.h"
 #include "algorithms/6lowpan/reassembling_manager.h"
+#include "algorithms/6lowpan/lowpan_flow_cache.h"
 
 #ifdef LOWPAN_MESH_UNDER
 #include "algorithms/6lowpan/interface_manager.h"
@@ -86,6 +87,10 @@ namespace wiselib
 		
 		typedef LoWPANReassemblingManager<OsModel, Radio, Debug, Timer> Reassembling_Mgr_t;
 		
+		#if LOWPAN_FLOW_CACHE_SIZE > 0
+		typedef LoWPANFlowCache<OsModel, Radio, Debug> Flow_Cache_t;
+		#endif
+		
 		#ifdef LOWPAN_MESH_UNDER
 		typedef InterfaceManager<OsModel, self_type, Radio, Debug, Timer, Uart_Radio> InterfaceManager_t;
 		
@@ -158,6 +163,10 @@ namespace wiselib
 			packet_pool_mgr_ = p_mgr;
 			reassembling_mgr_.init( *timer_, *debug_, packet_pool_mgr_ );
 			
+			#if LOWPAN_FLOW_CACHE_SIZE > 0
+			flow_cache_clear();
+			#endif
+			
 			
 			/*
 				ND is enabled for this interface
@@ -229,6 +238,16 @@ namespace wiselib
 		///Instance of the ND Storage
 		NDStorage_t nd_storage_;
 		
+		#if LOWPAN_FLOW_CACHE_SIZE > 0
+		/** \brief Drop the cached header templates
+		* It has to be called if the contexts are changed
+		*/
+		void flow_cache_clear()
+		{
+			flow_cache_.clear();
+		}
+		#endif
+		
 	private:
 		
 		Radio& radio()
@@ -706,6 +725,29 @@ namespace wiselib
 		*/
 		int get_unicast_address( node_id_t* link_local_source, bool source, IPv6Address_t& address );
 		
+		//-------------------------FLOW CACHE  ----------------------------------------------
+		#if LOWPAN_FLOW_CACHE_SIZE > 0
+		///Instance of the Flow Cache
+		Flow_Cache_t flow_cache_;
+		
+		/**
+		* Set the IPHC and the NHC header from the cached template of the flow
+		* \param ip_packet pointer to the actual IP packet
+		* \param link_local_destination pointer to the ll destination
+		* \return true if the headers are set, false if the full compression is required
+		*/
+		bool flow_cache_compress( IPv6Packet_t* ip_packet, node_id_t* link_local_destination );
+		
+		/**
+		* Store the headers of the buffer_ as the template of the flow
+		* NOTE: It has to be called after the set_IPHC_header and the set_NHC_header functions!
+		* \param ip_packet pointer to the actual IP packet
+		* \param link_local_destination pointer to the ll destination
+		*/
+		void flow_cache_store( IPv6Packet_t* ip_packet, node_id_t* link_local_destination );
+		#endif
+		//-------------------------FLOW CACHE  END-------------------------------------------
+		
 		///Buffer for the incoming radio messages
 		block_data_t buffer_[Radio::MAX_MESSAGE_LENGTH];
 		
@@ -892,6 +934,11 @@ namespace wiselib
 	//------------------------------------------------------------------------------------------------------------
 	//		IP HEADERS
 	//------------------------------------------------------------------------------------------------------------
+	#if LOWPAN_FLOW_CACHE_SIZE > 0
+		//Repeated flows without extension headers use the stored IPHC and NHC headers
+		bool flow_cached = flow_cache_compress( ip_packet, &mac_destination );
+		if( !flow_cached )
+	#endif
 		set_IPHC_header( ip_packet, &mac_destination );
 
 		//Start position: after the IPv6 header
@@ -918,8 +965,17 @@ namespace wiselib
 		}
 
 		//UDP header NHC compression
+	#if LOWPAN_FLOW_CACHE_SIZE > 0
+		if( !flow_cached )
+		{
+			if( actual_NH_value == UDP )
+				set_NHC_header( ip_packet );
+			flow_cache_store( ip_packet, &mac_destination );
+		}
+	#else
 		if( actual_NH_value == UDP )
 			set_NHC_header( ip_packet );
+	#endif
 		
 		//NOTE: if ICMPv6 is used, it is copied as payload, the Next Header field which links to this
 		//was set in the set_IPHC_header or in the last set_EH_header
@@ -961,13 +1017,11 @@ namespace wiselib
 			
 			//Free space in the packet, the offset is used in 8 octets
 			uint16_t free_space = ((uint16_t)( (MAX_MESSAGE_LENGTH - ACTUAL_SHIFT) / 8 ) * 8);
+			uint16_t chunk_length;
 			
 			if( payload_length > free_space )
 			{
-				memcpy((buffer_ + ACTUAL_SHIFT), payload_pointer, free_space);
-				payload_pointer += free_space;
-				payload_length -= free_space;
-				ACTUAL_SHIFT += free_space;
+				chunk_length = free_space;
 				
 				//Set the offset for the next packet, in 8 octets
 				offset += free_space / 8;
@@ -982,23 +1036,25 @@ namespace wiselib
 			}
 			//No fragmentation or Last fragment
 			else
-			{
-				//Copy the full (remaining) payload
-				memcpy((buffer_ + ACTUAL_SHIFT), payload_pointer, payload_length);
-				ACTUAL_SHIFT += payload_length;
-				payload_length = 0;
-			}
+				chunk_length = payload_length;
+			
+			//Copy the chunk behind the headers
+			memcpy((buffer_ + ACTUAL_SHIFT), payload_pointer, chunk_length);
+			payload_pointer += chunk_length;
+			payload_length -= chunk_length;
+			ACTUAL_SHIFT += chunk_length;
 			
 			tmp++;
 			#ifdef LOWPAN_ROUTE_OVER
-			if ( radio().send( mac_destination, ACTUAL_SHIFT, buffer_ ) != SUCCESS )
-				return ERR_UNSPEC;
+			int result = radio().send( mac_destination, ACTUAL_SHIFT, buffer_ );
 			#endif
 			
 			#ifdef LOWPAN_MESH_UNDER
-			if ( radio().send( mac_next_hop, ACTUAL_SHIFT, buffer_ ) != SUCCESS )
-				return ERR_UNSPEC;
+			int result = radio().send( mac_next_hop, ACTUAL_SHIFT, buffer_ );
 			#endif
+			
+			if( result != SUCCESS )
+				return ERR_UNSPEC;
 	
 			#ifdef LoWPAN_LAYER_DEBUG
 			if( !frag_required )
@@ -1184,6 +1240,9 @@ namespace wiselib
 		uint8_t frag_disp = bitwise_read<OsModel, block_data_t, uint8_t>( buffer_ + ACTUAL_SHIFT + FRAG_DISP_BYTE, FRAG_DISP_BIT, FRAG_DISP_LEN );
 		uint16_t datagram_size = 0;
 		
+		//The reassembling process of this packet
+		typename Reassembling_Mgr_t::Slot* slot = NULL;
+		
 		if( (0x18 == frag_disp) || (0x1C == frag_disp) )
 		{	
 			FRAG_SHIFT = ACTUAL_SHIFT;
@@ -1200,31 +1259,32 @@ namespace wiselib
 				fragment_offset = bitwise_read<OsModel, block_data_t, uint8_t>( buffer_ + FRAG_SHIFT + FRAG_OFFSET_BYTE, FRAG_OFFSET_BIT, FRAG_OFFSET_LEN );
 			}
 			
-			//debug().debug( "LoWPAN layer: RECEIVED!!! valid:%i, old tag:%i new tag:%i, old sender: %x offset: %x ", reassembling_mgr_.valid, reassembling_mgr_.datagram_tag, d_tag, reassembling_mgr_.frag_sender, fragment_offset );
-			//This is a fragment for the actual reassembling process
-			if( reassembling_mgr_.valid && (reassembling_mgr_.datagram_tag == d_tag) &&
-			 (reassembling_mgr_.frag_sender == from))
+			//The size of the first fragment's payload is only known after the decompression
+			uint8_t fragment_units = 1;
+			if( fragment_offset != 0 )
+				fragment_units = ( len - ACTUAL_SHIFT + 7 ) / 8;
+			
+			//This is a fragment for a running reassembling process
+			slot = reassembling_mgr_.find_reassembling( from, d_tag, datagram_size );
+			if( slot != NULL )
 			{
-			 	//If it is an already received fragment drop it, if not, the manager registers it
-				if( !(reassembling_mgr_.is_it_new_offset( fragment_offset )) )
+			 	//If it is an already received or overlapping fragment drop it, if not, the slot registers it
+				if( !(slot->is_it_new_offset( fragment_offset, fragment_units )) )
 					return;
-				//debug().debug( "LoWPAN layer: 1st offset: %x, ", fragment_offset);
 			}
-			//new fragment, but if the manager is valid, It has to be dropped
-			else if( reassembling_mgr_.valid == true )
-			{
-			 //debug().debug( "LoWPAN layer: 2nd offset: %x, ", fragment_offset);
-				return;
-			}
-			//new fragment, call the manager for a free IP packet
+			//new fragment, call the manager for a free slot and IP packet
 			else
 			{
-				//If no free packet, drop the actual
-				
-				if (!(reassembling_mgr_.start_new_reassembling( datagram_size, from, d_tag )))
+				//If no free slot or packet, drop the actual
+				slot = reassembling_mgr_.start_new_reassembling( datagram_size, from, d_tag );
+				if( slot == NULL )
+					return;
+				//debug().debug( "LoWPAN layer: new reassembling offset: %x from: %x, size: %i", fragment_offset, from, datagram_size);
+				if( !(slot->is_it_new_offset( fragment_offset, fragment_units )) )
+				{
+					reassembling_mgr_.cancel_reassembling( slot );
 					return;
-				//debug().debug( "LoWPAN layer: 3rd offset: %x from: %x, size: %i", fragment_offset, from, datagram_size);
-				reassembling_mgr_.is_it_new_offset( fragment_offset );
+				}
 			}
 		}
 		
@@ -1246,53 +1306,48 @@ namespace wiselib
 			//Non fragmented packet
 			if( FRAG_SHIFT == MAX_MESSAGE_LENGTH )
 			{
-				//If there is another packet drop it
-				if( reassembling_mgr_.valid == true )
+				//call the manager, if no free slot or IP packet, drop this
+				slot = reassembling_mgr_.start_new_reassembling( len, from );
+				if( slot == NULL )
 					return;
-				else
-				{
-					//call the manager, if no free IP packet, drop this
-					if (!(reassembling_mgr_.start_new_reassembling( len, from )))
-						return;
-				}
 			}
 			IPHC_SHIFT = ACTUAL_SHIFT;
-			if( uncompress_IPHC( reassembling_mgr_.ip_packet, &from ) != SUCCESS )
+			if( uncompress_IPHC( slot->ip_packet, &from ) != SUCCESS )
 				return;
 			
-			reassembling_mgr_.received_datagram_size += 40;
+			slot->received_datagram_size += 40;
 			//------------------------------------
 			//Extension headers
 			//------------------------------------
 			bool is_udp = false;
 			uint16_t EH_LEN = 0;
 			//Next header is compressed with NHC
-			if( reassembling_mgr_.ip_packet->real_next_header() == reassembling_mgr_.ip_packet->REAL_NH_NOT_SET )
+			if( slot->ip_packet->real_next_header() == slot->ip_packet->REAL_NH_NOT_SET )
 			{
 				if( 30 == bitwise_read<OsModel, block_data_t, uint8_t>( buffer_ + ACTUAL_SHIFT + NHC_DISP_BYTE, NHC_DISP_BIT, NHC_DISP_LEN ) )
 				{
 					is_udp = true;
-					reassembling_mgr_.ip_packet->set_real_next_header( UDP );
+					slot->ip_packet->set_real_next_header( UDP );
 				}
 				//EH
 				else
 				{
 					bool EHNHC = true;
 					while( EHNHC )
-						EHNHC = uncompress_EH( reassembling_mgr_.ip_packet, NEXT_HEADER_SHIFT, EH_LEN, is_udp );
+						EHNHC = uncompress_EH( slot->ip_packet, NEXT_HEADER_SHIFT, EH_LEN, is_udp );
 				}
 			}
 			
-			reassembling_mgr_.received_datagram_size += EH_LEN;
-			reassembling_mgr_.ip_packet->TRANSPORT_POS = NEXT_HEADER_SHIFT + reassembling_mgr_.ip_packet->PAYLOAD_POS;;
+			slot->received_datagram_size += EH_LEN;
+			slot->ip_packet->TRANSPORT_POS = NEXT_HEADER_SHIFT + slot->ip_packet->PAYLOAD_POS;;
 			
 			//Next header is compressed with NHC
 			if( is_udp )
 			{
-				uncompress_NHC( reassembling_mgr_.ip_packet );
-				reassembling_mgr_.received_datagram_size += 8;
+				uncompress_NHC( slot->ip_packet );
+				slot->received_datagram_size += 8;
 				UDP_SHIFT += 8;
-				reassembling_mgr_.ip_packet->set_transport_next_header( UDP );
+				slot->ip_packet->set_transport_next_header( UDP );
 				
 				//------------------------------------
 				// UDP LENGHT
@@ -1304,7 +1359,7 @@ namespace wiselib
 					//Full IP packet - IPv6 header - EH headers
 					udp_len = datagram_size - 40 - EH_LEN;
 					
-					reassembling_mgr_.ip_packet->set_real_length( datagram_size - 40 );
+					slot->ip_packet->set_real_length( datagram_size - 40 );
 				}
 				else
 				{
@@ -1312,24 +1367,24 @@ namespace wiselib
 					udp_len = len - ACTUAL_SHIFT + 8;
 					
 					//IP len (+ ext headers)
-					reassembling_mgr_.ip_packet->set_real_length( udp_len + EH_LEN );
+					slot->ip_packet->set_real_length( udp_len + EH_LEN );
 				}
-				reassembling_mgr_.ip_packet->template set_payload<uint16_t>( &udp_len, 4, 1 );
+				slot->ip_packet->template set_payload<uint16_t>( &udp_len, 4, 1 );
 			}
 			else
 			{
 				//Must be ICMPv6
-				reassembling_mgr_.ip_packet->set_transport_next_header( ICMPV6 );
+				slot->ip_packet->set_transport_next_header( ICMPV6 );
 				
 				//Fragmented
 				if( datagram_size != 0 )
 				{
-					reassembling_mgr_.ip_packet->set_real_length( datagram_size - 40 );
+					slot->ip_packet->set_real_length( datagram_size - 40 );
 				}
 				else
 				{
 					//ACT: end of the EH headers
-					reassembling_mgr_.ip_packet->set_real_length( len - ACTUAL_SHIFT + EH_LEN );
+					slot->ip_packet->set_real_length( len - ACTUAL_SHIFT + EH_LEN );
 				}
 			}
 			
@@ -1341,7 +1396,8 @@ namespace wiselib
 	//------------------------------------------------------------------------------------------------------------
 
 		//If there were no headers this is an invalid packet: drop it
-		if( (MESH_SHIFT == MAX_MESSAGE_LENGTH) && (FRAG_SHIFT == MAX_MESSAGE_LENGTH) && (IPHC_SHIFT == MAX_MESSAGE_LENGTH) )
+		if( ( (MESH_SHIFT == MAX_MESSAGE_LENGTH) && (FRAG_SHIFT == MAX_MESSAGE_LENGTH) && (IPHC_SHIFT == MAX_MESSAGE_LENGTH) ) ||
+			slot == NULL )
 		{
 			return;
 		}
@@ -1360,35 +1416,35 @@ namespace wiselib
 		if( fragment_offset != 0 )
 			real_payload_offset -= 40;
 
-		reassembling_mgr_.ip_packet->template set_payload<uint8_t>( buffer_ + ACTUAL_SHIFT, real_payload_offset, len - ACTUAL_SHIFT );
-		reassembling_mgr_.received_datagram_size += len - ACTUAL_SHIFT;
+		slot->ip_packet->template set_payload<uint8_t>( buffer_ + ACTUAL_SHIFT, real_payload_offset, len - ACTUAL_SHIFT );
+		slot->received_datagram_size += len - ACTUAL_SHIFT;
 
 	//----------------------------------------------------------------------------------------
 	// Reassembling		END
 	//----------------------------------------------------------------------------------------
-		//debug().debug( "AS: %i len %i rcvd: %i, full:y %i contetn: %i", ACTUAL_SHIFT, len, reassembling_mgr_.received_datagram_size, reassembling_mgr_.datagram_size, reassembling_mgr_.ip_packet->get_content_size() );
+		//debug().debug( "AS: %i len %i rcvd: %i, full:y %i contetn: %i", ACTUAL_SHIFT, len, slot->received_datagram_size, slot->datagram_size, slot->ip_packet->get_content_size() );
 		if( FRAG_SHIFT == MAX_MESSAGE_LENGTH || 
-		 	reassembling_mgr_.received_datagram_size == reassembling_mgr_.datagram_size )
+		 	slot->received_datagram_size == slot->datagram_size )
 		{
-			reassembling_mgr_.valid = false;
+			reassembling_mgr_.finish_reassembling( slot );
 			
 			//If the checksum was not carried in-line: recalculate it
-			if( reassembling_mgr_.ip_packet->transport_next_header() == UDP && 
-				(reassembling_mgr_.ip_packet->buffer_[6] == 0 &&
-				reassembling_mgr_.ip_packet->buffer_[7] == 0))
+			if( slot->ip_packet->transport_next_header() == UDP && 
+				(slot->ip_packet->buffer_[6] == 0 &&
+				slot->ip_packet->buffer_[7] == 0))
 			{
 				//Generate CHECKSUM, set 0 to the checkum's bytes first
 // 				uint16_t tmp = 0;
-// 				reassembling_mgr_.ip_packet->template set_payload<uint16_t>( &(tmp), 6 );
+// 				slot->ip_packet->template set_payload<uint16_t>( &(tmp), 6 );
 			
-				uint16_t tmp = reassembling_mgr_.ip_packet->generate_checksum();
-				reassembling_mgr_.ip_packet->template set_payload<uint16_t>( &(tmp), 6 );
+				uint16_t tmp = slot->ip_packet->generate_checksum();
+				slot->ip_packet->template set_payload<uint16_t>( &(tmp), 6 );
 			}
 			
-			reassembling_mgr_.ip_packet->target_interface = INTERFACE_RADIO;
-			reassembling_mgr_.ip_packet->remote_ll_address = from;
+			slot->ip_packet->target_interface = INTERFACE_RADIO;
+			slot->ip_packet->remote_ll_address = from;
 
-			notify_receivers( from, reassembling_mgr_.ip_packet_number, NULL );
+			notify_receivers( from, slot->ip_packet_number, NULL );
 		}
 		
 	}
@@ -2000,6 +2056,85 @@ namespace wiselib
 
 //-------------------------------------------------------------------------------------
 	
+	#if LOWPAN_FLOW_CACHE_SIZE > 0
+	template<typename OsModel_P,
+		typename Radio_P,
+		typename Debug_P,
+		typename Timer_P,
+		typename Uart_Radio_P>
+	bool
+	LoWPAN<OsModel_P, Radio_P, Debug_P, Timer_P, Uart_Radio_P>::
+	flow_cache_compress( IPv6Packet_t* ip_packet, node_id_t* link_local_destination )
+	{
+		typename Flow_Cache_t::Entry* entry = flow_cache_.find( ip_packet, *link_local_destination );
+		if( entry == NULL )
+			return false;
+		
+		//Refresh the used contexts as the full compression does, an expired context invalidates the template
+		if( ( entry->source_context < LOWPAN_CONTEXTS_NUMBER && context_mgr_.get_prefix_by_number( entry->source_context ) == NULL ) ||
+			( entry->destination_context < LOWPAN_CONTEXTS_NUMBER && context_mgr_.get_prefix_by_number( entry->destination_context ) == NULL ) )
+		{
+			entry->valid = false;
+			return false;
+		}
+		
+		IPHC_SHIFT = ACTUAL_SHIFT;
+		memcpy( buffer_ + ACTUAL_SHIFT, entry->header, entry->header_length );
+		ACTUAL_SHIFT += entry->header_length;
+		
+		//The checksum is always carried in-line
+		if( entry->NHC_position != 0 )
+		{
+			NHC_SHIFT = IPHC_SHIFT + entry->NHC_position;
+			memcpy( buffer_ + ACTUAL_SHIFT, ip_packet->payload() + 6, 2 );
+			ACTUAL_SHIFT += 2;
+		}
+		return true;
+	}
+	
+//-------------------------------------------------------------------------------------
+	
+	template<typename OsModel_P,
+		typename Radio_P,
+		typename Debug_P,
+		typename Timer_P,
+		typename Uart_Radio_P>
+	void
+	LoWPAN<OsModel_P, Radio_P, Debug_P, Timer_P, Uart_Radio_P>::
+	flow_cache_store( IPv6Packet_t* ip_packet, node_id_t* link_local_destination )
+	{
+		//Without the in-line checksum of the NHC
+		uint8_t length = ACTUAL_SHIFT - IPHC_SHIFT;
+		uint8_t NHC_position = 0;
+		if( NHC_SHIFT != MAX_MESSAGE_LENGTH )
+		{
+			length -= 2;
+			NHC_position = NHC_SHIFT - IPHC_SHIFT;
+		}
+		
+		typename Flow_Cache_t::Entry* entry = flow_cache_.store( ip_packet, *link_local_destination, buffer_ + IPHC_SHIFT, length, NHC_position );
+		if( entry == NULL )
+			return;
+		
+		//Read back the used contexts from the CID byte
+		if( 1 == bitwise_read<OsModel, block_data_t, uint8_t>( buffer_ + IPHC_SHIFT + IPHC_CID_BYTE, IPHC_CID_BIT, IPHC_CID_LEN ) )
+		{
+			uint8_t CID_value = buffer_[IPHC_SHIFT + 2];
+			
+			//SAC=1 SAM=00 is the unspecified address without context
+			if( 1 == bitwise_read<OsModel, block_data_t, uint8_t>( buffer_ + IPHC_SHIFT + IPHC_SAC_BYTE, IPHC_SAC_BIT, IPHC_SAC_LEN ) &&
+				0 != bitwise_read<OsModel, block_data_t, uint8_t>( buffer_ + IPHC_SHIFT + IPHC_SAM_BYTE, IPHC_SAM_BIT, IPHC_SAM_LEN ) )
+				entry->source_context = CID_value >> 4;
+			
+			if( 0 == bitwise_read<OsModel, block_data_t, uint8_t>( buffer_ + IPHC_SHIFT + IPHC_M_BYTE, IPHC_M_BIT, IPHC_M_LEN ) &&
+				1 == bitwise_read<OsModel, block_data_t, uint8_t>( buffer_ + IPHC_SHIFT + IPHC_DAC_BYTE, IPHC_DAC_BIT, IPHC_DAC_LEN ) )
+				entry->destination_context = CID_value & 0x0F;
+		}
+	}
+	
+//-------------------------------------------------------------------------------------
+	#endif
+	
 	template<typename OsModel_P,
 		typename Radio_P,
 		typename Debug_P,
@@ -31,6 +31,9 @@
 //Number of neighbors in the neighbor cache
 #define LOWPAN_MAX_OF_NEIGHBORS 10
 
+//Number of hash buckets for the neighbor cache lookup, it must be a power of 2
+#define LOWPAN_NEIGHBOR_HASH_SIZE 8
+
 //Number of routers in the default routers' list
 #define LOWPAN_MAX_OF_ROUTERS 5
 
@@ -40,6 +43,9 @@
 //Timeout in ms for a packet via the Radio (handle lost fragments)
 #define LOWPAN_REASSEMBLING_TIMEOUT 250
 
+//Number of cached IPHC/NHC header templates for the outgoing flows, 0 disables the cache
+#define LOWPAN_FLOW_CACHE_SIZE 4
+
 //The maximum of stored mesh broadcast sequence numbers
 #define MAX_BROADCAST_SEQUENCE_NUMBERS 15
 
@@ -51,9 +57,22 @@
 	#define IP_PACKET_POOL_SIZE 8
 #endif
 
+//Number of datagrams reassembled concurrently. Each slot holds an IP packet from the pool
+//until the datagram is complete, so one packet is always left for sending and forwarding
+#define LOWPAN_REASSEMBLING_SLOTS (IP_PACKET_POOL_SIZE > 1 ? IP_PACKET_POOL_SIZE - 1 : 1)
+
 //Forwarding table size in the IPv6 layer
 #define FORWARDING_TABLE_SIZE 5
 
+//Number of packets waiting for a route discovery in the IPv6 layer (ROUTE OVER only)
+#define LOWPAN_PENDING_QUEUE_SIZE IP_PACKET_POOL_SIZE
+
+//Number of waiting packets for the same destination
+#define LOWPAN_PENDING_PER_DESTINATION 2
+
+//Timeout in ms for the waiting packets if the routing does not answer
+#define LOWPAN_PENDING_TIMEOUT 3000
+
 //Minimum: 1, the index starts from 0 at the get_interface function!
 #define NUMBER_OF_INTERFACES 2
 
@@ -63,6 +82,12 @@
 //Enable the Router Solicitation messages on the UART interface
 // #define IPv6_SLIP
 
+//Longest-prefix-match forwarding table with prefix routes (ROUTE OVER only)
+//Recommended for border routers, increase FORWARDING_TABLE_SIZE for many downstream nodes
+#ifdef IPv6_SLIP
+	#define LOWPAN_LPM_FORWARDING
+#endif
+
 //Select routing method
 #define LOWPAN_ROUTE_OVER
 //#define LOWPAN_MESH_UNDER
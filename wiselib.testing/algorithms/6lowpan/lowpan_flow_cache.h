@@ -0,0 +1,190 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+/*
+* File: lowpan_flow_cache.h
+* Class(es): LoWPANFlowCache
+*/
+
+#ifndef __ALGORITHMS_6LOWPAN_LOWPAN_FLOW_CACHE_H__
+#define __ALGORITHMS_6LOWPAN_LOWPAN_FLOW_CACHE_H__
+
+#include "algorithms/6lowpan/ipv6_packet.h"
+
+namespace wiselib
+{
+	/** \brief Compressed header templates of the recent outgoing flows
+	*
+	* A flow is identified by the IPv6 header without the payload length, the UDP
+	* ports and the link-layer destination. Packets with extension headers are not
+	* cached. LOWPAN_FLOW_CACHE_SIZE entries are kept, the oldest stored one is
+	* replaced first. The LoWPAN layer fills the templates and checks the contexts.
+	*/
+	template<typename OsModel_P,
+		typename Radio_P,
+		typename Debug_P>
+	class LoWPANFlowCache
+	{
+	public:
+		typedef OsModel_P OsModel;
+		typedef Radio_P Radio;
+		typedef Debug_P Debug;
+		typedef typename Radio::node_id_t node_id_t;
+		typedef typename Radio::block_data_t block_data_t;
+		
+		typedef IPv6Packet<OsModel, Radio, Debug> IPv6Packet_t;
+		
+		enum FlowCacheLengths
+		{
+			///IPv6 header without the payload length + UDP ports
+			KEY_LEN = 42,
+			///IPHC with CID byte and in-line fields + NHC without the checksum
+			HEADER_MAX_LEN = 48
+		};
+		
+		/** \brief Compressed header template of an outgoing flow
+		*/
+		struct Entry
+		{
+			block_data_t key[KEY_LEN];
+			///The address elision depends on the link-layer destination
+			node_id_t mac_destination;
+			block_data_t header[HEADER_MAX_LEN];
+			uint8_t header_length;
+			///Position of the NHC in the header, 0 if there is no NHC
+			uint8_t NHC_position;
+			///The used contexts, LOWPAN_CONTEXTS_NUMBER if not used
+			uint8_t source_context;
+			uint8_t destination_context;
+			bool valid;
+		};
+		
+		// -----------------------------------------------------------------
+		///Constructor
+		LoWPANFlowCache()
+		{
+			clear();
+		}
+		
+		/**
+		* Drop every template
+		*/
+		void clear()
+		{
+			for( int i = 0; i < LOWPAN_FLOW_CACHE_SIZE; i++ )
+				entries_[i].valid = false;
+			next_ = 0;
+		}
+		
+		/**
+		* Look up the template of the flow of a packet
+		* \param ip_packet pointer to the actual IP packet
+		* \param mac_destination the link-layer destination
+		* \return the entry or NULL if the flow is not cached
+		*/
+		Entry* find( IPv6Packet_t* ip_packet, node_id_t mac_destination )
+		{
+			if( !cacheable( ip_packet ) )
+				return NULL;
+			
+			block_data_t key[KEY_LEN];
+			make_key( ip_packet, key );
+			
+			for( int i = 0; i < LOWPAN_FLOW_CACHE_SIZE; i++ )
+				if( entries_[i].valid && entries_[i].mac_destination == mac_destination &&
+					memcmp( entries_[i].key, key, KEY_LEN ) == 0 )
+					return &( entries_[i] );
+			return NULL;
+		}
+		
+		/**
+		* Store the compressed headers of a packet as the template of its flow
+		* The contexts of the returned entry are set to unused.
+		* \param ip_packet pointer to the actual IP packet
+		* \param mac_destination the link-layer destination
+		* \param header the IPHC and NHC headers without the in-line UDP checksum
+		* \param length the length of the header
+		* \param NHC_position position of the NHC in the header, 0 if there is no NHC
+		* \return the stored entry, NULL if the packet is not cached
+		*/
+		Entry* store( IPv6Packet_t* ip_packet, node_id_t mac_destination, block_data_t* header, uint8_t length, uint8_t NHC_position )
+		{
+			if( !cacheable( ip_packet ) || length > HEADER_MAX_LEN )
+				return NULL;
+			
+			Entry& entry = entries_[next_];
+			next_ = ( next_ + 1 ) % LOWPAN_FLOW_CACHE_SIZE;
+			
+			make_key( ip_packet, entry.key );
+			entry.mac_destination = mac_destination;
+			memcpy( entry.header, header, length );
+			entry.header_length = length;
+			entry.NHC_position = NHC_position;
+			entry.source_context = LOWPAN_CONTEXTS_NUMBER;
+			entry.destination_context = LOWPAN_CONTEXTS_NUMBER;
+			entry.valid = true;
+			return &entry;
+		}
+		
+		/**
+		* Number of the valid templates
+		*/
+		uint8_t size()
+		{
+			uint8_t n = 0;
+			for( int i = 0; i < LOWPAN_FLOW_CACHE_SIZE; i++ )
+				if( entries_[i].valid )
+					n++;
+			return n;
+		}
+		
+	private:
+		/**
+		* The extension headers are not cached
+		*/
+		bool cacheable( IPv6Packet_t* ip_packet )
+		{
+			uint8_t next_header = ip_packet->real_next_header();
+			return next_header == IPv6Packet_t::UDP || next_header == IPv6Packet_t::ICMPV6;
+		}
+		
+		/**
+		* Collect the fields which determine the compressed headers of a packet
+		* \param ip_packet pointer to the actual IP packet
+		* \param key KEY_LEN bytes (return)
+		*/
+		void make_key( IPv6Packet_t* ip_packet, block_data_t* key )
+		{
+			//Version, traffic class, flow label
+			memcpy( key, ip_packet->buffer_, 4 );
+			//Next header, hop limit, source and destination addresses
+			memcpy( key + 4, ip_packet->buffer_ + 6, 34 );
+			//UDP ports
+			if( ip_packet->real_next_header() == IPv6Packet_t::UDP )
+				memcpy( key + 38, ip_packet->payload(), 4 );
+			else
+				memset( key + 38, 0, 4 );
+		}
+		
+		Entry entries_[LOWPAN_FLOW_CACHE_SIZE];
+		///The next entry to be replaced
+		uint8_t next_;
+	};
+}
+#endif
@@ -0,0 +1,457 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+/*
+* File: lpm_forwarding_table.h
+* Class(es): LpmForwardingTable
+*/
+
+#ifndef __ALGORITHMS_6LOWPAN_LPM_FORWARDING_TABLE_H__
+#define __ALGORITHMS_6LOWPAN_LPM_FORWARDING_TABLE_H__
+
+#include "util/pstl/pair.h"
+
+namespace wiselib
+{
+	/** \brief Forwarding table with longest-prefix-match lookup for IPv6 addresses
+	*
+	* The routes are prefixes (address + prefix length) stored in a path-compressed
+	* binary trie, so lookup() walks at most one node per distinguishing bit instead of
+	* comparing the destination against every entry.
+	*
+	* The table can be used as a drop-in replacement for StaticArrayRoutingTable:
+	* the map interface (find, insert, erase, operator[]) works on host routes (/128),
+	* the NULL_NODE_ID key stands for the default route (::/0). Prefix routes are added
+	* with insert_prefix(). Entries and trie nodes are stored in static arrays, iterators
+	* stay valid until their entry is erased.
+	*/
+	template<typename OsModel_P,
+		typename Radio_P,
+		unsigned int TABLE_SIZE,
+		typename Value_P = typename Radio_P::node_id_t>
+	class LpmForwardingTable
+	{
+	public:
+		typedef OsModel_P OsModel;
+		typedef Radio_P Radio;
+
+		typedef LpmForwardingTable<OsModel, Radio, TABLE_SIZE, Value_P> self_type;
+
+		typedef typename Radio::node_id_t key_type;
+		typedef Value_P mapped_type;
+		typedef pair<key_type, mapped_type> value_type;
+		typedef value_type* pointer;
+		typedef value_type& reference;
+		typedef unsigned int size_type;
+
+		enum { ADDRESS_BITS = 128 };
+
+		/** \brief Iterator over the used entries
+		*/
+		class iterator
+		{
+		public:
+			iterator() : table_( 0 ), index_( 0 ) {}
+			iterator( self_type* table, size_type index ) : table_( table ), index_( index ) { skip(); }
+
+			reference operator*() { return table_->entries_[index_]; }
+			pointer operator->() { return &( table_->entries_[index_] ); }
+
+			iterator& operator++()
+			{
+				index_++;
+				skip();
+				return *this;
+			}
+
+			bool operator==( const iterator& other ) const { return index_ == other.index_; }
+			bool operator!=( const iterator& other ) const { return index_ != other.index_; }
+
+			size_type index() const { return index_; }
+
+		private:
+			void skip()
+			{
+				while( index_ < TABLE_SIZE && !table_->used_[index_] )
+					index_++;
+			}
+
+			self_type* table_;
+			size_type index_;
+		};
+
+		// -----------------------------------------------------------------
+		LpmForwardingTable()
+		{
+			clear();
+		}
+
+		// -----------------------------------------------------------------
+		///@name Iterators
+		///@{
+		iterator begin() { return iterator( this, 0 ); }
+		iterator end() { return iterator( this, TABLE_SIZE ); }
+		///@}
+
+		// -----------------------------------------------------------------
+		///@name Capacity
+		///@{
+		size_type size() { return size_; }
+		size_type max_size() { return TABLE_SIZE; }
+		bool empty() { return size_ == 0; }
+		bool full() { return size_ == TABLE_SIZE; }
+		///@}
+
+		// -----------------------------------------------------------------
+		///@name Element Access
+		///@{
+		mapped_type& operator[]( const key_type& k )
+		{
+			iterator it = insert( value_type( k, mapped_type() ) ).first;
+			if( it != end() )
+				return it->second;
+
+			// return dummy value that can be written to if the table is full,
+			// like StaticArrayRoutingTable does
+			return dummy_;
+		}
+		///@}
+
+		// -----------------------------------------------------------------
+		///@name Modifiers
+		///@{
+		/** Insert a host route, or the default route for NULL_NODE_ID
+		*/
+		pair<iterator, bool> insert( const value_type& x )
+		{
+			return insert_prefix( x.first, host_prefix_length( x.first ), x.second );
+		}
+
+		/** Insert a prefix route
+		* \param prefix the prefix, bits after prefix_length are ignored
+		* \param prefix_length length of the prefix in bits (0..128)
+		* \param value the route
+		* \return the iterator of the (new or already existing) entry and true if it is new,
+		* end() if the table is full
+		*/
+		pair<iterator, bool> insert_prefix( const key_type& prefix, uint8_t prefix_length, const mapped_type& value )
+		{
+			if( prefix_length > ADDRESS_BITS )
+				prefix_length = ADDRESS_BITS;
+			
+			if( full() )
+			{
+				iterator it = find_prefix( prefix, prefix_length );
+				return pair<iterator, bool>( it, false );
+			}
+
+			uint16_t n = ROOT;
+			for( ;; )
+			{
+				if( nodes_[n].length == prefix_length )
+				{
+					if( nodes_[n].entry != NONE )
+						return pair<iterator, bool>( iterator( this, nodes_[n].entry ), false );
+
+					uint16_t e = new_entry( prefix, prefix_length, value, n );
+					if( e == NONE )
+						return pair<iterator, bool>( end(), false );
+					nodes_[n].entry = e;
+					return pair<iterator, bool>( iterator( this, e ), true );
+				}
+
+				uint8_t b = bit( prefix.addr, nodes_[n].length );
+				uint16_t c = nodes_[n].child[b];
+				if( c == NONE )
+				{
+					uint16_t leaf = new_node( prefix.addr, prefix_length );
+					if( leaf == NONE )
+						return pair<iterator, bool>( end(), false );
+					uint16_t e = new_entry( prefix, prefix_length, value, leaf );
+					if( e == NONE )
+					{
+						free_node( leaf );
+						return pair<iterator, bool>( end(), false );
+					}
+					nodes_[leaf].entry = e;
+					link( n, b, leaf );
+					return pair<iterator, bool>( iterator( this, e ), true );
+				}
+
+				uint8_t limit = prefix_length < nodes_[c].length ? prefix_length : nodes_[c].length;
+				uint8_t m = common_length( prefix.addr, nodes_[c].prefix, limit );
+
+				//The child is on the path of the prefix
+				if( m == nodes_[c].length )
+				{
+					n = c;
+					continue;
+				}
+
+				//The new prefix has to be placed between n and c, as c's parent
+				//or as a branch node at the first differing bit
+				uint16_t p = new_node( prefix.addr, m );
+				if( p == NONE )
+					return pair<iterator, bool>( end(), false );
+				link( p, bit( nodes_[c].prefix, m ), c );
+				link( n, b, p );
+				n = p;
+			}
+		}
+
+		/** Erase an entry
+		*/
+		void erase( iterator it )
+		{
+			if( it == end() )
+				return;
+
+			uint16_t e = it.index();
+			uint16_t n = node_of_[e];
+			free_entry( e );
+			nodes_[n].entry = NONE;
+
+			//Remove the nodes which are not required anymore
+			while( n != ROOT && nodes_[n].entry == NONE )
+			{
+				uint16_t parent = nodes_[n].parent;
+				uint8_t side = nodes_[parent].child[1] == n;
+
+				if( nodes_[n].child[0] != NONE && nodes_[n].child[1] != NONE )
+					break;
+
+				uint16_t c = nodes_[n].child[0] != NONE ? nodes_[n].child[0] : nodes_[n].child[1];
+				if( c != NONE )
+				{
+					//Only one child: splice the node out
+					link( parent, side, c );
+					free_node( n );
+					break;
+				}
+
+				nodes_[parent].child[side] = NONE;
+				free_node( n );
+				n = parent;
+			}
+		}
+
+		void clear()
+		{
+			//Unused entries are chained through node_of_
+			for( uint16_t i = 0; i < TABLE_SIZE; i++ )
+			{
+				used_[i] = false;
+				node_of_[i] = i + 1;
+			}
+			node_of_[TABLE_SIZE - 1] = NONE;
+			free_entries_ = 0;
+
+			//Node 0 is the root (::/0), the others are chained into the free list
+			for( uint16_t i = 0; i < NODES; i++ )
+				nodes_[i].child[0] = i + 1;
+			nodes_[NODES - 1].child[0] = NONE;
+			free_nodes_ = 1;
+
+			memset( nodes_[ROOT].prefix, 0, 16 );
+			nodes_[ROOT].length = 0;
+			nodes_[ROOT].entry = NONE;
+			nodes_[ROOT].parent = NONE;
+			nodes_[ROOT].child[0] = NONE;
+			nodes_[ROOT].child[1] = NONE;
+
+			size_ = 0;
+		}
+		///@}
+
+		// -----------------------------------------------------------------
+		///@name Operations
+		///@{
+		/** Find a host route, or the default route for NULL_NODE_ID
+		*/
+		iterator find( const key_type& k )
+		{
+			return find_prefix( k, host_prefix_length( k ) );
+		}
+
+		/** Find the entry of exactly this prefix
+		*/
+		iterator find_prefix( const key_type& prefix, uint8_t prefix_length )
+		{
+			uint16_t n = ROOT;
+			while( n != NONE && nodes_[n].length < prefix_length )
+			{
+				n = nodes_[n].child[bit( prefix.addr, nodes_[n].length )];
+				if( n != NONE && common_length( prefix.addr, nodes_[n].prefix, nodes_[n].length ) < nodes_[n].length )
+					return end();
+			}
+
+			if( n == NONE || nodes_[n].length != prefix_length || nodes_[n].entry == NONE )
+				return end();
+			return iterator( this, nodes_[n].entry );
+		}
+
+		/** Longest prefix match
+		* \return the entry with the longest prefix that covers the address, end() if none
+		*/
+		iterator lookup( const key_type& address )
+		{
+			uint16_t best = nodes_[ROOT].entry;
+			uint16_t n = ROOT;
+			while( nodes_[n].length < ADDRESS_BITS )
+			{
+				n = nodes_[n].child[bit( address.addr, nodes_[n].length )];
+				if( n == NONE || common_length( address.addr, nodes_[n].prefix, nodes_[n].length ) < nodes_[n].length )
+					break;
+				if( nodes_[n].entry != NONE )
+					best = nodes_[n].entry;
+			}
+
+			if( best == NONE )
+				return end();
+			return iterator( this, best );
+		}
+
+		/** The prefix length of an entry
+		*/
+		uint8_t prefix_length( iterator it )
+		{
+			return nodes_[node_of_[it.index()]].length;
+		}
+		///@}
+
+	private:
+		enum
+		{
+			NODES = 2 * TABLE_SIZE + 1,
+			ROOT = 0,
+			NONE = 0xFFFF
+		};
+
+		/** Node of the trie: the first length bits of prefix are common for the subtree
+		*/
+		struct Node
+		{
+			uint8_t prefix[16];
+			uint8_t length;
+			uint16_t entry;
+			uint16_t parent;
+			uint16_t child[2];
+		};
+
+		static uint8_t host_prefix_length( const key_type& k )
+		{
+			for( uint8_t i = 0; i < 16; i++ )
+				if( k.addr[i] != 0 )
+					return ADDRESS_BITS;
+			return 0;
+		}
+
+		static uint8_t bit( const uint8_t* a, uint8_t i )
+		{
+			return ( a[i >> 3] >> ( 7 - ( i & 0x07 ) ) ) & 0x01;
+		}
+
+		/** Number of equal leading bits of a and b, at most limit
+		*/
+		static uint8_t common_length( const uint8_t* a, const uint8_t* b, uint8_t limit )
+		{
+			uint8_t i = 0;
+			while( i < limit && a[i >> 3] == b[i >> 3] )
+				i += 8;
+			if( i >= limit )
+				return limit;
+
+			uint8_t x = a[i >> 3] ^ b[i >> 3];
+			while( !( x & 0x80 ) )
+			{
+				x <<= 1;
+				i++;
+			}
+			return i < limit ? i : limit;
+		}
+
+		void link( uint16_t parent, uint8_t side, uint16_t child )
+		{
+			nodes_[parent].child[side] = child;
+			nodes_[child].parent = parent;
+		}
+
+		uint16_t new_node( const uint8_t* prefix, uint8_t length )
+		{
+			uint16_t n = free_nodes_;
+			if( n == NONE )
+				return NONE;
+			free_nodes_ = nodes_[n].child[0];
+
+			//Only the first length bits are kept
+			memset( nodes_[n].prefix, 0, 16 );
+			memcpy( nodes_[n].prefix, prefix, ( length + 7 ) / 8 );
+			if( length & 0x07 )
+				nodes_[n].prefix[length >> 3] &= 0xFF << ( 8 - ( length & 0x07 ) );
+
+			nodes_[n].length = length;
+			nodes_[n].entry = NONE;
+			nodes_[n].parent = NONE;
+			nodes_[n].child[0] = NONE;
+			nodes_[n].child[1] = NONE;
+			return n;
+		}
+
+		void free_node( uint16_t n )
+		{
+			nodes_[n].child[0] = free_nodes_;
+			free_nodes_ = n;
+		}
+
+		uint16_t new_entry( const key_type& prefix, uint8_t length, const mapped_type& value, uint16_t node )
+		{
+			uint16_t e = free_entries_;
+			if( e == NONE )
+				return NONE;
+			free_entries_ = node_of_[e];
+
+			used_[e] = true;
+			entries_[e].first = prefix;
+			entries_[e].second = value;
+			node_of_[e] = node;
+			size_++;
+			return e;
+		}
+
+		void free_entry( uint16_t e )
+		{
+			used_[e] = false;
+			node_of_[e] = free_entries_;
+			free_entries_ = e;
+			size_--;
+		}
+
+		value_type entries_[TABLE_SIZE];
+		bool used_[TABLE_SIZE];
+		uint16_t node_of_[TABLE_SIZE];
+		uint16_t free_entries_;
+
+		Node nodes_[NODES];
+		uint16_t free_nodes_;
+
+		size_type size_;
+		mapped_type dummy_;
+	};
+}
+#endif
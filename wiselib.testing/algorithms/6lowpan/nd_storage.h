@@ -120,6 +120,12 @@ namespace wiselib
 				TENTATIVE = NeighborCacheEntryType_t::TENTATIVE
 			};
 			
+			NeighborCache_DefaultRouters()
+			{
+				for( int i = 0; i < LOWPAN_NEIGHBOR_HASH_SIZE; i++ )
+					bucket_head_[i] = LOWPAN_MAX_OF_NEIGHBORS;
+			}
+			
 			/**
 			* Updates a Neighbor Cache entry or creates a new one.
 			* An entry could be deleted with 0 lifetime and !is_tentative
@@ -139,8 +145,10 @@ namespace wiselib
 				IPv6Addr_t link_local_ip = *(ip_address);
 				link_local_ip.make_it_link_local();
 				
-				//Search for the IP address in the list
-				for( int i = 0; i < LOWPAN_MAX_OF_NEIGHBORS; i++ )
+				//Search for the IP address in its bucket, the link-local address has the same IID
+				uint8_t bucket = neighbor_bucket( ip_address );
+				uint8_t previous = LOWPAN_MAX_OF_NEIGHBORS;
+				for( uint8_t i = bucket_head_[bucket]; i != LOWPAN_MAX_OF_NEIGHBORS; previous = i, i = next_in_bucket_[i] )
 				{
 					//If there is an entry with this IP
 					if( neighbors_[i].ip_address == *(ip_address) || (neighbors_[i].ip_address == link_local_ip))
@@ -153,6 +161,11 @@ namespace wiselib
 								if( !is_tentative )
 								{
 									//This is a message to delete this entry
+									if( previous == LOWPAN_MAX_OF_NEIGHBORS )
+										bucket_head_[bucket] = next_in_bucket_[i];
+									else
+										next_in_bucket_[previous] = next_in_bucket_[i];
+									
 									neighbors_[i].status = GARBAGECOLLECTIBLE;
 									neighbors_[i].link_layer_address = 0;
 									neighbors_[i].ip_address = IPv6Addr_t();
@@ -182,9 +195,15 @@ namespace wiselib
 						}
 						
 					}
-					if( selected_place == LOWPAN_MAX_OF_NEIGHBORS &&
-						neighbors_[i].status == GARBAGECOLLECTIBLE )
+				}
+				
+				for( int i = 0; i < LOWPAN_MAX_OF_NEIGHBORS; i++ )
+				{
+					if( neighbors_[i].status == GARBAGECOLLECTIBLE )
+					{
 						selected_place = i;
+						break;
+					}
 				}
 				
 				if( selected_place == LOWPAN_MAX_OF_NEIGHBORS )
@@ -197,6 +216,21 @@ namespace wiselib
 				
 				neighbors_[selected_place].ip_address = *(ip_address);
 				neighbors_[selected_place].link_layer_address = (uint64_t)ll_address;
+				
+				//The bucket is kept in index order, so the first match is the same as in the array
+				if( bucket_head_[bucket] == LOWPAN_MAX_OF_NEIGHBORS || bucket_head_[bucket] > selected_place )
+				{
+					next_in_bucket_[selected_place] = bucket_head_[bucket];
+					bucket_head_[bucket] = selected_place;
+				}
+				else
+				{
+					previous = bucket_head_[bucket];
+					while( next_in_bucket_[previous] != LOWPAN_MAX_OF_NEIGHBORS && next_in_bucket_[previous] < selected_place )
+						previous = next_in_bucket_[previous];
+					next_in_bucket_[selected_place] = next_in_bucket_[previous];
+					next_in_bucket_[previous] = selected_place;
+				}
 				neighbors_[selected_place].is_router = false;
 				neighbors_[selected_place].lifetime = lifetime;
 				number_of_neighbor = selected_place;
@@ -223,9 +257,9 @@ namespace wiselib
 			*/
 			node_id_t get_link_layer_address_for_neighbor( IPv6Addr_t* ip_address )
 			{
-				for( int i = 0; i < LOWPAN_MAX_OF_NEIGHBORS; i++ )
+				for( uint8_t i = bucket_head_[neighbor_bucket( ip_address )]; i != LOWPAN_MAX_OF_NEIGHBORS; i = next_in_bucket_[i] )
 					if( neighbors_[i].ip_address == *(ip_address) &&
-						neighbors_[i].ip_address == REGISTERED )
+						neighbors_[i].status == REGISTERED )
 						return (node_id_t)(neighbors_[i].link_layer_address);
 				return 0;
 			}
@@ -338,8 +372,24 @@ namespace wiselib
 			}
 			
 		private:
+			/**
+			* Hash bucket of an address, computed from the interface identifier (last 8 bytes)
+			* so an address and its link-local form are in the same bucket
+			*/
+			uint8_t neighbor_bucket( IPv6Addr_t* ip_address )
+			{
+				uint8_t h = 0;
+				for( int i = 8; i < 16; i++ )
+					h = ( h * 31 ) + ip_address->addr[i];
+				return h & ( LOWPAN_NEIGHBOR_HASH_SIZE - 1 );
+			}
+			
 			///Array for the neighbors (Neighbor Cache)
 			NeighborCacheEntryType_t neighbors_[LOWPAN_MAX_OF_NEIGHBORS];
+			///First neighbor in each hash bucket, LOWPAN_MAX_OF_NEIGHBORS if empty
+			uint8_t bucket_head_[LOWPAN_NEIGHBOR_HASH_SIZE];
+			///Next neighbor in the same hash bucket
+			uint8_t next_in_bucket_[LOWPAN_MAX_OF_NEIGHBORS];
 			///Array for the routers (Default Router List)
 			DefaultRouterEntryType_t routers_[LOWPAN_MAX_OF_ROUTERS];
 			
@@ -28,11 +28,17 @@
 
 #include "algorithms/6lowpan/ipv6_packet_pool_manager.h"
 
-#define MAX_FRAGMENTS 16
+//Bytes of the received fragment bitmap, one bit per 8 octet offset unit
+#define LOWPAN_REASSEMBLING_BITMAP_SIZE ((LOWPAN_IP_PACKET_BUFFER_MAX_SIZE / 8 + 7) / 8)
 
 namespace wiselib
 {
 	/** \brief This manager deals with the reassebling of the 6LoWPAN fragments
+	*
+	* Up to LOWPAN_REASSEMBLING_SLOTS datagrams are reassembled at the same time,
+	* every one of them in its own slot. A slot is identified by the
+	* (sender, tag, size) triple of the fragmentation header, received fragments are
+	* registered in a bitmap indexed by the offset and every slot has its own timeout.
 	*/
 	template<typename OsModel_P,
 		typename Radio_P,
@@ -52,11 +58,91 @@ namespace wiselib
 
 		typedef LoWPANReassemblingManager<OsModel, Radio, Debug, Timer> self_type;
 
+		/** \brief State of one reassembling process
+		*/
+		struct Slot
+		{
+			/**
+			* Function to determinate that the received packet is a duplicate or not
+			* A fragment that overlaps an already received one is treated as a duplicate,
+			* its bytes would be counted twice for the completion of the datagram.
+			* \param offset the new offset
+			* \param units the number of 8 octet units covered by the fragment
+			* \return true if this is new, false otherwise
+			*/
+			bool is_it_new_offset( uint8_t offset, uint8_t units = 1 )
+			{
+				if( units == 0 )
+					units = 1;
+				
+				//Fragment out of the IP packet buffer: treat it as a duplicate, it will be dropped
+				if( offset + units > LOWPAN_REASSEMBLING_BITMAP_SIZE * 8 )
+					return false;
+				
+				for( int i = offset; i < offset + units; i++ )
+					if( rcvd_offsets_[i >> 3] & ( 1 << ( i & 0x07 ) ) )
+						return false;
+				
+				//This is a new fragment, save the covered units
+				for( int i = offset; i < offset + units; i++ )
+					rcvd_offsets_[i >> 3] |= 1 << ( i & 0x07 );
+				return true;
+			}
+			
+			/**
+			* The fargmentation process in this slot is still valid
+			*/
+			bool valid;
+			/**
+			* Tag code for the actual packet
+			*/
+			uint16_t datagram_tag;
+			/**
+			* Size of the IPv6 packet
+			*/
+			uint16_t datagram_size;
+			/**
+			* Size of the received fragments
+			*/
+			uint16_t received_datagram_size;
+			/**
+			* Reference to the used IP packet from the pool
+			*/
+			IPv6Packet_t* ip_packet;
+			/**
+			* Number of the used IP packet from the pool
+			*/
+			uint8_t ip_packet_number;
+			/**
+			* The Sender of the currently reassembled packet
+			*/
+			node_id_t frag_sender;
+			
+			/**
+			* Tag code for the previous packet in this slot
+			*/
+			uint16_t previous_datagram_tag_;
+			/**
+			* The Sender of the previously reassembled packet in this slot
+			*/
+			node_id_t previous_frag_sender_;
+			/**
+			* Identifier of the running process, passed to the timer
+			*/
+			uint16_t sequence_;
+			/**
+			* Bitmap of the received 8 octet units
+			* A packet can be received more than one time
+			*/
+			uint8_t rcvd_offsets_[LOWPAN_REASSEMBLING_BITMAP_SIZE];
+		};
+
 		// -----------------------------------------------------------------
 		///Constructor
 		LoWPANReassemblingManager()
 			{
-				valid = false;
+				for( int i = 0; i < LOWPAN_REASSEMBLING_SLOTS; i++ )
+					slots_[i].valid = false;
 			}
 
 		// -----------------------------------------------------------------
@@ -69,8 +155,34 @@ namespace wiselib
 			timer_ = &timer;
 			debug_ = &debug;
 			packet_pool_mgr_ = p_mgr;
-			previous_datagram_tag_ = 0;
-			previous_frag_sender_ = 0;
+			sequence_ = 0;
+			for( int i = 0; i < LOWPAN_REASSEMBLING_SLOTS; i++ )
+			{
+				slots_[i].valid = false;
+				slots_[i].previous_datagram_tag_ = 0;
+				slots_[i].previous_frag_sender_ = 0;
+				slots_[i].sequence_ = 0;
+			}
+		}
+		
+		// -----------------------------------------------------------------
+		
+		/**
+		* Find the running reassembling process of a fragment
+		* \param sender the MAC address of the sender node
+		* \param tag tag code from the fragmentation header
+		* \param size the size of the full datagram
+		* \return the slot of the process, or NULL if there is no such process
+		*/
+		Slot* find_reassembling( node_id_t sender, uint16_t tag, uint16_t size )
+		{
+			for( int i = 0; i < LOWPAN_REASSEMBLING_SLOTS; i++ )
+			{
+				Slot& s = slots_[i];
+				if( s.valid && s.datagram_tag == tag && s.frag_sender == sender && s.datagram_size == size )
+					return &s;
+			}
+			return NULL;
 		}
 		
 		// -----------------------------------------------------------------
@@ -80,61 +192,74 @@ namespace wiselib
 		* \param size the size of the full datagram
 		* \param sender the MAC address of the sender node
 		* \param tag tag code from the fragmentation, if 0 this is a non fragmented packet
-		* \return false: If the previous reassembling is still active, or there is no free packet in the pool, true: new reassembling started
+		* \return NULL: If it is a fragment from an already finished packet, there is no free slot
+		* or there is no free packet in the pool, the slot of the new reassembling otherwise
 		*/
-		bool start_new_reassembling( uint16_t size, node_id_t sender, uint16_t tag = 0 )
+		Slot* start_new_reassembling( uint16_t size, node_id_t sender, uint16_t tag = 0 )
 		{
-			//Still working, or it is a fragment from the previous packet
-			if( valid == true || ( ( tag != 0 ) && (previous_datagram_tag_ == tag ) && (previous_frag_sender_ != sender)) )
-				return false;
-			else
+			Slot* slot = NULL;
+			for( int i = 0; i < LOWPAN_REASSEMBLING_SLOTS; i++ )
 			{
-				ip_packet_number = packet_pool_mgr_->get_unused_packet_with_number();
-				//If no free packet, the reassembling canceled
-				if( ip_packet_number == Packet_Pool_Mgr_t::NO_FREE_PACKET )
-					return false;
-				else
-				{
-					ip_packet = packet_pool_mgr_->get_packet_pointer( ip_packet_number );
-					
-					//Save the old variables, to eliminate remained fragments from the old process
-					previous_datagram_tag_ = datagram_tag;
-					previous_frag_sender_ = frag_sender;
-					
-					//Initilize the variables for the new process
-					valid = true;
-					datagram_tag = tag;
-					frag_sender = sender;
-					datagram_size = size;
-					received_fragments_number_ = 0;
-					received_datagram_size = 0;
-					for( int i = 0; i < MAX_FRAGMENTS; i++ )
-						rcvd_offsets_[i] = 255;
-					
-					reset_timer();
-					return true;
-				}
+				Slot& s = slots_[i];
+				//It is a remained fragment from a previous packet
+				if( ( tag != 0 ) && ( s.previous_datagram_tag_ == tag ) && ( s.previous_frag_sender_ == sender ) )
+					return NULL;
+				if( !s.valid && slot == NULL )
+					slot = &s;
 			}
 			
+			//All slots are working
+			if( slot == NULL )
+				return NULL;
+			
+			slot->ip_packet_number = packet_pool_mgr_->get_unused_packet_with_number();
+			//If no free packet, the reassembling canceled
+			if( slot->ip_packet_number == Packet_Pool_Mgr_t::NO_FREE_PACKET )
+				return NULL;
+			
+			slot->ip_packet = packet_pool_mgr_->get_packet_pointer( slot->ip_packet_number );
+			
+			//Initilize the variables for the new process
+			slot->valid = true;
+			slot->datagram_tag = tag;
+			slot->frag_sender = sender;
+			slot->datagram_size = size;
+			slot->received_datagram_size = 0;
+			for( int i = 0; i < LOWPAN_REASSEMBLING_BITMAP_SIZE; i++ )
+				slot->rcvd_offsets_[i] = 0;
+			
+			//0 is never used, so a timer of a slot that has never been started can't match
+			if( ++sequence_ == 0 )
+				++sequence_;
+			slot->sequence_ = sequence_;
+			
+			reset_timer( slot );
+			return slot;
 		}
 		
 		// -----------------------------------------------------------------
 		
 		/**
-		* Function to determinate that the received packet is a duplicate or not
-		* \param offset the new offset
-		* \return true if this is new, false otherwise
+		* Finish the reassembling process of a slot, the IP packet is passed to the upper layer
+		* Fragments arriving later for the same datagram are dropped.
 		*/
-		bool is_it_new_offset( uint8_t offset )
+		void finish_reassembling( Slot* slot )
 		{
-			for( int i = 0; i < received_fragments_number_; i++ )
-				if( rcvd_offsets_[i] == offset )
-					return false;
-			
-			//This is a new fragment, save the offset
-			rcvd_offsets_[received_fragments_number_++] = offset;
-			
-			return true;
+			slot->valid = false;
+			slot->previous_datagram_tag_ = slot->datagram_tag;
+			slot->previous_frag_sender_ = slot->frag_sender;
+		}
+		
+		// -----------------------------------------------------------------
+		
+		/**
+		* Drop the process of a slot that has not received anything usable,
+		* the IP packet is returned to the pool
+		*/
+		void cancel_reassembling( Slot* slot )
+		{
+			slot->valid = false;
+			packet_pool_mgr_->clean_packet( slot->ip_packet );
 		}
 		
 		// -----------------------------------------------------------------
@@ -142,9 +267,9 @@ namespace wiselib
 		/**
 		* Function to set the timer
 		*/
-		void reset_timer()
+		void reset_timer( Slot* slot )
 		{
-			timer().template set_timer<self_type, &self_type::timeout>( LOWPAN_REASSEMBLING_TIMEOUT, this, (void*) datagram_tag );
+			timer().template set_timer<self_type, &self_type::timeout>( LOWPAN_REASSEMBLING_TIMEOUT, this, (void*)( size_t )( slot->sequence_ ) );
 		}
 		
 		// -----------------------------------------------------------------
@@ -153,52 +278,26 @@ namespace wiselib
 		* If the timer expired this function is called.
 		* If the same reassebling is still in the system, the reassembling process is canceled
 		*/
-		void timeout( void* old_datagram_tag_ )
+		void timeout( void* sequence )
 		{
-			//If no new fragment since set the timer, reset the fragmentation process
-			if( valid && (received_datagram_size < datagram_size) &&
-			 (datagram_tag == ( int )(old_datagram_tag_)) )
+			for( int i = 0; i < LOWPAN_REASSEMBLING_SLOTS; i++ )
 			{
-				valid = false;
-				packet_pool_mgr_->clean_packet( ip_packet );
-				
-				#ifdef LoWPAN_LAYER_DEBUG
-				debug().debug(" Reassembling manager: fragment collection timeot for packet: %i from %llx.", ip_packet_number, (long long unsigned)frag_sender );
-				#endif
+				Slot& s = slots_[i];
+				//If the process is not finished since set the timer, reset the fragmentation process
+				if( s.valid && (s.received_datagram_size < s.datagram_size) &&
+				 (s.sequence_ == ( uint16_t )( size_t )(sequence)) )
+				{
+					finish_reassembling( &s );
+					packet_pool_mgr_->clean_packet( s.ip_packet );
+					
+					#ifdef LoWPAN_LAYER_DEBUG
+					debug().debug(" Reassembling manager: fragment collection timeot for packet: %i from %llx.", s.ip_packet_number, (long long unsigned)s.frag_sender );
+					#endif
+					return;
+				}
 			}
 		}
 		
-		// -----------------------------------------------------------------
-
-		/**
-		* The current fargmentation process is still valid
-		*/
-		bool valid;
-		/**
-		* Tag code for the actual packet
-		*/
-		uint16_t datagram_tag;
-		/**
-		* Size of the IPv6 packet
-		*/
-		uint16_t datagram_size;
-		/**
-		* Size of the received fragments
-		*/
-		uint16_t received_datagram_size;
-		/**
-		* Reference to the used IP packet from the pool
-		*/
-		IPv6Packet_t* ip_packet;
-		/**
-		* Number of the used IP packet from the pool
-		*/
-		uint8_t ip_packet_number;
-		/**
-		* The Sender of the currently reassembled packet
-		*/
-		node_id_t frag_sender;
-		
 	 private:
 	 	typename Timer::self_pointer_t timer_;
 		typename Debug::self_pointer_t debug_;
@@ -214,22 +313,13 @@ namespace wiselib
 		}
 		
 		/**
-		* number of received fragments
-		*/
-		uint8_t received_fragments_number_;
-		/**
-		* Store of the offsets
-		* A packet can be received more than one time
-		*/
-		uint8_t rcvd_offsets_[MAX_FRAGMENTS];
-		/**
-		* Tag code for the previous packet
+		* The reassembling processes
 		*/
-		uint16_t previous_datagram_tag_;
+		Slot slots_[LOWPAN_REASSEMBLING_SLOTS];
 		/**
-		* The Sender of the previously reassembled packet
+		* Identifier of the last started process
 		*/
-		node_id_t previous_frag_sender_;
+		uint16_t sequence_;
 		
 		/**
 		* Pointer to the packet pool manager
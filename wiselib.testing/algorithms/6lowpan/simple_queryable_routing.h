@@ -27,6 +27,8 @@
 #define __ALGORITHMS_6LOWPAN_SIMPLE_ROUTING_H__
 
 #include "internal_interface/routing_table/routing_table_static_array.h"
+#include "algorithms/6lowpan/lpm_forwarding_table.h"
+#include "util/delegates/delegate.hpp"
 
 namespace wiselib
 {
@@ -100,7 +102,11 @@ namespace wiselib
 		* The entries have lower level Radio types because the next hop is a MAC address if MESH UNDER mode enabled
 		*/
 		#ifdef LOWPAN_ROUTE_OVER
+		#ifdef LOWPAN_LPM_FORWARDING
+		typedef wiselib::LpmForwardingTable<OsModel, Radio_Upper_Layer, FORWARDING_TABLE_SIZE, wiselib::ForwardingTableValue<Radio_Upper_Layer> > ForwardingTable;
+		#else
 		typedef wiselib::StaticArrayRoutingTable<OsModel, Radio_Upper_Layer, FORWARDING_TABLE_SIZE, wiselib::ForwardingTableValue<Radio_Upper_Layer> > ForwardingTable;
+		#endif
 		typedef typename Radio_Upper_Layer::node_id_t node_id_t;
 		
 		/**
@@ -144,6 +150,18 @@ namespace wiselib
 			ROUTING_BUSY = 3
 		};
 		
+		/**
+		* Route notification callback, the parameter is the destination.
+		* NULL_NODE_ID means that any destination can be affected (default route change).
+		*/
+		typedef delegate1<void, node_id_t> route_delegate_t;
+
+		/**
+		* Lookup of routes that are kept outside of the forwarding table (e.g. by the RPL root).
+		* Parameters: destination, next hop (return value). Returns true if there is a route.
+		*/
+		typedef delegate2<bool, node_id_t, node_id_t&> route_lookup_delegate_t;
+		
 		// -----------------------------------------------------------------
 		/// Constructor
 		SimpleQueryableRouting()
@@ -287,6 +305,47 @@ namespace wiselib
 		int find( node_id_t destination, uint8_t& target_interface, node_id_t& next_hop, bool start_discovery = true );
 		
 
+		/** \brief Register the handler of the route notifications
+		* It is called by the routing when the discovery for a destination finished (successfully or not)
+		* Usage: routing_.template reg_route_callback<self_type, &self_type::route_available>( this );
+		*/
+		template<class T, void (T::*TMethod)(node_id_t)>
+		void reg_route_callback( T* obj_pnt )
+		{
+			route_callback_ = route_delegate_t::template from_method<T, TMethod>( obj_pnt );
+		}
+		
+		void unreg_route_callback()
+		{
+			route_callback_ = route_delegate_t();
+		}
+
+		/** \brief Register a lookup for the destinations which are not in the forwarding table
+		* It is asked before a discovery is started
+		* Usage: routing_.template reg_route_lookup<self_type, &self_type::route_lookup>( this );
+		*/
+		template<class T, bool (T::*TMethod)(node_id_t, node_id_t&)>
+		void reg_route_lookup( T* obj_pnt )
+		{
+			route_lookup_ = route_lookup_delegate_t::template from_method<T, TMethod>( obj_pnt );
+		}
+
+		void unreg_route_lookup()
+		{
+			route_lookup_ = route_lookup_delegate_t();
+		}
+		
+		/** \brief Notify the registered handler about a changed route
+		* It has to be called by the routing algorithms after an entry is inserted into the forwarding table
+		* or after a discovery failed
+		* \param destination The destination, or NULL_NODE_ID if any destination can be affected
+		*/
+		void route_available( node_id_t destination )
+		{
+			if( route_callback_ )
+				route_callback_( destination );
+		}
+
 		/** \brief Print the forwarding table
 		*/
 		void print_forwarding_table();
@@ -314,6 +373,8 @@ namespace wiselib
 
 	 private:
 	 	typename Timer::self_pointer_t timer_;
+		route_delegate_t route_callback_;
+		route_lookup_delegate_t route_lookup_;
 		typename Radio_Os::self_pointer_t os_radio_;
 		typename Debug::self_pointer_t debug_;
 		
@@ -404,13 +465,24 @@ namespace wiselib
 			#endif
 			
 		 	//Search for the next hop in the table
+			#if defined(LOWPAN_ROUTE_OVER) && defined(LOWPAN_LPM_FORWARDING)
+			//Longest prefix match: host routes, prefix routes and the default route (NULL_NODE_ID)
+		 	ForwardingTableIterator it = forwarding_table_.lookup( destination );
+			#else
 		 	ForwardingTableIterator it = forwarding_table_.find( destination );
+			#endif
 			if( it != forwarding_table_.end() && it->second.next_hop != NULL_NODE_ID )
 			{
 				next_hop = it->second.next_hop;
 				target_interface = it->second.target_interface;
 				return ROUTE_AVAILABLE;
 			}
+			//Not in the table, but the registered lookup may know it
+			else if( route_lookup_ && route_lookup_( destination, next_hop ) )
+			{
+				target_interface = InterfaceManager_t::INTERFACE_RADIO;
+				return ROUTE_AVAILABLE;
+			}
 			//Not in the table, but maybe the algorithm is working on this or another destination
 			else if( is_working )
 			{
@@ -483,6 +555,9 @@ namespace wiselib
 			
 			is_working = false;
 			
+			//Packets waiting for this route can be sent now
+			route_available( requested_destination_ );
+			
 			//print_forwarding_table();
 		}
 	
@@ -510,8 +585,12 @@ namespace wiselib
 		for ( ForwardingTableIterator it = forwarding_table_.begin(); it != forwarding_table_.end(); ++it )
 		{
 			#ifdef LOWPAN_ROUTE_OVER
+			#ifdef LOWPAN_LPM_FORWARDING
+			debug().debug( "   Routing:   %i: Dest %s/%i  SendTo %s Hops %i", i++, it->first.get_address(str), forwarding_table_.prefix_length( it ), it->second.next_hop.get_address(strb), it->second.hops);
+			#else
 			debug().debug( "   Routing:   %i: Dest %s  SendTo %s Hops %i", i++, it->first.get_address(str), it->second.next_hop.get_address(strb), it->second.hops);
 			#endif
+			#endif
 
 			#ifdef LOWPAN_MESH_UNDER
 			debug().debug( "   Routing:   %i: Dest %x  SendTo %x Hops %i", i++, it->first, it->second.next_hop, it->second.hops);
@@ -203,6 +203,32 @@ namespace wiselib
 		* NOTE: uint16_t is used as a len because the provided uint8_t is not enough for IP packets
 		*/
 		int send( node_id_t receiver, uint16_t len, block_data_t *data );
+		
+		/**
+		* Zero-copy send, first step: get a packet from the pool
+		* The UDP payload has to be written directly to the returned place, then the packet
+		* is sent with send_packet(). The IPv6 and UDP headers are filled in by send_packet().
+		* \param packet_number the number of the packet in the PacketPool
+		* \return pointer to the UDP payload (max_payload_size() bytes) or NULL if no free packet
+		*/
+		block_data_t* get_send_buffer( uint8_t& packet_number );
+		
+		/**
+		* Zero-copy send, second step: send a packet prepared with get_send_buffer()
+		* The packet is handed over, the caller must not clean it.
+		* \param receiver the target socket
+		* \param packet_number the number of the packet in the PacketPool
+		* \param len the length of the UDP payload
+		*/
+		int send_packet( node_id_t receiver, uint8_t packet_number, uint16_t len );
+		
+		/**
+		* The maximal UDP payload in one packet
+		*/
+		uint16_t max_payload_size()
+		{
+			return LOWPAN_IP_PACKET_BUFFER_MAX_SIZE - IPv6Packet_t::PAYLOAD_POS - 8;
+		}
 		/**
 		* Callback function of the layer. This is called by the IPv6 layer.
 		* \param from The IP address of the sender
@@ -445,19 +471,69 @@ namespace wiselib
 //		if( socket_number < 0 || socket_number >= NUMBER_OF_UDP_SOCKETS || (sockets_[socket_number].callback_id == -1) )
 //			return ERR_NOTIMPL;
 		
-		if( len >= LOWPAN_IP_PACKET_BUFFER_MAX_SIZE )
+		if( len > max_payload_size() )
 		{
 			#ifdef UDP_LAYER_DEBUG
-			debug().debug( "UDP layer: Error payload too big (%i). Maximum length: %i", len, LOWPAN_IP_PACKET_BUFFER_MAX_SIZE );
+			debug().debug( "UDP layer: Error payload too big (%i). Maximum length: %i", len, max_payload_size() );
 			#endif
 			return ERR_NOTIMPL;
 		}
 		
+		//Get a packet from the manager
+		uint8_t packet_number;
+		block_data_t* payload = get_send_buffer( packet_number );
+		if( payload == NULL )
+			return ERR_UNSPEC;
+		
+		//UDP payload
+		memcpy( payload, data, len );
+		
+		return send_packet( socket, packet_number, len );
+	}
+	
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		typename Radio_P,
+		typename Debug_P>
+	typename UDP<OsModel_P, Radio_IP_P, Radio_P, Debug_P>::block_data_t*
+	UDP<OsModel_P, Radio_IP_P, Radio_P, Debug_P>::
+	get_send_buffer( uint8_t& packet_number )
+	{
+		packet_number = packet_pool_mgr_->get_unused_packet_with_number();
+		if( packet_number == Packet_Pool_Mgr_t::NO_FREE_PACKET )
+			return NULL;
+		
+		//Without extension headers the UDP header starts at the payload position
+		return packet_pool_mgr_->get_packet_pointer( packet_number )->payload() + 8;
+	}
+	
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		typename Radio_P,
+		typename Debug_P>
+	int
+	UDP<OsModel_P, Radio_IP_P, Radio_P, Debug_P>::
+	send_packet( node_id_t socket, uint8_t packet_number, uint16_t len )
+	{
+		IPv6Packet_t* message = packet_pool_mgr_->get_packet_pointer( packet_number );
+		
+		if( len > max_payload_size() )
+		{
+			#ifdef UDP_LAYER_DEBUG
+			debug().debug( "UDP layer: Error payload too big (%i). Maximum length: %i", len, max_payload_size() );
+			#endif
+			packet_pool_mgr_->clean_packet( message );
+			return ERR_NOTIMPL;
+		}
+		
 		if( socket.remote_host == Radio_IP::NULL_NODE_ID )
 		{
 			#ifdef UDP_LAYER_DEBUG
 			debug().debug( "UDP layer: Error, target must be specified!" );
 			#endif
+			packet_pool_mgr_->clean_packet( message );
 			return ERR_UNSPEC;
 		}
 		
@@ -466,15 +542,6 @@ namespace wiselib
 		debug().debug( "UDP layer: Send to [%s]:%i (Local Port: %i)", socket.remote_host.get_address(str), socket.remote_port,  socket.local_port );
 		#endif
 		
-		//Get a packet from the manager
-		uint8_t packet_number = packet_pool_mgr_->get_unused_packet_with_number();
-		if( packet_number == Packet_Pool_Mgr_t::NO_FREE_PACKET )
-			return ERR_UNSPEC;
-		
-		IPv6Packet_t* message = packet_pool_mgr_->get_packet_pointer( packet_number );
-		if( message == NULL )
-			return ERR_UNSPEC;
-		
 		//Next header = 17 UDP
 		message->set_transport_next_header(Radio_IP::UDP);
 		//Maximum limit
@@ -495,7 +562,7 @@ namespace wiselib
 // 		message->set_flow_label(flow_label_);
 // 		message->set_traffic_class(traffic_class_);
 		
-		//Construct the UDP header
+		//Construct the UDP header, the payload is already in place
 		//Local Port
 		message->template set_payload<uint16_t>( &(socket.local_port), 0 );
 		
@@ -505,9 +572,6 @@ namespace wiselib
 		//Length (payload + UDP header)
 		message->template set_payload<uint16_t>( &(len), 4 );
 		
-		//UDP payload
-		message->template set_payload<uint8_t>( data, 8, len );
-		
 		//Generate CHECKSUM in the interface manager because the source address will be set there
 		
 		//Send the packet to the IP layer
@@ -0,0 +1,375 @@
+
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+#ifndef PREFIX_CODEC_H
+#define PREFIX_CODEC_H
+
+#include <string.h>
+#include <external_interface/external_interface.h>
+#include <external_interface/external_interface_testing.h>
+#include <util/meta.h>
+
+namespace wiselib {
+
+	/**
+	 * @brief Shared-prefix codec for URI-heavy data (e.g. RDF).
+	 *
+	 * Strings are encoded against a table of namespace prefixes that is
+	 * learned with @a learn() / @a add_prefix() before the first call to
+	 * @a encode(). An encoded value is a zero-terminated string consisting of
+	 * one code byte (0x01 for "no prefix", 0x02 + i for prefix i) followed by
+	 * the remaining suffix of the input.
+	 *
+	 * The prefix table itself is kept sorted and front-coded: each entry
+	 * only stores the number of leading bytes it shares with its predecessor
+	 * and the differing suffix. Every BUCKET_SIZE_P entries a restart entry
+	 * with no shared bytes allows for random access by prefix id.
+	 *
+	 * Encoding always picks the longest matching prefix and the table is
+	 * frozen by the first @a encode(), so encoded values are canonical:
+	 * two encoded values are equal iff the decoded strings are, which is what
+	 * CodecTupleStore relies on for matching encoded queries. @a compare()
+	 * additionally gives the lexicographic order of the decoded strings
+	 * without decoding them.
+	 *
+	 * Like the other codecs, the table is static and thus shared by all
+	 * users of a particular template instantiation.
+	 *
+	 * @tparam MAX_PREFIXES_P maximum number of prefixes (at most 254).
+	 * @tparam TABLE_SIZE_P size of the front-coded prefix table in bytes.
+	 * @tparam BUCKET_SIZE_P number of table entries between restarts.
+	 *
+	 * @ingroup Codec_concept
+	 */
+	template<
+		typename OsModel_P,
+		int MAX_PREFIXES_P = 64,
+		int TABLE_SIZE_P = 1024,
+		int BUCKET_SIZE_P = 8
+	>
+	class PrefixCodec {
+		public:
+			typedef OsModel_P OsModel;
+			typedef typename OsModel::size_t size_type;
+			typedef typename OsModel::block_data_t block_data_t;
+			typedef PrefixCodec<OsModel, MAX_PREFIXES_P, TABLE_SIZE_P, BUCKET_SIZE_P> self_type;
+
+			enum {
+				MAX_PREFIXES = MAX_PREFIXES_P,
+				TABLE_SIZE = TABLE_SIZE_P,
+				BUCKET_SIZE = BUCKET_SIZE_P,
+				BUCKETS = (MAX_PREFIXES_P + BUCKET_SIZE_P - 1) / BUCKET_SIZE_P,
+				MAX_PREFIX_LENGTH = 255,
+				MIN_PREFIX_LENGTH = 4,
+				ENTRY_HEADER_SIZE = 2
+			};
+
+			enum {
+				CODE_NONE = 0x01,
+				CODE_FIRST_PREFIX = 0x02
+			};
+
+			// codes are single non-zero bytes
+			static_assert(MAX_PREFIXES_P >= 0 && MAX_PREFIXES_P <= 0x100 - CODE_FIRST_PREFIX);
+
+			/**
+			 * Learn the namespace of @a in_ (everything up to and including
+			 * the last '/' or '#') as prefix.
+			 * @return true iff a new prefix has been added.
+			 */
+			static bool learn(block_data_t* in_) {
+				char *in = reinterpret_cast<char*>(in_);
+				size_type l = 0;
+				for(size_type i = 0; in[i]; i++) {
+					if(in[i] == '/' || in[i] == '#') { l = i + 1; }
+				}
+				if(l < MIN_PREFIX_LENGTH) { return false; }
+				return add_prefix(in, l);
+			}
+
+			/**
+			 * Add the first @a l bytes of @a prefix to the prefix table.
+			 * Fails when the table is full or has already been frozen by
+			 * encoding a value.
+			 * @return true iff a new prefix has been added.
+			 */
+			static bool add_prefix(const char* prefix, size_type l) {
+				if(frozen_ || prefixes_ >= MAX_PREFIXES) { return false; }
+				if(l == 0 || l > MAX_PREFIX_LENGTH) { return false; }
+
+				block_data_t *table = ::get_allocator().template allocate_array<block_data_t>(TABLE_SIZE).raw();
+				char last[MAX_PREFIX_LENGTH], cur[MAX_PREFIX_LENGTH];
+				size_type last_len = 0, used = 0, idx = 0, pos = 0;
+				bool inserted = false, ok = true;
+
+				for(size_type k = 0; k < prefixes_ && ok; k++) {
+					size_type shared = table_[pos], slen = table_[pos + 1];
+					memcpy(cur + shared, table_ + pos + ENTRY_HEADER_SIZE, slen);
+					size_type cur_len = shared + slen;
+					pos += ENTRY_HEADER_SIZE + slen;
+
+					if(!inserted) {
+						int c = strncmp_len(prefix, l, cur, cur_len);
+						if(c == 0) { ok = false; break; }
+						if(c < 0) {
+							ok = emit(table, used, idx, last, last_len, prefix, l);
+							inserted = true;
+						}
+					}
+					if(ok) { ok = emit(table, used, idx, last, last_len, cur, cur_len); }
+				}
+				if(ok && !inserted) {
+					ok = emit(table, used, idx, last, last_len, prefix, l);
+				}
+
+				if(ok) {
+					memcpy(table_, table, used);
+					table_used_ = used;
+					prefixes_ = idx;
+				}
+				else {
+					// duplicate or out of table space, rebuild restart index
+					// from the unchanged table
+					rebuild_restarts();
+				}
+				::get_allocator().free_array(table);
+				return ok;
+			}
+
+			/**
+			 * Disallow further changes to the prefix table. Called implicitly
+			 * by @a encode().
+			 */
+			static void freeze() { frozen_ = true; }
+
+			/**
+			 * Forget all prefixes. Only safe when no encoded values are alive
+			 * anymore.
+			 */
+			static void reset() {
+				frozen_ = false;
+				prefixes_ = 0;
+				table_used_ = 0;
+			}
+
+			static size_type prefixes() { return prefixes_; }
+			static size_type table_used() { return table_used_; }
+
+			/**
+			 * @return Prefix-encoded version of @a in_ as zero-terminated
+			 * string.
+			 */
+			static block_data_t* encode(block_data_t* in_) {
+				freeze();
+				char *in = reinterpret_cast<char*>(in_);
+				size_type prefix_len = 0;
+				int id = longest_prefix(in, prefix_len);
+				size_type l = strlen(in + prefix_len);
+
+				char *r = ::get_allocator().template allocate_array<char>(l + 2).raw();
+				r[0] = (id < 0) ? (char)CODE_NONE : (char)(CODE_FIRST_PREFIX + id);
+				memcpy((void*)(r + 1), (void*)(in + prefix_len), l + 1);
+				return reinterpret_cast<block_data_t*>(r);
+			}
+
+			/**
+			 * @return Decoded version as zero-terminated string.
+			 */
+			static block_data_t* decode(block_data_t* in_) {
+				char *in = reinterpret_cast<char*>(in_);
+				char prefix[MAX_PREFIX_LENGTH];
+				size_type prefix_len = 0;
+				if((::uint8_t)in[0] != CODE_NONE) {
+					prefix_len = expand_prefix((::uint8_t)in[0] - CODE_FIRST_PREFIX, prefix);
+				}
+				size_type l = strlen(in + 1);
+
+				char *r = ::get_allocator().template allocate_array<char>(prefix_len + l + 1).raw();
+				memcpy((void*)r, (void*)prefix, prefix_len);
+				memcpy((void*)(r + prefix_len), (void*)(in + 1), l + 1);
+				return reinterpret_cast<block_data_t*>(r);
+			}
+
+			/**
+			 * Free result returned by @a encode or @a decode.
+			 */
+			static void free_result(block_data_t* s) {
+				::get_allocator().free_array(s);
+			}
+
+			/**
+			 * Compare two encoded values.
+			 * @return true iff the decoded values are equal.
+			 */
+			static bool equals(block_data_t* a, block_data_t* b) {
+				return strcmp((char*)a, (char*)b) == 0;
+			}
+
+			/**
+			 * Compare two encoded values without decoding them.
+			 * @return <0, 0 or >0 according to the lexicographic (byte-wise,
+			 * unsigned) order of the decoded values.
+			 */
+			static int compare(block_data_t* a, block_data_t* b) {
+				if(a[0] == b[0]) {
+					return unsigned_strcmp(a + 1, b + 1);
+				}
+
+				block_data_t pa[MAX_PREFIX_LENGTH], pb[MAX_PREFIX_LENGTH];
+				size_type la = (a[0] == CODE_NONE) ? 0 : expand_prefix(a[0] - CODE_FIRST_PREFIX, (char*)pa);
+				size_type lb = (b[0] == CODE_NONE) ? 0 : expand_prefix(b[0] - CODE_FIRST_PREFIX, (char*)pb);
+
+				for(size_type i = 0; ; i++) {
+					block_data_t ca = (i < la) ? pa[i] : a[1 + i - la];
+					block_data_t cb = (i < lb) ? pb[i] : b[1 + i - lb];
+					if(ca != cb) { return (int)ca - (int)cb; }
+					if(ca == 0) { return 0; }
+				}
+			}
+
+		private:
+
+			/**
+			 * @return id of the longest prefix in the table that @a in starts
+			 * with or -1 if there is none, its length is returned in @a len.
+			 */
+			static int longest_prefix(const char* in, size_type& len) {
+				int r = -1;
+				len = 0;
+
+				// lcp = length of the common prefix of the previous table
+				// entry and in. As entries share their first bytes with their
+				// predecessor, only the suffixes need to be inspected.
+				size_type lcp = 0, pos = 0;
+				for(size_type k = 0; k < prefixes_; k++) {
+					size_type shared = table_[pos], slen = table_[pos + 1];
+					const block_data_t *suffix = table_ + pos + ENTRY_HEADER_SIZE;
+					pos += ENTRY_HEADER_SIZE + slen;
+
+					if(shared > lcp) { continue; }
+					lcp = shared;
+					size_type i = 0;
+					while(i < slen && in[lcp] && (block_data_t)in[lcp] == suffix[i]) {
+						lcp++;
+						i++;
+					}
+					if(i == slen) {
+						// table is sorted, so any later match is longer
+						r = k;
+						len = lcp;
+					}
+				}
+				return r;
+			}
+
+			/**
+			 * Reconstruct prefix @a id into @a out (if non-null), which only
+			 * needs to hold the prefix itself: the bucket entries before it
+			 * can be longer and are expanded into a scratch buffer.
+			 * @return length of the prefix.
+			 */
+			static size_type expand_prefix(size_type id, char* out) {
+				char scratch[MAX_PREFIX_LENGTH];
+				size_type pos = restarts_[id / BUCKET_SIZE];
+				size_type l = 0;
+				for(size_type k = id - id % BUCKET_SIZE; k <= id; k++) {
+					size_type shared = table_[pos], slen = table_[pos + 1];
+					memcpy(scratch + shared, table_ + pos + ENTRY_HEADER_SIZE, slen);
+					l = shared + slen;
+					pos += ENTRY_HEADER_SIZE + slen;
+				}
+				if(out) { memcpy(out, scratch, l); }
+				return l;
+			}
+
+			/**
+			 * Append @a s to the front-coded @a table, restart entries are
+			 * recorded in restarts_.
+			 */
+			static bool emit(block_data_t* table, size_type& used, size_type& idx,
+					char* last, size_type& last_len, const char* s, size_type l) {
+				if(idx >= MAX_PREFIXES) { return false; }
+
+				size_type shared = 0;
+				if(idx % BUCKET_SIZE) {
+					while(shared < l && shared < last_len && last[shared] == s[shared]) { shared++; }
+				}
+				size_type slen = l - shared;
+				if(used + ENTRY_HEADER_SIZE + slen > TABLE_SIZE) { return false; }
+
+				if(idx % BUCKET_SIZE == 0) { restarts_[idx / BUCKET_SIZE] = used; }
+				table[used] = shared;
+				table[used + 1] = slen;
+				memcpy(table + used + ENTRY_HEADER_SIZE, s + shared, slen);
+				used += ENTRY_HEADER_SIZE + slen;
+				idx++;
+
+				memcpy(last + shared, s + shared, slen);
+				last_len = l;
+				return true;
+			}
+
+			static void rebuild_restarts() {
+				size_type pos = 0;
+				for(size_type k = 0; k < prefixes_; k++) {
+					if(k % BUCKET_SIZE == 0) { restarts_[k / BUCKET_SIZE] = pos; }
+					pos += ENTRY_HEADER_SIZE + table_[pos + 1];
+				}
+			}
+
+			static int strncmp_len(const char* a, size_type alen, const char* b, size_type blen) {
+				for(size_type i = 0; i < alen && i < blen; i++) {
+					if(a[i] != b[i]) { return (int)(::uint8_t)a[i] - (int)(::uint8_t)b[i]; }
+				}
+				return (int)alen - (int)blen;
+			}
+
+			static int unsigned_strcmp(const block_data_t* a, const block_data_t* b) {
+				while(*a && *a == *b) { a++; b++; }
+				return (int)*a - (int)*b;
+			}
+
+			static block_data_t table_[TABLE_SIZE_P];
+			static ::uint16_t restarts_[(MAX_PREFIXES_P + BUCKET_SIZE_P - 1) / BUCKET_SIZE_P];
+			static size_type table_used_;
+			static size_type prefixes_;
+			static bool frozen_;
+	};
+
+	template<typename OsModel_P, int MAX_PREFIXES_P, int TABLE_SIZE_P, int BUCKET_SIZE_P>
+		typename OsModel_P::block_data_t PrefixCodec<OsModel_P, MAX_PREFIXES_P, TABLE_SIZE_P, BUCKET_SIZE_P>::table_[TABLE_SIZE_P];
+
+	template<typename OsModel_P, int MAX_PREFIXES_P, int TABLE_SIZE_P, int BUCKET_SIZE_P>
+		::uint16_t PrefixCodec<OsModel_P, MAX_PREFIXES_P, TABLE_SIZE_P, BUCKET_SIZE_P>::restarts_[(MAX_PREFIXES_P + BUCKET_SIZE_P - 1) / BUCKET_SIZE_P];
+
+	template<typename OsModel_P, int MAX_PREFIXES_P, int TABLE_SIZE_P, int BUCKET_SIZE_P>
+		typename OsModel_P::size_t PrefixCodec<OsModel_P, MAX_PREFIXES_P, TABLE_SIZE_P, BUCKET_SIZE_P>::table_used_ = 0;
+
+	template<typename OsModel_P, int MAX_PREFIXES_P, int TABLE_SIZE_P, int BUCKET_SIZE_P>
+		typename OsModel_P::size_t PrefixCodec<OsModel_P, MAX_PREFIXES_P, TABLE_SIZE_P, BUCKET_SIZE_P>::prefixes_ = 0;
+
+	template<typename OsModel_P, int MAX_PREFIXES_P, int TABLE_SIZE_P, int BUCKET_SIZE_P>
+		bool PrefixCodec<OsModel_P, MAX_PREFIXES_P, TABLE_SIZE_P, BUCKET_SIZE_P>::frozen_ = false;
+
+} // namespace wiselib
+
+#endif // PREFIX_CODEC_H
+
+/* vim: set ts=3 sw=3 tw=78 noexpandtab :*/
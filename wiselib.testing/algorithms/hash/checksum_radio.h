@@ -37,7 +37,9 @@ namespace wiselib {
 	 * 
 	 * @ingroup Radio_concept
 	 * 
-	 * @tparam Hash_P The hash algorithm to use.
+	 * @tparam Hash_P The hash algorithm to use. Crc16Sliced computes the same
+	 *   checksums as Crc16 several times faster (at the cost of RAM for its
+	 *   tables) and is the better choice for gateways.
 	 */
 	template<
 		typename OsModel_P,
@@ -0,0 +1,226 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+#ifndef CRC16_SLICED_H
+#define CRC16_SLICED_H
+
+#include <algorithms/hash/crc16.h>
+
+#if defined(PC) && defined(__PCLMUL__) && defined(__SSE4_1__)
+	#include <wmmintrin.h>
+	#include <smmintrin.h>
+	#define CRC16_SLICED_USE_CLMUL 1
+#else
+	#define CRC16_SLICED_USE_CLMUL 0
+#endif
+
+namespace wiselib {
+	
+	/**
+	 * @brief Table driven "slicing-by-N" implementation of the CRC 16 bit
+	 * checksum algorithm.
+	 * 
+	 * Computes the same checksums as @ref Crc16 but processes SLICES_P bytes
+	 * per iteration using SLICES_P lookup tables of 256 entries each
+	 * (i.e. 512 * SLICES_P bytes of RAM, computed on first use).
+	 * Use SLICES_P = 1 for a classic byte-wise table on memory constrained
+	 * nodes, 8 on gateways.
+	 * 
+	 * On PC builds with PCLMULQDQ and SSE 4.1 enabled (e.g. -march=native)
+	 * inputs of at least 32 bytes are folded 16 bytes at a time with carry-less
+	 * multiplication.
+	 * 
+	 * Provides the incremental @a init() / @a update() / @a final()
+	 * interface in addition to @a hash().
+	 * 
+	 * @ingroup Hash_concept
+	 */
+	template<
+		typename OsModel_P,
+		int SLICES_P = 8
+	>
+	class Crc16Sliced {
+		public:
+			typedef OsModel_P OsModel;
+			typedef typename OsModel::block_data_t block_data_t;
+			typedef typename OsModel::size_t size_type;
+			typedef ::uint16_t hash_t;
+			typedef ::uint16_t state_t;
+			
+			enum { MAX_VALUE = (hash_t)(-1) };
+			enum { SLICES = SLICES_P };
+			enum {
+				/// Number of tables, folding uses slicing-by-8 for reduction
+				TABLES = (CRC16_SLICED_USE_CLMUL && SLICES_P < 8) ? 8 : SLICES_P
+			};
+			enum {
+				/// Reflected polynomial, as in Crc16
+				POLYNOMIAL = 0xa001,
+				INIT = 0xffff
+			};
+			
+			static void init(state_t& st) { st = INIT; }
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				if(!initialized_) { init_tables(); }
+				
+				const block_data_t *end = s + l;
+				hash_t crc = st;
+				
+			#if CRC16_SLICED_USE_CLMUL
+				if(l >= 32) {
+					crc = fold(crc, s, l & ~(size_type)0x0f);
+					s += l & ~(size_type)0x0f;
+				}
+			#endif
+				
+				if(SLICES_P > 1) {
+					for( ; s + SLICES_P <= end; s += SLICES_P) {
+						crc ^= s[0] | (s[1] << 8);
+						hash_t c = table_[SLICES_P - 1][crc & 0xff] ^ table_[SLICES_P - 2][crc >> 8];
+						for(int j = 2; j < SLICES_P; j++) {
+							c ^= table_[SLICES_P - 1 - j][s[j]];
+						}
+						crc = c;
+					}
+				}
+				
+				for( ; s < end; s++) {
+					crc = (crc >> 8) ^ table_[0][(crc ^ *s) & 0xff];
+				}
+				st = crc;
+			}
+			
+			static hash_t final(state_t& st) { return st; }
+			
+			static hash_t hash(const block_data_t *s, size_type l) {
+				state_t st;
+				init(st);
+				update(st, s, l);
+				return final(st);
+			}
+			
+		private:
+			
+			static void init_tables() {
+				for(int i = 0; i < 256; i++) {
+					hash_t crc = i;
+					for(int n = 0; n < 8; n++) {
+						crc = (crc & 0x01) ? ((crc >> 1) ^ POLYNOMIAL) : (crc >> 1);
+					}
+					table_[0][i] = crc;
+				}
+				for(int k = 1; k < TABLES; k++) {
+					for(int i = 0; i < 256; i++) {
+						hash_t crc = table_[k - 1][i];
+						table_[k][i] = (crc >> 8) ^ table_[0][crc & 0xff];
+					}
+				}
+				
+			#if CRC16_SLICED_USE_CLMUL
+				// In the reflected bit order a 16 byte block loaded into a
+				// register has the coefficient of x^(127 - p) at bit p.
+				// clmul of two such 64 bit halves yields the product times x,
+				// hence the constants are x^(128+64-1) and x^(128-1) (mod P).
+				fold_high_ = reflect64(xn_mod_p(191));
+				fold_low_ = reflect64(xn_mod_p(127));
+			#endif
+				
+				initialized_ = true;
+			}
+			
+		#if CRC16_SLICED_USE_CLMUL
+			/**
+			 * x^n mod P in normal (non-reflected) representation.
+			 */
+			static ::uint32_t xn_mod_p(int n) {
+				// P = x^16 + x^15 + x^2 + 1, POLYNOMIAL in normal order
+				::uint32_t r = 1;
+				for(int i = 0; i < n; i++) {
+					r <<= 1;
+					if(r & 0x10000) { r ^= 0x18005; }
+				}
+				return r;
+			}
+			
+			static ::uint64_t reflect64(::uint32_t p) {
+				::uint64_t r = 0;
+				for(int d = 0; d < 16; d++) {
+					if(p & (1UL << d)) { r |= 1ULL << (63 - d); }
+				}
+				return r;
+			}
+			
+			/**
+			 * Fold @a l (multiple of 16, >= 32) bytes into a 16 byte
+			 * remainder that is congruent mod P and feed that through the
+			 * tables.
+			 */
+			static hash_t fold(hash_t crc, const block_data_t *s, size_type l) {
+				const __m128i k = _mm_set_epi64x(fold_low_, fold_high_);
+				const block_data_t *end = s + l;
+				
+				__m128i a = _mm_loadu_si128((const __m128i*)s);
+				a = _mm_xor_si128(a, _mm_cvtsi32_si128(crc));
+				for(s += 16; s < end; s += 16) {
+					__m128i h = _mm_clmulepi64_si128(a, k, 0x00);
+					__m128i lo = _mm_clmulepi64_si128(a, k, 0x11);
+					a = _mm_xor_si128(_mm_xor_si128(h, lo), _mm_loadu_si128((const __m128i*)s));
+				}
+				
+				block_data_t buf[16];
+				_mm_storeu_si128((__m128i*)buf, a);
+				crc = 0;
+				for(int i = 0; i < 16; i += 8) {
+					crc ^= buf[i] | (buf[i + 1] << 8);
+					hash_t c = table_[7][crc & 0xff] ^ table_[6][crc >> 8];
+					for(int j = 2; j < 8; j++) {
+						c ^= table_[7 - j][buf[i + j]];
+					}
+					crc = c;
+				}
+				return crc;
+			}
+			
+			static ::uint64_t fold_high_;
+			static ::uint64_t fold_low_;
+		#endif
+			
+			static hash_t table_[TABLES][256];
+			static bool initialized_;
+		
+	}; // Crc16Sliced
+	
+	template<typename OsModel_P, int SLICES_P>
+	::uint16_t Crc16Sliced<OsModel_P, SLICES_P>::table_[Crc16Sliced<OsModel_P, SLICES_P>::TABLES][256];
+	
+	template<typename OsModel_P, int SLICES_P>
+	bool Crc16Sliced<OsModel_P, SLICES_P>::initialized_ = false;
+	
+#if CRC16_SLICED_USE_CLMUL
+	template<typename OsModel_P, int SLICES_P>
+	::uint64_t Crc16Sliced<OsModel_P, SLICES_P>::fold_high_;
+	
+	template<typename OsModel_P, int SLICES_P>
+	::uint64_t Crc16Sliced<OsModel_P, SLICES_P>::fold_low_;
+#endif
+}
+
+#endif // CRC16_SLICED_H
+
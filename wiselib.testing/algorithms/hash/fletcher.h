@@ -48,12 +48,26 @@ namespace wiselib {
 			
 			enum { MAX_HASH_VALUE = (hash_t)(-2) };
 		
+			/**
+			 * Note that sum1 and sum2 are only reduced once at the end, so
+			 * all arithmetic is modulo 2^16. This allows processing eight
+			 * bytes at a time: after a block b0..b7, sum1 has grown by
+			 * b0 + ... + b7 and sum2 by 8 * sum1 + 8 * b0 + 7 * b1 + ... + b7.
+			 */
 			static hash_t hash(const block_data_t* s, size_type l) {
 				::uint16_t sum1 = 0xff;
 				::uint16_t sum2 = 0xff;
 				//l = l > 20 ? 20 : l;
 				const block_data_t *end = s + l;
 				
+				for( ; s + 8 <= end; s += 8) {
+					::uint16_t a = (s[0] + s[1]) + (s[2] + s[3]) + ((s[4] + s[5]) + (s[6] + s[7]));
+					::uint16_t b = (8 * s[0] + 7 * s[1]) + (6 * s[2] + 5 * s[3]) +
+						((4 * s[4] + 3 * s[5]) + (2 * s[6] + s[7]));
+					sum2 += (sum1 << 3) + b;
+					sum1 += a;
+				}
+				
 				for( ; s < end; s++) {
 					sum2 += sum1 += *s;
 				}
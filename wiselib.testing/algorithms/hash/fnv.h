@@ -22,6 +22,13 @@
 
 namespace wiselib {
 
+	/**
+	 * Common implementation of FNV1 and FNV1A.
+	 * 
+	 * Besides the one-shot @a hash() an incremental interface is provided:
+	 * @a init() a @a state_t, feed it with any number of @a update() calls
+	 * and obtain the hash value of the concatenated input with @a final().
+	 */
 	template<
 		typename OsModel_P,
 		typename Hash_P,
@@ -35,18 +42,30 @@ namespace wiselib {
 			typedef typename OsModel::block_data_t block_data_t;
 			typedef typename OsModel::size_t size_type;
 			typedef Hash_P hash_t;
+			typedef Hash_P state_t;
 			
 			enum { MAX_VALUE = (hash_t)(-1) };
 			
-			static hash_t hash(const block_data_t *s, size_type l) {
-				hash_t hashval = Init_P;
+			static void init(state_t& st) { st = Init_P; }
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				hash_t hashval = st;
 				const hash_t magicprime = MagicPrime_P;
 				const block_data_t *end = s + l;
 				for( ; s != end; s++) {
 					hashval *= magicprime;
 					hashval ^= *s;
 				}
-				return hashval;
+				st = hashval;
+			}
+			
+			static hash_t final(state_t& st) { return st; }
+			
+			static hash_t hash(const block_data_t *s, size_type l) {
+				state_t st;
+				init(st);
+				update(st, s, l);
+				return final(st);
 			}
 	};
 	
@@ -62,16 +81,28 @@ namespace wiselib {
 			typedef typename OsModel::block_data_t block_data_t;
 			typedef typename OsModel::size_t size_type;
 			typedef typename FnvBase::hash_t hash_t;
+			typedef typename FnvBase::state_t state_t;
 			
-			static hash_t hash(const block_data_t *s, size_type l) {
-				hash_t hashval = Init_P;
+			static void init(state_t& st) { st = Init_P; }
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				hash_t hashval = st;
 				const hash_t magicprime = MagicPrime_P;
 				const block_data_t *end = s + l;
 				for( ; s != end; s++) {
 					hashval ^= *s;
 					hashval *= magicprime;
 				}
-				return hashval;
+				st = hashval;
+			}
+			
+			static hash_t final(state_t& st) { return st; }
+			
+			static hash_t hash(const block_data_t *s, size_type l) {
+				state_t st;
+				init(st);
+				update(st, s, l);
+				return final(st);
 			}
 	};
 	
@@ -99,6 +130,20 @@ namespace wiselib {
 			
 			enum { MAX_VALUE = (hash_t)(-1) };
 			
+			typedef typename Fnv1<OsModel_P, ::uint32_t>::state_t state_t;
+			
+			static void init(state_t& st) {
+				Fnv1<OsModel_P, ::uint32_t>::init(st);
+			}
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				Fnv1<OsModel_P, ::uint32_t>::update(st, s, l);
+			}
+			
+			static hash_t final(state_t& st) {
+				return (st >> 16) ^ (st & 0xffff);
+			}
+			
 			static hash_t hash(const block_data_t *s, size_type l) {
 				::uint32_t h = Fnv1<OsModel_P, ::uint32_t>::hash(s, l);
 				return (h >> 16) ^ (h & 0xffff);
@@ -144,6 +189,20 @@ namespace wiselib {
 			
 			enum { MAX_VALUE = (hash_t)(-1) };
 			
+			typedef typename Fnv1a<OsModel_P, ::uint32_t>::state_t state_t;
+			
+			static void init(state_t& st) {
+				Fnv1a<OsModel_P, ::uint32_t>::init(st);
+			}
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				Fnv1a<OsModel_P, ::uint32_t>::update(st, s, l);
+			}
+			
+			static hash_t final(state_t& st) {
+				return (st >> 16) ^ (st & 0xffff);
+			}
+			
 			static hash_t hash(const block_data_t *s, size_type l) {
 				::uint32_t h = Fnv1a<OsModel_P, ::uint32_t>::hash(s, l);
 				return (h >> 16) ^ (h & 0xffff);
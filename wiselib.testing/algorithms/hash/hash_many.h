@@ -0,0 +1,187 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+#ifndef HASH_MANY_H
+#define HASH_MANY_H
+
+#include <algorithms/hash/murmur.h>
+#include <algorithms/hash/fnv.h>
+
+#if defined(PC) && defined(__SSE4_1__)
+	#include <smmintrin.h>
+	#define HASH_MANY_USE_SSE4_1 1
+#else
+	#define HASH_MANY_USE_SSE4_1 0
+#endif
+
+namespace wiselib {
+	
+	/**
+	 * @brief Batched hashing of many keys at once.
+	 * 
+	 * hash_many(keys, lengths, n, out) sets out[i] to
+	 * Hash_P::hash(keys[i], lengths[i]) for all i < n.
+	 * The generic version simply loops over the keys, for Murmur and 32 bit
+	 * FNV1A there are specializations that on x86 with SSE 4.1 hash four
+	 * keys in parallel in the lanes of a vector register (compile with
+	 * -msse4.1 or -march=native to enable).
+	 * 
+	 * @tparam Hash_P hash function to use (see @ref Hash_concept).
+	 */
+	template<
+		typename Hash_P
+	>
+	class HashMany {
+		public:
+			typedef Hash_P Hash;
+			typedef typename Hash::block_data_t block_data_t;
+			typedef typename Hash::size_type size_type;
+			typedef typename Hash::hash_t hash_t;
+			
+			static void hash_many(const block_data_t * const *keys, const size_type *lengths, size_type n, hash_t *out) {
+				for(size_type i = 0; i < n; i++) {
+					out[i] = Hash::hash(keys[i], lengths[i]);
+				}
+			}
+	};
+	
+#if HASH_MANY_USE_SSE4_1
+	
+	namespace HashMany_detail {
+		template<int R>
+		inline __m128i rotl32x4(__m128i x) {
+			return _mm_or_si128(_mm_slli_epi32(x, R), _mm_srli_epi32(x, 32 - R));
+		}
+		
+		template<typename size_type>
+		inline size_type min4(const size_type *l) {
+			size_type m = l[0];
+			if(l[1] < m) { m = l[1]; }
+			if(l[2] < m) { m = l[2]; }
+			if(l[3] < m) { m = l[3]; }
+			return m;
+		}
+	}
+	
+	template<
+		typename OsModel_P
+	>
+	class HashMany< Murmur<OsModel_P> > {
+		public:
+			typedef Murmur<OsModel_P> Hash;
+			typedef typename Hash::block_data_t block_data_t;
+			typedef typename Hash::size_type size_type;
+			typedef typename Hash::hash_t hash_t;
+			typedef typename Hash::state_t state_t;
+			
+			static void hash_many(const block_data_t * const *keys, const size_type *lengths, size_type n, hash_t *out) {
+				using namespace HashMany_detail;
+				
+				const __m128i c1 = _mm_set1_epi32(0xcc9e2d51);
+				const __m128i c2 = _mm_set1_epi32(0x1b873593);
+				const __m128i m = _mm_set1_epi32(5);
+				const __m128i c = _mm_set1_epi32(0xe6546b64);
+				
+				size_type i = 0;
+				for( ; i + 4 <= n; i += 4) {
+					// process the words all four keys have in common in
+					// parallel, continue with the scalar implementation for
+					// the rest of each key.
+					size_type words = min4(lengths + i) / 4;
+					__m128i h = _mm_set1_epi32(Hash::SEED);
+					for(size_type w = 0; w < words; w++) {
+						__m128i k = _mm_set_epi32(
+								Hash::load(keys[i + 3] + 4 * w), Hash::load(keys[i + 2] + 4 * w),
+								Hash::load(keys[i + 1] + 4 * w), Hash::load(keys[i] + 4 * w));
+						k = _mm_mullo_epi32(k, c1);
+						k = rotl32x4<15>(k);
+						k = _mm_mullo_epi32(k, c2);
+						h = _mm_xor_si128(h, k);
+						h = rotl32x4<13>(h);
+						h = _mm_add_epi32(_mm_mullo_epi32(h, m), c);
+					}
+					
+					::uint32_t lanes[4];
+					_mm_storeu_si128((__m128i*)lanes, h);
+					for(size_type j = 0; j < 4; j++) {
+						state_t st;
+						st.hash = lanes[j];
+						st.length = 4 * words;
+						st.tail_length = 0;
+						Hash::update(st, keys[i + j] + 4 * words, lengths[i + j] - 4 * words);
+						out[i + j] = Hash::final(st);
+					}
+				}
+				
+				for( ; i < n; i++) {
+					out[i] = Hash::hash(keys[i], lengths[i]);
+				}
+			}
+	};
+	
+	template<
+		typename OsModel_P
+	>
+	class HashMany< Fnv1a<OsModel_P, ::uint32_t> > {
+		public:
+			typedef Fnv1a<OsModel_P, ::uint32_t> Hash;
+			typedef typename Hash::block_data_t block_data_t;
+			typedef typename Hash::size_type size_type;
+			typedef typename Hash::hash_t hash_t;
+			typedef typename Hash::state_t state_t;
+			
+			static void hash_many(const block_data_t * const *keys, const size_type *lengths, size_type n, hash_t *out) {
+				using namespace HashMany_detail;
+				
+				const __m128i prime = _mm_set1_epi32(0x1000193);
+				
+				size_type i = 0;
+				for( ; i + 4 <= n; i += 4) {
+					size_type common = min4(lengths + i);
+					state_t init;
+					Hash::init(init);
+					__m128i h = _mm_set1_epi32(init);
+					for(size_type b = 0; b < common; b++) {
+						__m128i k = _mm_set_epi32(keys[i + 3][b], keys[i + 2][b],
+								keys[i + 1][b], keys[i][b]);
+						h = _mm_xor_si128(h, k);
+						h = _mm_mullo_epi32(h, prime);
+					}
+					
+					::uint32_t lanes[4];
+					_mm_storeu_si128((__m128i*)lanes, h);
+					for(size_type j = 0; j < 4; j++) {
+						state_t st = lanes[j];
+						Hash::update(st, keys[i + j] + common, lengths[i + j] - common);
+						out[i + j] = Hash::final(st);
+					}
+				}
+				
+				for( ; i < n; i++) {
+					out[i] = Hash::hash(keys[i], lengths[i]);
+				}
+			}
+	};
+	
+#endif // HASH_MANY_USE_SSE4_1
+	
+}
+
+#endif // HASH_MANY_H
+
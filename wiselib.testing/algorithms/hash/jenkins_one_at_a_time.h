@@ -26,6 +26,9 @@ namespace wiselib {
 	 * @brief The Jenkins One-at-a-time hash from
 	 * http://www.burtleburtle.net/bob/hash/doobs.html
 	 * 
+	 * Provides the incremental @a init() / @a update() / @a final()
+	 * interface in addition to @a hash().
+	 * 
 	 * @ingroup Hash_concept
 	 */
 	template<
@@ -40,18 +43,34 @@ namespace wiselib {
 			
 			enum { MAX_VALUE = (hash_t)(-1) };
 			
-			static hash_t hash(const block_data_t *s, size_type l) {
-				::uint32_t h, i;
-				for(h = i = 0; i < l; i++) {
+			typedef hash_t state_t;
+			
+			static void init(state_t& st) { st = 0; }
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				::uint32_t h = st;
+				for(size_type i = 0; i < l; i++) {
 					h += s[i];
 					h += (h << 10);
 					h ^= (h >> 6);
 				}
+				st = h;
+			}
+			
+			static hash_t final(state_t& st) {
+				::uint32_t h = st;
 				h += (h << 3);
 				h ^= (h >> 11);
 				h += (h << 15);
 				return h;
 			}
+			
+			static hash_t hash(const block_data_t *s, size_type l) {
+				state_t st;
+				init(st);
+				update(st, s, l);
+				return final(st);
+			}
 		
 	}; // Jenkins
 }
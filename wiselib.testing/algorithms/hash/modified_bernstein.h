@@ -25,6 +25,9 @@ namespace wiselib {
 	/**
 	 * @brief The "modified" Bernstein hash function.
 	 * 
+	 * Provides the incremental @a init() / @a update() / @a final()
+	 * interface in addition to @a hash().
+	 * 
 	 * @ingroup Hash_concept
 	 */
 	template<
@@ -40,13 +43,26 @@ namespace wiselib {
 			
 			enum { MAX_VALUE = (hash_t)(-1) };
 			
-			static hash_t hash(const block_data_t *s, size_type l) {
-				hash_t h = (hash_t)5381;
+			typedef hash_t state_t;
+			
+			static void init(state_t& st) { st = (hash_t)5381; }
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				hash_t h = st;
 				const block_data_t *end = s + l;
 				for( ; s < end; s++) {
 					h = (33 * h) ^ *s;
 				}
-				return h;
+				st = h;
+			}
+			
+			static hash_t final(state_t& st) { return st; }
+			
+			static hash_t hash(const block_data_t *s, size_type l) {
+				state_t st;
+				init(st);
+				update(st, s, l);
+				return final(st);
 			}
 	}; // ModifiedBernstein
 }
@@ -20,13 +20,15 @@
 #ifndef MURMUR_H
 #define MURMUR_H
 
-#include <util/standalone_math.h>
-
 namespace wiselib {
 	
 	/**
 	 * @brief Murmur hash function.
 	 * 
+	 * Besides the one-shot @a hash() an incremental interface is provided:
+	 * @a init() a @a state_t, feed it with any number of @a update() calls
+	 * and obtain the hash value of the concatenated input with @a final().
+	 * 
 	 * @ingroup Hash_concept
 	 */
 	template<
@@ -39,28 +41,63 @@ namespace wiselib {
 			typedef typename OsModel::block_data_t block_data_t;
 			typedef typename OsModel::size_t size_type;
 			typedef ::uint32_t hash_t;
-			typedef StandaloneMath<OsModel> Math;
 			
 			enum { MAX_VALUE = (hash_t)(-1) };
+			enum { SEED = 0x12345678 };
 			
-			static hash_t hash(const block_data_t *s, size_type l) {
-				static const ::uint32_t seed = 0x12345678;
+			struct state_t {
+				::uint32_t hash;
+				::uint32_t length;
+				block_data_t tail[4];
+				::uint8_t tail_length;
+			};
+			
+			static void init(state_t& st) {
+				st.hash = SEED;
+				st.length = 0;
+				st.tail_length = 0;
+			}
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				const block_data_t *end = s + l;
+				st.length += l;
 				
-				::uint32_t c1 = 0xcc9e2d51, c2 = 0x1b873593,
-					r1 = 15, r2 = 13, m = 5,
-					n = 0xe6546b64, hash = seed;
+				if(st.tail_length) {
+					while(st.tail_length < 4 && s < end) {
+						st.tail[st.tail_length++] = *s++;
+					}
+					if(st.tail_length < 4) { return; }
+					st.hash = mix(st.hash, load(st.tail));
+					st.tail_length = 0;
+				}
 				
-				const block_data_t *end = s + l;
 				for( ; s + 4 <= end; s += 4) {
+					st.hash = mix(st.hash, load(s));
+				}
+				
+				while(s < end) {
+					st.tail[st.tail_length++] = *s++;
+				}
+			}
+			
+			static hash_t final(state_t& st) {
+				::uint32_t hash = st.hash;
+				if(st.tail_length) {
 					::uint32_t k = 0;
-					memcpy(&k, s, Math::min((size_type)4, (size_type)(end - s)));
-					k *= c1;
-					k = (k << r1) | (k >> (32 - r1));
-					k *= c2;
-					
-					hash ^= k;
-					hash = (hash << r2) | (hash >> (32 - r2));
-					hash = hash * m + n;
+					for(int i = 0; i < st.tail_length; i++) {
+						k |= st.tail[i] << (8 * i);
+					}
+					hash ^= scramble(k);
+				}
+				return finalize(hash, st.length);
+			}
+			
+			static hash_t hash(const block_data_t *s, size_type l) {
+				::uint32_t hash = SEED;
+				
+				const block_data_t *end = s + l;
+				for( ; s + 4 <= end; s += 4) {
+					hash = mix(hash, load(s));
 				}
 				
 				if(end > s) {
@@ -68,14 +105,36 @@ namespace wiselib {
 					for(int i = 0; i < end - s; i++) {
 						k |= s[i] << (8 * i);
 					}
-					
-					k *= c1;
-					k = (k << r1) | (k >> (32 - r1));
-					k *= c2;
-					hash ^= k;
+					hash ^= scramble(k);
 				}
 				
-				hash ^= (::uint32_t)l;
+				return finalize(hash, (::uint32_t)l);
+			}
+			
+			/// @{ Building blocks, also used by the batched implementation
+			/// in hash_many.h.
+			
+			static ::uint32_t load(const block_data_t *s) {
+				::uint32_t k;
+				memcpy(&k, s, 4);
+				return k;
+			}
+			
+			static ::uint32_t scramble(::uint32_t k) {
+				k *= 0xcc9e2d51;
+				k = (k << 15) | (k >> (32 - 15));
+				k *= 0x1b873593;
+				return k;
+			}
+			
+			static ::uint32_t mix(::uint32_t hash, ::uint32_t k) {
+				hash ^= scramble(k);
+				hash = (hash << 13) | (hash >> (32 - 13));
+				return hash * 5 + 0xe6546b64;
+			}
+			
+			static ::uint32_t finalize(::uint32_t hash, ::uint32_t l) {
+				hash ^= l;
 				hash ^= (hash >> 16);
 				hash *= 0x85ebca6b;
 				hash ^= (hash >> 13);
@@ -83,6 +142,8 @@ namespace wiselib {
 				hash ^= (hash >> 16);
 				return hash;
 			}
+			
+			/// @}
 	}; // Murmur
 }
 
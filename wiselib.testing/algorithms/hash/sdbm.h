@@ -26,6 +26,9 @@ namespace wiselib {
 	 * @brief The "SDBM" hash function.
 	 * Source: http://www.cse.yorku.ca/~oz/hash.html#sdbm
 	 * 
+	 * Provides the incremental @a init() / @a update() / @a final()
+	 * interface in addition to @a hash().
+	 * 
 	 * @ingroup Hash_concept
 	 */
 	template<
@@ -41,13 +44,26 @@ namespace wiselib {
 			
 			enum { MAX_VALUE = (hash_t)(-1) };
 			
-			static hash_t hash(const block_data_t *s, size_type l) {
-				hash_t h = 0;
+			typedef hash_t state_t;
+			
+			static void init(state_t& st) { st = 0; }
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				hash_t h = st;
 				const block_data_t *end = s + l;
 				for( ; s < end; s++) {
 					h = *s + (h << 6) + (h << 16) - h;
 				}
-				return h;
+				st = h;
+			}
+			
+			static hash_t final(state_t& st) { return st; }
+			
+			static hash_t hash(const block_data_t *s, size_type l) {
+				state_t st;
+				init(st);
+				update(st, s, l);
+				return final(st);
 			}
 			
 	}; // Sdbm
@@ -0,0 +1,200 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+#ifndef XXHASH_H
+#define XXHASH_H
+
+namespace wiselib {
+	
+	/**
+	 * @brief 64 bit xxHash (XXH64) by Yann Collet.
+	 * Source: https://github.com/Cyan4973/xxHash
+	 * 
+	 * Processes 32 byte stripes in four independent lanes and thus is
+	 * considerably faster than the byte-wise hashes on 32/64 bit platforms
+	 * while passing SMHasher. Input is read in little endian byte order so
+	 * values are platform independent.
+	 * 
+	 * Provides the incremental @a init() / @a update() / @a final()
+	 * interface in addition to @a hash().
+	 * 
+	 * @ingroup Hash_concept
+	 */
+	template<
+		typename OsModel_P,
+		::uint64_t Seed_P = 0
+	>
+	class XxHash64 {
+		public:
+			typedef OsModel_P OsModel;
+			typedef typename OsModel::block_data_t block_data_t;
+			typedef typename OsModel::size_t size_type;
+			typedef ::uint64_t hash_t;
+			
+			enum { MAX_VALUE = (hash_t)(-1) };
+			enum { STRIPE_SIZE = 32 };
+			
+			struct state_t {
+				::uint64_t v[4];
+				::uint64_t length;
+				block_data_t buffer[STRIPE_SIZE];
+				::uint8_t buffer_length;
+			};
+			
+			static void init(state_t& st) {
+				st.v[0] = Seed_P + P1 + P2;
+				st.v[1] = Seed_P + P2;
+				st.v[2] = Seed_P;
+				st.v[3] = Seed_P - P1;
+				st.length = 0;
+				st.buffer_length = 0;
+			}
+			
+			static void update(state_t& st, const block_data_t *s, size_type l) {
+				const block_data_t *end = s + l;
+				st.length += l;
+				
+				if(st.buffer_length) {
+					while(st.buffer_length < STRIPE_SIZE && s < end) {
+						st.buffer[st.buffer_length++] = *s++;
+					}
+					if(st.buffer_length < STRIPE_SIZE) { return; }
+					stripe(st.v, st.buffer);
+					st.buffer_length = 0;
+				}
+				
+				for( ; s + STRIPE_SIZE <= end; s += STRIPE_SIZE) {
+					stripe(st.v, s);
+				}
+				
+				while(s < end) {
+					st.buffer[st.buffer_length++] = *s++;
+				}
+			}
+			
+			static hash_t final(state_t& st) {
+				::uint64_t h;
+				if(st.length >= STRIPE_SIZE) {
+					h = converge(st.v);
+				}
+				else {
+					h = Seed_P + P5;
+				}
+				h += st.length;
+				return tail(h, st.buffer, st.buffer_length);
+			}
+			
+			static hash_t hash(const block_data_t *s, size_type l) {
+				const block_data_t *end = s + l;
+				::uint64_t h;
+				
+				if(l >= STRIPE_SIZE) {
+					::uint64_t v[4] = { Seed_P + P1 + P2, Seed_P + P2, Seed_P, Seed_P - P1 };
+					for( ; s + STRIPE_SIZE <= end; s += STRIPE_SIZE) {
+						stripe(v, s);
+					}
+					h = converge(v);
+				}
+				else {
+					h = Seed_P + P5;
+				}
+				h += l;
+				return tail(h, s, end - s);
+			}
+			
+		private:
+			static const ::uint64_t P1 = 11400714785074694791ULL;
+			static const ::uint64_t P2 = 14029467366897019727ULL;
+			static const ::uint64_t P3 =  1609587929392839161ULL;
+			static const ::uint64_t P4 =  9650029242287828579ULL;
+			static const ::uint64_t P5 =  2870177450012600261ULL;
+			
+			static ::uint64_t rotl(::uint64_t x, int r) {
+				return (x << r) | (x >> (64 - r));
+			}
+			
+			static ::uint32_t read32(const block_data_t *s) {
+				return (::uint32_t)s[0] | ((::uint32_t)s[1] << 8) |
+					((::uint32_t)s[2] << 16) | ((::uint32_t)s[3] << 24);
+			}
+			
+			static ::uint64_t read64(const block_data_t *s) {
+				return (::uint64_t)read32(s) | ((::uint64_t)read32(s + 4) << 32);
+			}
+			
+			static ::uint64_t round(::uint64_t acc, ::uint64_t input) {
+				acc += input * P2;
+				acc = rotl(acc, 31);
+				return acc * P1;
+			}
+			
+			static ::uint64_t merge_round(::uint64_t acc, ::uint64_t v) {
+				acc ^= round(0, v);
+				return acc * P1 + P4;
+			}
+			
+			static void stripe(::uint64_t *v, const block_data_t *s) {
+				v[0] = round(v[0], read64(s));
+				v[1] = round(v[1], read64(s + 8));
+				v[2] = round(v[2], read64(s + 16));
+				v[3] = round(v[3], read64(s + 24));
+			}
+			
+			static ::uint64_t converge(const ::uint64_t *v) {
+				::uint64_t h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+				h = merge_round(h, v[0]);
+				h = merge_round(h, v[1]);
+				h = merge_round(h, v[2]);
+				h = merge_round(h, v[3]);
+				return h;
+			}
+			
+			/**
+			 * Process the remaining (< STRIPE_SIZE) bytes and apply the
+			 * final avalanche.
+			 */
+			static ::uint64_t tail(::uint64_t h, const block_data_t *s, size_type l) {
+				const block_data_t *end = s + l;
+				for( ; s + 8 <= end; s += 8) {
+					h ^= round(0, read64(s));
+					h = rotl(h, 27) * P1 + P4;
+				}
+				if(s + 4 <= end) {
+					h ^= (::uint64_t)read32(s) * P1;
+					h = rotl(h, 23) * P2 + P3;
+					s += 4;
+				}
+				for( ; s < end; s++) {
+					h ^= (::uint64_t)*s * P5;
+					h = rotl(h, 11) * P1;
+				}
+				
+				h ^= h >> 33;
+				h *= P2;
+				h ^= h >> 29;
+				h *= P3;
+				h ^= h >> 32;
+				return h;
+			}
+			
+	}; // XxHash64
+}
+
+#endif // XXHASH_H
+
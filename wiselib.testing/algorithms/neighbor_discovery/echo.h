@@ -66,6 +66,33 @@
  */
 #define ECHO_TIMES_ACC_NEARBY 2
 
+/**
+ * Beacons carry a piggybacked payload only in the ECHO_PAYLOAD_REPEAT
+ * beacons after it was changed and the list of stable neighbors only after
+ * it changed, otherwise just a digest of it. Every
+ * ECHO_FULL_BEACON_INTERVAL-th beacon and the first beacon after a new
+ * neighbor showed up carry everything (1 sends every beacon complete).
+ */
+#define ECHO_FULL_BEACON_INTERVAL 8
+#define ECHO_PAYLOAD_REPEAT 3
+
+/**
+ * While the neighborhood does not change and the node stability is at
+ * least ECHO_STABLE_NODE_STABILITY the beacon period is doubled after each
+ * beacon, up to ECHO_MAX_PERIOD_SHIFT times (0 keeps the period fixed).
+ * Any change goes back to the configured period. The period in use is
+ * announced in the beacons, the receivers scale their timeouts with it.
+ */
+#define ECHO_MAX_PERIOD_SHIFT 2
+#define ECHO_STABLE_NODE_STABILITY 8
+
+/**
+ * Events that are not payload events are queued while a beacon or the
+ * neighborhood is processed and handed to the registered algorithms
+ * afterwards.
+ */
+#define ECHO_MAX_PENDING_EVENTS 16
+
 //#define SUNSPOT_TEST
 
 namespace wiselib {
@@ -127,17 +154,22 @@ namespace wiselib {
       struct neighbor_entry {
          node_id_t id;
          uint32_t total_beacons;
+         uint32_t beacons_expected;
          time_t last_echo;
          time_t timeout;
          time_t first_beacon;
          uint16_t last_lqi;
          uint16_t avg_lqi;
          uint16_t stability;
+         uint16_t nb_digest;
          uint8_t beacons_in_row;
          uint8_t inverse_link_assoc;
+         uint8_t last_seq;
+         uint8_t period_shift;
          bool active;
          bool stable;
          bool bidi;
+         bool nb_list_known;
       };
 
       struct reg_alg_entry {
@@ -146,6 +178,12 @@ namespace wiselib {
          uint8_t alg_id;
          uint8_t size;
          uint8_t events_flag;
+         uint8_t changed;
+      };
+
+      struct pending_event {
+         node_id_t from;
+         uint8_t event;
       };
 
       // --------------------------------------------------------------------
@@ -153,6 +191,8 @@ namespace wiselib {
       typedef wiselib::vector_static<OsModel, reg_alg_entry_t, TOTAL_REG_ALG>
       reg_alg_vector_t;
       typedef typename reg_alg_vector_t::iterator reg_alg_iterator_t;
+      typedef wiselib::vector_static<OsModel, struct pending_event, ECHO_MAX_PENDING_EVENTS>
+      pending_event_vector_t;
 
       /**
        * Actual Vector containing callbacks for all the register applications.
@@ -297,7 +337,14 @@ namespace wiselib {
        * */
       void init_echo() {
          neighborhood.clear();
+         pending_events.clear();
          node_stability = 0;
+         beacon_seq = 0;
+         beacons_since_full = 0;
+         period_shift = 0;
+         last_nb_digest = 0;
+         full_beacon_pending = true;
+         nb_changed = true;
       }
       ;
 
@@ -327,6 +374,7 @@ namespace wiselib {
             entry.alg_id = payload_id;
             entry.size = 0;
             entry.events_flag = 0;
+            entry.changed = 0;
             entry.event_notifier_callback = event_notifier_delegate_t();
 
             //                entry.events_flag = events_flag;
@@ -342,6 +390,7 @@ namespace wiselib {
             entry.alg_id = payload_id;
             entry.size = 0;
             entry.events_flag = 0;
+            entry.changed = 0;
             entry.event_notifier_callback = event_notifier_delegate_t();
 
             /*                entry.alg_id = payload_id;
@@ -373,15 +422,20 @@ namespace wiselib {
 
       /**
        * It sets the payload for a specific application that is going
-       * to be piggybacked in the next hello msg.
+       * to be piggybacked in the next hello msg. A payload that did not
+       * change is only sent with the next full beacon.
        * */
       uint8_t set_payload(uint8_t payload_id, uint8_t *data, uint8_t len) {
 
          for (reg_alg_iterator_t it = registered_apps.begin(); it
                  != registered_apps.end(); it++) {
             if (it->alg_id == payload_id) {
-               memcpy(it->data, data, len);
-               it->size = len;
+               if (it->size != len || memcmp(it->data, data, len) != 0) {
+                  memcpy(it->data, data, len);
+                  it->size = len;
+                  it->changed = ECHO_PAYLOAD_REPEAT;
+                  nb_changed = true;
+               }
                return 0;
             }
          }
@@ -466,12 +520,8 @@ namespace wiselib {
          uint8_t stability = 0;
          for (iterator_t it = neighborhood.begin(); it != neighborhood.end(); ++it) {
             if (it->id == id) {
-               uint32_t millis = (uint32_t) clock().milliseconds(
-                       clock().time()) + clock().seconds(clock().time())
-                       * 1000 - (uint32_t) clock().milliseconds(
-                       it->first_beacon) - (uint32_t) clock().seconds(
-                       it->first_beacon) * 1000;
-               uint32_t beacons_send = (millis / beacon_period) + 1;
+               // counted from the sequence numbers, the period may vary
+               uint32_t beacons_send = it->beacons_expected;
 
 #ifdef DEBUG_ECHO
                if (beacons_send < it->total_beacons)
@@ -538,6 +588,7 @@ namespace wiselib {
          reg_alg_entry_t entry;
          entry.alg_id = alg_id;
          entry.size = 0;
+         entry.changed = 0;
          entry.event_notifier_callback
                  = event_notifier_delegate_t::template from_method<T, TMethod>(
                  obj_pnt);
@@ -616,7 +667,26 @@ namespace wiselib {
                                         echomsg.payload() + sizeof(node_id_t)*2 + sizeof(uint8_t))
                                         ,echomsg.nb_list_size());*/
 #endif
-            add_pg_payload(&echomsg);
+            uint16_t digest = echomsg.nb_list_digest();
+            if (digest != last_nb_digest) {
+               last_nb_digest = digest;
+               full_beacon_pending = true;
+               nb_changed = true;
+            }
+            // the beacon announces the period until the next one
+            update_period_shift();
+            bool full = full_beacon_pending
+                    || (++beacons_since_full >= ECHO_FULL_BEACON_INTERVAL);
+            if (full) {
+               beacons_since_full = 0;
+               full_beacon_pending = false;
+            } else {
+               echomsg.clear_nb_list();
+            }
+            echomsg.set_nb_digest(digest);
+            echomsg.set_seq(++beacon_seq);
+            echomsg.set_period_shift(period_shift);
+            add_pg_payload(&echomsg, full);
 
 
             //send the Beacon
@@ -651,11 +721,15 @@ namespace wiselib {
 #ifdef DEBUG_ECHO_EXTRA
             show_nearby();
 #endif
+         } else {
+            update_period_shift();
          }
 
+         flush_events();
+
          //Reset the timoout for the next beacon
-         timer().template set_timer<self_t, &self_t::say_hello> (beacon_period,
-                 this, (void*) 0);
+         timer().template set_timer<self_t, &self_t::say_hello> (
+                 (uint32_t) beacon_period << period_shift, this, (void*) 0);
       }
       ;
 
@@ -713,9 +787,9 @@ namespace wiselib {
 
             // check the beacons sender status
 #ifndef SHAWN
-            received_beacon(from, ex);
+            received_beacon(from, ex, recvmsg);
 #else
-            received_beacon(from);
+            received_beacon(from, recvmsg);
 #endif
 
             for (iterator_t
@@ -730,7 +804,15 @@ namespace wiselib {
 
                if (it->id == from) {
 
-                  uint8_t nb_size_bytes = recvmsg->nb_list_size();
+                  // Beacons without the list or with the list that was
+                  // evaluated last time leave the bidi state as it is
+                  bool parse_list = recvmsg->nb_list_included();
+#ifndef ENABLE_STABILITY_THRESHOLDS
+                  if (it->nb_list_known && it->nb_digest == recvmsg->nb_digest()) {
+                     parse_list = false;
+                  }
+#endif
+                  uint8_t nb_size_bytes = parse_list ? recvmsg->nb_list_size() : 0;
                   uint8_t bytes_read = 0;
 
 
@@ -815,19 +897,27 @@ namespace wiselib {
                   debug().debug("Debug::echo NODE %d has bidirectional communication with %d\n", radio().id(), from);
 #endif
 
-                  if (contains_my_id) {
-                     if (!it->bidi) {
-                        it->bidi = true;
-                        notify_listeners(NEW_NB_BIDI, from, 0, 0);
-                     }
+                  if (parse_list) {
+                     it->nb_digest = recvmsg->nb_digest();
+                     it->nb_list_known = true;
 
-                  } else {
-                     if (it->bidi) {
-                        it->bidi = false;
-                        notify_listeners(LOST_NB_BIDI, from, 0, 0);
+                     if (contains_my_id) {
+                        if (!it->bidi) {
+                           it->bidi = true;
+                           notify_listeners(NEW_NB_BIDI, from, 0, 0);
+                        }
+
+                     } else {
+                        if (it->bidi) {
+                           it->bidi = false;
+                           notify_listeners(LOST_NB_BIDI, from, 0, 0);
+                        }
                      }
                   }
 
+                  // the payload events come after the ones of this beacon
+                  flush_events();
+
                   uint8_t * alg_pl = recvmsg->payload()
                           + recvmsg->nb_list_size();
                   for (int i = 0; i < recvmsg->get_pg_payloads_num(); i++) {
@@ -877,6 +967,7 @@ namespace wiselib {
                }
 
             }
+            flush_events();
          }
 
       }
@@ -914,10 +1005,10 @@ namespace wiselib {
        * */
 #ifdef SHAWN
 
-      void received_beacon(node_id_t from) {
+      void received_beacon(node_id_t from, EchoMsg_t * msg) {
 #else
 
-      void received_beacon(node_id_t from, ExData ex) {
+      void received_beacon(node_id_t from, ExData ex, EchoMsg_t * msg) {
 #endif
          // known is true if node from was contacted before
          bool known = false;
@@ -931,6 +1022,24 @@ namespace wiselib {
                //						radio().id(), from, get_nb_stability(from) , get_ilink_assoc(from), get_link_assoc(from));
 
                it->total_beacons++;
+               // beacons sent by from since the last one received, a
+               // sequence number that went back or that advanced by more
+               // beacons than fit into the time since the last one means
+               // that from rebooted
+               uint8_t gap = (uint8_t) (msg->seq() - it->last_seq);
+               uint32_t elapsed_millisec = (clock().seconds(clock().time())
+                       - clock().seconds(it->last_echo)) * 1000
+                       + clock().milliseconds(clock().time())
+                       - clock().milliseconds(it->last_echo);
+               if (gap == 0 || gap >= 128
+                       || (uint32_t) (gap - 1) * beacon_period > elapsed_millisec) {
+                  it->total_beacons = 1;
+                  it->beacons_expected = 1;
+               } else {
+                  it->beacons_expected += gap;
+               }
+               it->last_seq = msg->seq();
+               it->period_shift = msg->period_shift();
 
                if (!it->active) {
                   break;
@@ -1003,37 +1112,44 @@ namespace wiselib {
             }
 #endif
 #endif
-            if (neighborhood.size() < neighborhood.max_size()) {
-
-               if (it == neighborhood.end()) {
-                  // create a new struct entry for the vector
-                  neighbor_entry_t new_nb_entry;
-                  new_nb_entry.id = from;
-                  new_nb_entry.first_beacon = clock().time();
-                  new_nb_entry.last_echo = clock().time();
-                  //                    new_nb_entry.timeout = new_nb_entry.last_echo + timeout_period;
-                  new_nb_entry.beacons_in_row = 1;
-                  new_nb_entry.stability = 0;
-                  new_nb_entry.inverse_link_assoc = 0;
-                  new_nb_entry.total_beacons = 1;
-                  new_nb_entry.active = true;
-                  new_nb_entry.stable = false;
-                  new_nb_entry.bidi = false;
-
-                  //                    a.uptime = ((double)a.time_known-(double)a.beacons_missed)/(double)a.time_known;
-                  //add the struct to the vector
-                  neighborhood.push_back(new_nb_entry);
-               } else {
-                  it->active = true;
-                  it->last_echo = clock().time();
-                  it->beacons_in_row = 1;
-                  it->stable = false;
-                  it->bidi = false;
-                  it->total_beacons++;
-               }
+            // inactive entries are reused even if the vector is full
+            if (it != neighborhood.end()) {
+               it->active = true;
+               it->last_echo = clock().time();
+               it->beacons_in_row = 1;
+               it->stable = false;
+               it->bidi = false;
+               it->nb_list_known = false;
+               full_beacon_pending = true;
+               nb_changed = true;
+            } else if (neighborhood.size() < neighborhood.max_size()) {
+               // create a new struct entry for the vector
+               neighbor_entry_t new_nb_entry;
+               new_nb_entry.id = from;
+               new_nb_entry.first_beacon = clock().time();
+               new_nb_entry.last_echo = clock().time();
+               //                    new_nb_entry.timeout = new_nb_entry.last_echo + timeout_period;
+               new_nb_entry.beacons_in_row = 1;
+               new_nb_entry.stability = 0;
+               new_nb_entry.nb_digest = 0;
+               new_nb_entry.inverse_link_assoc = 0;
+               new_nb_entry.total_beacons = 1;
+               new_nb_entry.beacons_expected = 1;
+               new_nb_entry.last_seq = msg->seq();
+               new_nb_entry.period_shift = msg->period_shift();
+               new_nb_entry.active = true;
+               new_nb_entry.stable = false;
+               new_nb_entry.bidi = false;
+               new_nb_entry.nb_list_known = false;
+
+               //                    a.uptime = ((double)a.time_known-(double)a.beacons_missed)/(double)a.time_known;
+               //add the struct to the vector
+               neighborhood.push_back(new_nb_entry);
+               // the new neighbor gets all payloads with the next beacon
+               full_beacon_pending = true;
+               nb_changed = true;
 
                //debug().debug("Added new neighbor %d %d\n",radio().id(),from);
-
             }
          }
 
@@ -1137,18 +1253,23 @@ namespace wiselib {
 
             uint32_t last_echo_millisec = clock().seconds(it->last_echo) * 1000
                     + (uint32_t) clock().milliseconds(it->last_echo);
+            // the neighbor announces the period it is using, on a longer one
+            // it may miss two more of its beacons than on beacon_period
+            uint32_t nb_beacon_period = (uint32_t) beacon_period << it->period_shift;
+            uint32_t nb_timeout_period = (uint32_t) timeout_period
+                    + 2 * (nb_beacon_period - beacon_period);
 
             //               debug().debug( "Debug::echo NODE %d cleanup %d %d\n",
             //                       radio().id(),
             //                       last_echo_millisec ,
             //                       current_millisec );
 
-            if ((last_echo_millisec + beacon_period + 40) < current_millisec) {
+            if ((last_echo_millisec + nb_beacon_period + 40) < current_millisec) {
                it->beacons_in_row = 0;
             }
             //TODO: Add a delta to last_echo_millisec
             // if last echo was too long before
-            if ((last_echo_millisec + (uint32_t) timeout_period)
+            if ((last_echo_millisec + nb_timeout_period)
                     < current_millisec) {
 
                // remove the node from the neighborhood
@@ -1161,8 +1282,10 @@ namespace wiselib {
                it->active = false;
                it->stable = false;
                it->bidi = false;
+               it->nb_list_known = false;
                it->beacons_in_row = 0;
                it->stability = 0;
+               nb_changed = true;
 
 #ifdef DEBUG_ECHO
 #ifdef ISENSE
@@ -1171,8 +1294,6 @@ namespace wiselib {
                debug().debug("Debug::echo NODE %d droped from neighbors %d\n", radio().id(), it->id);
 #endif
 #endif
-               cleanup_nearby();
-               break;
             }
             /*
             #ifdef ENABLE_STABILITY_THRESHOLDSX
@@ -1263,33 +1384,85 @@ namespace wiselib {
 
       // --------------------------------------------------------------------
 
+      /**
+       * Queues an event without payload, flush_events() hands the queued
+       * events to the registered algorithms.
+       */
       void notify_listeners(uint8_t event, node_id_t from, uint8_t len,
               uint8_t *data) {
 
+         if (event == NEW_NB || event == DROPPED_NB
+                 || event == NEW_NB_BIDI || event == LOST_NB_BIDI) {
+            nb_changed = true;
+         }
+         if (pending_events.size() == pending_events.max_size()) {
+            flush_events();
+         }
+         struct pending_event pe;
+         pe.event = event;
+         pe.from = from;
+         pending_events.push_back(pe);
+         //                debug_callback(event, from, len, data);
+      }
+
+      /**
+       * Hands the queued events to the registered algorithms, in the order
+       * they were generated.
+       */
+      void flush_events() {
+
+         if (pending_events.empty()) {
+            return;
+         }
          for (reg_alg_iterator_t ait = registered_apps.begin(); ait
                  != registered_apps.end(); ++ait) {
 
-            if ((ait->event_notifier_callback != 0) && ((ait->events_flag
-                    & (uint8_t) event) == (uint8_t) event)) {
+            if (ait->event_notifier_callback == 0) {
+               continue;
+            }
+            for (size_t i = 0; i < pending_events.size(); i++) {
+               uint8_t event = pending_events[i].event;
+               if ((ait->events_flag & event) == event) {
+                  ait->event_notifier_callback(event, pending_events[i].from, 0, 0);
+               }
+            }
+         }
+         pending_events.clear();
+      }
 
-               ait->event_notifier_callback(event, from, len, data);
+      /**
+       * Doubles the beacon period while the neighborhood stays the same
+       * and the node is stable, any change goes back to beacon_period.
+       */
+      void update_period_shift() {
 
-            }
+         uint8_t max_shift = 0;
+         while (max_shift < ECHO_MAX_PERIOD_SHIFT
+                 && ((uint32_t) beacon_period << (max_shift + 1)) <= 0xffff) {
+            max_shift++;
          }
-         //                debug_callback(event, from, len, data);
+         if (nb_changed || node_stability < ECHO_STABLE_NODE_STABILITY) {
+            period_shift = 0;
+         } else if (period_shift < max_shift) {
+            period_shift++;
+         }
+         nb_changed = false;
       }
 
       /**
        * Add the payloads that were set by each registered algorithm
        * to the echo message that is going to be transmitted
        */
-      void add_pg_payload(EchoMsg_t * msg) {
+      void add_pg_payload(EchoMsg_t * msg, bool full) {
 
          for (reg_alg_iterator_t ait = registered_apps.begin(); ait
                  != registered_apps.end(); ++ait) {
-            if (ait->size != 0) {
+            if (ait->size != 0 && (full || ait->changed)) {
                msg->append_payload(ait->alg_id, ait->data, ait->size);
             }
+            if (ait->changed) {
+               ait->changed--;
+            }
          }
       }
 
@@ -1357,6 +1530,35 @@ namespace wiselib {
       uint16_t node_stability;
       uint16_t node_stability_prv;
 
+      /**
+       * Events waiting for flush_events().
+       */
+      pending_event_vector_t pending_events;
+      /**
+       * Sequence number of the last beacon sent.
+       */
+      uint8_t beacon_seq;
+      /**
+       * Beacons sent since the last full one.
+       */
+      uint8_t beacons_since_full;
+      /**
+       * The beacon period in use is beacon_period << period_shift.
+       */
+      uint8_t period_shift;
+      /**
+       * Digest of the neighbor list of the last beacon sent.
+       */
+      uint16_t last_nb_digest;
+      /**
+       * The next beacon carries the neighbor list and all payloads.
+       */
+      bool full_beacon_pending;
+      /**
+       * The neighborhood or a payload changed since the last beacon.
+       */
+      bool nb_changed;
+
       /**
        * \brief The timeout for dropping a stable neighbor.
        *
@@ -29,6 +29,7 @@
 
 #include "pgb_payloads_ids.h"
 #include "util/serialization/simple_types.h"
+#include "algorithms/hash/fnv.h"
 
 namespace wiselib {
 
@@ -55,15 +56,26 @@ namespace wiselib {
          MSG_ID_POS  = 0, // message id position inside the message [uint8]
          NBS_NUM = 1,
          PG_NUM = 2,
-         PAYLOAD_POS = 3   // position of the payload length
+         FLAGS_POS = 3,    // NB_LIST_FLAG and the period shift [uint8]
+         SEQ_POS = 4,      // beacon sequence number [uint8]
+         NB_DIGEST_POS = 5, // digest of the neighbor list [uint16]
+         PAYLOAD_POS = 7   // position of the payload length
                            // (the payload starts at +1)
         };
 
+        enum flags {
+         NB_LIST_FLAG = 0x01, // the neighbor list is included
+         PERIOD_SHIFT_MASK = 0xf0 // the beacon period is shifted left by this
+        };
+
         // --------------------------------------------------------------------
 
         EchoMsg() {
             set_msg_id(HELLO_MESSAGE);
             set_nearby_list_size(0);
+            buffer[FLAGS_POS] = NB_LIST_FLAG;
+            buffer[SEQ_POS] = 0;
+            set_nb_digest(0);
             set_payload(0,0);
         };
         // --------------------------------------------------------------------
@@ -209,6 +221,52 @@ namespace wiselib {
             return buffer[PG_NUM];
         };
 
+        bool nb_list_included(void) {
+            return (buffer[FLAGS_POS] & NB_LIST_FLAG) != 0;
+        };
+
+        /**
+         * Removes the neighbor list, only the digest is left. Has to be
+         * called before any payload is appended.
+         */
+        void clear_nb_list(void) {
+            buffer[PAYLOAD_POS] -= buffer[NBS_NUM];
+            buffer[NBS_NUM] = 0;
+            buffer[FLAGS_POS] &= ~NB_LIST_FLAG;
+        };
+
+        uint8_t period_shift(void) {
+            return (buffer[FLAGS_POS] & PERIOD_SHIFT_MASK) >> 4;
+        };
+
+        void set_period_shift(uint8_t shift) {
+            buffer[FLAGS_POS] = (buffer[FLAGS_POS] & ~PERIOD_SHIFT_MASK) | (shift << 4);
+        };
+
+        uint8_t seq(void) {
+            return buffer[SEQ_POS];
+        };
+
+        void set_seq(uint8_t seq) {
+            buffer[SEQ_POS] = seq;
+        };
+
+        uint16_t nb_digest(void) {
+            return read<OsModel, block_data_t, uint16_t > (buffer + NB_DIGEST_POS);
+        };
+
+        void set_nb_digest(uint16_t digest) {
+            write<OsModel, block_data_t, uint16_t > (buffer + NB_DIGEST_POS, digest);
+        };
+
+        /**
+         * Digest of the neighbor list, sent instead of the list while it
+         * does not change.
+         */
+        uint16_t nb_list_digest(void) {
+            return Fnv1a<OsModel, uint16_t>::hash(buffer + PAYLOAD_POS + 1, buffer[NBS_NUM]);
+        };
+
 //        void append_payload(uint8_t pay)
 
     private:
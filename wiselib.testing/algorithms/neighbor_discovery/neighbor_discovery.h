@@ -324,11 +324,11 @@ namespace wiselib
 						}
 						if (nv_SCL.size() > 0 )
 						{
-							q_sort_neigh_active_con( 0, nv_SCL.size(), nv_SCL );
+							sort_neigh_active_con( nv_SCL );
 						}
 						if ( nv_non_SCL.size() > 0 )
 						{
-							q_sort_neigh_active_con( 0, nv_non_SCL.size(), nv_non_SCL );
+							sort_neigh_active_con( nv_non_SCL );
 						}
 						for ( Neighbor_vector_iterator i = nv_SCL.begin(); i != nv_SCL.end(); ++i )
 						{
@@ -375,7 +375,7 @@ namespace wiselib
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_ACTIVE_CONNECTIVITY_FILTERING
 						if ( beacon.get_neighborhood_ref()->size() > 0 )
 						{
-							q_sort_neigh_active_con( 0, beacon.get_neighborhood_ref()->size() - 1, *( beacon.get_neighborhood_ref() ) );
+							sort_neigh_active_con( *( beacon.get_neighborhood_ref() ) );
 						}
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_BEACONS
 						Protocol* p_ptr_atp = get_protocol_ref( ATP_PROTOCOL_ID );
@@ -464,150 +464,147 @@ namespace wiselib
 					{
 						uint8_t found_flag = 0;
 						Neighbor new_neighbor;
-						Neighbor_vector_iterator update_neighbor_it = pit->get_neighborhood_ref()->begin();
-						for ( Neighbor_vector_iterator nit = pit->get_neighborhood_ref()->begin(); nit != pit->get_neighborhood_ref()->end(); ++nit )
+						Neighbor* nit = pit->get_neighbor_ref( _from );
+						if ( nit != NULL )
 						{
-							if ( _from == nit->get_id() )
+#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
+							if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
 							{
+							debug().debug( "NeighborDiscovery - receive %x - Neighbor %x is known for protocol %i.\n", radio().id(), _from, pit->get_protocol_id() );
+							}
+#endif
+							found_flag = 1;
+							dead_time_res = clock().seconds( current_time ) * 1000 - clock().seconds( nit->get_last_beacon() ) * 1000 + clock().milliseconds( current_time ) - clock().milliseconds( nit->get_last_beacon() );
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-								if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
-								{
-								debug().debug( "NeighborDiscovery - receive %x - Neighbor %x is known for protocol %i.\n", radio().id(), _from, pit->get_protocol_id() );
-								}
+							if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
+							{
+							if ( clock().milliseconds( current_time ) == 0 )
+							{
+								debug().debug( "NeighborDiscovery - receive %x - Clock paradox possibility from: %x - %d:%d minus %d:%d.\n", radio().id(), _from, clock().seconds( current_time ), clock().seconds( nit->get_last_beacon() ), clock().milliseconds( current_time ), clock().milliseconds( nit->get_last_beacon() ) );
+							}
+							}
 #endif
-								update_neighbor_it = nit;
-								found_flag = 1;
-								dead_time_res = clock().seconds( current_time ) * 1000 - clock().seconds( nit->get_last_beacon() ) * 1000 + clock().milliseconds( current_time ) - clock().milliseconds( nit->get_last_beacon() );
+							if ( dead_time_res < 0 )
+							{
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
 								if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
 								{
-								if ( clock().milliseconds( current_time ) == 0 )
-								{
-									debug().debug( "NeighborDiscovery - receive %x - Clock paradox possibility from: %x - %d:%d minus %d:%d.\n", radio().id(), _from, clock().seconds( current_time ), clock().seconds( nit->get_last_beacon() ), clock().milliseconds( current_time ), clock().milliseconds( nit->get_last_beacon() ) );
-								}
+								debug().debug( "NeighborDiscovery - receive %x - Clock paradox from: %x - %d:%d minus %d:%d.\n", radio().id(), _from, clock().seconds( current_time ), clock().seconds( nit->get_last_beacon() ), clock().milliseconds( current_time ), clock().milliseconds( nit->get_last_beacon() ) );
 								}
 #endif
-								if ( dead_time_res < 0 )
+#ifdef DEBUG_NEIGHBOR_DISCOVERY_STATS
+								clock_paradox_message_drops++;
+#endif
+								return;
+							}
+							else
+							{
+								dead_time = clock().seconds( current_time ) * 1000 - clock().seconds( nit->get_last_beacon() ) * 1000 + clock().milliseconds( current_time ) - clock().milliseconds( nit->get_last_beacon() );
+							}
+							if ( beacon.get_beacon_period() == nit->get_beacon_period() )
+							{
+								if ( dead_time < beacon.get_beacon_period() + beacon.get_beacon_period()/2 )
 								{
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
 									if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
 									{
-									debug().debug( "NeighborDiscovery - receive %x - Clock paradox from: %x - %d:%d minus %d:%d.\n", radio().id(), _from, clock().seconds( current_time ), clock().seconds( nit->get_last_beacon() ), clock().milliseconds( current_time ), clock().milliseconds( nit->get_last_beacon() ) );
+									debug().debug( "NeighborDiscovery - receive %x - Neighbor %x is on time same as advertised for protocol %i with dead_time : %d.\n", radio().id(), _from, pit->get_protocol_id(), dead_time );
 									}
 #endif
-#ifdef DEBUG_NEIGHBOR_DISCOVERY_STATS
-									clock_paradox_message_drops++;
-#endif
-									return;
-								}
-								else
-								{
-									dead_time = clock().seconds( current_time ) * 1000 - clock().seconds( nit->get_last_beacon() ) * 1000 + clock().milliseconds( current_time ) - clock().milliseconds( nit->get_last_beacon() );
-								}
-								if ( beacon.get_beacon_period() == nit->get_beacon_period() )
-								{
-									if ( dead_time < beacon.get_beacon_period() + beacon.get_beacon_period()/2 )
-									{
+									new_neighbor = *nit;
+									new_neighbor.inc_total_beacons( 1 * pit->resolve_beacon_weight( _from ) );
+									new_neighbor.inc_total_beacons_expected( 1 * pit->resolve_beacon_weight( _from ) );
+									new_neighbor.update_link_stab_ratio();
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
-										{
-										debug().debug( "NeighborDiscovery - receive %x - Neighbor %x is on time same as advertised for protocol %i with dead_time : %d.\n", radio().id(), _from, pit->get_protocol_id(), dead_time );
-										}
-#endif
-										new_neighbor = *nit;
-										new_neighbor.inc_total_beacons( 1 * pit->resolve_beacon_weight( _from ) );
-										new_neighbor.inc_total_beacons_expected( 1 * pit->resolve_beacon_weight( _from ) );
-										new_neighbor.update_link_stab_ratio();
-#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
-										{
-										debug().debug( "LSR:%x:%x:%d", radio().id(), new_neighbor.get_id(), new_neighbor.get_total_beacons_expected() );
-										}
+									if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
+									{
+									debug().debug( "LSR:%x:%x:%d", radio().id(), new_neighbor.get_id(), new_neighbor.get_total_beacons_expected() );
+									}
 #endif
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_LQI_FILTERING
-										new_neighbor.update_avg_LQI( signal_quality, 1 );
+									new_neighbor.update_avg_LQI( signal_quality, 1 );
 #endif
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_RSSI_FILTERING
-										new_neighbor.update_avg_RSSI( signal_strength, 1 );
+									new_neighbor.update_avg_RSSI( signal_strength, 1 );
 #endif
-										new_neighbor.set_beacon_period( beacon.get_beacon_period() );
-										new_neighbor.set_beacon_period_update_counter( beacon.get_beacon_period_update_counter() );
-										new_neighbor.set_last_beacon( current_time );
-									}
-									else
-									{
+									new_neighbor.set_beacon_period( beacon.get_beacon_period() );
+									new_neighbor.set_beacon_period_update_counter( beacon.get_beacon_period_update_counter() );
+									new_neighbor.set_last_beacon( current_time );
+								}
+								else
+								{
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
-										{
-										debug().debug( "NeighborDiscovery - receive %x - Neighbor %x was late same as advertised for protocol %i with dead_time : %d.\n", radio().id(), _from, pit->get_protocol_id(), dead_time );
-										}
-#endif
-										new_neighbor = *nit;
-										new_neighbor.inc_total_beacons( 1 * pit->resolve_beacon_weight( _from ) );
-										new_neighbor.inc_total_beacons_expected( ( dead_time / nit->get_beacon_period() ) * ( pit->resolve_lost_beacon_weight( _from ) ) );
-										new_neighbor.update_link_stab_ratio();
+									if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
+									{
+									debug().debug( "NeighborDiscovery - receive %x - Neighbor %x was late same as advertised for protocol %i with dead_time : %d.\n", radio().id(), _from, pit->get_protocol_id(), dead_time );
+									}
+#endif
+									new_neighbor = *nit;
+									new_neighbor.inc_total_beacons( 1 * pit->resolve_beacon_weight( _from ) );
+									new_neighbor.inc_total_beacons_expected( ( dead_time / nit->get_beacon_period() ) * ( pit->resolve_lost_beacon_weight( _from ) ) );
+									new_neighbor.update_link_stab_ratio();
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
-										{
-										debug().debug( "LSR:%x:%x:%d", radio().id(), new_neighbor.get_id(), new_neighbor.get_total_beacons_expected() );
-										}
+									if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
+									{
+									debug().debug( "LSR:%x:%x:%d", radio().id(), new_neighbor.get_id(), new_neighbor.get_total_beacons_expected() );
+									}
 #endif
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_LQI_FILTERING
-										new_neighbor.update_avg_LQI( signal_quality, 1 );
+									new_neighbor.update_avg_LQI( signal_quality, 1 );
 #endif
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_RSSI_FILTERING
-										new_neighbor.update_avg_RSSI( signal_strength, 1 );
+									new_neighbor.update_avg_RSSI( signal_strength, 1 );
 #endif
-										new_neighbor.set_beacon_period( beacon.get_beacon_period() );
-										new_neighbor.set_beacon_period_update_counter( beacon.get_beacon_period_update_counter() );
-										new_neighbor.set_last_beacon( current_time );
-									}
+									new_neighbor.set_beacon_period( beacon.get_beacon_period() );
+									new_neighbor.set_beacon_period_update_counter( beacon.get_beacon_period_update_counter() );
+									new_neighbor.set_last_beacon( current_time );
 								}
-								else
+							}
+							else
+							{
+								if ( dead_time < beacon.get_beacon_period() + beacon.get_beacon_period()/2 )
 								{
-									if ( dead_time < beacon.get_beacon_period() + beacon.get_beacon_period()/2 )
-									{
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
-										{
-										debug().debug( "NeighborDiscovery - receive %x - Neighbor %x is on time same as advertised for protocol %i with dead_time : %d.\n", radio().id(), _from, pit->get_protocol_id(), dead_time );
-										}
-#endif
-										new_neighbor = *nit;
-										new_neighbor.inc_total_beacons( 1 * pit->resolve_beacon_weight( _from ) );
-										new_neighbor.inc_total_beacons_expected( 1 * pit->resolve_beacon_weight( _from ) );
-										new_neighbor.update_link_stab_ratio();
+									if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
+									{
+									debug().debug( "NeighborDiscovery - receive %x - Neighbor %x is on time same as advertised for protocol %i with dead_time : %d.\n", radio().id(), _from, pit->get_protocol_id(), dead_time );
+									}
+#endif
+									new_neighbor = *nit;
+									new_neighbor.inc_total_beacons( 1 * pit->resolve_beacon_weight( _from ) );
+									new_neighbor.inc_total_beacons_expected( 1 * pit->resolve_beacon_weight( _from ) );
+									new_neighbor.update_link_stab_ratio();
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
-										{
-										debug().debug( "LSR:%x:%x:%d", radio().id(), new_neighbor.get_id(), new_neighbor.get_total_beacons_expected() );
-										}
+									if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) && ( radio().id() == 0x96f4 ) )
+									{
+									debug().debug( "LSR:%x:%x:%d", radio().id(), new_neighbor.get_id(), new_neighbor.get_total_beacons_expected() );
+									}
 #endif
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_LQI_FILTERING
-										new_neighbor.update_avg_LQI( signal_quality, 1 );
+									new_neighbor.update_avg_LQI( signal_quality, 1 );
 #endif
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_RSSI_FILTERING
-										new_neighbor.update_avg_RSSI( signal_strength, 1 );
+									new_neighbor.update_avg_RSSI( signal_strength, 1 );
 #endif
-										new_neighbor.set_beacon_period( beacon.get_beacon_period() );
-										new_neighbor.set_beacon_period_update_counter( beacon.get_beacon_period_update_counter() );
-										new_neighbor.set_last_beacon( current_time );
-									}
-									else
-									{
+									new_neighbor.set_beacon_period( beacon.get_beacon_period() );
+									new_neighbor.set_beacon_period_update_counter( beacon.get_beacon_period_update_counter() );
+									new_neighbor.set_last_beacon( current_time );
+								}
+								else
+								{
 //#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID )/* && ( radio().id() == 0x96f4 )*/ )
-										{
-										debug().debug( "NeighborDiscovery - receive %x - Neighbor %x is late and not as advertised for protocol %id with dead_time : %d.\n", radio().id(), _from, pit->get_protocol_id(), dead_time );
-										}
+									if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID )/* && ( radio().id() == 0x96f4 )*/ )
+									{
+									debug().debug( "NeighborDiscovery - receive %x - Neighbor %x is late and not as advertised for protocol %id with dead_time : %d.\n", radio().id(), _from, pit->get_protocol_id(), dead_time );
+									}
 //#endif
-										//TODO overflow here.
-										//uint32_t last_beacon_period_update = beacon.get_beacon_period_update_counter() * beacon.get_beacon_period();
-										millis_t approximate_beacon_period = 0;
-										if ( pit->get_protocol_settings_ref()->get_dead_time_strategy() == ProtocolSettings::NEW_DEAD_TIME_PERIOD )
-										{
-											approximate_beacon_period = beacon.get_beacon_period();
-										}
+									//TODO overflow here.
+									//uint32_t last_beacon_period_update = beacon.get_beacon_period_update_counter() * beacon.get_beacon_period();
+									millis_t approximate_beacon_period = 0;
+									if ( pit->get_protocol_settings_ref()->get_dead_time_strategy() == ProtocolSettings::NEW_DEAD_TIME_PERIOD )
+									{
+										approximate_beacon_period = beacon.get_beacon_period();
+									}
 //										else if ( pit->get_protocol_settings_ref()->get_dead_time_strategy() == ProtocolSettings::OLD_DEAD_TIME_PERIOD )
 //										{
 //											approximate_beacon_period = nit->get_beacon_period();
@@ -620,27 +617,26 @@ namespace wiselib
 //										{
 //											approximate_beacon_period = ( beacon.get_beacon_period() * pit->get_protocol_settings_ref()->get_new_dead_time_period_weight() + nit->get_beacon_period() * pit->get_protocol_settings_ref()->get_old_dead_time_period_weight() ) / ( pit->get_protocol_settings_ref()->get_old_dead_time_period_weight() + pit->get_protocol_settings_ref()->get_new_dead_time_period_weight() );
 //										}
-										uint32_t dead_time_messages_lost = ( dead_time/* - last_beacon_period_update*/ ) / approximate_beacon_period;
-										new_neighbor = *nit;
-										new_neighbor.inc_total_beacons( 1 * pit->resolve_beacon_weight( _from ) );
-										new_neighbor.inc_total_beacons_expected( /*(*/ dead_time_messages_lost /*+ beacon.get_beacon_period_update_counter() )*/ * ( pit->resolve_lost_beacon_weight( _from ) ) );
-										new_neighbor.update_link_stab_ratio();
+									uint32_t dead_time_messages_lost = ( dead_time/* - last_beacon_period_update*/ ) / approximate_beacon_period;
+									new_neighbor = *nit;
+									new_neighbor.inc_total_beacons( 1 * pit->resolve_beacon_weight( _from ) );
+									new_neighbor.inc_total_beacons_expected( /*(*/ dead_time_messages_lost /*+ beacon.get_beacon_period_update_counter() )*/ * ( pit->resolve_lost_beacon_weight( _from ) ) );
+									new_neighbor.update_link_stab_ratio();
 //#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) /*&& ( radio().id() == 0x96f4 )*/ )
-										{
-										debug().debug( "LSR:%x:%x:%d:%d:%d:%d:%d\n", radio().id(), new_neighbor.get_id(), dead_time_messages_lost, beacon.get_beacon_period(), nit->get_beacon_period(), dead_time, pit->resolve_beacon_weight( _from ), new_neighbor.get_total_beacons_expected() );
-										}
+									if ( ( pit->get_protocol_id() == ATP_PROTOCOL_ID ) /*&& ( radio().id() == 0x96f4 )*/ )
+									{
+									debug().debug( "LSR:%x:%x:%d:%d:%d:%d:%d\n", radio().id(), new_neighbor.get_id(), dead_time_messages_lost, beacon.get_beacon_period(), nit->get_beacon_period(), dead_time, pit->resolve_beacon_weight( _from ), new_neighbor.get_total_beacons_expected() );
+									}
 //#endif
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_LQI_FILTERING
-										new_neighbor.update_avg_LQI( signal_quality, 1 );
+									new_neighbor.update_avg_LQI( signal_quality, 1 );
 #endif
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_RSSI_FILTERING
-										new_neighbor.update_avg_RSSI( signal_strength, 1 );
+									new_neighbor.update_avg_RSSI( signal_strength, 1 );
 #endif
-										new_neighbor.set_beacon_period( beacon.get_beacon_period() );
-										new_neighbor.set_beacon_period_update_counter( beacon.get_beacon_period_update_counter() );
-										new_neighbor.set_last_beacon( current_time );
-									}
+									new_neighbor.set_beacon_period( beacon.get_beacon_period() );
+									new_neighbor.set_beacon_period_update_counter( beacon.get_beacon_period_update_counter() );
+									new_neighbor.set_last_beacon( current_time );
 								}
 							}
 						}
@@ -766,11 +762,13 @@ namespace wiselib
 							if ( found_flag == 1 )
 							{
 								events_flag = events_flag | ProtocolSettings::UPDATE_NB;
-								if ( new_neighbor.get_beacon_period() != update_neighbor_it->get_beacon_period() )
+								if ( new_neighbor.get_beacon_period() != nit->get_beacon_period() )
 								{
 									events_flag = events_flag | ProtocolSettings::BEACON_PERIOD_UPDATE;
 								}
-								*update_neighbor_it = new_neighbor;
+								*nit = new_neighbor;
+								pit->update_neighbor( nit );
+								pit->schedule_neighbor( nit, neighbor_deadline( *nit ) );
 								pit->resolve_overflow_strategy( _from );
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
 								debug().debug( "NeighborDiscovery - receive - Neighbor %x was updated and active for protocol %i.\n", _from, pit->get_protocol_id() );
@@ -779,35 +777,21 @@ namespace wiselib
 							else
 							{
 								events_flag = events_flag | ProtocolSettings::NEW_NB;
-								if ( pit->get_neighborhood_ref()->size() == pit->get_neighborhood_ref()->max_size() )
+								if ( pit->insert_neighbor( new_neighbor, neighbor_deadline( new_neighbor ) ) != NULL )
 								{
-									uint8_t rs = remove_worst_neighbor( *pit );
-									if ( rs == 0 )
-									{
-										pit->get_neighborhood_ref()->push_back( new_neighbor );
-										pit->resolve_overflow_strategy( _from );
-#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										debug().debug("NeighborDiscovery - receive - Neighbor %x was inserted and active for protocol %i.\n", _from, pit->get_protocol_id() );
-										new_neighbor.print( debug(), radio() );
-#endif
-									}
+									pit->resolve_overflow_strategy( _from );
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-									else
-									{
-										debug().debug("NeighborDiscovery - receive - Neighbor %x was could be inserted and would be active for protocol %i.\n", _from, pit->get_protocol_id() );
-										new_neighbor.print( debug(), radio() );
-									}
+									debug().debug("NeighborDiscovery - receive - Neighbor %x was inserted and active for protocol %i.\n", _from, pit->get_protocol_id() );
+									new_neighbor.print( debug(), radio() );
 #endif
 								}
+#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
 								else
 								{
-									pit->get_neighborhood_ref()->push_back( new_neighbor );
-									pit->resolve_overflow_strategy( _from );
-#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										debug().debug("NeighborDiscovery - receive - Neighbor %x was inserted and active for protocol %i.\n", _from, pit->get_protocol_id() );
-										new_neighbor.print( debug(), radio() );
-#endif
+									debug().debug("NeighborDiscovery - receive - Neighbor %x could not be inserted and would be active for protocol %i.\n", _from, pit->get_protocol_id() );
+									new_neighbor.print( debug(), radio() );
 								}
+#endif
 							}
 							uint8_t payload_found_flag = 0;
 							ProtocolPayload pp;
@@ -841,40 +825,29 @@ namespace wiselib
 							if ( found_flag == 1 )
 							{
 								events_flag = events_flag | ProtocolSettings::LOST_NB;
-								*update_neighbor_it = new_neighbor;
+								*nit = new_neighbor;
+								pit->update_neighbor( nit );
+								pit->schedule_neighbor( nit, neighbor_deadline( *nit ) );
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
 								debug().debug("NeighborDiscovery - receive - Neighbor %x was updated but inactive for protocol %i.\n", _from, pit->get_protocol_id() );
 #endif
 							}
 							else
 							{
-								if (pit->get_neighborhood_ref()->size() == pit->get_neighborhood_ref()->max_size() )
+								if ( pit->insert_neighbor( new_neighbor, neighbor_deadline( new_neighbor ) ) != NULL )
 								{
-									uint8_t rs = remove_worst_neighbor( *pit );
-									if ( rs == 0 )
-									{
-										pit->get_neighborhood_ref()->push_back( new_neighbor );
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-										debug().debug("NeighborDiscovery - receive - Neighbor %x was inserted but inactive for protocol %i.\n", _from, pit->get_protocol_id() );
-										new_neighbor.print( debug(), radio() );
-#endif
-									}
-#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-									else
-									{
-										debug().debug("NeighborDiscovery - receive - Neighbor %x could not be inserted but would be inactive for protocol %i.\n", _from, pit->get_protocol_id() );
-										new_neighbor.print( debug(), radio() );
-									}
+									debug().debug("NeighborDiscovery - receive - Neighbor %x was inserted but inactive for protocol %i.\n", _from, pit->get_protocol_id() );
+									new_neighbor.print( debug(), radio() );
 #endif
 								}
+#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
 								else
 								{
-									pit->get_neighborhood_ref()->push_back( new_neighbor );
-#ifdef DEBUG_NEIGHBOR_DISCOVERY_H_RECEIVE
-									debug().debug("NeighborDiscovery - receive - Neighbor %x was inserted but inactive for protocol %i.\n", _from, pit->get_protocol_id() );
+									debug().debug("NeighborDiscovery - receive - Neighbor %x could not be inserted but would be inactive for protocol %i.\n", _from, pit->get_protocol_id() );
 									new_neighbor.print( debug(), radio() );
-#endif
 								}
+#endif
 							}
 							events_flag = pit->get_protocol_settings_ref()->get_events_flag() & events_flag;
 							if ( events_flag != 0 )
@@ -965,8 +938,14 @@ namespace wiselib
 				int32_t dead_time_res = 0;
 				for ( Protocol_vector_iterator pit = protocols.begin(); pit != protocols.end(); ++pit )
 				{
-					for ( Neighbor_vector_iterator nit = pit->get_neighborhood_ref()->begin(); nit != pit->get_neighborhood_ref()->end(); ++nit )
+					// Only the neighbors whose deadline passed, the node itself is never scheduled
+					pit->begin_expiry( millis( current_time ) );
+					for ( Neighbor* nit = pit->next_expired_neighbor(); nit != NULL; nit = pit->next_expired_neighbor() )
 					{
+						if ( nit->get_id() == radio().id() )
+						{
+							continue;
+						}
 						dead_time_res = clock().seconds( current_time ) * 1000 - clock().seconds( nit->get_last_beacon() ) * 1000 + clock().milliseconds( current_time ) - clock().milliseconds( nit->get_last_beacon() );
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_ND_DAEMON
 						if ( clock().milliseconds( current_time ) == 0 )
@@ -982,14 +961,14 @@ namespace wiselib
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_STATS
 							clock_paradox_message_drops++;
 #endif
-							timer().template set_timer<self_t, &self_t::nd_daemon> ( nd_daemon_period, this, 0 );
-							return;
+							pit->schedule_neighbor( nit, neighbor_deadline( *nit ) );
+							continue;
 						}
 						else
 						{
 							dead_time = clock().seconds( current_time ) * 1000 - clock().seconds( nit->get_last_beacon() ) * 1000 + clock().milliseconds( current_time ) - clock().milliseconds( nit->get_last_beacon() );
 						}
-						if ( ( dead_time > nit->get_beacon_period() + nit->get_beacon_period()/2 ) && ( nit->get_id() != radio().id() ) )
+						if ( dead_time > nit->get_beacon_period() + nit->get_beacon_period()/2 )
 						{
 #ifdef DEBUG_NEIGHBOR_DISCOVERY_H_ND_DAEMON
 							debug().debug("NeighborDiscovery-nb_daemon %x - Teasing node %x.", radio().id(), nit->get_id() );
@@ -1075,12 +1054,14 @@ namespace wiselib
 								nit->set_active( 0 );
 								events_flag = events_flag | ProtocolSettings::LOST_NB;
 							}
+							pit->update_neighbor( nit );
 							events_flag = pit->get_protocol_settings_ref()->get_events_flag() & events_flag;
 							if ( events_flag != 0 )
 							{
 								pit->get_event_notifier_callback()( events_flag, nit->get_id(), 0, NULL );
 							}
 						}
+						pit->schedule_neighbor( nit, neighbor_deadline( *nit ) );
 					}
 				}
 				timer().template set_timer<self_t, &self_t::nd_daemon> ( nd_daemon_period, this, 0 );
@@ -1092,98 +1073,26 @@ namespace wiselib
 		// --------------------------------------------------------------------
 		uint8_t remove_worst_neighbor( Protocol& p_ref )
 		{
-			uint8_t min_link_stab_ratio = 100;
-			uint8_t min_link_stab_ratio_inverse = 100;
-#ifdef CONFIG_NEIGHBOR_DISCOVERY_H_LQI_FILTERING
-			uint8_t max_avg_lqi = ND_MAX_AVG_LQI_THRESHOLD;
-			uint8_t max_avg_lqi_inverse = ND_MAX_AVG_LQI_INVERSE_THRESHOLD;
-#endif
-#ifdef CONFIG_NEIGHBOR_DISCOVERY_H_RSSI_FILTERING
-			uint8_t min_avg_rssi = ND_MIN_AVG_RSSI_THRESHOLD;
-			uint8_t min_avg_rssi_inverse = ND_MIN_AVG_RSSI_INVERSE_THRESHOLD;
-#endif
-			Neighbor_vector_iterator mlsr		= p_ref.get_neighborhood_ref()->begin();
-			Neighbor_vector_iterator mlsr_in	= p_ref.get_neighborhood_ref()->begin();
-			Neighbor_vector_iterator mal		= p_ref.get_neighborhood_ref()->begin();
-			Neighbor_vector_iterator mal_in		= p_ref.get_neighborhood_ref()->begin();
-			Neighbor_vector_iterator mar		= p_ref.get_neighborhood_ref()->begin();
-			Neighbor_vector_iterator mar_in		= p_ref.get_neighborhood_ref()->begin();
-
-			for ( Neighbor_vector_iterator nit = p_ref.get_neighborhood_ref()->begin(); nit != p_ref.get_neighborhood_ref()->end(); ++nit )
-			{
-				if ( ( min_link_stab_ratio > nit->get_link_stab_ratio() ) && ( nit->get_active() == 0 ) )
-				{
-					mlsr = nit;
-					min_link_stab_ratio = nit->get_link_stab_ratio();
-				}
-				if ( ( min_link_stab_ratio > nit->get_link_stab_ratio_inverse() ) && ( nit->get_active() == 0 ) )
-				{
-					mlsr_in = nit;
-					min_link_stab_ratio_inverse = nit->get_link_stab_ratio_inverse();
-				}
-#ifdef CONFIG_NEIGHBOR_DISCOVERY_H_LQI_FILTERING
-				if ( ( max_avg_lqi < nit->get_avg_LQI() ) && ( nit->get_active() == 0 ) )
-				{
-					mal = nit;
-					max_avg_lqi = nit->get_avg_LQI();
-				}
-				if ( ( max_avg_lqi_inverse < nit->get_avg_LQI_inverse() ) && ( nit->get_active() == 0 ) )
-				{
-					mal_in = nit;
-					max_avg_lqi_inverse = nit->get_avg_LQI_inverse();
-				}
-
-#endif
-#ifdef CONFIG_NEIGHBOR_DISCOVERY_H_RSSI_FILTERING
-				if ( ( min_avg_rssi > nit->get_avg_RSSI() ) && ( nit->get_active() == 0 ) )
-				{
-					mar = nit;
-					min_avg_rssi = nit->get_avg_RSSI();
-				}
-				if ( ( min_avg_rssi_inverse < nit->get_avg_RSSI_inverse() ) && ( nit->get_active() == 0 ) )
-				{
-					mar_in = nit;
-					min_avg_rssi_inverse = nit->get_avg_RSSI_inverse();
-				}
-#endif
-			}
-			if ( min_link_stab_ratio != 0 )
-			{
-				p_ref.get_neighborhood_ref()->erase( mlsr );
-				return ProtocolSettings::NB_REMOVED;
-			}
-			if ( min_link_stab_ratio_inverse != 0 )
-			{
-				p_ref.get_neighborhood_ref()->erase( mlsr_in );
-				return ProtocolSettings::NB_REMOVED;
-			}
-#ifdef CONFIG_NEIGHBOR_DISCOVERY_H_LQI_FILTERING
-			if ( max_avg_lqi != 0 )
-			{
-				p_ref.get_neighborhood_ref()->erase( mal );
-				return ProtocolSettings::NB_REMOVED;
-			}
-			if ( max_avg_lqi_inverse != 0 )
-			{
-				p_ref.get_neighborhood_ref()->erase( mal_in );
-				return ProtocolSettings::NB_REMOVED;
-			}
-#endif
-#ifdef CONFIG_NEIGHBOR_DISCOVERY_H_RSSI_FILTERING
-			if ( min_avg_rssi != 0 )
-			{
-				p_ref.get_neighborhood_ref()->erase( mar );
-				return ProtocolSettings::NB_REMOVED;
-			}
-			if ( min_avg_rssi_inverse != 0 )
+			if ( p_ref.remove_worst_neighbor() )
 			{
-				p_ref.get_neighborhood_ref()->erase( mar_in );
 				return ProtocolSettings::NB_REMOVED;
 			}
-#endif
 			return 0;
 		}
 		// --------------------------------------------------------------------
+		/* Time in milliseconds used for the deadlines of the neighbors, the
+		 * differences are the ones the dead time computations use.
+		 */
+		uint32_t millis( time_t _t )
+		{
+			return clock().seconds( _t ) * 1000 + clock().milliseconds( _t );
+		}
+		// --------------------------------------------------------------------
+		uint32_t neighbor_deadline( Neighbor& _n )
+		{
+			return millis( _n.get_last_beacon() ) + _n.get_beacon_period() + _n.get_beacon_period() / 2;
+		}
+		// --------------------------------------------------------------------
 		uint8_t register_protocol( Protocol p )
 		{
 			if ( protocols.max_size() == protocols.size() )
@@ -1319,39 +1228,44 @@ namespace wiselib
 		}
 		// --------------------------------------------------------------------
 #ifdef CONFIG_NEIGHBOR_DISCOVERY_H_ACTIVE_CONNECTIVITY_FILTERING
-		void q_sort_neigh_active_con( int8_t _left, int8_t _right, Neighbor_vector& _neighborhood )
+		/* Heap sort by ascending active connectivity, no recursion and no
+		 * index limits for large neighborhoods.
+		 */
+		void sort_neigh_active_con( Neighbor_vector& _neighborhood )
 		{
-			int8_t i = _left;
-			int8_t j = _right;
-			Neighbor tmp;
-			Neighbor pivot = _neighborhood[ ( _left + _right ) / 2 ];
-			while (i <= j)
+			size_t n = _neighborhood.size();
+			for ( size_t i = n / 2; i > 0; i-- )
 			{
-				while ( _neighborhood[i].get_active_connectivity() < pivot.get_active_connectivity() )
-				{
-					i++;
-				}
-				while ( _neighborhood[j].get_active_connectivity() > pivot.get_active_connectivity() )
+				sift_neigh_active_con( i - 1, n, _neighborhood );
+			}
+			for ( size_t i = n; i > 1; i-- )
+			{
+				Neighbor tmp = _neighborhood[0];
+				_neighborhood[0] = _neighborhood[i - 1];
+				_neighborhood[i - 1] = tmp;
+				sift_neigh_active_con( 0, i - 1, _neighborhood );
+			}
+		}
+		// --------------------------------------------------------------------
+		void sift_neigh_active_con( size_t _root, size_t _size, Neighbor_vector& _neighborhood )
+		{
+			Neighbor tmp = _neighborhood[_root];
+			size_t child = 2 * _root + 1;
+			while ( child < _size )
+			{
+				if ( ( child + 1 < _size ) && ( _neighborhood[child].get_active_connectivity() < _neighborhood[child + 1].get_active_connectivity() ) )
 				{
-					j--;
+					child++;
 				}
-				if ( i <= j )
+				if ( _neighborhood[child].get_active_connectivity() <= tmp.get_active_connectivity() )
 				{
-					tmp = _neighborhood[i];
-					_neighborhood[i] = _neighborhood[j];
-					_neighborhood[j] = tmp;
-					i++;
-					j--;
+					break;
 				}
-			};
-			if ( _left < j )
-			{
-				q_sort_neigh_active_con( _left, j, _neighborhood );
-			}
-			if ( i < _right )
-			{
-				q_sort_neigh_active_con( i, _right, _neighborhood);
+				_neighborhood[_root] = _neighborhood[child];
+				_root = child;
+				child = 2 * _root + 1;
 			}
+			_neighborhood[_root] = tmp;
 		}
 #endif
 		// --------------------------------------------------------------------
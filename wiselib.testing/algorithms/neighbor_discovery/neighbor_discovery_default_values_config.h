@@ -5,6 +5,7 @@
 #define ND_BEACON_PERIOD 1000
 #define ND_TRANSMISSION_POWER_DB -30
 #define ND_DAEMON_PERIOD 500
+#define ND_EXPIRY_WHEEL_SLOTS 16
 
 //benchmark settings
 #define ND_STATS_DURATION 5000
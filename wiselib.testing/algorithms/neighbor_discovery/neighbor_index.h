@@ -0,0 +1,398 @@
+/***************************************************************************
+** This file is part of the generic algorithm library Wiselib.           **
+** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+**                                                                       **
+** The Wiselib is free software: you can redistribute it and/or modify   **
+** it under the terms of the GNU Lesser General Public License as        **
+** published by the Free Software Foundation, either version 3 of the    **
+** License, or (at your option) any later version.                       **
+**                                                                       **
+** The Wiselib is distributed in the hope that it will be useful,        **
+** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+** GNU Lesser General Public License for more details.                   **
+**                                                                       **
+** You should have received a copy of the GNU Lesser General Public      **
+** License along with the Wiselib.                                       **
+** If not, see <http://www.gnu.org/licenses/>.                           **
+***************************************************************************/
+
+#ifndef __NEIGHBOR_INDEX_H__
+#define	__NEIGHBOR_INDEX_H__
+
+#include "util/types.h"
+#include "algorithms/hash/fnv.h"
+#include "neighbor_discovery_default_values_config.h"
+
+namespace wiselib
+{
+	/*
+	 * Index over the positions of a neighborhood vector. It keeps
+	 *
+	 * - a hash table from node id to position,
+	 * - a binary heap of the positions ordered by an eviction key (lowest
+	 *   first),
+	 * - an expiry wheel of WHEEL_SLOTS_P buckets, one daemon period wide
+	 *   each, holding the positions by the time (in milliseconds) their
+	 *   neighbor has to be checked again.
+	 *
+	 * The owner of the vector reports every change: insert() for a new
+	 * element at position pos, remove() before the element at pos is
+	 * dropped and move() when the element at from is copied to to.
+	 */
+	template<	typename Os_P,
+				typename node_id_t_P,
+				int SIZE_P,
+				int WHEEL_SLOTS_P = ND_EXPIRY_WHEEL_SLOTS>
+	class NeighborIndex_Type
+	{
+	public:
+		typedef Os_P Os;
+		typedef node_id_t_P node_id_t;
+		typedef uint16_t pos_t;
+		typedef NeighborIndex_Type<Os, node_id_t, SIZE_P, WHEEL_SLOTS_P> self_type;
+		enum
+		{
+			SIZE = SIZE_P,
+			HASH_SIZE = 2 * SIZE_P + 1,
+			WHEEL_SLOTS = WHEEL_SLOTS_P,
+			NO_POS = 0xffff,
+			NOT_SCHEDULED = 0xff,
+			ACTIVE_KEY = 0x8000
+		};
+		// --------------------------------------------------------------------
+		NeighborIndex_Type() :
+			slot_width	( ND_DAEMON_PERIOD )
+		{
+			clear();
+		}
+		// --------------------------------------------------------------------
+		void clear()
+		{
+			for ( int i = 0; i < HASH_SIZE; i++ )
+			{
+				table[i] = NO_POS;
+			}
+			for ( int i = 0; i < WHEEL_SLOTS; i++ )
+			{
+				wheel[i] = NO_POS;
+			}
+			heap_size = 0;
+			active = 0;
+			wheel_started = 0;
+			scan_next = NO_POS;
+			scan_left = 0;
+			scan_last_tick = 0;
+		}
+		// --------------------------------------------------------------------
+		void set_slot_width( uint32_t _width )
+		{
+			slot_width = _width ? _width : 1;
+		}
+		// --------------------------------------------------------------------
+		int find( node_id_t _id )
+		{
+			for ( int h = home( _id ); table[h] != NO_POS; h = ( h + 1 ) % HASH_SIZE )
+			{
+				if ( ids[table[h]] == _id )
+				{
+					return table[h];
+				}
+			}
+			return -1;
+		}
+		// --------------------------------------------------------------------
+		void insert( pos_t _pos, node_id_t _id, uint16_t _key )
+		{
+			ids[_pos] = _id;
+			int h = home( _id );
+			while ( table[h] != NO_POS )
+			{
+				h = ( h + 1 ) % HASH_SIZE;
+			}
+			table[h] = _pos;
+			key[_pos] = _key;
+			if ( _key & ACTIVE_KEY )
+			{
+				active++;
+			}
+			heap[heap_size] = _pos;
+			heap_pos[_pos] = heap_size++;
+			sift_up( heap_pos[_pos] );
+			bucket[_pos] = NOT_SCHEDULED;
+		}
+		// --------------------------------------------------------------------
+		void remove( pos_t _pos )
+		{
+			unschedule( _pos );
+			if ( key[_pos] & ACTIVE_KEY )
+			{
+				active--;
+			}
+			pos_t hp = heap_pos[_pos];
+			heap_size--;
+			if ( hp != heap_size )
+			{
+				pos_t moved = heap[heap_size];
+				heap[hp] = moved;
+				heap_pos[moved] = hp;
+				sift_down( hp );
+				sift_up( heap_pos[moved] );
+			}
+			// Backward shift deletion, keeps the probe sequences intact
+			int i = slot_of( _pos );
+			table[i] = NO_POS;
+			for ( int j = ( i + 1 ) % HASH_SIZE; table[j] != NO_POS; j = ( j + 1 ) % HASH_SIZE )
+			{
+				int k = home( ids[table[j]] );
+				if ( ( j > i && ( k <= i || k > j ) ) || ( j < i && k <= i && k > j ) )
+				{
+					table[i] = table[j];
+					table[j] = NO_POS;
+					i = j;
+				}
+			}
+		}
+		// --------------------------------------------------------------------
+		void move( pos_t _from, pos_t _to )
+		{
+			ids[_to] = ids[_from];
+			table[slot_of( _from )] = _to;
+			key[_to] = key[_from];
+			heap_pos[_to] = heap_pos[_from];
+			heap[heap_pos[_to]] = _to;
+			bucket[_to] = bucket[_from];
+			deadline[_to] = deadline[_from];
+			if ( bucket[_to] != NOT_SCHEDULED )
+			{
+				next[_to] = next[_from];
+				prev[_to] = prev[_from];
+				if ( prev[_to] == NO_POS )
+				{
+					wheel[bucket[_to]] = _to;
+				}
+				else
+				{
+					next[prev[_to]] = _to;
+				}
+				if ( next[_to] != NO_POS )
+				{
+					prev[next[_to]] = _to;
+				}
+			}
+			if ( scan_next == _from )
+			{
+				scan_next = _to;
+			}
+		}
+		// --------------------------------------------------------------------
+		void set_key( pos_t _pos, uint16_t _key )
+		{
+			if ( ( key[_pos] ^ _key ) & ACTIVE_KEY )
+			{
+				active += ( _key & ACTIVE_KEY ) ? 1 : -1;
+			}
+			uint16_t old_key = key[_pos];
+			key[_pos] = _key;
+			if ( _key < old_key )
+			{
+				sift_up( heap_pos[_pos] );
+			}
+			else if ( _key > old_key )
+			{
+				sift_down( heap_pos[_pos] );
+			}
+		}
+		// --------------------------------------------------------------------
+		/* Position with the lowest key that is not marked active, -1 if
+		 * all are active.
+		 */
+		int worst()
+		{
+			if ( heap_size == 0 || ( key[heap[0]] & ACTIVE_KEY ) )
+			{
+				return -1;
+			}
+			return heap[0];
+		}
+		// --------------------------------------------------------------------
+		uint16_t active_size()
+		{
+			return active;
+		}
+		// --------------------------------------------------------------------
+		void schedule( pos_t _pos, uint32_t _deadline )
+		{
+			unschedule( _pos );
+			uint32_t tick = _deadline / slot_width;
+			// Overdue entries go to the bucket that is scanned next
+			if ( wheel_started && (int32_t)( tick - scan_last_tick ) < 0 )
+			{
+				tick = scan_last_tick;
+			}
+			uint8_t b = tick % WHEEL_SLOTS;
+			deadline[_pos] = _deadline;
+			bucket[_pos] = b;
+			prev[_pos] = NO_POS;
+			next[_pos] = wheel[b];
+			if ( wheel[b] != NO_POS )
+			{
+				prev[wheel[b]] = _pos;
+			}
+			wheel[b] = _pos;
+		}
+		// --------------------------------------------------------------------
+		void unschedule( pos_t _pos )
+		{
+			if ( bucket[_pos] == NOT_SCHEDULED )
+			{
+				return;
+			}
+			if ( scan_next == _pos )
+			{
+				scan_next = next[_pos];
+			}
+			if ( prev[_pos] == NO_POS )
+			{
+				wheel[bucket[_pos]] = next[_pos];
+			}
+			else
+			{
+				next[prev[_pos]] = next[_pos];
+			}
+			if ( next[_pos] != NO_POS )
+			{
+				prev[next[_pos]] = prev[_pos];
+			}
+			bucket[_pos] = NOT_SCHEDULED;
+		}
+		// --------------------------------------------------------------------
+		/* Starts a pass over the buckets that were passed since the last
+		 * one, next_expired() then hands out the entries due at _now.
+		 */
+		void begin_expiry( uint32_t _now )
+		{
+			uint32_t now_tick = _now / slot_width;
+			uint32_t passed = now_tick - scan_last_tick;
+			// The first pass (and one after a long pause) sees every bucket
+			if ( !wheel_started || passed >= (uint32_t)WHEEL_SLOTS )
+			{
+				passed = WHEEL_SLOTS - 1;
+			}
+			wheel_started = 1;
+			scan_last_tick = now_tick;
+			scan_left = passed;
+			scan_bucket = ( now_tick - passed ) % WHEEL_SLOTS;
+			scan_now = _now;
+			scan_next = wheel[scan_bucket];
+		}
+		// --------------------------------------------------------------------
+		/* Next position whose deadline has passed, it is unscheduled. -1
+		 * at the end of the pass.
+		 */
+		int next_expired()
+		{
+			for ( ;; )
+			{
+				while ( scan_next == NO_POS )
+				{
+					if ( scan_left == 0 )
+					{
+						return -1;
+					}
+					scan_left--;
+					scan_bucket = ( scan_bucket + 1 ) % WHEEL_SLOTS;
+					scan_next = wheel[scan_bucket];
+				}
+				pos_t pos = scan_next;
+				scan_next = next[pos];
+				if ( (int32_t)( deadline[pos] - scan_now ) < 0 )
+				{
+					unschedule( pos );
+					return pos;
+				}
+			}
+		}
+		// --------------------------------------------------------------------
+	private:
+		int home( node_id_t _id )
+		{
+			return Fnv1a<Os, uint32_t>::hash( (typename Os::block_data_t*)&_id, sizeof(node_id_t) ) % HASH_SIZE;
+		}
+		// --------------------------------------------------------------------
+		int slot_of( pos_t _pos )
+		{
+			int h = home( ids[_pos] );
+			while ( table[h] != _pos )
+			{
+				h = ( h + 1 ) % HASH_SIZE;
+			}
+			return h;
+		}
+		// --------------------------------------------------------------------
+		void sift_up( pos_t _hp )
+		{
+			pos_t p = heap[_hp];
+			while ( _hp > 0 )
+			{
+				pos_t parent = ( _hp - 1 ) / 2;
+				if ( key[heap[parent]] <= key[p] )
+				{
+					break;
+				}
+				heap[_hp] = heap[parent];
+				heap_pos[heap[_hp]] = _hp;
+				_hp = parent;
+			}
+			heap[_hp] = p;
+			heap_pos[p] = _hp;
+		}
+		// --------------------------------------------------------------------
+		void sift_down( pos_t _hp )
+		{
+			pos_t p = heap[_hp];
+			for ( ;; )
+			{
+				pos_t child = 2 * _hp + 1;
+				if ( child >= heap_size )
+				{
+					break;
+				}
+				if ( child + 1 < heap_size && key[heap[child + 1]] < key[heap[child]] )
+				{
+					child++;
+				}
+				if ( key[p] <= key[heap[child]] )
+				{
+					break;
+				}
+				heap[_hp] = heap[child];
+				heap_pos[heap[_hp]] = _hp;
+				_hp = child;
+			}
+			heap[_hp] = p;
+			heap_pos[p] = _hp;
+		}
+		// --------------------------------------------------------------------
+		pos_t table[HASH_SIZE];
+		node_id_t ids[SIZE];
+		uint16_t key[SIZE];
+		pos_t heap[SIZE];
+		pos_t heap_pos[SIZE];
+		pos_t heap_size;
+		uint16_t active;
+		pos_t wheel[WHEEL_SLOTS];
+		pos_t next[SIZE];
+		pos_t prev[SIZE];
+		uint8_t bucket[SIZE];
+		uint32_t deadline[SIZE];
+		uint32_t slot_width;
+		uint32_t scan_now;
+		uint32_t scan_last_tick;
+		uint16_t scan_left;
+		uint8_t scan_bucket;
+		pos_t scan_next;
+		uint8_t wheel_started;
+	};
+}
+#endif
@@ -23,6 +23,7 @@
 #include "neighbor.h"
 #include "protocol_settings.h"
 #include "protocol_payload.h"
+#include "neighbor_index.h"
 #include "util/pstl/vector_static.h"
 #include "util/delegates/delegate.hpp"
 
@@ -48,6 +49,7 @@ namespace wiselib
 		typedef ProtocolSettings_Type<Os, Radio, Timer, Debug> ProtocolSettings;
 		typedef vector_static<Os, Neighbor, ND_MAX_NEIGHBORS> Neighbor_vector;
 		typedef typename Neighbor_vector::iterator Neighbor_vector_iterator;
+		typedef NeighborIndex_Type<Os, node_id_t, ND_MAX_NEIGHBORS> NeighborIndex;
 		typedef vector_static<Os, ProtocolPayload, ND_MAX_REGISTERED_PROTOCOLS> ProtocolPayload_vector;
 		typedef typename ProtocolPayload_vector::iterator ProtocolPayload_vector_iterator;
 		typedef delegate4<void, uint8_t, node_id_t, size_t, uint8_t*> event_notifier_delegate_t;
@@ -110,6 +112,10 @@ namespace wiselib
 			settings = _ps;
 		}
 		// --------------------------------------------------------------------
+		/* Neighbors may be modified in place, adding or removing them has to
+		 * go through insert_neighbor() and erase_neighbor() which keep the
+		 * index up to date.
+		 */
 		Neighbor_vector* get_neighborhood_ref()
 		{
 			return &neighborhood;
@@ -136,43 +142,116 @@ namespace wiselib
 		void set_neighborhood( Neighbor_vector& _nv )
 		{
 			neighborhood = _nv;
+			index.clear();
+			for ( size_t i = 0; i < neighborhood.size(); i++ )
+			{
+				index.insert( i, neighborhood[i].get_id(), eviction_key( neighborhood[i] ) );
+				// Checked by the next daemon pass
+				index.schedule( i, 0 );
+			}
 		}
 		// --------------------------------------------------------------------
 		Neighbor* get_neighbor_ref( node_id_t _nid )
 		{
-			for ( Neighbor_vector_iterator it = neighborhood.begin(); it != neighborhood.end(); ++it )
+			int pos = index.find( _nid );
+			if ( pos < 0 )
 			{
-				if (it->get_id() == _nid )
-				{
-					return &(*it);
-				}
+				return NULL;
 			}
-			return NULL;
+			return &neighborhood[pos];
 		}
 		// --------------------------------------------------------------------
 		Neighbor* get_active_neighbor_ref( node_id_t _nid )
 		{
-			for ( Neighbor_vector_iterator it = neighborhood.begin(); it != neighborhood.end(); ++it )
+			Neighbor* n = get_neighbor_ref( _nid );
+			if ( ( n != NULL ) && ( n->get_active() == 1 ) )
 			{
-				if ( (it->get_id() == _nid ) && ( it->get_active() == 1 ) )
-				{
-					return &(*it);
-				}
+				return n;
 			}
 			return NULL;
 		}
 		// --------------------------------------------------------------------
 		size_t get_neighborhood_active_size()
 		{
-			size_t active_size = 0;
-			for ( Neighbor_vector_iterator it = neighborhood.begin(); it != neighborhood.end(); ++it )
+			return index.active_size();
+		}
+		// --------------------------------------------------------------------
+		/* Adds a neighbor that is not in the neighborhood yet. A full
+		 * neighborhood makes room by dropping the worst inactive
+		 * neighbor first, NULL if there is none.
+		 */
+		Neighbor* insert_neighbor( const Neighbor& _n, uint32_t _deadline )
+		{
+			if ( ( neighborhood.size() == neighborhood.max_size() ) && !remove_worst_neighbor() )
 			{
-				if ( it->get_active() == 1 )
-				{
-					active_size++;
-				}
+				return NULL;
+			}
+			neighborhood.push_back( _n );
+			size_t pos = neighborhood.size() - 1;
+			index.insert( pos, neighborhood[pos].get_id(), eviction_key( neighborhood[pos] ) );
+			index.schedule( pos, _deadline );
+			return &neighborhood[pos];
+		}
+		// --------------------------------------------------------------------
+		/* Has to be called after the link quality or the activity of
+		 * _n changed.
+		 */
+		void update_neighbor( Neighbor* _n )
+		{
+			index.set_key( _n - &neighborhood[0], eviction_key( *_n ) );
+		}
+		// --------------------------------------------------------------------
+		/* _n is handed out by next_expired_neighbor() after _deadline
+		 * (milliseconds, see NeighborIndex_Type).
+		 */
+		void schedule_neighbor( Neighbor* _n, uint32_t _deadline )
+		{
+			index.schedule( _n - &neighborhood[0], _deadline );
+		}
+		// --------------------------------------------------------------------
+		void begin_expiry( uint32_t _now )
+		{
+			index.begin_expiry( _now );
+		}
+		// --------------------------------------------------------------------
+		/* Next neighbor whose deadline passed before the time given to
+		 * begin_expiry(), it has to be scheduled again. NULL at the end.
+		 */
+		Neighbor* next_expired_neighbor()
+		{
+			int pos = index.next_expired();
+			if ( pos < 0 )
+			{
+				return NULL;
 			}
-			return active_size;
+			return &neighborhood[pos];
+		}
+		// --------------------------------------------------------------------
+		/* Drops the inactive neighbor with the lowest link stability
+		 * ratio (ties: lowest inverse ratio).
+		 * \return 1 if one was dropped
+		 */
+		uint8_t remove_worst_neighbor()
+		{
+			int pos = index.worst();
+			if ( pos < 0 )
+			{
+				return 0;
+			}
+			erase_neighbor( pos );
+			return 1;
+		}
+		// --------------------------------------------------------------------
+		void erase_neighbor( size_t _pos )
+		{
+			size_t last = neighborhood.size() - 1;
+			index.remove( _pos );
+			if ( _pos != last )
+			{
+				neighborhood[_pos] = neighborhood[last];
+				index.move( last, _pos );
+			}
+			neighborhood.pop_back();
 		}
 		// --------------------------------------------------------------------
 		void resolve_overflow_strategy( node_id_t _nid )
@@ -267,6 +346,7 @@ namespace wiselib
 			event_notifier_callback = _p.event_notifier_callback;
 			settings = _p.settings;
 			neighborhood = _p.neighborhood;
+			index = _p.index;
 			return *this;
 		}
 		// --------------------------------------------------------------------
@@ -302,10 +382,23 @@ namespace wiselib
 		{}
 		// --------------------------------------------------------------------
 	private:
+		uint16_t eviction_key( Neighbor& _n )
+		{
+			uint16_t lsr = _n.get_link_stab_ratio() < 127 ? _n.get_link_stab_ratio() : 127;
+			uint16_t lsr_in = _n.get_link_stab_ratio_inverse() < 127 ? _n.get_link_stab_ratio_inverse() : 127;
+			uint16_t key = ( lsr << 7 ) | lsr_in;
+			if ( _n.get_active() == 1 )
+			{
+				key = key | NeighborIndex::ACTIVE_KEY;
+			}
+			return key;
+		}
+		// --------------------------------------------------------------------
 		uint8_t protocol_id;
 		event_notifier_delegate_t event_notifier_callback;
 		ProtocolSettings settings;
 		Neighbor_vector neighborhood;
+		NeighborIndex index;
 	};
 }
 #endif
@@ -0,0 +1,354 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+#ifndef __ALGORITHMS_PROTOCOLS_TRICKLE_TRICKLE_TIMER_H__
+#define __ALGORITHMS_PROTOCOLS_TRICKLE_TRICKLE_TIMER_H__
+
+#include "util/delegates/delegate.hpp"
+#include "util/types.h"
+
+namespace wiselib {
+
+	/**
+	 * @brief Trickle algorithm (RFC 6206) for several independent instances
+	 * driven by a single timer.
+	 *
+	 * Every instance has its own interval I in [Imin, Imin * 2^doublings],
+	 * redundancy constant k and counter c. In each interval the instance
+	 * picks a random point t in [I/2, I) and calls its transmit delegate
+	 * there unless c >= k (k == 0 disables suppression). When the interval
+	 * ends, I is doubled, c is cleared and the interval delegate is called.
+	 *
+	 * The protocol reports what it hears with consistent() (increments c)
+	 * and inconsistent() (falls back to Imin). Only the earliest deadline of
+	 * all instances is armed at the timer. Since timers can not be
+	 * cancelled, every armed timer carries a token, a timer whose token is
+	 * outdated is ignored when it fires.
+	 *
+	 * @tparam MAX_INSTANCES_P Number of instances that can be added.
+	 */
+	template<
+		typename OsModel_P,
+		typename Timer_P,
+		typename Clock_P,
+		typename Rand_P,
+		int MAX_INSTANCES_P = 4
+	>
+	class TrickleTimer {
+
+		public:
+			typedef OsModel_P OsModel;
+			typedef Timer_P Timer;
+			typedef Clock_P Clock;
+			typedef Rand_P Rand;
+
+			typedef TrickleTimer<OsModel, Timer, Clock, Rand, MAX_INSTANCES_P> self_type;
+			typedef self_type* self_pointer_t;
+
+			typedef typename Timer::millis_t millis_t;
+			typedef typename Clock::time_t time_t;
+
+			typedef delegate1<void, void*> trickle_delegate_t;
+
+			enum { MAX_INSTANCES = MAX_INSTANCES_P };
+
+			enum { NO_INSTANCE = -1 };
+
+			enum ErrorCodes {
+				SUCCESS = OsModel::SUCCESS,
+				ERR_UNSPEC = OsModel::ERR_UNSPEC
+			};
+
+			TrickleTimer() : timer_(0), clock_(0), rand_(0) {
+			}
+
+			int init(Timer& timer, Clock& clock, Rand& rand) {
+				timer_ = &timer;
+				clock_ = &clock;
+				rand_ = &rand;
+				token_ = 0;
+				armed_ = false;
+				dispatching_ = false;
+				for(int i = 0; i < MAX_INSTANCES; i++) {
+					instances_[i].used = false;
+				}
+				return SUCCESS;
+			}
+
+			int destruct() {
+				for(int i = 0; i < MAX_INSTANCES; i++) {
+					instances_[i].used = false;
+				}
+				// Let the timer that is still out fire into the void
+				token_++;
+				armed_ = false;
+				return SUCCESS;
+			}
+
+			/**
+			 * Adds a stopped instance.
+			 *
+			 * @param imin Minimum interval in ms.
+			 * @param doublings Imax = imin * 2^doublings.
+			 * @param k Redundancy constant, 0 means infinity.
+			 * @return The instance id, NO_INSTANCE if all slots are in use.
+			 */
+			int add(millis_t imin, ::uint8_t doublings, ::uint8_t k,
+					trickle_delegate_t transmit, trickle_delegate_t interval, void* userdata = 0) {
+				for(int i = 0; i < MAX_INSTANCES; i++) {
+					Instance &inst = instances_[i];
+					if(inst.used) { continue; }
+
+					inst.used = true;
+					inst.running = false;
+					inst.transmitted = false;
+					inst.c = 0;
+					inst.transmit = transmit;
+					inst.interval_end = interval;
+					inst.userdata = userdata;
+					set_parameters(i, imin, doublings, k);
+					return i;
+				}
+				return NO_INSTANCE;
+			}
+
+			template<class T, void (T::*TransmitMethod)(void*), void (T::*IntervalMethod)(void*)>
+			int add(millis_t imin, ::uint8_t doublings, ::uint8_t k, T* obj, void* userdata = 0) {
+				return add(imin, doublings, k,
+						trickle_delegate_t::template from_method<T, TransmitMethod>(obj),
+						trickle_delegate_t::template from_method<T, IntervalMethod>(obj),
+						userdata);
+			}
+
+			int remove(int id) {
+				if(!valid(id)) { return ERR_UNSPEC; }
+				instances_[id].used = false;
+				instances_[id].running = false;
+				return SUCCESS;
+			}
+
+			/**
+			 * Changes Imin, Imax and k. A running instance keeps its current
+			 * interval, clipped to the new bounds at its next doubling.
+			 */
+			int set_parameters(int id, millis_t imin, ::uint8_t doublings, ::uint8_t k) {
+				if(!valid(id)) { return ERR_UNSPEC; }
+				Instance &inst = instances_[id];
+
+				inst.imin = (imin < 2) ? 2 : imin;
+				inst.imax = inst.imin;
+				for(::uint8_t d = 0; d < doublings && inst.imax < MAX_IMAX / 2; d++) {
+					inst.imax *= 2;
+				}
+				inst.k = k;
+				if(!inst.running) {
+					inst.i = inst.imin;
+				}
+				return SUCCESS;
+			}
+
+			/**
+			 * Starts an interval of the current length, a running instance
+			 * is left untouched.
+			 */
+			int start(int id) {
+				if(!valid(id)) { return ERR_UNSPEC; }
+				Instance &inst = instances_[id];
+				if(inst.running) { return SUCCESS; }
+
+				inst.running = true;
+				begin_interval(inst, now());
+				schedule();
+				return SUCCESS;
+			}
+
+			int stop(int id) {
+				if(!valid(id)) { return ERR_UNSPEC; }
+				// The armed timer is reused by the other instances or ignored
+				instances_[id].running = false;
+				return SUCCESS;
+			}
+
+			/**
+			 * Heard a consistent transmission.
+			 */
+			void consistent(int id) {
+				if(!valid(id)) { return; }
+				if(instances_[id].c < 0xff) { instances_[id].c++; }
+			}
+
+			/**
+			 * Heard an inconsistent transmission or some external event:
+			 * a running instance starts over with Imin unless it is there
+			 * already, a stopped one will start with Imin.
+			 */
+			void inconsistent(int id) {
+				if(!valid(id)) { return; }
+				Instance &inst = instances_[id];
+				if(!inst.running) {
+					inst.i = inst.imin;
+					return;
+				}
+				if(inst.i == inst.imin) { return; }
+
+				inst.i = inst.imin;
+				begin_interval(inst, now());
+				schedule();
+			}
+
+			bool running(int id) {
+				return valid(id) && instances_[id].running;
+			}
+
+			/// Length of the current interval in ms
+			millis_t interval(int id) {
+				return valid(id) ? instances_[id].i : 0;
+			}
+
+			/// Offset of the transmission point in the current interval in ms
+			millis_t transmission_point(int id) {
+				return valid(id) ? instances_[id].t : 0;
+			}
+
+			::uint8_t counter(int id) {
+				return valid(id) ? instances_[id].c : 0;
+			}
+
+		private:
+			enum { MAX_IMAX = 0x7fffffffUL };
+
+			struct Instance {
+				trickle_delegate_t transmit;
+				trickle_delegate_t interval_end;
+				void* userdata;
+
+				::uint32_t start;
+				/// Absolute time of the next event, t or the end of the interval
+				::uint32_t deadline;
+				millis_t imin;
+				millis_t imax;
+				millis_t i;
+				millis_t t;
+				::uint8_t k;
+				::uint8_t c;
+				bool used;
+				bool running;
+				bool transmitted;
+			};
+
+			bool valid(int id) {
+				return id >= 0 && id < MAX_INSTANCES && instances_[id].used;
+			}
+
+			::uint32_t now() {
+				time_t t = clock().time();
+				return clock().seconds(t) * 1000 + clock().milliseconds(t);
+			}
+
+			static bool due(::uint32_t deadline, ::uint32_t now) {
+				return (::int32_t)(deadline - now) <= 0;
+			}
+
+			void begin_interval(Instance& inst, ::uint32_t now) {
+				inst.c = 0;
+				inst.transmitted = false;
+				inst.start = now;
+				inst.t = inst.i / 2 + rand()() % (inst.i - inst.i / 2);
+				inst.deadline = now + inst.t;
+			}
+
+			/**
+			 * Arms the timer for the earliest deadline unless a timer for an
+			 * earlier (or the same) point is out already.
+			 */
+			void schedule() {
+				if(dispatching_) { return; }
+
+				bool found = false;
+				::uint32_t earliest = 0;
+				for(int i = 0; i < MAX_INSTANCES; i++) {
+					Instance &inst = instances_[i];
+					if(!inst.used || !inst.running) { continue; }
+					if(!found || (::int32_t)(inst.deadline - earliest) < 0) {
+						earliest = inst.deadline;
+						found = true;
+					}
+				}
+				if(!found) { return; }
+				if(armed_ && due(armed_at_, earliest)) { return; }
+
+				::uint32_t n = now();
+				millis_t delay = due(earliest, n) ? 0 : (millis_t)(earliest - n);
+
+				token_++;
+				armed_ = true;
+				armed_at_ = earliest;
+				timer().template set_timer<self_type, &self_type::fire>(delay, this, (void*)(typename OsModel::size_t)token_);
+			}
+
+			void fire(void* userdata) {
+				if((::uint16_t)(typename OsModel::size_t)userdata != token_) { return; }
+				armed_ = false;
+
+				dispatching_ = true;
+				::uint32_t n = now();
+				for(int i = 0; i < MAX_INSTANCES; i++) {
+					Instance &inst = instances_[i];
+					// An instance handles at most its t and the end of
+					// its interval per firing, callbacks may stop it
+					for(int step = 0; step < 2; step++) {
+						if(!inst.used || !inst.running || !due(inst.deadline, n)) { break; }
+
+						if(!inst.transmitted) {
+							inst.transmitted = true;
+							inst.deadline = inst.start + inst.i;
+							if((inst.k == 0 || inst.c < inst.k) && inst.transmit) {
+								inst.transmit(inst.userdata);
+							}
+						}
+						else {
+							inst.i = (inst.i >= inst.imax / 2) ? inst.imax : inst.i * 2;
+							begin_interval(inst, n);
+							if(inst.interval_end) {
+								inst.interval_end(inst.userdata);
+							}
+						}
+					}
+				}
+				dispatching_ = false;
+				schedule();
+			}
+
+			Timer& timer() { return *timer_; }
+			Clock& clock() { return *clock_; }
+			Rand& rand() { return *rand_; }
+
+			typename Timer::self_pointer_t timer_;
+			typename Clock::self_pointer_t clock_;
+			typename Rand::self_pointer_t rand_;
+
+			Instance instances_[MAX_INSTANCES];
+			::uint16_t token_;
+			::uint32_t armed_at_;
+			bool armed_;
+			bool dispatching_;
+
+	}; // TrickleTimer
+}
+
+#endif // __ALGORITHMS_PROTOCOLS_TRICKLE_TRICKLE_TIMER_H__
@@ -21,7 +21,7 @@
 #ifndef INTERMEDIATE_RESULT_MESSAGE_H
 #define INTERMEDIATE_RESULT_MESSAGE_H
 
-#include <util/serialization/serialization.h>
+#include <util/serialization/message_layout.h>
 
 namespace wiselib {
 	
@@ -48,51 +48,58 @@ namespace wiselib {
 			typedef typename Query::BOD::operator_id_t operator_id_t;
 			typedef typename Radio::Radio::Radio::node_id_t physical_node_id_t;
 			
+			typedef LayoutField<message_id_t> MessageIdField;
+			typedef LayoutField<query_id_t, MessageIdField> QueryIdField;
+			typedef LayoutField<operator_id_t, QueryIdField> OperatorIdField;
+			typedef LayoutField<physical_node_id_t, OperatorIdField> FromField;
+			typedef LayoutField< ::uint8_t, FromField> PayloadSizeField;
+			typedef LayoutCheck<PayloadSizeField, Radio::MAX_MESSAGE_LENGTH> Header;
+			
 			enum {
-				POS_MESSAGE_ID = 0,
-				POS_QUERY_ID = POS_MESSAGE_ID + sizeof(message_id_t),
-				POS_OPERATOR_ID = POS_QUERY_ID + sizeof(query_id_t),
-				POS_FROM = POS_OPERATOR_ID + sizeof(operator_id_t),
-				POS_PAYLOAD_SIZE = POS_FROM + sizeof(physical_node_id_t),
-				POS_PAYLOAD = POS_PAYLOAD_SIZE + sizeof(::uint8_t),
+				POS_MESSAGE_ID = MessageIdField::OFFSET,
+				POS_QUERY_ID = QueryIdField::OFFSET,
+				POS_OPERATOR_ID = OperatorIdField::OFFSET,
+				POS_FROM = FromField::OFFSET,
+				POS_PAYLOAD_SIZE = PayloadSizeField::OFFSET,
+				POS_PAYLOAD = Header::SIZE,
 				HEADER_SIZE = POS_PAYLOAD,
 			};
 			
 			message_id_t message_id() {
-				return wiselib::read<OsModel, block_data_t, message_id_t>(data_ + POS_MESSAGE_ID);
+				return wiselib::read_field<OsModel, MessageIdField>(data_);
 			}
 			
 			void set_message_id(message_id_t msgid) {
-				wiselib::write<OsModel>(data_ + POS_MESSAGE_ID, msgid);
+				wiselib::write_field<OsModel, MessageIdField>(data_, msgid);
 			}
 			
 			physical_node_id_t from() {
-				return wiselib::read<OsModel, block_data_t, physical_node_id_t>(data_ + POS_FROM);
+				return wiselib::read_field<OsModel, FromField>(data_);
 			}
 			
 			void set_from(physical_node_id_t f) {
-				wiselib::write<OsModel>(data_ + POS_FROM, f);
+				wiselib::write_field<OsModel, FromField>(data_, f);
 			}
 			
 			
 			query_id_t query_id() {
-				return wiselib::read<OsModel, block_data_t, query_id_t>(data_ + POS_QUERY_ID);
+				return wiselib::read_field<OsModel, QueryIdField>(data_);
 			}
 			
 			void set_query_id(query_id_t qid) {
-				wiselib::write<OsModel>(data_ + POS_QUERY_ID, qid);
+				wiselib::write_field<OsModel, QueryIdField>(data_, qid);
 			}
 			
 			block_data_t* payload() { return data_ + POS_PAYLOAD; }
-			size_type payload_size() { return wiselib::read<OsModel, block_data_t, ::uint8_t>(data_ + POS_PAYLOAD_SIZE); }
+			size_type payload_size() { return wiselib::read_field<OsModel, PayloadSizeField>(data_); }
 			void set_payload_size(::uint8_t s) {
-				wiselib::write<OsModel, block_data_t, ::uint8_t>(data_ + POS_PAYLOAD_SIZE, s);
+				wiselib::write_field<OsModel, PayloadSizeField>(data_, s);
 			}
 			
-			operator_id_t operator_id() { return wiselib::read<OsModel, block_data_t, operator_id_t>(data_ + POS_OPERATOR_ID); }
+			operator_id_t operator_id() { return wiselib::read_field<OsModel, OperatorIdField>(data_); }
 			
 			void set_operator_id(operator_id_t oid) {
-				wiselib::write<OsModel>(data_ + POS_OPERATOR_ID, oid);
+				wiselib::write_field<OsModel, OperatorIdField>(data_, oid);
 			}
 		
 		private:
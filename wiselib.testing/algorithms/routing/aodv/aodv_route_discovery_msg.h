@@ -101,7 +101,10 @@ namespace wiselib
       { return read<OsModel, block_data_t, uint8_t>(buffer + PAYLOAD_POS); }
       // -----------------------------------------------------------------------
       inline void set_payload( uint8_t len, block_data_t* data )
-      { memcpy( buffer + PAYLOAD_POS + 1, data, len ); }
+      {
+         set_payload_size( len );
+         memcpy( buffer + PAYLOAD_POS + 1, data, len );
+      }
       // -----------------------------------------------------------------------
       inline block_data_t* payload( void )
       { return buffer + PAYLOAD_POS + 1; }
@@ -123,6 +126,9 @@ namespace wiselib
          PAYLOAD_POS   = 12
       };
 private:
+      inline void set_payload_size( uint8_t len )
+      { write<OsModel, block_data_t, uint8_t>(buffer + PAYLOAD_POS, len); }
+      // -----------------------------------------------------------------------
       block_data_t buffer[Radio::MAX_MESSAGE_LENGTH];
    };
    // -----------------------------------------------------------------------
@@ -148,6 +154,7 @@ private:
       set_source( source );
       set_destination( destination );
       set_next_hop( next_hop );
+      set_payload_size( 0 );
    };
 
 }
@@ -260,11 +260,8 @@ namespace wiselib {
             if(n_it->second == 0){
                //debug().debug(" %i no longer neighbor with %i \n",radio().id(), n_it->first);
 
-               neighbors_.erase(n_it);
-
-               if (n_it != neighbors_.end()){
-                   break;
-               }
+               neighbors_.erase(n_it++);
+               continue;
 
 
 	   }
@@ -504,14 +501,9 @@ namespace wiselib {
              //if(p_it->second.time == 0 && p_it->second.retries > 3)
             else if (p_it->second.time == 0)   {
 
-                pend_dests_.erase(p_it);
-
-
                 pending_msgs_.erase(p_it->first);
-
-                if(p_it == pend_dests_.end()){
-                    break;
-                }
+                pend_dests_.erase(p_it++);
+                continue;
 
               //  resend_rreq(p_it->first);
                 //debug().debug(" %i found no route for %i \n",radio().id(), p_it->first );
@@ -558,10 +550,8 @@ namespace wiselib {
     
             if(it->second.lifetime == 0){
                //debug().debug(" %i delete's entry for %i lifetime:%i \n",radio().id(), it->second.destination,it->second.lifetime );
-               routing_table_.erase(it);
-               if (it != routing_table_.end()){
-                   break;
-               }
+               routing_table_.erase(it++);
+               continue;
 	   }
 		else{
 		it->second.lifetime -= 1;
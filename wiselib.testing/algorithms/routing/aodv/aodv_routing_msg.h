@@ -19,7 +19,7 @@
 #ifndef __ALGORITHMS_ROUTING_AODV_ROUTING_MSG_H__
 #define __ALGORITHMS_ROUTING_AODV_ROUTING_MSG_H__
 
-#include "util/serialization/simple_types.h"
+#include "util/serialization/message_layout.h"
 
 namespace wiselib
 {
@@ -33,7 +33,16 @@ namespace wiselib
       typedef OsModel_P OsModel;
       typedef Radio_P Radio;
       typedef typename Radio::block_data_t block_data_t;
+      typedef typename Radio::node_id_t node_id_t;
       typedef Path_P Path;
+
+      typedef LayoutField<uint8_t> MsgIdField;
+      typedef LayoutField<uint8_t, MsgIdField> IdxField;
+      typedef LayoutField<uint16_t, IdxField> SourceField;
+      typedef LayoutField<uint16_t, SourceField> DestField;
+      typedef LayoutArray<node_id_t, sizeof(Path) / sizeof(node_id_t), DestField> PathField;
+      typedef LayoutField<uint8_t, PathField> PayloadSizeField;
+      typedef LayoutCheck<PayloadSizeField, Radio::MAX_MESSAGE_LENGTH> Header;
       // --------------------------------------------------------------------
       inline AODVRoutingMessage();
       // --------------------------------------------------------------------
@@ -42,16 +51,16 @@ namespace wiselib
                         uint8_t path_idx, uint8_t l, uint8_t *d );
       // --------------------------------------------------------------------
       inline uint8_t msg_id()
-      { return read<OsModel, block_data_t, uint8_t>( buffer ); };
+      { return read_field<OsModel, MsgIdField>( buffer ); };
       // --------------------------------------------------------------------
       inline void set_msg_id( uint8_t id )
-      { write<OsModel, block_data_t, uint8_t>( buffer, id ); }
+      { write_field<OsModel, MsgIdField>( buffer, id ); }
       // --------------------------------------------------------------------
       inline uint8_t path_idx()
-      { return read<OsModel, block_data_t, uint8_t>(buffer + IDX_POS); }
+      { return read_field<OsModel, IdxField>( buffer ); }
       // --------------------------------------------------------------------
       inline void set_path_idx( uint8_t idx )
-      { write<OsModel, block_data_t, uint8_t>(buffer + IDX_POS, idx); }
+      { write_field<OsModel, IdxField>( buffer, idx ); }
       // --------------------------------------------------------------------
       inline void dec_path_idx( void )
       { set_path_idx( path_idx() - 1 );  }
@@ -60,50 +69,47 @@ namespace wiselib
       { set_path_idx( path_idx() + 1 );  }
       // --------------------------------------------------------------------
       inline uint16_t source()
-      { return read<OsModel, block_data_t, uint16_t>(buffer + SOURCE_POS); }
+      { return read_field<OsModel, SourceField>( buffer ); }
       // --------------------------------------------------------------------
       inline void set_source( uint16_t src )
-      { write<OsModel, block_data_t, uint16_t>(buffer + SOURCE_POS, src); }
+      { write_field<OsModel, SourceField>( buffer, src ); }
       // --------------------------------------------------------------------
       inline uint16_t destination()
-      { return read<OsModel, block_data_t, uint16_t>(buffer + DEST_POS); }
+      { return read_field<OsModel, DestField>( buffer ); }
       // --------------------------------------------------------------------
       inline void set_destination( uint16_t dest )
-      { write<OsModel, block_data_t, uint16_t>(buffer + DEST_POS, dest); }
+      { write_field<OsModel, DestField>( buffer, dest ); }
       // --------------------------------------------------------------------
       inline void set_path( Path& p )
-      {
-         // TODO: Use serialization!
-         memcpy( buffer + PATH_POS, &p, sizeof(p) );
-      }
+      { write_field_array<OsModel, PathField>( buffer, p ); }
       // -----------------------------------------------------------------------
-      inline Path* path( void )
-      {
-         // TODO: Use serialization!
-         return (Path*)(buffer + PATH_POS);
-      }
+      inline void path( Path& p )
+      { read_field_array<OsModel, PathField>( buffer, p ); }
       // --------------------------------------------------------------------
       inline uint8_t payload_size()
-      { return read<OsModel, block_data_t, uint8_t>(buffer + PAYLOAD_POS); }
+      { return read_field<OsModel, PayloadSizeField>( buffer ); }
       // -----------------------------------------------------------------------
       inline void set_payload( uint8_t len, block_data_t* data )
-      { memcpy( buffer + PAYLOAD_POS + 1, data, len ); }
+      {
+         write_field<OsModel, PayloadSizeField>( buffer, len );
+         memcpy( buffer + Header::SIZE, data, len );
+      }
       // -----------------------------------------------------------------------
       inline block_data_t* payload( void )
-      { return buffer + PAYLOAD_POS + 1; }
+      { return buffer + Header::SIZE; }
       // --------------------------------------------------------------------
       inline size_t buffer_size()
-      { return PAYLOAD_POS + 1 + payload_size(); }
+      { return Header::SIZE + payload_size(); }
 
    private:
       enum data_positions
       {
-         MSG_ID_POS  = 0,
-         IDX_POS     = 1,
-         SOURCE_POS  = 2,
-         DEST_POS    = 4,
-         PATH_POS    = 6,
-         PAYLOAD_POS = 6 + sizeof(Path)
+         MSG_ID_POS  = MsgIdField::OFFSET,
+         IDX_POS     = IdxField::OFFSET,
+         SOURCE_POS  = SourceField::OFFSET,
+         DEST_POS    = DestField::OFFSET,
+         PATH_POS    = PathField::OFFSET,
+         PAYLOAD_POS = PayloadSizeField::OFFSET
       };
 
       block_data_t buffer[Radio::MAX_MESSAGE_LENGTH];
@@ -19,9 +19,9 @@
 #ifndef __ALGORITHMS_ROUTING_DYMO_ROUTING_H__
 #define __ALGORITHMS_ROUTING_DYMO_ROUTING_H__
 
-#include "/home/zhongliang/project/WISEBED/wiselib/trunk/wiselib.incubation/routing/dymo/dymo_routing_types.h"
-#include "/home/zhongliang/project/WISEBED/wiselib/trunk/wiselib.incubation/routing/dymo/dymo_route_discovery_msg.h"
-#include "/home/zhongliang/project/WISEBED/wiselib/trunk/wiselib.incubation/routing/dymo/dymo_routing_msg.h"
+#include "algorithms/routing/dymo/dymo_routing_types.h"
+#include "algorithms/routing/dymo/dymo_route_discovery_msg.h"
+#include "algorithms/routing/dymo/dymo_routing_msg.h"
 #include "util/base_classes/routing_base.h"
 #include <string.h>
 #include "util/pstl/list_static.h"
@@ -32,6 +32,12 @@
 #undef DEBUG
 //#define DEBUG
 
+/// Size of the static tables (neighbors, sequence numbers, pending
+/// destinations and messages, remembered DYMO_RREQs)
+#ifndef DYMO_TABLE_SIZE
+#define DYMO_TABLE_SIZE 10
+#endif
+
 #define NET_DIAM 10
 #define ROUTE_TIMEOUT 2 *NET_DIAM
 
@@ -85,7 +91,7 @@ namespace wiselib {
 
         typedef DYMORouteDiscoveryMessage<OsModel, Radio, Path> RouteDiscoveryMessage;
         //typedef map<uint8_t, RouteDiscoveryMessage> pending_msgs_t;
-	typedef wiselib::MapStaticVector<OsModel,uint8_t, RouteDiscoveryMessage, 10> pending_msgs_t;	/// Given fix size of the map of pending messages
+	typedef wiselib::MapStaticVector<OsModel,uint8_t, RouteDiscoveryMessage, DYMO_TABLE_SIZE> pending_msgs_t;	/// Given fix size of the map of pending messages
 
         //typedef DYMORouting
         // --------------------------------------------------------------------
@@ -172,7 +178,7 @@ namespace wiselib {
         uint16_t my_seq_nr_;
         uint16_t my_bcast_id_;
         //map<uint16_t, uint16_t> seq_numbers_;
-	typename wiselib::MapStaticVector<OsModel,uint16_t, uint16_t, 10> seq_numbers_; /// Given fix value of the destination sequence number
+	typename wiselib::MapStaticVector<OsModel,uint16_t, uint16_t, DYMO_TABLE_SIZE> seq_numbers_; /// Given fix value of the destination sequence number
 
         pending_msgs_t pending_msgs_;
 
@@ -184,18 +190,24 @@ namespace wiselib {
         bool route_found;
 
         //list<struct rreq_info> received_rreq_;				//define a list called "received_rreq_"
-        typename wiselib::list_static<OsModel,struct rreq_info, 10> received_rreq_; /// Given fix value of number of received DYMO_RREQ
+        typename wiselib::list_static<OsModel,struct rreq_info, DYMO_TABLE_SIZE> received_rreq_; /// Given fix value of number of received DYMO_RREQ
         //typename list<struct rreq_info>::iterator rreq_iter_;		//define an iterator of list consisting of "struct rreq_info"
-        typedef typename wiselib::list_static<OsModel,struct rreq_info, 10>::iterator rreq_iter_;
-	rreq_iter_ rreq_iter;
+        typedef typename wiselib::list_static<OsModel,struct rreq_info, DYMO_TABLE_SIZE>::iterator rreq_iter_;
+
+        /// Remembers a DYMO_RREQ, the oldest one is forgotten when the list is full
+        void remember_rreq(const struct rreq_info& info) {
+            if (received_rreq_.full())
+                received_rreq_.pop_front();
+            received_rreq_.push_back(info);
+        }
 
 
         typename pending_msgs_t::iterator pend_iter_;
 
         //map<uint16_t, uint8_t> neighbors_;
-	typename wiselib::MapStaticVector<OsModel,uint16_t, uint8_t, 10> neighbors_; /// Given fix value of neighbor number
+	typename wiselib::MapStaticVector<OsModel,uint16_t, uint8_t, DYMO_TABLE_SIZE> neighbors_; /// Given fix value of neighbor number
         //typedef typename map<uint16_t, uint8_t>::iterator neighbors_iter_;
-	typedef typename wiselib::MapStaticVector<OsModel,uint16_t, uint8_t, 10>::iterator neighbors_iter_;
+	typedef typename wiselib::MapStaticVector<OsModel,uint16_t, uint8_t, DYMO_TABLE_SIZE>::iterator neighbors_iter_;
 
         struct retry_info {
             uint8_t retries;
@@ -204,9 +216,9 @@ namespace wiselib {
         };
 
         //map<uint16_t, struct retry_info> pend_dests_;
-	typename wiselib::MapStaticVector<OsModel,uint16_t, struct retry_info, 10> pend_dests_; /// Given fix value of the destination sequence number
+	typename wiselib::MapStaticVector<OsModel,uint16_t, struct retry_info, DYMO_TABLE_SIZE> pend_dests_; /// Given fix value of the destination sequence number
        //typedef typename map<uint16_t, struct retry_info>::iterator pend_dests_iter_;
-	typedef typename wiselib::MapStaticVector<OsModel,uint16_t, struct retry_info, 10>::iterator pend_dests_iter_;
+	typedef typename wiselib::MapStaticVector<OsModel,uint16_t, struct retry_info, DYMO_TABLE_SIZE>::iterator pend_dests_iter_;
 
 
         short seconds;
@@ -456,7 +468,7 @@ namespace wiselib {
             struct rreq_info own_rreq;
             own_rreq.source = radio().id();
             own_rreq.bcast_id = my_bcast_id_;
-            received_rreq_.push_back(own_rreq);
+            remember_rreq(own_rreq);
 
             debug().debug("%i Resent DYMO_RREQ for %i \n", radio().id(), dest);
 
@@ -653,7 +665,7 @@ namespace wiselib {
             struct rreq_info own_rreq;
             own_rreq.source = radio().id();
             own_rreq.bcast_id = my_bcast_id_;
-            received_rreq_.push_back(own_rreq);
+            remember_rreq(own_rreq);
 
             debug().debug("%i sent DYMO_RREQ for %i \n", radio().id(), destination);
 
@@ -707,7 +719,7 @@ namespace wiselib {
         //debug().debug("%i received DYMO_RREQ from: %i. src:%i dst:%i bcast:%i hops:%i\n", radio().id(), from, message.source(), message.destination(), message.bcast_id(),message.hop_cnt());
 
         // drop any reduntant messages
-        for (rreq_iter = received_rreq_.begin(); rreq_iter != received_rreq_.end(); ++rreq_iter) {
+        for (rreq_iter_ rreq_iter = received_rreq_.begin(); rreq_iter != received_rreq_.end(); ++rreq_iter) {
             if ((*rreq_iter).source == message.source()
                     && (*rreq_iter).bcast_id == message.bcast_id()) {
                 //cout << "\t\t\tDROPPED\n";
@@ -726,7 +738,7 @@ namespace wiselib {
         tmp_info.source = message.source();
         tmp_info.bcast_id = message.bcast_id();
         //tmp_info.lifetime = INT_MAX;
-        received_rreq_.push_back(tmp_info);
+        remember_rreq(tmp_info);
 
 
         // add REVERSE path entry
@@ -27,7 +27,7 @@ namespace wiselib
       DYMO_RREQ = 200, //ROUTE REQUEST
       DYMO_RREP = 201, //ROUTE REPLY
       DYMO_ERR =  202, //ROUTE ERROR
-      DYMO_DATA = 300  //DATA
+      DYMO_DATA = 203  //DATA
    };
    // -----------------------------------------------------------------------
    // -----------------------------------------------------------------------
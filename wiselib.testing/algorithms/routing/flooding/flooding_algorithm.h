@@ -20,14 +20,57 @@
 #define __FLOODING_ALGORITHM_H__
 
 #include "util/base_classes/routing_base.h"
+#include "algorithms/rand/kiss.h"
 #include "flooding_message.h"
+#include "flooding_duplicate_cache.h"
 #include <string.h>
 
+/// Number of originators whose sequence numbers are remembered
+#ifndef FLOODING_DUPLICATE_CACHE_SIZE
+#define FLOODING_DUPLICATE_CACHE_SIZE 32
+#endif
+
+#define FLOODING_REBROADCAST_ALWAYS 0
+#define FLOODING_REBROADCAST_PROBABILISTIC 1
+#define FLOODING_REBROADCAST_COUNTER 2
+
+/** FLOODING_REBROADCAST_ALWAYS forwards every new message.
+ *  FLOODING_REBROADCAST_PROBABILISTIC forwards with probability
+ *  FLOODING_REBROADCAST_PROBABILITY percent (gossiping).
+ *  FLOODING_REBROADCAST_COUNTER waits a random delay of up to
+ *  FLOODING_REBROADCAST_DELAY ms and drops the rebroadcast if the message
+ *  has been heard FLOODING_REBROADCAST_COUNTER_THRESHOLD times meanwhile.
+ *  This mode needs a timer, see FloodingAlgorithm::init().
+ */
+#ifndef FLOODING_REBROADCAST_MODE
+#define FLOODING_REBROADCAST_MODE FLOODING_REBROADCAST_ALWAYS
+#endif
+
+#ifndef FLOODING_REBROADCAST_PROBABILITY
+#define FLOODING_REBROADCAST_PROBABILITY 65
+#endif
+
+#ifndef FLOODING_REBROADCAST_COUNTER_THRESHOLD
+#define FLOODING_REBROADCAST_COUNTER_THRESHOLD 3
+#endif
+
+#ifndef FLOODING_REBROADCAST_DELAY
+#define FLOODING_REBROADCAST_DELAY 50
+#endif
+
+/// Number of rebroadcasts that can wait at the same time in counter mode
+#ifndef FLOODING_PENDING_SIZE
+#define FLOODING_PENDING_SIZE 4
+#endif
+
 namespace wiselib
 {
 
    /** Flooding Algorithm for the Wiselib.
     * 
+    *  Duplicates are detected with a FloodingDuplicateCache of fixed size.
+    *  NodeidIntMap_P is not used anymore and only kept for compatibility.
+    *
     *  \ingroup routing_concept
     *  \ingroup radio_concept
     *  \ingroup basic_algorithm_concept
@@ -46,7 +89,6 @@ namespace wiselib
       typedef Debug_P Debug;
 
       typedef NodeidIntMap_P MapType;
-      typedef typename MapType::iterator MapTypeIterator;
 
       typedef FloodingAlgorithm<OsModel, MapType, Radio, Debug> self_type;
       typedef self_type* self_pointer_t;
@@ -57,6 +99,12 @@ namespace wiselib
       typedef typename Radio::message_id_t message_id_t;
 
       typedef FloodingMessage<OsModel, Radio> Message;
+      typedef typename Message::seq_nr_t seq_nr_t;
+
+      typedef Kiss<OsModel> Rand;
+#if FLOODING_REBROADCAST_MODE == FLOODING_REBROADCAST_COUNTER
+      typedef typename OsModel::Timer Timer;
+#endif
       // --------------------------------------------------------------------
       enum ErrorCodes
       {
@@ -73,7 +121,7 @@ namespace wiselib
       // --------------------------------------------------------------------
       enum Restrictions
       {
-         MAX_MESSAGE_LENGTH = Radio_P::MAX_MESSAGE_LENGTH - Message::PAYLOAD_POS  ///< Maximal number of bytes in payload
+         MAX_MESSAGE_LENGTH = Message::Header::SPACE  ///< Maximal number of bytes in payload
       };
       // --------------------------------------------------------------------
       ///@name Construction / Destruction
@@ -102,10 +150,19 @@ namespace wiselib
       { return radio_->id(); };
       ///@}
 
+#if FLOODING_REBROADCAST_MODE == FLOODING_REBROADCAST_COUNTER
+      int init( Radio& radio, Debug& debug, Timer& timer )
+      {
+         timer_ = &timer;
+         for ( int i = 0; i < FLOODING_PENDING_SIZE; i++ )
+            pending_[i].used = false;
+#else
       int init( Radio& radio, Debug& debug )
       {
+#endif
          radio_ = &radio;
          debug_ = &debug;
+         rand_.srand( (uint32_t)radio.id() );
          return SUCCESS;
       }
 
@@ -117,6 +174,10 @@ namespace wiselib
 
       int destruct()
       {
+#if FLOODING_REBROADCAST_MODE == FLOODING_REBROADCAST_COUNTER
+         for ( int i = 0; i < FLOODING_PENDING_SIZE; i++ )
+            pending_[i].used = false;
+#endif
          return disable_radio();
       }
 
@@ -127,9 +188,36 @@ namespace wiselib
       Debug& debug()
       { return *debug_; }
 
+      void rebroadcast( node_id_t origin, seq_nr_t seq, size_t len, block_data_t *data );
+
+      /** Counts a duplicate of (origin, seq) towards a waiting rebroadcast
+       */
+      void heard_duplicate( node_id_t origin, seq_nr_t seq );
+
       typename Radio::self_pointer_t radio_;
       typename Debug::self_pointer_t debug_;
 
+#if FLOODING_REBROADCAST_MODE == FLOODING_REBROADCAST_COUNTER
+      void pending_timer_elapsed( void *userdata );
+
+      Timer& timer()
+      { return *timer_; }
+
+      typename Timer::self_pointer_t timer_;
+
+      struct Pending
+      {
+         node_id_t origin;
+         seq_nr_t seq;
+         uint8_t count;
+         bool used;
+         size_t len;
+         block_data_t data[Radio::MAX_MESSAGE_LENGTH];
+      };
+
+      Pending pending_[FLOODING_PENDING_SIZE];
+#endif
+
       enum MessageIds
       {
          FLOODING_MESSAGE_ID = 112
@@ -140,10 +228,15 @@ namespace wiselib
          FLOODING_INIT_SEQ_NR = 0
       };
 
+      // A window restarts when an originator starts over at FLOODING_INIT_SEQ_NR
+      typedef FloodingDuplicateCache<OsModel, node_id_t, seq_nr_t, FLOODING_DUPLICATE_CACHE_SIZE,
+                                     4, FLOODING_INIT_SEQ_NR> DuplicateCache;
+
       int callback_id_;
-      uint16_t seq_nr_;
+      seq_nr_t seq_nr_;
 
-      MapType seq_map_;
+      DuplicateCache duplicates_;
+      Rand rand_;
    };
    // -----------------------------------------------------------------------
    // -----------------------------------------------------------------------
@@ -260,22 +353,13 @@ namespace wiselib
          }
 
          // Has message already been received? If so, return.
-         // Of course, there is a simplification with the check for seq_nr
-         // just to be greater than the known one---but this can be done for
-         // simplicity reasons (code-space!!)
-         MapTypeIterator it = seq_map_.find( message->node_id() );
-         if ( it == seq_map_.end() ||
-               ( it != seq_map_.end() &&
-                  ( message->seq_nr() > it->second ||
-                  ( message->seq_nr() == FLOODING_INIT_SEQ_NR && it->second >= 2))) )
+         if ( duplicates_.accept( message->node_id(), message->seq_nr() ) )
          {
-            // Update sequence number, and forward the message to neighbors.
-            seq_map_[message->node_id()] = message->seq_nr();
-            radio().send( radio().BROADCAST_ADDRESS, len, data );
+            rebroadcast( message->node_id(), message->seq_nr(), len, data );
 
 #ifdef ROUTING_FLOODING_DEBUG
-            debug().debug( "FloodingAlgorithm: receive at %d from %d with seqnr %d (here is %d)\n",
-                           radio_->id(), message->node_id(), message->seq_nr(), seq_map_[message->node_id()] );
+            debug().debug( "FloodingAlgorithm: receive at %d from %d with seqnr %d\n",
+                           radio_->id(), message->node_id(), message->seq_nr() );
 #endif
 			
             // Pass message to each registered receiver.
@@ -285,9 +369,10 @@ namespace wiselib
          }
          else
          {
+            heard_duplicate( message->node_id(), message->seq_nr() );
 #ifdef ROUTING_FLOODING_DEBUG
-   debug().debug( "FloodingAlgorithm ERROR: sequence number already known at %d (%d <= %d)\n",
-                     radio_->id(), message->seq_nr(), seq_map_[message->node_id()]  );
+   debug().debug( "FloodingAlgorithm ERROR: sequence number already known at %d (%d from %d)\n",
+                     radio_->id(), message->seq_nr(), message->node_id() );
 #endif
          }
       }
@@ -298,6 +383,85 @@ namespace wiselib
 #endif
       }
    }
+   // -----------------------------------------------------------------------
+   template<typename OsModel_P,
+            typename RoutingTable_P,
+            typename Radio_P,
+            typename Debug_P>
+   void
+   FloodingAlgorithm<OsModel_P, RoutingTable_P, Radio_P, Debug_P>::
+   rebroadcast( node_id_t origin, seq_nr_t seq, size_t len, block_data_t *data )
+   {
+#if FLOODING_REBROADCAST_MODE == FLOODING_REBROADCAST_PROBABILISTIC
+      if ( rand_() % 100 >= FLOODING_REBROADCAST_PROBABILITY )
+         return;
+#elif FLOODING_REBROADCAST_MODE == FLOODING_REBROADCAST_COUNTER
+      for ( int i = 0; i < FLOODING_PENDING_SIZE; i++ )
+      {
+         Pending &p = pending_[i];
+         if ( p.used || len > Radio::MAX_MESSAGE_LENGTH )
+            continue;
+
+         p.used = true;
+         p.origin = origin;
+         p.seq = seq;
+         p.count = 1;
+         p.len = len;
+         memcpy( p.data, data, len );
+         timer().template set_timer<self_type, &self_type::pending_timer_elapsed>(
+            rand_() % FLOODING_REBROADCAST_DELAY + 1, this, (void*)&p );
+         return;
+      }
+      // No room to wait, forward right away
+#endif
+      radio().send( radio().BROADCAST_ADDRESS, len, data );
+   }
+   // -----------------------------------------------------------------------
+   template<typename OsModel_P,
+            typename RoutingTable_P,
+            typename Radio_P,
+            typename Debug_P>
+   void
+   FloodingAlgorithm<OsModel_P, RoutingTable_P, Radio_P, Debug_P>::
+   heard_duplicate( node_id_t origin, seq_nr_t seq )
+   {
+#if FLOODING_REBROADCAST_MODE == FLOODING_REBROADCAST_COUNTER
+      for ( int i = 0; i < FLOODING_PENDING_SIZE; i++ )
+      {
+         Pending &p = pending_[i];
+         if ( p.used && p.origin == origin && p.seq == seq )
+         {
+            if ( p.count < 0xff )
+               p.count++;
+            return;
+         }
+      }
+#endif
+   }
+#if FLOODING_REBROADCAST_MODE == FLOODING_REBROADCAST_COUNTER
+   // -----------------------------------------------------------------------
+   template<typename OsModel_P,
+            typename RoutingTable_P,
+            typename Radio_P,
+            typename Debug_P>
+   void
+   FloodingAlgorithm<OsModel_P, RoutingTable_P, Radio_P, Debug_P>::
+   pending_timer_elapsed( void *userdata )
+   {
+      Pending *p = (Pending*)userdata;
+      if ( !p->used )
+         return;
+
+      p->used = false;
+      if ( p->count < FLOODING_REBROADCAST_COUNTER_THRESHOLD )
+         radio().send( radio().BROADCAST_ADDRESS, p->len, p->data );
+#ifdef ROUTING_FLOODING_DEBUG
+      else
+         debug().debug( "FloodingAlgorithm: suppressed rebroadcast at %d (heard %d times)\n",
+                        radio_->id(), p->count );
+#endif
+   }
+#endif
 
 }
 #endif
@@ -0,0 +1,246 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+#ifndef __FLOODING_DUPLICATE_CACHE_H__
+#define __FLOODING_DUPLICATE_CACHE_H__
+
+#include "util/types.h"
+#include "algorithms/hash/fnv.h"
+
+namespace wiselib
+{
+
+   /** Sliding window over the sequence numbers of one originator.
+    *
+    *  Remembers the highest sequence number seen and, as a bitmap, which
+    *  of the WINDOW numbers below it have been seen. Sequence numbers are
+    *  compared in serial number arithmetic, so they may wrap around and
+    *  packets may arrive out of order. A number that lies further behind
+    *  than the window is taken as a restart of the originator, as is
+    *  INIT_SEQ_P (the first number after a reboot) once the highest
+    *  number seen is 2 or more, unless it was seen within the window
+    *  already: then it is a late copy of the first packet.
+    */
+   template<typename Seq_P,
+            int INIT_SEQ_P = 0>
+   class FloodingSequenceWindow
+   {
+   public:
+      typedef Seq_P seq_nr_t;
+
+      enum { WINDOW = 32, INIT_SEQ_NR = INIT_SEQ_P };
+
+      FloodingSequenceWindow()
+         : valid_ ( false )
+      {}
+
+      void reset()
+      { valid_ = false; }
+
+      /** \return true if seq has not been seen before, it is marked as
+       *  seen then
+       */
+      bool accept( seq_nr_t seq )
+      {
+         if ( !valid_ )
+         {
+            restart( seq );
+            return true;
+         }
+
+         seq_nr_t ahead = (seq_nr_t)( seq - highest_ );
+         if ( ahead == 0 )
+            return false;
+
+         if ( ahead < HALF_RANGE )
+         {
+            bitmap_ = ( ahead >= WINDOW ) ? 1 : ( ( bitmap_ << ahead ) | 1 );
+            highest_ = seq;
+            return true;
+         }
+
+         seq_nr_t behind = (seq_nr_t)( highest_ - seq );
+         if ( behind >= WINDOW )
+         {
+            restart( seq );
+            return true;
+         }
+
+         uint32_t bit = (uint32_t)1 << behind;
+         if ( bitmap_ & bit )
+            return false;
+         if ( seq == (seq_nr_t)INIT_SEQ_NR && highest_ >= 2 )
+         {
+            restart( seq );
+            return true;
+         }
+         bitmap_ |= bit;
+         return true;
+      }
+
+      inline seq_nr_t highest()
+      { return highest_; }
+
+      inline bool valid()
+      { return valid_; }
+
+   private:
+      static const seq_nr_t HALF_RANGE = (seq_nr_t)( (seq_nr_t)(-1) / 2 + 1 );
+
+      void restart( seq_nr_t seq )
+      {
+         valid_ = true;
+         highest_ = seq;
+         bitmap_ = 1;
+      }
+
+      uint32_t bitmap_;
+      seq_nr_t highest_;
+      bool valid_;
+   };
+   // -----------------------------------------------------------------------
+   // -----------------------------------------------------------------------
+   // -----------------------------------------------------------------------
+   /** Fixed size duplicate cache for flooded messages.
+    *
+    *  Keeps a FloodingSequenceWindow for up to SIZE_P originators. The
+    *  table is hashed on the originator and split into buckets of WAYS_P
+    *  entries. Every access stamps the entry, when a bucket is full the
+    *  entry that has not been used for the longest time is replaced.
+    *  Entries are not aged by time: an originator that comes back after
+    *  a reboot starts over at INIT_SEQ_P, which resets its window.
+    */
+   template<typename OsModel_P,
+            typename NodeId_P,
+            typename Seq_P,
+            int SIZE_P,
+            int WAYS_P = 4,
+            int INIT_SEQ_P = 0>
+   class FloodingDuplicateCache
+   {
+   public:
+      typedef OsModel_P OsModel;
+      typedef typename OsModel::block_data_t block_data_t;
+      typedef NodeId_P node_id_t;
+      typedef Seq_P seq_nr_t;
+      typedef FloodingSequenceWindow<seq_nr_t, INIT_SEQ_P> Window;
+
+      enum
+      {
+         WAYS = ( WAYS_P < SIZE_P ) ? WAYS_P : SIZE_P,
+         BUCKETS = SIZE_P / WAYS,
+         SIZE = BUCKETS * WAYS
+      };
+
+      FloodingDuplicateCache()
+      { clear(); }
+
+      void clear()
+      {
+         for ( int i = 0; i < SIZE; i++ )
+            entries_[i].used = false;
+         stamp_ = 0;
+         used_ = 0;
+         evictions_ = 0;
+      }
+
+      /** \return true if (origin, seq) has not been seen before, it is
+       *  recorded then
+       */
+      bool accept( node_id_t origin, seq_nr_t seq )
+      {
+         stamp_++;
+
+         Entry *bucket = entries_ + bucket_of( origin ) * WAYS;
+         Entry *victim = 0;
+         for ( int i = 0; i < WAYS; i++ )
+         {
+            Entry &e = bucket[i];
+            if ( !e.used )
+            {
+               if ( !victim || victim->used )
+                  victim = &e;
+               continue;
+            }
+            if ( e.origin == origin )
+            {
+               e.stamp = stamp_;
+               return e.window.accept( seq );
+            }
+            if ( !victim || ( victim->used && age( e ) > age( *victim ) ) )
+               victim = &e;
+         }
+
+         if ( victim->used )
+            evictions_++;
+         else
+            used_++;
+
+         victim->used = true;
+         victim->origin = origin;
+         victim->stamp = stamp_;
+         victim->window.reset();
+         return victim->window.accept( seq );
+      }
+
+      /** Forgets the originator, e.g. because it is known to have rebooted
+       */
+      void erase( node_id_t origin )
+      {
+         Entry *bucket = entries_ + bucket_of( origin ) * WAYS;
+         for ( int i = 0; i < WAYS; i++ )
+            if ( bucket[i].used && bucket[i].origin == origin )
+            {
+               bucket[i].used = false;
+               used_--;
+            }
+      }
+
+      inline int size()
+      { return used_; }
+
+      /// Number of originators that were pushed out of a full bucket
+      inline uint32_t evictions()
+      { return evictions_; }
+
+   private:
+      struct Entry
+      {
+         Window window;
+         node_id_t origin;
+         uint16_t stamp;
+         bool used;
+      };
+
+      inline uint16_t age( Entry &e )
+      { return (uint16_t)( stamp_ - e.stamp ); }
+
+      int bucket_of( node_id_t origin )
+      {
+         // over the bytes of the id, independent of its width
+         return Fnv1a<OsModel, uint32_t>::hash( (block_data_t*)&origin, sizeof(node_id_t) ) % BUCKETS;
+      }
+
+      Entry entries_[SIZE];
+      uint16_t stamp_;
+      int used_;
+      uint32_t evictions_;
+   };
+
+}
+#endif
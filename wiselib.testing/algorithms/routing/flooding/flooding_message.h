@@ -19,7 +19,7 @@
 #ifndef __FLOODING_ALGORITHM_MSG_H__
 #define __FLOODING_ALGORITHM_MSG_H__
 
-#include "util/serialization/simple_types.h"
+#include "util/serialization/message_layout.h"
 
 namespace wiselib
 {
@@ -36,54 +36,61 @@ namespace wiselib
       typedef typename Radio::block_data_t block_data_t;
       typedef typename Radio::size_t size_t;
       typedef typename Radio::message_id_t message_id_t;
+
+      typedef LayoutField<message_id_t> MsgIdField;
+      typedef LayoutField<node_id_t, MsgIdField> NodeIdField;
+      typedef LayoutField<node_id_t, NodeIdField> DestIdField;
+      typedef LayoutField<seq_nr_t, DestIdField> SeqNrField;
+      typedef LayoutField<size_t, SeqNrField> PayloadSizeField;
+      typedef LayoutCheck<PayloadSizeField, Radio::MAX_MESSAGE_LENGTH> Header;
       // --------------------------------------------------------------------
       inline FloodingMessage();
       // --------------------------------------------------------------------
       inline message_id_t msg_id()
-      { return read<OsModel, block_data_t, message_id_t>( buffer ); };
+      { return read_field<OsModel, MsgIdField>( buffer ); };
       // --------------------------------------------------------------------
       inline void set_msg_id( message_id_t id )
-      { write<OsModel, block_data_t, message_id_t>( buffer, id ); }
+      { write_field<OsModel, MsgIdField>( buffer, id ); }
       // --------------------------------------------------------------------
       inline node_id_t node_id()
-      { return read<OsModel, block_data_t, node_id_t>(buffer + NODE_ID_POS); }
+      { return read_field<OsModel, NodeIdField>( buffer ); }
       // --------------------------------------------------------------------
       inline void set_node_id( node_id_t id )
-      { write<OsModel, block_data_t, node_id_t>(buffer + NODE_ID_POS, id); }
+      { write_field<OsModel, NodeIdField>( buffer, id ); }
       // --------------------------------------------------------------------
       inline node_id_t dest_id()
-      { return read<OsModel, block_data_t, node_id_t>(buffer + DEST_ID_POS); }
+      { return read_field<OsModel, DestIdField>( buffer ); }
       // --------------------------------------------------------------------
       inline void set_dest_id( node_id_t id )
-      { write<OsModel, block_data_t, node_id_t>(buffer + DEST_ID_POS, id); }
+      { write_field<OsModel, DestIdField>( buffer, id ); }
       // --------------------------------------------------------------------
       inline seq_nr_t seq_nr()
-      { return read<OsModel, block_data_t, seq_nr_t>(buffer + SEQ_NR_POS); }
+      { return read_field<OsModel, SeqNrField>( buffer ); }
       // --------------------------------------------------------------------
       inline void set_seq_nr( seq_nr_t seq )
-      { write<OsModel, block_data_t, seq_nr_t>(buffer + SEQ_NR_POS, seq); }
+      { write_field<OsModel, SeqNrField>( buffer, seq ); }
       // --------------------------------------------------------------------
       inline size_t payload_size()
-      { return read<OsModel, block_data_t, size_t>(buffer + PAYLOAD_POS); }
+      { return read_field<OsModel, PayloadSizeField>( buffer ); }
       // --------------------------------------------------------------------
       inline block_data_t* payload()
-      { return buffer + PAYLOAD_POS + sizeof(size_t); }
+      { return buffer + Header::SIZE; }
       // --------------------------------------------------------------------
       inline void set_payload( size_t len, block_data_t *buf )
       {
-         write<OsModel, block_data_t, size_t>(buffer + PAYLOAD_POS, len);
-         memcpy( buffer + PAYLOAD_POS + sizeof(size_t), buf, len);
+         write_field<OsModel, PayloadSizeField>( buffer, len );
+         memcpy( buffer + Header::SIZE, buf, len);
       }
       // --------------------------------------------------------------------
       inline size_t buffer_size()
-      { return PAYLOAD_POS + sizeof(size_t) + payload_size(); }
+      { return Header::SIZE + payload_size(); }
 
       enum data_positions
       {
-         NODE_ID_POS = sizeof(message_id_t),
-         DEST_ID_POS = NODE_ID_POS + sizeof(node_id_t),
-         SEQ_NR_POS = DEST_ID_POS + sizeof(node_id_t),
-         PAYLOAD_POS = SEQ_NR_POS + sizeof(seq_nr_t)
+         NODE_ID_POS = NodeIdField::OFFSET,
+         DEST_ID_POS = DestIdField::OFFSET,
+         SEQ_NR_POS = SeqNrField::OFFSET,
+         PAYLOAD_POS = PayloadSizeField::OFFSET
       };
       
    private:    
@@ -97,8 +104,7 @@ namespace wiselib
    {
       set_msg_id( 0 );
       set_node_id( 0 );
-      size_t len = 0;
-      write<OsModel, block_data_t, size_t>(buffer + PAYLOAD_POS, len);
+      write_field<OsModel, PayloadSizeField>( buffer, 0 );
    }
 
 }
@@ -25,6 +25,7 @@
 
 #include <util/pstl/vector_static.h>
 #include "flooding_nd_neighbor.h"
+#include <algorithms/routing/flooding/flooding_duplicate_cache.h>
 #include <util/serialization/serialization.h>
 
 namespace wiselib {
@@ -59,6 +60,7 @@ namespace wiselib {
 			typedef typename Radio::message_id_t message_id_t;
 			typedef FloodingNdNeighbor<Radio> Neighbor;
 			typedef ::uint8_t sequence_number_t;
+			typedef FloodingSequenceWindow<sequence_number_t> SequenceWindow;
 			typedef FloodingNd<OsModel_P, Radio_P> self_type;
 			typedef self_type* self_pointer_t;
 			typedef RadioBase<OsModel_P, typename Radio_P::node_id_t, typename Radio_P::size_t, typename Radio_P::block_data_t> base_type;
@@ -113,6 +115,7 @@ namespace wiselib {
 				radio_ = radio;
 				radio_->template reg_recv_callback<self_type, &self_type::on_receive>(this);
 				sequence_number_ = 0;
+				seen_.reset();
 				parent_set_ = false;
 			}
 			
@@ -131,6 +134,7 @@ namespace wiselib {
 				
 				wiselib::write<OsModel>(message, m);
 				sequence_number_++;
+				seen_.accept(sequence_number_);
 				wiselib::write<OsModel>(message + sizeof(message_id_t), sequence_number_);
 				memcpy(message + sizeof(message_id_t) + sizeof(sequence_number_t), data, size);
 				
@@ -190,15 +194,21 @@ namespace wiselib {
 				if(msg_id == MESSAGE_ID_FLOODING) {
 				//Serial.println("fnd recv3");
 					sequence_number_t seq = wiselib::read<OsModel, block_data_t, sequence_number_t>(d_seq);
-					if(seq > sequence_number_) { // || (sequence_number_ == MAX_SEQUENCE_NUMBER && seq != sequence_number_)) {
+					// The window also accepts floods that overtook each
+					// other and keeps working when the sequence number wraps
+					if(seen_.accept(seq)) {
 				//Serial.println("fnd recv4");
 						base_type::notify_receivers(from,
 								size - sizeof(sequence_number_t) - sizeof(message_id_t), d_payload);
 						radio_->send(Radio::BROADCAST_ADDRESS, size, data);
-						sequence_number_ = seq;
-						parent_.set_id(from);
-						parent_.set_state(Neighbor::OUT_EDGE);
-						parent_set_ = true;
+						
+						// Only the latest flood defines the tree
+						if(seen_.highest() == seq) {
+							sequence_number_ = seq;
+							parent_.set_id(from);
+							parent_.set_state(Neighbor::OUT_EDGE);
+							parent_set_ = true;
+						}
 					}
 				}
 				else {
@@ -209,6 +219,7 @@ namespace wiselib {
 			Neighbor parent_;
 			typename Radio::self_pointer_t radio_;
 			sequence_number_t sequence_number_;
+			SequenceWindow seen_;
 			bool parent_set_;
 		
 	}; // FloodingNd
@@ -0,0 +1,97 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+#ifndef __ALGORITHMS_ROUTING_OLSR_TUPLE_POOL_H__
+#define __ALGORITHMS_ROUTING_OLSR_TUPLE_POOL_H__
+
+namespace wiselib
+{
+   /** \brief Fixed size storage for the OLSR tuple sets.
+    *
+    *  All tuples of one kind live in a single contiguous array. Free slots
+    *  are chained through a free list, so alloc() and free() are O(1) and
+    *  a tuple never moves while it is in use, the tuple sets and timers can
+    *  keep pointing to it.
+    */
+   template<typename Tuple_P, int SIZE_P>
+   class OlsrTuplePool
+   {
+   public:
+      typedef Tuple_P tuple_t;
+
+      enum { SIZE = SIZE_P };
+
+      OlsrTuplePool()
+      {
+         for ( int i = 0; i < SIZE - 1; i++ )
+            next_[i] = i + 1;
+         next_[SIZE - 1] = NO_SLOT;
+         free_ = 0;
+         used_ = 0;
+      }
+
+      /** \return a default initialized tuple, NULL if the pool is exhausted
+       */
+      tuple_t* alloc()
+      {
+         if ( free_ == NO_SLOT )
+            return NULL;
+
+         int slot = free_;
+         free_ = next_[slot];
+         next_[slot] = IN_USE;
+         used_++;
+
+         tuples_[slot] = tuple_t();
+         return &tuples_[slot];
+      }
+
+      /** Returns a tuple obtained from alloc() to the pool. NULL and tuples
+       *  that are not (or no longer) part of the pool are ignored.
+       */
+      void free( tuple_t* tuple )
+      {
+         if ( tuple < tuples_ || tuple >= tuples_ + SIZE )
+            return;
+
+         int slot = tuple - tuples_;
+         if ( next_[slot] != IN_USE )
+            return;
+
+         next_[slot] = free_;
+         free_ = slot;
+         used_--;
+      }
+
+      inline int size()
+      { return used_; }
+
+      inline bool full()
+      { return free_ == NO_SLOT; }
+
+   private:
+      enum { NO_SLOT = -1, IN_USE = -2 };
+
+      tuple_t tuples_[SIZE];
+      int next_[SIZE];
+      int free_;
+      int used_;
+   };
+
+}
+#endif
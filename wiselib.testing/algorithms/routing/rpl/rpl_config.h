@@ -31,5 +31,10 @@
 //Metric type (activate one at a time)
 #define ETX_METRIC
 
+//Keep the downward routes of the DODAG root in a hashed table with route lifetimes
+//instead of the forwarding table (border routers with large DODAGs)
+//In non-storing mode no Source Route Header is inserted, only the children of the root are reachable
+//#define RPL_ROOT_ROUTE_TABLE
+
 
 #endif
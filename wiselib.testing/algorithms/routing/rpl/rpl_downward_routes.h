@@ -0,0 +1,432 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+/*
+* File: rpl_downward_routes.h
+*/
+
+#ifndef __ALGORITHMS_ROUTING_RPL_DOWNWARD_ROUTES_H__
+#define __ALGORITHMS_ROUTING_RPL_DOWNWARD_ROUTES_H__
+
+#include "algorithms/hash/fnv.h"
+
+//Lollipop sequence counters are only comparable within this window (RFC 6550 7.2)
+#define RPL_SEQUENCE_WINDOW 16
+
+namespace wiselib
+{
+	/**
+	 * \brief Downward route table of a DODAG root.
+	 *
+	 * Every target announced with a DAO gets one entry, indexed by a hash of its
+	 * address, so DAO processing and the next hop lookup of a forwarded packet
+	 * are O(1) no matter how many nodes are in the DODAG.
+	 *
+	 * In storing mode an entry holds the neighbor the DAO came from (the next
+	 * hop). In non-storing mode it holds the DAO parent of the target, the root
+	 * finds the first hop by walking the parents up to itself. The first hop is
+	 * cached in the entry and only looked up again after the DODAG changed.
+	 * The root does not insert an RFC 6554 Source Route Header, so in
+	 * non-storing mode downward routing is unsupported beyond the children of
+	 * the root: the first hop has no route for the rest of the path.
+	 *
+	 * Route lifetimes are kept in a timer wheel: tick() has to be called every
+	 * tick (the caller decides the length of a tick), it expires the routes of
+	 * one slot, inserting and refreshing a route is O(1).
+	 */
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		int SIZE_P,
+		int WHEEL_SLOTS_P,
+		int MAX_HOPS_P>
+	class RPLDownwardRoutes
+	{
+	public:
+		typedef OsModel_P OsModel;
+		typedef Radio_IP_P Radio_IP;
+
+		typedef typename Radio_IP::node_id_t node_id_t;
+		typedef typename Radio_IP::block_data_t block_data_t;
+		typedef typename Radio_IP::size_t size_t;
+
+		typedef RPLDownwardRoutes<OsModel, Radio_IP, SIZE_P, WHEEL_SLOTS_P, MAX_HOPS_P> self_type;
+
+		enum { SIZE = SIZE_P, WHEEL_SLOTS = WHEEL_SLOTS_P, MAX_HOPS = MAX_HOPS_P };
+
+		/// Lifetime of routes that never expire
+		enum { INFINITE_LIFETIME = 0xFFFFFFFF };
+
+		enum ErrorCodes
+		{
+			SUCCESS = OsModel::SUCCESS,
+			ERR_NOMEM = OsModel::ERR_NOMEM,
+			/// The DAO carried an older path sequence than the stored route
+			ERR_STALE = OsModel::ERR_UNSPEC - 1
+		};
+
+		RPLDownwardRoutes()
+		{
+			init( Radio_IP::NULL_NODE_ID, true );
+		}
+
+		/**
+		 * Drops all routes
+		 * \param root address of the root, the non-storing mode paths end at it
+		 * \param storing true for storing mode, false for non-storing mode
+		 */
+		void init( const node_id_t& root, bool storing )
+		{
+			root_ = root;
+			storing_ = storing;
+			now_ = 0;
+			generation_ = 0;
+			count_ = 0;
+			for( int i = 0; i < SIZE; i++ )
+			{
+				bucket_[i] = NO_SLOT;
+				routes_[i].next = ( i + 1 < SIZE ) ? i + 1 : NO_SLOT;
+			}
+			free_ = 0;
+			for( int i = 0; i < WHEEL_SLOTS; i++ )
+				wheel_[i] = NO_SLOT;
+		}
+
+		/**
+		 * Stores the route announced by a DAO
+		 * \param target the announced address
+		 * \param via next hop (storing mode) or DAO parent (non-storing mode)
+		 * \param path_sequence path sequence of the Transit Information option
+		 * \param lifetime in ticks, 0 removes the route (No-Path DAO)
+		 * \return SUCCESS, ERR_STALE if the stored route is newer, ERR_NOMEM if the table is full
+		 */
+		int update( const node_id_t& target, const node_id_t& via, uint8_t path_sequence, uint32_t lifetime );
+
+		/**
+		 * Removes the route to target
+		 * \return false if there was none
+		 */
+		bool remove( const node_id_t& target )
+		{
+			int slot = find( target );
+			if( slot == NO_SLOT )
+				return false;
+			release( slot );
+			return true;
+		}
+
+		bool contains( const node_id_t& target )
+		{
+			return find( target ) != NO_SLOT;
+		}
+
+		/**
+		 * The neighbor a packet for target has to be sent to: the stored next hop
+		 * in storing mode, the child of the root on the path to target in
+		 * non-storing mode
+		 * \return false if there is no (complete) route
+		 */
+		bool next_hop( const node_id_t& target, node_id_t& hop );
+
+		/**
+		 * Advances the wheel by one tick and drops the routes expiring now
+		 */
+		void tick();
+
+		int size()
+		{
+			return count_;
+		}
+
+		bool full()
+		{
+			return free_ == NO_SLOT;
+		}
+
+	private:
+		enum { NO_SLOT = -1 };
+
+		struct Route
+		{
+			node_id_t target;
+			node_id_t via;
+			uint32_t expires;
+			// generation_ the cached first hop was found in
+			uint32_t generation;
+			// hash chain when used, free list otherwise
+			int next;
+			int wheel_prev;
+			int wheel_next;
+			uint8_t path_sequence;
+			// the first hop is cached, false if it was not found yet
+			bool first_hop_valid;
+			node_id_t first_hop;
+		};
+
+		static unsigned int hash( const node_id_t& address )
+		{
+			// the prefix is shared by the whole DODAG, the IID is enough
+			return Fnv1a<OsModel, uint32_t>::hash( address.addr + 8, 8 ) % SIZE;
+		}
+
+		/**
+		 * a > b for the lollipop counters of RFC 6550, counters that are
+		 * not comparable count as newer
+		 */
+		static bool sequence_newer( uint8_t a, uint8_t b )
+		{
+			if( a > 127 && b <= 127 )
+				return ( 256 + b - a ) > RPL_SEQUENCE_WINDOW;
+			if( a <= 127 && b > 127 )
+				return ( 256 + a - b ) <= RPL_SEQUENCE_WINDOW;
+			uint8_t diff = ( a > b ) ? a - b : b - a;
+			if( diff > RPL_SEQUENCE_WINDOW )
+				return true;
+			return (uint8_t)( ( a - b ) & 0x7F ) != 0 && (uint8_t)( ( a - b ) & 0x7F ) < 64;
+		}
+
+		int find( const node_id_t& target )
+		{
+			for( int slot = bucket_[hash( target )]; slot != NO_SLOT; slot = routes_[slot].next )
+				if( routes_[slot].target == target )
+					return slot;
+			return NO_SLOT;
+		}
+
+		void release( int slot );
+
+		void wheel_insert( int slot )
+		{
+			Route& route = routes_[slot];
+			int head = route.expires % WHEEL_SLOTS;
+			route.wheel_prev = NO_SLOT;
+			route.wheel_next = wheel_[head];
+			if( wheel_[head] != NO_SLOT )
+				routes_[wheel_[head]].wheel_prev = slot;
+			wheel_[head] = slot;
+		}
+
+		void wheel_remove( int slot )
+		{
+			Route& route = routes_[slot];
+			if( route.expires == INFINITE_LIFETIME )
+				return;
+			if( route.wheel_prev != NO_SLOT )
+				routes_[route.wheel_prev].wheel_next = route.wheel_next;
+			else
+				wheel_[route.expires % WHEEL_SLOTS] = route.wheel_next;
+			if( route.wheel_next != NO_SLOT )
+				routes_[route.wheel_next].wheel_prev = route.wheel_prev;
+		}
+
+		bool find_first_hop( Route& route );
+
+		Route routes_[SIZE];
+		int bucket_[SIZE];
+		int wheel_[WHEEL_SLOTS];
+		int free_;
+		int count_;
+		uint32_t now_;
+		// changed whenever a DAO parent changes or a route is dropped, invalidates the cached first hops
+		uint32_t generation_;
+		node_id_t root_;
+		bool storing_;
+	};
+
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		int SIZE_P,
+		int WHEEL_SLOTS_P,
+		int MAX_HOPS_P>
+	int
+	RPLDownwardRoutes<OsModel_P, Radio_IP_P, SIZE_P, WHEEL_SLOTS_P, MAX_HOPS_P>::
+	update( const node_id_t& target, const node_id_t& via, uint8_t path_sequence, uint32_t lifetime )
+	{
+		int slot = find( target );
+
+		if( slot != NO_SLOT )
+		{
+			Route& route = routes_[slot];
+			if( route.path_sequence != path_sequence && !sequence_newer( path_sequence, route.path_sequence ) )
+				return ERR_STALE;
+
+			if( lifetime == 0 )
+			{
+				// a No-Path from the old branch must not drop the route through the new one
+				if( storing_ && !( route.via == via ) )
+					return ERR_STALE;
+				release( slot );
+				return SUCCESS;
+			}
+
+			if( !( route.via == via ) )
+			{
+				route.via = via;
+				generation_++;
+			}
+			route.path_sequence = path_sequence;
+			wheel_remove( slot );
+		}
+		else
+		{
+			if( lifetime == 0 )
+				return SUCCESS;
+			if( free_ == NO_SLOT )
+				return ERR_NOMEM;
+
+			slot = free_;
+			free_ = routes_[slot].next;
+
+			Route& route = routes_[slot];
+			unsigned int h = hash( target );
+			route.next = bucket_[h];
+			bucket_[h] = slot;
+
+			route.target = target;
+			route.via = via;
+			route.path_sequence = path_sequence;
+			route.first_hop_valid = false;
+			count_++;
+		}
+
+		Route& route = routes_[slot];
+		if( lifetime == INFINITE_LIFETIME )
+			route.expires = INFINITE_LIFETIME;
+		else
+		{
+			route.expires = now_ + lifetime;
+			// never collide with the marker of routes that don't expire
+			if( route.expires == INFINITE_LIFETIME )
+				route.expires--;
+			wheel_insert( slot );
+		}
+		return SUCCESS;
+	}
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		int SIZE_P,
+		int WHEEL_SLOTS_P,
+		int MAX_HOPS_P>
+	void
+	RPLDownwardRoutes<OsModel_P, Radio_IP_P, SIZE_P, WHEEL_SLOTS_P, MAX_HOPS_P>::
+	release( int slot )
+	{
+		Route& route = routes_[slot];
+
+		unsigned int h = hash( route.target );
+		if( bucket_[h] == slot )
+			bucket_[h] = route.next;
+		else
+		{
+			int prev = bucket_[h];
+			while( routes_[prev].next != slot )
+				prev = routes_[prev].next;
+			routes_[prev].next = route.next;
+		}
+
+		wheel_remove( slot );
+
+		route.next = free_;
+		free_ = slot;
+		count_--;
+
+		// paths through this node are broken now
+		generation_++;
+	}
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		int SIZE_P,
+		int WHEEL_SLOTS_P,
+		int MAX_HOPS_P>
+	void
+	RPLDownwardRoutes<OsModel_P, Radio_IP_P, SIZE_P, WHEEL_SLOTS_P, MAX_HOPS_P>::
+	tick()
+	{
+		now_++;
+		if( now_ == INFINITE_LIFETIME )
+			now_ = 0;
+
+		int slot = wheel_[now_ % WHEEL_SLOTS];
+		while( slot != NO_SLOT )
+		{
+			// routes of a later round of the wheel stay
+			int next = routes_[slot].wheel_next;
+			if( routes_[slot].expires == now_ )
+				release( slot );
+			slot = next;
+		}
+	}
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		int SIZE_P,
+		int WHEEL_SLOTS_P,
+		int MAX_HOPS_P>
+	bool
+	RPLDownwardRoutes<OsModel_P, Radio_IP_P, SIZE_P, WHEEL_SLOTS_P, MAX_HOPS_P>::
+	find_first_hop( Route& route )
+	{
+		if( route.first_hop_valid && route.generation == generation_ )
+			return true;
+
+		// walk from the target up to the child of the root
+		route.first_hop_valid = false;
+		Route* current = &route;
+		for( uint8_t hops = 1; !( current->via == root_ ); hops++ )
+		{
+			int parent = find( current->via );
+			// the parent has no route (yet), the path is too long or the parents form a loop
+			if( parent == NO_SLOT || hops == MAX_HOPS || &routes_[parent] == &route )
+				return false;
+			current = &routes_[parent];
+		}
+
+		route.first_hop = current->target;
+		route.first_hop_valid = true;
+		route.generation = generation_;
+		return true;
+	}
+	// -----------------------------------------------------------------------
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		int SIZE_P,
+		int WHEEL_SLOTS_P,
+		int MAX_HOPS_P>
+	bool
+	RPLDownwardRoutes<OsModel_P, Radio_IP_P, SIZE_P, WHEEL_SLOTS_P, MAX_HOPS_P>::
+	next_hop( const node_id_t& target, node_id_t& hop )
+	{
+		int slot = find( target );
+		if( slot == NO_SLOT )
+			return false;
+
+		if( storing_ )
+		{
+			hop = routes_[slot].via;
+			return true;
+		}
+
+		if( !find_first_hop( routes_[slot] ) )
+			return false;
+		hop = routes_[slot].first_hop;
+		return true;
+	}
+}
+#endif
@@ -27,7 +27,12 @@
 #include "util/base_classes/routing_base.h"
 #include "algorithms/6lowpan/ipv6_packet_pool_manager.h"
 #include "algorithms/routing/rpl/etx_computation.h"
+#include "algorithms/protocols/trickle/trickle_timer.h"
+#include "algorithms/rand/kiss.h"
 #include "algorithms/routing/rpl/rpl_config.h"
+#ifdef RPL_ROOT_ROUTE_TABLE
+#include "algorithms/routing/rpl/rpl_downward_routes.h"
+#endif
 
 #include "util/pstl/map_static_vector.h"
 
@@ -39,6 +44,11 @@
 
 #define DEFAULT_DAO_DELAY 1000
 
+//Path lifetime of the DAOs, in Lifetime Units, announced by the root with the configuration option
+#define DEFAULT_DAO_LIFETIME 5
+//Lifetime Unit in seconds (RFC 6550 6.7.6), the routes live DEFAULT_DAO_LIFETIME * 60 s = 5 minutes
+#define DEFAULT_LIFETIME_UNIT 60
+
 #define NO_PATH_DAO_COUNT 3
 
 
@@ -58,6 +68,24 @@
 
 #define DODAG_REPAIR_THRESHOLD 30
 
+#ifdef RPL_ROOT_ROUTE_TABLE
+//Downward routes kept by the root, see rpl_downward_routes.h
+#ifndef RPL_ROOT_ROUTE_TABLE_SIZE
+#define RPL_ROOT_ROUTE_TABLE_SIZE 1024
+#endif
+//Longest path from the root (non-storing mode)
+#ifndef RPL_ROOT_ROUTE_MAX_HOPS
+#define RPL_ROOT_ROUTE_MAX_HOPS 16
+#endif
+#ifndef RPL_ROUTE_WHEEL_SLOTS
+#define RPL_ROUTE_WHEEL_SLOTS 256
+#endif
+//Length of a route lifetime tick (ms)
+#ifndef RPL_ROUTE_WHEEL_TICK
+#define RPL_ROUTE_WHEEL_TICK 1000
+#endif
+#endif
+
 namespace wiselib
 {
 
@@ -76,8 +104,8 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	class RPLRouting
 		: public RoutingBase<OsModel_P, Radio_IP_P>
 	{
@@ -87,9 +115,9 @@ namespace wiselib
 		typedef Radio_P Radio;
 		typedef Debug_P Debug;
 		typedef Timer_P Timer;
-		//typedef Clock_P Clock;
+		typedef Clock_P Clock;
 
-		typedef RPLRouting<OsModel, Radio_IP, Radio, Debug, Timer/*, Clock*/> self_type;
+		typedef RPLRouting<OsModel, Radio_IP, Radio, Debug, Timer, Clock> self_type;
 		typedef self_type* self_pointer_t;
 
 		typedef wiselib::IPv6PacketPoolManager<OsModel, Radio, Debug> Packet_Pool_Mgr_t;
@@ -100,12 +128,15 @@ namespace wiselib
 		typedef typename Radio_IP::block_data_t block_data_t;
 		typedef typename Radio_IP::message_id_t message_id_t;
 
-		//typedef typename Clock::time_t time_t;
+		typedef typename Clock::time_t time_t;
 		
 		typedef typename Radio::node_id_t link_layer_node_id_t;
 
 		typedef typename Timer::millis_t millis_t;
 
+		typedef wiselib::Kiss<OsModel> Rand_t;
+		typedef wiselib::TrickleTimer<OsModel, Timer, Clock, Rand_t, 1> Trickle_t;
+
 		struct Mapped_erase_node
 		{
 			node_id_t node;
@@ -140,6 +171,10 @@ namespace wiselib
 
 		typedef wiselib::ETX_computation<OsModel, Radio_IP, Radio, Debug, Timer> ETX_computation_t;
 		typedef typename ETX_computation_t::ETX_values_iterator ETX_values_iterator;
+
+		#ifdef RPL_ROOT_ROUTE_TABLE
+		typedef wiselib::RPLDownwardRoutes<OsModel, Radio_IP, RPL_ROOT_ROUTE_TABLE_SIZE, RPL_ROUTE_WHEEL_SLOTS, RPL_ROOT_ROUTE_MAX_HOPS> DownwardRoutes_t;
+		#endif
 		
 		/**
 		* Enumeration of the ICMPv6 message code types
@@ -231,16 +266,23 @@ namespace wiselib
 		~RPLRouting();
 		///@}
 		
-		int init( Radio_IP& radio_ip, Radio& radio, Debug& debug, Timer& timer/*, Clock& clock*/, Packet_Pool_Mgr_t* p_mgr)
+		int init( Radio_IP& radio_ip, Radio& radio, Debug& debug, Timer& timer, Clock& clock, Packet_Pool_Mgr_t* p_mgr)
 		{
 			
 			radio_ip_ = &radio_ip;
 			radio_ = &radio;
 			debug_ = &debug;
 			timer_ = &timer;
-			//clock_ = &clock; //uncomment if clock enabled
+			clock_ = &clock;
 			packet_pool_mgr_ = p_mgr;
+			rand_.srand( (uint32_t)radio.id() );
+			trickle_.init( timer, clock, rand_ );
+			dio_trickle_ = trickle_.template add<self_type, &self_type::threshold_timer_elapsed, &self_type::timer_elapsed>(
+				(millis_t)1 << dio_int_min_, imax_, dio_redund_const_, this );
 			etx_computation_.init( radio_ip, radio, debug, timer, *packet_pool_mgr_ );
+			#ifdef RPL_ROOT_ROUTE_TABLE
+			root_routes_ready_ = false;
+			#endif
 			return SUCCESS;
 		}
 
@@ -294,11 +336,11 @@ namespace wiselib
 		///@{
 		/** \brief Periodic Tasks
 		 *
-		 *  This method is called periodically with intervals defined by
-		 *  ::current_interval_. Each connected node (the root and nodes that have
+		 *  This method is called by the DIO trickle timer at the end of each
+		 *  interval. Each connected node (the root and nodes that have
 		 *  a parent) broadcast a RPL DIO message with the Configuration Option, so that 
-		 *  newly installed nodes can connect to the DODAG. If a node is not yet
-		 *  connected, it prints out an appropriate debug message.
+		 *  newly installed nodes can connect to the DODAG. The trickle timer is
+		 *  stopped here for leaves and when the DIO timer has been stopped.
 		 */
 		void timer_elapsed( void *userdata );
 		 ///@}
@@ -307,6 +349,9 @@ namespace wiselib
  
 		void dis_delay( void *userdata );
 		
+		/** Called by the DIO trickle timer at its transmission point unless
+		 *  enough consistent DIOs have been heard in the current interval.
+		 */
 		void threshold_timer_elapsed( void *userdata );
 
 		void leaf_timer_elapsed( void* userdata );
@@ -326,6 +371,18 @@ namespace wiselib
 		void more_dio_timer_elapsed( void* userdata );
 
 		void delayed_restart_timer_elapsed( void* userdata );
+
+		#ifdef RPL_ROOT_ROUTE_TABLE
+		void route_wheel_timer_elapsed( void* userdata );
+
+		void root_dao_received( uint8_t packet_number, IPv6Packet_t* message, block_data_t *data, node_id_t sender );
+
+		bool root_route_available( node_id_t destination );
+
+		bool root_route_lookup( node_id_t destination, node_id_t& next_hop );
+
+		void read_dao_address( block_data_t *data, node_id_t& address );
+		#endif
 			
 		void first_dio( node_id_t from, block_data_t *data, uint16_t length );
 
@@ -367,48 +424,13 @@ namespace wiselib
 		
 		void print_neighbor_set();
 
-		//uncomment if clock enabled
-		/*
-		time_t time()
-		{
-			return clock().time();
- 		}
-
-		uint32_t seconds( time_t t )
-		{
-			return clock().seconds( t );
- 		}
-		
-		uint16_t milliseconds( time_t t )
-		{
-			return clock().milliseconds( t );
- 		}
-		*/
-				
-		void set_current_interval( uint8_t num )
-		{				
-			if (num == 0)
-			{
-				uint32_t t = 123456;  //comment if clock enabled
-				//uint32_t t = milliseconds(time()) + 1000*seconds(time()); //uncomment if clock enabled
-				current_interval_ = (t % (imax_ - imin_)) + imin_;
-							
-			}
-			else if (num == 1)
-				current_interval_ = max_interval_;
-			else	
-				current_interval_ = current_interval_*2;
-		}
-		
-		
-		void compute_sending_threshold()
+		/** Imin is 2^DIOIntervalMin ms, Imax is Imin doubled DIOIntervalDoublings times
+		 */
+		void set_dio_trickle_parameters()
 		{
-			uint32_t t = 123456; //comment if clock enabled			
-			//uint32_t t = milliseconds(time()) + 1000*seconds(time()); //uncomment if clock enabled
-			sending_threshold_ = ( t % current_interval_/2) + current_interval_/2;
+			trickle_.set_parameters( dio_trickle_, (millis_t)1 << dio_int_min_, imax_, dio_redund_const_ );
 		}
 
-		
 		uint16_t DAGRank( uint16_t rank )
 		{			
 			if( etx_ || ocp_ == 0 )
@@ -437,11 +459,8 @@ namespace wiselib
 		Debug& debug()
 		{ return *debug_; }
 		
-		//uncomment if clock enabled
-		/*
 		Clock& clock()
-        	{ return *clock_; }
-		*/		
+		{ return *clock_; }
 
 		typename Radio_IP::self_pointer_t radio_ip_;
 
@@ -449,7 +468,7 @@ namespace wiselib
 		typename Timer::self_pointer_t timer_;
 		
 		typename Debug::self_pointer_t debug_;
-		//typename Clock::self_pointer_t clock_; //uncomment if clock enabled
+		typename Clock::self_pointer_t clock_;
 				
 		Packet_Pool_Mgr_t* packet_pool_mgr_;
 
@@ -477,6 +496,12 @@ namespace wiselib
 
 		ETX_computation_t etx_computation_;
 
+		#ifdef RPL_ROOT_ROUTE_TABLE
+		DownwardRoutes_t downward_routes_;
+
+		bool root_routes_ready_;
+		#endif
+
 		Erase_parent_list erase_parent_list_;
 
 		ParentSet parent_set_;
@@ -511,9 +536,10 @@ namespace wiselib
 
 		uint8_t no_path_count_;
 
-		//timer variables
-		uint32_t current_interval_;
-		uint32_t sending_threshold_;
+		//DIO trickle timer
+		Trickle_t trickle_;
+		Rand_t rand_;
+		int dio_trickle_;
 
 		uint16_t step_of_rank_;
 		uint16_t rank_factor_;
@@ -550,19 +576,18 @@ namespace wiselib
 		RPLRoutingState state_;
 
 		uint8_t dio_int_min_;
-		uint8_t imin_; 
 		uint8_t imax_; 
 		
-		uint8_t dio_count_;
-
 		uint8_t more_dio_count_;
 
 		uint8_t dao_sequence_;
 		uint8_t path_sequence_;
 				
-		uint32_t max_interval_;
 		uint8_t dio_redund_const_;
 
+		uint8_t default_lifetime_;
+		uint16_t lifetime_unit_;
+
 		uint8_t dio_reference_number_;
 		uint8_t dis_reference_number_;
 		uint8_t dao_reference_number_;
@@ -576,9 +601,9 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+		typename Timer_P,
+		typename Clock_P>
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	RPLRouting()
 		: rpl_instance_id_ (1),
 		etx_ (true),
@@ -588,7 +613,6 @@ namespace wiselib
 		neighbors_found_ (false),
 		dao_received_ (false),
 		state_ (Unconnected),
-		dio_count_ (0),
 		more_dio_count_ (2),
 		dis_count_ (0),
 		bcast_neigh_count_ (0),
@@ -608,6 +632,8 @@ namespace wiselib
 		dio_int_min_ (DEFAULT_DIO_INTERVAL_MIN),
 		imax_ (DEFAULT_DIO_INTERVAL_DOUBLINGS),
 		dio_redund_const_ (DEFAULT_DIO_REDUNDANCY_CONSTANT),
+		default_lifetime_ (DEFAULT_DAO_LIFETIME),
+		lifetime_unit_ (DEFAULT_LIFETIME_UNIT),
 		min_hop_rank_increase_ (DEFAULT_MIN_HOP_RANK_INCREASE),
 		DAGMaxRankIncrease_ ( 0 ), //0 means disabled
 		preferred_parent_ ( Radio_IP::NULL_NODE_ID ),
@@ -621,9 +647,9 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+		typename Timer_P,
+		typename Clock_P>
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	~RPLRouting()
 	{
 		#ifdef ROUTING_RPL_DEBUG
@@ -636,10 +662,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	int
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	destruct( void )
 	{
 		packet_pool_mgr_->clean_packet_with_number( dis_reference_number_ );
@@ -647,7 +673,15 @@ namespace wiselib
 		packet_pool_mgr_->clean_packet_with_number( dao_reference_number_ );
 		packet_pool_mgr_->clean_packet_with_number( no_path_reference_number_ );
 		stop_dio_timer_ = true;
+		trickle_.stop( dio_trickle_ );
 		stop_dao_timer_ = true;
+		#ifdef RPL_ROOT_ROUTE_TABLE
+		if( root_routes_ready_ )
+		{
+			root_routes_ready_ = false;
+			radio_ip().routing_.unreg_route_lookup();
+		}
+		#endif
 		return disable_radio();
 		
 	}
@@ -656,10 +690,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	int
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	enable_radio( void )
 	{
 		#ifdef ROUTING_RPL_DEBUGS
@@ -725,10 +759,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	int
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	disable_radio( void )
 	{
 		
@@ -753,10 +787,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	set_dodag_root( bool root )
 	{
 		if ( root )
@@ -810,10 +844,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	uint8_t
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	start( void )
 	{
 		//NB: the set_payload function starts to fill the packet fields from the 40th byte (the ICMP header)
@@ -846,10 +880,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	start2( void* userdata )
 	{	
 		for (ETX_values_iterator it = etx_computation_.etx_values_.begin(); it != etx_computation_.etx_values_.end(); it++) 
@@ -884,9 +918,7 @@ namespace wiselib
 		{		
 			stop_dao_timer_ = true;
 			version_number_ = 1;
-			imin_ = 2 << (dio_int_min_ - 1);
-			//imax_ = DEFAULT_DIO_INTERVAL_DOUBLINGS;
-			max_interval_ = (2 << (imax_ - 1)) * imin_;
+			set_dio_trickle_parameters();
 			
 			dodag_id_ = my_global_address_;
 
@@ -909,17 +941,24 @@ namespace wiselib
 			
 			dio_message_->set_transport_length( dio_current_position ); 
 			
-			set_current_interval(0);
-			compute_sending_threshold();
+			trickle_.inconsistent( dio_trickle_ );
 
 			#ifdef ROUTING_RPL_DEBUG
 			debug().debug( "\nRPL Routing: Start as root/gateway\n" );
 			#endif
 
-			timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-					
-			timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
-						
+			trickle_.start( dio_trickle_ );
+
+			#ifdef RPL_ROOT_ROUTE_TABLE
+			//start() is called again by a global repair, the routes are kept until they expire
+			if( !root_routes_ready_ )
+			{
+				root_routes_ready_ = true;
+				downward_routes_.init( my_global_address_, mop_ >= 2 );
+				radio_ip().routing_.template reg_route_lookup<self_type, &self_type::root_route_lookup>( this );
+				timer().template set_timer<self_type, &self_type::route_wheel_timer_elapsed>( RPL_ROUTE_WHEEL_TICK, this, 0 );
+			}
+			#endif
 		}
 		else
 		{
@@ -944,10 +983,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	int
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	send_dis( node_id_t destination, uint16_t len, block_data_t *data )   
 	{
 		dis_message_->set_transport_next_header( Radio_IP::ICMPV6 );
@@ -968,10 +1007,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	int
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	send( node_id_t destination, uint16_t len, block_data_t *data )
 	{
 		//mainly used to forward DAO messages up the DODAG
@@ -992,10 +1031,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	dis_delay( void* userdata )
 	{
 		char str[43];
@@ -1044,47 +1083,24 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	timer_elapsed( void* userdata )
 	{
-		dio_count_ = 0;
-		if( !stop_dio_timer_ && state_ != Leaf )
-		{
-		
-			if ( 2 * current_interval_ < max_interval_ )
-				set_current_interval(2);
-			else
-				set_current_interval(1); 
-
-			compute_sending_threshold();
-				
-			timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-			
-			timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );	
-			
-			version_last_time_ = version_number_;
-		}
-		
-		//Enter if a 'new version DIO' has been received (this happens when the timer of the new version expires before the old one)
-		else if ( version_last_time_ != version_number_ && state_ != Leaf && state_ != Dodag_root )
+		if( stop_dio_timer_ || state_ == Leaf )
 		{
-			if ( 2 * current_interval_ < max_interval_ )
-				set_current_interval(2);
+			//Keep going if a 'new version DIO' has been received (this happens when the interval of the new version ends before the old one)
+			if ( version_last_time_ != version_number_ && state_ != Leaf && state_ != Dodag_root )
+				stop_dio_timer_ = false;
 			else
-				set_current_interval(1);
-		
-			compute_sending_threshold();
-				
-			timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-			
-			timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );	
-			
-			version_last_time_ = version_number_;
-			stop_dio_timer_ = false;
+			{
+				trickle_.stop( dio_trickle_ );
+				return;
+			}
 		}
+		version_last_time_ = version_number_;
 	}
 
 	// -----------------------------------------------------------------------
@@ -1093,10 +1109,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	more_dio_timer_elapsed( void* userdata )
 	{
 		if( more_dio_count_ > 0  )
@@ -1115,10 +1131,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	metric_timer_elapsed( void* userdata )
 	{
 		
@@ -1160,37 +1176,224 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	delayed_restart_timer_elapsed( void* userdata )
 	{
 		timer().template set_timer<self_type, &self_type::more_dio_timer_elapsed>( 300, this, 0 );
 								
 		//reset timer
-		set_current_interval(0);
-		compute_sending_threshold();
+		trickle_.inconsistent( dio_trickle_ );
 		if( state_ == Leaf )
 		{
 			dao_received_ = false;
 			state_ = Connected;
-			timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-			timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-			timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+			timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+			trickle_.start( dio_trickle_ );
+		}
+	}
+
+	#ifdef RPL_ROOT_ROUTE_TABLE
+	// -----------------------------------------------------------------------
+
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		typename Radio_P,
+		typename Debug_P,
+		typename Timer_P,
+		typename Clock_P>
+	void
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
+	route_wheel_timer_elapsed( void* userdata )
+	{
+		if( !root_routes_ready_ )
+			return;
+		downward_routes_.tick();
+		timer().template set_timer<self_type, &self_type::route_wheel_timer_elapsed>( RPL_ROUTE_WHEEL_TICK, this, 0 );
+	}
+
+	// -----------------------------------------------------------------------
+
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		typename Radio_P,
+		typename Debug_P,
+		typename Timer_P,
+		typename Clock_P>
+	void
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
+	read_dao_address( block_data_t *data, node_id_t& address )
+	{
+		uint8_t addr[16];
+		memcpy(addr, data, 16);
+
+		#ifdef SHAWN
+		uint8_t k = 0;
+		for( uint8_t i = 15; i>7; i--)
+		{
+			uint8_t temp;
+			temp = addr[i];
+			addr[i] = addr[k];
+			addr[k] = temp;
+			k++;
+		}
+		#endif
+
+		address.set_address(addr);
+	}
+
+	// -----------------------------------------------------------------------
+
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		typename Radio_P,
+		typename Debug_P,
+		typename Timer_P,
+		typename Clock_P>
+	void
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
+	root_dao_received( uint8_t packet_number, IPv6Packet_t* message, block_data_t *data, node_id_t sender )
+	{
+		//Target and Transit Information option
+		uint16_t length = message->transport_length();
+		if( length < 50 )
+		{
+			packet_pool_mgr_->clean_packet( message );
+			return;
+		}
+
+		node_id_t target;
+		read_dao_address( data + 28, target );
+
+		//Storing mode: the DAO sender is the next hop, Non-storing mode: the DAO parent of the target
+		//(a No-Path DAO doesn't carry it, the route is dropped whatever the parent is)
+		node_id_t via = sender;
+		if( mop_ == 1 )
+		{
+			if( length >= 66 )
+				read_dao_address( data + 50, via );
+			else if( data[49] != 0 )
+			{
+				packet_pool_mgr_->clean_packet( message );
+				return;
+			}
+		}
+
+		if( target == my_global_address_ )
+		{
+			packet_pool_mgr_->clean_packet( message );
+			return;
+		}
+
+		//The Lifetime Unit is in seconds, the table counts in ticks
+		uint32_t lifetime = DownwardRoutes_t::INFINITE_LIFETIME;
+		if( data[49] != 0xFF )
+		{
+			uint32_t seconds = (uint32_t)data[49] * lifetime_unit_;
+			lifetime = seconds / RPL_ROUTE_WHEEL_TICK * 1000 + seconds % RPL_ROUTE_WHEEL_TICK * 1000 / RPL_ROUTE_WHEEL_TICK;
+		}
+
+		int result = downward_routes_.update( target, via, data[48], lifetime );
+
+		if( result == DownwardRoutes_t::ERR_STALE )
+		{
+			packet_pool_mgr_->clean_packet( message );
+			return;
+		}
+
+		#ifdef ROUTING_RPL_DEBUG
+		char str[43];
+		char str2[43];
+		if( result == DownwardRoutes_t::ERR_NOMEM )
+			debug().debug( "\nRPL Routing: ROOT route table full, DAO for target %s rejected\n", target.get_address(str) );
+		else
+			debug().debug( "\nRPL Routing: ROOT received DAO with target: %s, via: %s, lifetime: %i\n", target.get_address(str), via.get_address(str2), data[49] );
+		#endif
+
+		if( result == SUCCESS && lifetime != 0 )
+		{
+			dao_received_ = true;
+			stop_dio_timer_ = false;
+			radio_ip().routing_.route_available( target );
+		}
+
+		if( data[5] != 128 )
+		{
+			packet_pool_mgr_->clean_packet( message );
+			return;
+		}
+
+		uint8_t setter_byte = DEST_ADVERT_OBJECT_ACK;
+		message->template set_payload<uint8_t>( &setter_byte, 1, 1 );
+		setter_byte = data[7];
+		message->template set_payload<uint8_t>( &setter_byte, 6, 1 );
+		setter_byte = 0;
+		message->template set_payload<uint8_t>( &setter_byte, 5, 1 );
+		//Status: 128 and above means rejected (RFC 6550 6.5)
+		setter_byte = ( result == SUCCESS ) ? 0 : 128;
+		message->template set_payload<uint8_t>( &setter_byte, 7, 1 );
+
+		message->set_transport_length( 8 );
+
+		message->set_source_address(my_global_address_);
+
+		send( target, packet_number, NULL );
+	}
+
+	// -----------------------------------------------------------------------
+
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		typename Radio_P,
+		typename Debug_P,
+		typename Timer_P,
+		typename Clock_P>
+	bool
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
+	root_route_available( node_id_t destination )
+	{
+		node_id_t next_hop;
+		if( !downward_routes_.next_hop( destination, next_hop ) )
+			return false;
+
+		if( !is_reachable( next_hop ) )
+		{
+			//In non-storing mode the entry of the first hop is the broken one, it expires on its own
+			if( mop_ >= 2 )
+				downward_routes_.remove( destination );
+			return false;
 		}
+		return true;
 	}
 
+	// -----------------------------------------------------------------------
+
+	template<typename OsModel_P,
+		typename Radio_IP_P,
+		typename Radio_P,
+		typename Debug_P,
+		typename Timer_P,
+		typename Clock_P>
+	bool
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
+	root_route_lookup( node_id_t destination, node_id_t& next_hop )
+	{
+		return downward_routes_.next_hop( destination, next_hop );
+	}
+	#endif
+
 	// -----------------------------------------------------------------------
 	
 	template<typename OsModel_P,
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	no_path_timer_elapsed( void* userdata )
 	{
 		radio_ip().send( old_preferred_parent_, no_path_reference_number_, NULL );
@@ -1209,10 +1412,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	transient_parent_timer_elapsed( void* userdata )
 	{
 		transient_preferred_parent_ = Radio_IP::NULL_NODE_ID;
@@ -1224,10 +1427,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	leaf_timer_elapsed( void* userdata )
 	{
 		if(state_ != Dodag_root && state_ != Router && !dao_received_ )
@@ -1253,10 +1456,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	dao_timer_elapsed( void* userdata )
 	{
 		//this timer must be directly proportional to the rank when aggregation is not supported (rank_*something +/- something_else??) 
@@ -1275,15 +1478,13 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	threshold_timer_elapsed( void* userdata )
 	{
-		
-		if ( dio_count_ < dio_redund_const_ )
-			radio_ip().send( Radio_IP::BROADCAST_ADDRESS, dio_reference_number_, NULL );
+		radio_ip().send( Radio_IP::BROADCAST_ADDRESS, dio_reference_number_, NULL );
 	}
 	// -----------------------------------------------------------------------
 	
@@ -1291,10 +1492,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	floating_timer_elapsed( void* userdata )
 	{
 		//Before creating a Floating DODAG there's the need to understand how long it takes for a DIO to reach all the network
@@ -1306,8 +1507,7 @@ namespace wiselib
 						
 			state_ = Floating_Dodag_root;
 			version_number_ = 1;
-			imin_ = 2 << (dio_int_min_ - 1);
-			max_interval_ = (2 << (imax_ - 1)) * imin_; 
+			set_dio_trickle_parameters();
 			
 			dodag_id_ = my_address_;   
 			preferred_parent_ = my_address_;
@@ -1323,16 +1523,13 @@ namespace wiselib
 			dio_message_->set_transport_length( dio_current_position ); 
 			
 			//initialize timers
-			set_current_interval(0);
-			compute_sending_threshold();
+			trickle_.inconsistent( dio_trickle_ );
 
 			#ifdef ROUTING_RPL_DEBUG
 			debug().debug( "\nRPL Routing: Start as floating root\n" );
 			#endif
 			
-			timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-					
-			timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+			trickle_.start( dio_trickle_ );
 		}
 	}
 	
@@ -1341,10 +1538,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	receive( node_id_t from, size_t packet_number, block_data_t *data )
 	{
 		char str[43];
@@ -1510,9 +1707,8 @@ namespace wiselib
 								dao_received_ = false;
 								state_ = Connected;
 			
-								timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-								timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-								timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+								timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+								trickle_.start( dio_trickle_ );
 									
 							}
 															
@@ -1612,7 +1808,7 @@ namespace wiselib
 					map.grounded = grounded;
 					//map.dtsn = data[9];		
 										
-					dio_count_ = dio_count_ + 1;
+					trickle_.consistent( dio_trickle_ );
 
 					if (parent_rank == rank_ )
 					{
@@ -1675,9 +1871,8 @@ namespace wiselib
 									dao_received_ = false;
 									state_ = Connected;
 			
-									timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-									timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-									timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+									timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+									trickle_.start( dio_trickle_ );
 									
 								}
 								
@@ -1733,9 +1928,8 @@ namespace wiselib
 									dao_received_ = false;
 									state_ = Connected;
 			
-									timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-									timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-									timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+									timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+									trickle_.start( dio_trickle_ );
 									
 								}
 								update_dio( best, current_best_path_cost );
@@ -1778,9 +1972,8 @@ namespace wiselib
 										state_ = Connected;
 			
 										
-										timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-										timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-										timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+										timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+										trickle_.start( dio_trickle_ );
 									
 									}
 									
@@ -1841,8 +2034,7 @@ namespace wiselib
 								
 								dio_message_->template set_payload<uint8_t>( &dtsn_, 9, 1 );
 
-								set_current_interval(0);
-								compute_sending_threshold();
+								trickle_.inconsistent( dio_trickle_ );
 
 							}
 							packet_pool_mgr_->clean_packet( message );
@@ -1903,8 +2095,7 @@ namespace wiselib
 							debug().debug( "\nRPL Routing: Leaf with Good Rank, Change state to Router\n" );
 							#endif							
 							state_ = Router;
-							timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-							timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+							trickle_.start( dio_trickle_ );
 						}
 						find_worst_parent();
 						
@@ -1941,16 +2132,14 @@ namespace wiselib
 				radio_ip().send( Radio_IP::BROADCAST_ADDRESS, dio_reference_number_, NULL );
 				timer().template set_timer<self_type, &self_type::more_dio_timer_elapsed>( 100, this, 0 );
 								
-				set_current_interval(0);
-				compute_sending_threshold();
+				trickle_.inconsistent( dio_trickle_ );
 				if( state_ == Leaf )
 				{
 					dao_received_ = false;
 					state_ = Connected;
 			
-					timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-					timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-					timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+					timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+					trickle_.start( dio_trickle_ );
 
 				}
 			}
@@ -1966,9 +2155,8 @@ namespace wiselib
 				dao_received_ = false;
 				state_ = Connected;
 			
-				timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-				timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-				timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+				timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+				trickle_.start( dio_trickle_ );
 
 			}
 
@@ -1976,11 +2164,25 @@ namespace wiselib
 		}
 		else if( typecode == DEST_ADVERT_OBJECT )
 		{
-			
+			#ifdef RPL_ROOT_ROUTE_TABLE
+			if( state_ == Dodag_root )
+			{
+				root_dao_received( packet_number, message, data, sender );
+				return;
+			}
+			#endif
+
 			//MOP = 1 is Non-storing mode
 			if (mop_ == 1)
 			{
-				//Not supported for the moment
+				//Only the root keeps downward routes, pass the DAO on
+				if( state_ != Dodag_root && state_ != Floating_Dodag_root )
+				{
+					message->remote_ll_address = Radio_P::NULL_NODE_ID;
+					message->target_interface = NUMBER_OF_INTERFACES;
+					send( preferred_parent_, packet_number, NULL );
+					return;
+				}
 			}
 			
 			//Storing mode
@@ -2077,14 +2279,14 @@ namespace wiselib
 						{		
 							if( state_ == Leaf)
 							{
-								timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-								timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+								trickle_.start( dio_trickle_ );
 							}			
 							state_ = Router;
 						}
 						stop_dio_timer_ = false;
 						Forwarding_table_value entry( sender, 0, seq_nr, 0 );
 						radio_ip().routing_.forwarding_table_.insert( ft_pair_t( target, entry ) );
+						radio_ip().routing_.route_available( target );
 												
 					}
 				}
@@ -2157,10 +2359,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	first_dio( node_id_t from, block_data_t *data, uint16_t length )
 	{
 		char str[43];
@@ -2243,19 +2445,16 @@ namespace wiselib
 
 		dio_message_->set_transport_length( length );
 		
-		set_current_interval(0);
-		compute_sending_threshold();
+		trickle_.inconsistent( dio_trickle_ );
 
 		
 		#ifdef ROUTING_RPL_DEBUG
 		debug().debug( "\n\n\nRPL Routing: Starting the timers\n\n" );
 		#endif
 		
-		timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>( current_interval_ + 2500, this, 0 );
+		timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>( trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
 
-		timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-
-		timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+		trickle_.start( dio_trickle_ );
 		
 		if( mop_ == 2 )
 		{
@@ -2265,7 +2464,7 @@ namespace wiselib
 			dao_sequence_ = dao_sequence_ + 1;
 			dao_length = prepare_dao();
 			dao_message_->set_transport_length( dao_length );
-			timer().template set_timer<self_type, &self_type::dao_timer_elapsed>( 300 + current_interval_, this, 0 );
+			timer().template set_timer<self_type, &self_type::dao_timer_elapsed>( 300 + trickle_.interval( dio_trickle_ ), this, 0 );
 		}
 	}
 	
@@ -2275,10 +2474,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	uint8_t
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	options_check( block_data_t *data, uint16_t length_checked, uint16_t length, node_id_t sender )
 	{
 		
@@ -2347,10 +2546,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	scan_configuration_option( block_data_t *data, uint16_t length_checked )
 	{
 		uint8_t option_type = data[ length_checked ];
@@ -2367,10 +2566,12 @@ namespace wiselib
 
 		min_hop_rank_increase_ = ( data[ length_checked + 8 ] << 8 ) | data[ length_checked + 9 ];
 
-		imin_ = 2 << (dio_int_min_ - 1);
-		max_interval_ = (2 << (imax_ - 1)) *imin_;
+		set_dio_trickle_parameters();
 		
 		ocp_ = ( data[ length_checked + 10 ] << 8 ) | data[ length_checked + 11 ];	
+
+		default_lifetime_ = data[ length_checked + 13 ];
+		lifetime_unit_ = ( data[ length_checked + 14 ] << 8 ) | data[ length_checked + 15 ];
 		
 	}
 
@@ -2380,10 +2581,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	scan_prefix_information( block_data_t *data, uint16_t length_checked )
 	{
 		uint8_t prefix_len = data[ length_checked + 2 ];
@@ -2421,15 +2622,15 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	uint8_t
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	set_firsts_dio_fields( node_id_t from, block_data_t *data )
 	{		
 		
 		parent_set_.clear(); 
-		dio_count_ = dio_count_ + 1; 
+		trickle_.consistent( dio_trickle_ );
 		rpl_instance_id_ = data[4];
 		version_number_ = data[5];
 	
@@ -2503,6 +2704,7 @@ namespace wiselib
 		//ADD default route
 		Forwarding_table_value entry( preferred_parent_, 0, 0, 0 );
 		radio_ip().routing_.forwarding_table_.insert( ft_pair_t( Radio_IP::NULL_NODE_ID, entry ) );
+		radio_ip().routing_.route_available( Radio_IP::NULL_NODE_ID );
 		
 		#ifdef ROUTING_RPL_DEBUG
 		char str[43];
@@ -2561,10 +2763,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	uint8_t
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	dio_packet_initialization( uint8_t position, bool grounded )
 	{
 		dio_message_->set_transport_next_header( Radio_IP::ICMPV6 );
@@ -2605,10 +2807,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	uint8_t
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	add_configuration_option( uint8_t position )
 	{
 		uint8_t	setter_byte = DODAG_CONFIGURATION;	
@@ -2634,11 +2836,8 @@ namespace wiselib
 		setter_byte = 0;
 		dio_message_->template set_payload<uint8_t>( &setter_byte, position + 12, 1 );
 
-		setter_byte = 5;
-		dio_message_->template set_payload<uint8_t>( &setter_byte, position + 13, 1 );
-
-		setter_byte_2 = 60000;
-		dio_message_->template set_payload<uint16_t>( &setter_byte_2, position + 14, 1 );
+		dio_message_->template set_payload<uint8_t>( &default_lifetime_, position + 13, 1 );
+		dio_message_->template set_payload<uint16_t>( &lifetime_unit_, position + 14, 1 );
 		
 		return position + 16;
 	}
@@ -2648,10 +2847,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	bool
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	is_reachable( node_id_t node )
 	{
 		ETX_values_iterator it = etx_computation_.etx_values_.find( node );
@@ -2667,10 +2866,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	find_worst_parent()
 	{
 		uint16_t current_worst_path_cost = 0;
@@ -2691,10 +2890,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	uint8_t
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	prepare_dao()
 	{
 		dao_message_->set_transport_next_header( Radio_IP::ICMPV6 );
@@ -2744,8 +2943,7 @@ namespace wiselib
 		dao_message_->template set_payload<uint8_t>( &setter_byte, 47, 1 );
 		dao_message_->template set_payload<uint8_t>( &path_sequence_, 48, 1 );
 		
-		setter_byte = 255;
-		dao_message_->template set_payload<uint8_t>( &setter_byte, 49, 1 );
+		dao_message_->template set_payload<uint8_t>( &default_lifetime_, 49, 1 );
 
 		if( mop_ == 1 )
 		{
@@ -2769,10 +2967,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	send_no_path_dao( node_id_t target )
 	{
 		
@@ -2843,10 +3041,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	uint8_t
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	add_prefix_information( uint8_t position )
 	{
 		uint8_t setter_byte = PREFIX_INFORMATION;
@@ -2875,10 +3073,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	update_dio( node_id_t parent, uint16_t path_cost )
 	{
 		ParentSet_iterator it = parent_set_.find( parent );
@@ -2918,8 +3116,7 @@ namespace wiselib
 			parent_set_.erase( it_er->node );
 		}
 
-		set_current_interval(0);
-		compute_sending_threshold();
+		trickle_.inconsistent( dio_trickle_ );
 		
 	}
 
@@ -2928,10 +3125,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	int
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	handle_TLV( uint8_t packet_number, uint8_t* data_pointer, bool only_usage )
 	{
 		IPv6Packet_t* message = packet_pool_mgr_->get_packet_pointer( packet_number ); 
@@ -3085,6 +3282,13 @@ namespace wiselib
 
 				else
 				{
+					#ifdef RPL_ROOT_ROUTE_TABLE
+					if( root_route_available( destination ) )
+					{
+						data_pointer[2] = 128;
+						return Radio_IP::CORRECT;
+					}
+					#endif
 					if( preferred_parent_ == my_address_ )
 					{
 						
@@ -3155,9 +3359,8 @@ namespace wiselib
 								dao_received_ = false;
 								state_ = Connected;
 			
-								timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-								timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-								timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+								timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+								trickle_.start( dio_trickle_ );
 									
 							}
 						
@@ -3260,6 +3463,13 @@ namespace wiselib
 					}
 					else
 					{
+						#ifdef RPL_ROOT_ROUTE_TABLE
+						if( root_route_available( destination ) )
+						{
+							data_pointer[2] = 128;
+							return Radio_IP::CORRECT;
+						}
+						#endif
 						if ( preferred_parent_ == my_address_ )
 						{
 							#ifdef ROUTING_RPL_DEBUG
@@ -3359,15 +3569,14 @@ namespace wiselib
 										#ifdef ROUTING_RPL_DEBUG
 										debug().debug( "\nRPLRouting: REACTIVATE TIMERS\n" );
 										#endif
-										timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-										timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-										timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+										timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+										trickle_.start( dio_trickle_ );
 									
 									}
 									
 									
 									#ifdef ROUTING_RPL_DEBUG
-									debug().debug( "\nRPLRouting: dio timer is %i, sending_threshold is %i\n", current_interval_, sending_threshold_ );
+									debug().debug( "\nRPLRouting: dio timer is %i, sending_threshold is %i\n", trickle_.interval( dio_trickle_ ), trickle_.transmission_point( dio_trickle_ ) );
 									#endif									
 
 
@@ -3539,6 +3748,18 @@ namespace wiselib
 					}
 					else
 					{
+						#ifdef RPL_ROOT_ROUTE_TABLE
+						if( root_route_available( destination ) )
+						{
+							if( rank_error == 1 )
+								data_pointer[2] = 192;
+							else
+								data_pointer[2] = 128;
+							data_pointer[4] = (uint8_t) (rank_ >> 8 );
+							data_pointer[5] = (uint8_t) (rank_ );
+							return Radio_IP::CORRECT;
+						}
+						#endif
 						if ( preferred_parent_ == my_address_ )
 						{
 							#ifdef ROUTING_RPL_DEBUG
@@ -3633,9 +3854,8 @@ namespace wiselib
 									dao_received_ = false;
 									state_ = Connected;
 			
-									timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  current_interval_ + 2500, this, 0 );
-									timer().template set_timer<self_type, &self_type::timer_elapsed>( current_interval_, this, 0 );
-									timer().template set_timer<self_type, &self_type::threshold_timer_elapsed>( sending_threshold_, this, 0 );
+									timer().template set_timer<self_type, &self_type::leaf_timer_elapsed>(  trickle_.interval( dio_trickle_ ) + 2500, this, 0 );
+									trickle_.start( dio_trickle_ );
 									
 								}
 							
@@ -3679,10 +3899,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	print_parent_set()
 	{
 		debug().debug( "\nRPL Routing: Parent Set with relative rank and path cost: \n" );
@@ -3701,10 +3921,10 @@ namespace wiselib
 		typename Radio_IP_P,
 		typename Radio_P,
 		typename Debug_P,
-		typename Timer_P/*,
-		typename Clock_P*/>
+		typename Timer_P,
+		typename Clock_P>
 	void
-	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P/*, Clock_P*/>::
+	RPLRouting<OsModel_P, Radio_IP_P, Radio_P, Debug_P, Timer_P, Clock_P>::
 	print_neighbor_set()
 	{
 		char str[43];
@@ -430,9 +430,11 @@ namespace wiselib {
         map<int,int>::iterator iterator;
         int tmp_id;
         int tmp_s;
-        for (iterator = neighbors.begin(); iterator != neighbors.end() ; iterator++) {
+        iterator = neighbors.begin();
+        while (iterator != neighbors.end()) {
             tmp_id = iterator->first;
             tmp_s = iterator->second;
+            bool dead = false;
             
             if(tmp_s <= 0){
 
@@ -467,13 +469,18 @@ namespace wiselib {
                                 radio().send(radio().BROADCAST_ADDRESS, UPDmsg.buffer_size(), (uint8_t*) & UPDmsg);
                                 cout<<"\tBroadcating an UPD message"<<endl;
                             }
-                            neighbors.erase(tmp_id);
+                            dead = true;
                     }
                 }
 
 
             }
 
+            // Erasing it right away would invalidate the iterator
+            if (dead)
+                neighbors.erase(iterator++);
+            else
+                iterator++;
         }
     }
 
@@ -1248,7 +1255,8 @@ namespace wiselib {
     void
     ToraRouting<OsModel_P, RoutingTable_P, Radio_P, Debug_P>::
     clearDest() {
-        for (destinationsIter = destinations.begin(); destinationsIter != destinations.end(); destinationsIter++) {
+        destinationsIter = destinations.begin();
+        while (destinationsIter != destinations.end()) {
             destinationsIter->second--;
             if (destinationsIter->second <= 0) {
                 NH.erase(destinationsIter->first);
@@ -1260,8 +1268,10 @@ namespace wiselib {
                     cout <<"\t Message to destination: " << destinationsIter->first << " could not be delivered... NO ROUTE found" << endl;
                     pend_msgs.erase(destinationsIter->first);
                 }
-                destinations.erase(destinationsIter->first);
+                destinations.erase(destinationsIter++);
+                continue;
             }
+            destinationsIter++;
         }
 
     }
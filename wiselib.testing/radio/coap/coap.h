@@ -37,6 +37,15 @@ static const size_t COAPRADIO_SENT_LIST_SIZE = 10;
 static const size_t COAPRADIO_RECEIVED_LIST_SIZE = 10;
 static const size_t COAPRADIO_RESOURCES_SIZE = 10;
 
+// Block-wise transfers: block size exponent, blocks are 2^(COAP_BLOCK_SZX + 4) bytes long (0..6, 2 = 64 byte)
+static const uint8_t COAP_BLOCK_SZX = 2;
+// number of block requests a client keeps in flight per transfer
+static const size_t COAP_BLOCK_WINDOW = 2;
+// number of concurrent block-wise downloads
+static const size_t COAP_BLOCK_TRANSFERS = 2;
+// a download is aborted if no block arrived for this long (ms)
+static const uint32_t COAP_BLOCK_TIMEOUT = 60000;
+
 enum CoapMsgIds
 {
 	CoapMsgId = 51 // Coap Message Type according to Wiselibs Reserved Message IDs
@@ -66,7 +75,7 @@ enum CoapType
 static const uint8_t COAP_LONG_OPTION = 15;
 static const uint8_t COAP_UNLIMITED_OPTIONS = 15;
 static const uint8_t COAP_MAX_DELTA_UNLIMITED = 14;
-static const uint8_t COAP_MAX_DELTA_DEFAULT = 16;
+static const uint8_t COAP_MAX_DELTA_DEFAULT = 15;
 static const uint8_t COAP_END_OF_OPTIONS_MARKER = 0xf0;
 
 enum CoapOptionNum
@@ -87,7 +96,9 @@ enum CoapOptionNum
 	COAP_OPT_IF_MATCH = 13,
 	COAP_OPT_FENCEPOST = 14,
 	COAP_OPT_URI_QUERY = 15,
+	COAP_OPT_BLOCK2 = 17, // as in draft-ietf-core-block-08
 	COAP_OPT_CONDITION = 18,
+	COAP_OPT_BLOCK1 = 19, // as in draft-ietf-core-block-08
 	COAP_OPT_HL_STATE = 23, // TODO Option number for High-Level States
 	COAP_OPT_IF_NONE_MATCH = 21
 };
@@ -101,6 +112,7 @@ static const uint8_t COAP_OPT_MAXLEN_TOKEN = 8;
 static const uint8_t COAP_OPT_MAXLEN_ACCEPT = 2;
 static const uint8_t COAP_OPT_MAXLEN_IF_MATCH = 8;
 static const uint8_t COAP_OPT_MAXLEN_IF_NONE_MATCH = 0;
+static const uint8_t COAP_OPT_MAXLEN_BLOCK = 3;
 static const uint16_t COAP_STRING_OPTS_MAXLEN = 270;
 static const uint16_t COAP_STRING_OPTS_MINLEN = 1;
 
@@ -110,6 +122,12 @@ static const uint16_t COAP_OPT_MAXLEN_HL_STATE = 257;
 static const uint8_t COAP_DEFAULT_MAX_AGE = 60;
 
 static const uint8_t COAP_MAX_OBSERVERS = 30;
+// minimum time between two notifications to the same observer (ms), updates in between are coalesced
+static const uint32_t COAP_OBSERVE_MIN_INTERVAL = 1000;
+// space for a serialized notification without its token
+static const size_t COAP_OBSERVE_NOTIFICATION_SIZE = 64;
+// space for a number printed as notification payload
+static const size_t COAP_OBSERVE_VALUE_SIZE = 48;
 
 // Finding the longest opaque option, out of the 4 opage options Etag, Token, IfMatch and HL-State
 static const uint16_t COAP_OPT_MAXLEN_OPAQUE = COAP_OPT_MAXLEN_HL_STATE;
@@ -135,6 +153,7 @@ enum CoapCode
 	COAP_CODE_VALID = 67, // 2.03
 	COAP_CODE_CHANGED = 68, // 2.04
 	COAP_CODE_CONTENT = 69, // 2.05
+	COAP_CODE_CONTINUE = 95, // 2.31
 	COAP_CODE_BAD_REQUEST = 128, // 4.00
 	COAP_CODE_UNAUTHORIZED = 129, // 4.01
 	COAP_CODE_BAD_OPTION = 	130, // 4.02
@@ -142,6 +161,7 @@ enum CoapCode
 	COAP_CODE_NOT_FOUND = 132, // 4.04
 	COAP_CODE_METHOD_NOT_ALLOWED = 133, // 4.05
 	COAP_CODE_NOT_ACCEPTABLE = 134, // 4.06
+	COAP_CODE_REQUEST_ENTITY_INCOMPLETE = 136, // 4.08
 	COAP_CODE_PRECONDITION_FAILED = 140, // 4.12
 	COAP_CODE_REQUEST_ENTITY_TOO_LARGE = 141, // 4.13
 	COAP_CODE_UNSUPPORTED_MEDIA_TYPE = 143, // 4.15
@@ -200,9 +220,9 @@ static const uint8_t COAP_OPTION_FORMAT[COAP_OPTION_ARRAY_SIZE] =
 	COAP_FORMAT_NONE,			// 14: COAP_OPT_FENCEPOST
 	COAP_FORMAT_STRING,			// 15: COAP_OPT_URI_QUERY
 	COAP_FORMAT_UNKNOWN,		// 16: not in use
-	COAP_FORMAT_UNKNOWN,		// 17: not in use
+	COAP_FORMAT_UINT,			// 17: COAP_OPT_BLOCK2
 	COAP_FORMAT_OPAQUE	,		// 18: COAP_OPT_CONDITION
-	COAP_FORMAT_UNKNOWN,		// 19: not in use
+	COAP_FORMAT_UINT,			// 19: COAP_OPT_BLOCK1
 	COAP_FORMAT_UNKNOWN,		// 20: not in use
 	COAP_FORMAT_NONE,			// 21: COAP_OPT_IF_NONE_MATCH
 	COAP_FORMAT_UNKNOWN,		// 22: not in use
@@ -228,9 +248,9 @@ static const bool COAP_OPT_CAN_OCCUR_MULTIPLE[COAP_OPTION_ARRAY_SIZE] =
 	false,			// 14: COAP_OPT_FENCEPOST
 	true,			// 15: COAP_OPT_URI_QUERY
 	false,			// 16: not in use
-	false,			// 17: not in use
+	false,			// 17: COAP_OPT_BLOCK2
 	true,			// 18: COAP_OPT_CONDITION
-	false,			// 19: not in use
+	false,			// 19: COAP_OPT_BLOCK1
 	false,			// 20: not in use
 	false,			// 21: COAP_OPT_IF_NONE_MATCH
 	false,			// 22: not in use
@@ -334,6 +354,86 @@ namespace wiselib
 		size_t length_;
 		uint8_t value_[COAP_OPT_MAXLEN_OPAQUE];
 	};
+
+	/**
+	 * Value of a Block1 or Block2 option: block number, more flag and size exponent
+	 */
+	class CoapBlockOption
+	{
+	public:
+		CoapBlockOption()
+		{
+			num_ = 0;
+			more_ = false;
+			szx_ = COAP_BLOCK_SZX;
+		}
+
+		CoapBlockOption( uint32_t num, bool more, uint8_t szx )
+		{
+			num_ = num;
+			more_ = more;
+			szx_ = szx;
+		}
+
+		/**
+		 * @param value uint value of the option as stored in the packet
+		 */
+		explicit CoapBlockOption( uint32_t value )
+		{
+			num_ = value >> 4;
+			more_ = ( value & 0x08 ) != 0;
+			szx_ = value & 0x07;
+		}
+
+		uint32_t value() const
+		{
+			return ( num_ << 4 ) | ( more_ ? 0x08 : 0 ) | ( szx_ & 0x07 );
+		}
+
+		uint32_t num() const
+		{
+			return num_;
+		}
+
+		bool more() const
+		{
+			return more_;
+		}
+
+		uint8_t szx() const
+		{
+			return szx_;
+		}
+
+		size_t size() const
+		{
+			return block_size( szx_ );
+		}
+
+		size_t offset() const
+		{
+			return (size_t) num_ * size();
+		}
+
+		static size_t block_size( uint8_t szx )
+		{
+			return (size_t) 1 << ( szx + 4 );
+		}
+
+		/**
+		 * Block options are at most COAP_OPT_MAXLEN_BLOCK bytes long
+		 * @param value uint value of the option as stored in the packet
+		 */
+		static bool is_valid( uint32_t value )
+		{
+			return ( value >> ( 8 * COAP_OPT_MAXLEN_BLOCK ) ) == 0;
+		}
+
+	private:
+		uint32_t num_;
+		bool more_;
+		uint8_t szx_;
+	};
 }
 
 #endif // COAP_H
@@ -139,8 +139,9 @@ bool coap_satisfies_condition(
 			break;
 
 		case ConditionalObserveType::MINIMUM_RESPONSE_TIME:
-			// FIXME what if time wraps?
-			satisfied = ( observer.last_value != new_value ) && ( condition_value <= ( time - observer.timestamp) );
+			// the minimum time is the observer's rate limit in ObservableService,
+			// changes within it are delayed instead of dropped
+			satisfied = observer.last_value != new_value;
 			break;
 
 		case ConditionalObserveType::MAXIMUM_RESPONSE_TIME:
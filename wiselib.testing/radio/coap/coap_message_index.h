@@ -0,0 +1,202 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+#ifndef COAP_MESSAGE_INDEX_H
+#define COAP_MESSAGE_INDEX_H
+
+#include "coap.h"
+#include "algorithms/hash/fnv.h"
+
+namespace wiselib {
+
+/**
+ * \brief Hash index over the messages stored in a list_static queue of CoapServiceStatic.
+ * Messages are found by (correspondent, message ID) and by (correspondent, token)
+ * without walking the queue and without parsing the token option of every stored packet.
+ * The index only keeps pointers, the messages stay in the queue. Every message has to be
+ * inserted right after it was queued and erased before it is dropped from the queue.
+ * Lookups return the most recently inserted match, just like a walk from the front of the queue.
+ *
+ * \tparam Message_P ReceivedMessage or SentMessage, needs message() and correspondent()
+ * \tparam node_id_t type of the correspondent
+ * \tparam size_ size of the indexed queue, also the number of hash buckets
+ */
+template<typename OsModel_P,
+	typename Message_P,
+	typename node_id_t,
+	typename OsModel_P::size_t size_>
+class CoapMessageIndex
+{
+public:
+	typedef Message_P message_t;
+	typedef int16_t slot_t;
+
+	static const slot_t NO_SLOT = -1;
+
+	CoapMessageIndex()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		for( slot_t i = 0; i < (slot_t) size_; ++i )
+		{
+			id_bucket_[i] = NO_SLOT;
+			token_bucket_[i] = NO_SLOT;
+			messages_[i] = NULL;
+			id_next_[i] = i + 1;
+		}
+		id_next_[size_ - 1] = NO_SLOT;
+		free_ = 0;
+	}
+
+	/**
+	 * Adds a queued message to the index
+	 * @param message pointer to the message in the queue
+	 */
+	void insert( message_t *message )
+	{
+		if( free_ == NO_SLOT )
+			return;
+
+		slot_t slot = free_;
+		free_ = id_next_[slot];
+
+		messages_[slot] = message;
+		ids_[slot] = message->message().msg_id();
+		OpaqueData token;
+		message->message().token( token );
+		token_hashes_[slot] = token_hash( token );
+
+		slot_t &id_head = id_bucket_[ids_[slot] % size_];
+		id_next_[slot] = id_head;
+		id_head = slot;
+
+		slot_t &token_head = token_bucket_[token_hashes_[slot] % size_];
+		token_next_[slot] = token_head;
+		token_head = slot;
+	}
+
+	/**
+	 * Removes a message from the index, has to be called before the message is dropped from the queue
+	 * @param message pointer to the message in the queue
+	 */
+	void erase( message_t *message )
+	{
+		slot_t slot = id_bucket_[message->message().msg_id() % size_];
+		while( slot != NO_SLOT && messages_[slot] != message )
+			slot = id_next_[slot];
+
+		// the message ID was changed after queueing
+		if( slot == NO_SLOT )
+		{
+			for( slot_t i = 0; i < (slot_t) size_; ++i )
+			{
+				if( messages_[i] == message )
+				{
+					slot = i;
+					break;
+				}
+			}
+			if( slot == NO_SLOT )
+				return;
+		}
+
+		unlink( id_bucket_[ids_[slot] % size_], id_next_, slot );
+		unlink( token_bucket_[token_hashes_[slot] % size_], token_next_, slot );
+
+		messages_[slot] = NULL;
+		id_next_[slot] = free_;
+		free_ = slot;
+	}
+
+	/**
+	 * Finds a message by message ID
+	 * @param correspondent sender or receiver of the message
+	 * @param id message ID
+	 * @return pointer to the message, NULL if it isn't indexed
+	 */
+	message_t* find_by_id( node_id_t correspondent, coap_msg_id_t id )
+	{
+		for( slot_t i = id_bucket_[id % size_]; i != NO_SLOT; i = id_next_[i] )
+		{
+			if( messages_[i]->message().msg_id() == id && messages_[i]->correspondent() == correspondent )
+				return messages_[i];
+		}
+		return NULL;
+	}
+
+	/**
+	 * Finds a message by token
+	 * @param correspondent sender or receiver of the message
+	 * @param token token of the message
+	 * @return pointer to the message, NULL if it isn't indexed
+	 */
+	message_t* find_by_token( node_id_t correspondent, const OpaqueData &token )
+	{
+		uint32_t hash = token_hash( token );
+		OpaqueData current_token;
+		for( slot_t i = token_bucket_[hash % size_]; i != NO_SLOT; i = token_next_[i] )
+		{
+			if( token_hashes_[i] == hash && messages_[i]->correspondent() == correspondent )
+			{
+				messages_[i]->message().token( current_token );
+				if( current_token == token )
+					return messages_[i];
+			}
+		}
+		return NULL;
+	}
+
+	/**
+	 * FNV-1a hash of a token
+	 */
+	static uint32_t token_hash( const OpaqueData &token )
+	{
+		return Fnv1a<OsModel_P, uint32_t>::hash( token.value(), token.length() );
+	}
+
+private:
+	void unlink( slot_t &head, slot_t *next, slot_t slot )
+	{
+		for( slot_t *link = &head; *link != NO_SLOT; link = &next[*link] )
+		{
+			if( *link == slot )
+			{
+				*link = next[slot];
+				return;
+			}
+		}
+	}
+
+	message_t *messages_[size_];
+	coap_msg_id_t ids_[size_];
+	uint32_t token_hashes_[size_];
+	slot_t id_bucket_[size_];
+	slot_t id_next_[size_];
+	slot_t token_bucket_[size_];
+	slot_t token_next_[size_];
+	// free slots are chained through id_next_
+	slot_t free_;
+};
+
+}
+
+#endif // COAP_MESSAGE_INDEX_H
@@ -0,0 +1,316 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+#ifndef COAP_PACKET_BUILDER_H
+#define COAP_PACKET_BUILDER_H
+
+#include "coap.h"
+#include "coap_packet_view.h"
+
+namespace wiselib
+{
+	/**
+	 * \brief Serializes a CoAP message directly into a caller supplied buffer.
+	 * Unlike CoapPacketStatic there is no intermediate storage: options are
+	 * written to the buffer as they are added, so they have to be added in
+	 * ascending order of their option numbers. The payload is copied once,
+	 * in finish(). Fenceposts are inserted as needed, so the result is valid
+	 * whether or not the message ends up with more than 14 options.
+	 *
+	 * Usage:
+	 * \code
+	 * block_data_t buf[64];
+	 * builder_t builder( buf, sizeof( buf ) );
+	 * builder.init( COAP_MSG_TYPE_NON, COAP_CODE_CONTENT, msg_id );
+	 * builder.add_option( COAP_OPT_CONTENT_TYPE, COAP_CONTENT_TYPE_TEXT_PLAIN );
+	 * builder.add_option( COAP_OPT_TOKEN, token );
+	 * builder.set_data( payload, payload_length );
+	 * size_t length = builder.finish(); // 0 if anything went wrong
+	 * \endcode
+	 */
+	template<typename OsModel_P,
+	typename Radio_P>
+	class CoapPacketBuilder
+	{
+	public:
+		typedef OsModel_P OsModel;
+		typedef Radio_P Radio;
+		typedef typename Radio::block_data_t block_data_t;
+		typedef CoapPacketView<OsModel_P, Radio_P> view_t;
+
+		typedef CoapPacketBuilder<OsModel_P, Radio_P> self_type;
+
+		enum error_code
+		{
+			SUCCESS = OsModel::SUCCESS,
+			ERR_NOMEM = OsModel::ERR_NOMEM,
+			ERR_UNSPEC = OsModel::ERR_UNSPEC,
+			ERR_WRONG_TYPE = view_t::ERR_WRONG_TYPE,
+			ERR_UNKNOWN_OPT = view_t::ERR_UNKNOWN_OPT,
+			ERR_OPT_TOO_LONG = view_t::ERR_OPT_TOO_LONG,
+			ERR_MULTIPLE_OCCURENCES_OF_OPTION = view_t::ERR_MULTIPLE_OCCURENCES_OF_OPTION,
+			ERR_EMPTY_STRING_OPTION = view_t::ERR_EMPTY_STRING_OPTION,
+			// option numbers have to be ascending
+			ERR_OPTION_ORDER = view_t::ERR_WRONG_COAP_VERSION + 1
+		};
+
+		/**
+		 * @param buffer where the message is serialized to
+		 * @param capacity size of the buffer
+		 */
+		CoapPacketBuilder( block_data_t *buffer, size_t capacity )
+		{
+			buffer_ = buffer;
+			capacity_ = capacity;
+			init( COAP_MSG_TYPE_NON, COAP_CODE_EMPTY, 0 );
+		}
+
+		/**
+		 * Starts a new message, everything written before is discarded
+		 */
+		void init( CoapType type, CoapCode code, coap_msg_id_t msg_id )
+		{
+			type_ = type;
+			code_ = code;
+			msg_id_ = msg_id;
+			position_ = COAP_START_OF_OPTIONS;
+			option_count_ = 0;
+			previous_ = 0;
+			payload_ = NULL;
+			data_length_ = 0;
+			status_ = ( capacity_ < COAP_START_OF_OPTIONS ) ? ERR_NOMEM : SUCCESS;
+		}
+
+		/**
+		 * Appends an option.
+		 * @return SUCCESS<br>
+		 *         ERR_UNKNOWN_OPT when an unknown option number is passed<br>
+		 *         ERR_OPTION_ORDER when the option number is smaller than the one of the previous option<br>
+		 *         ERR_MULTIPLE_OCCURENCES_OF_OPTION if the option was added before and must not occur multiple times<br>
+		 *         ERR_OPT_TOO_LONG if the value is longer than COAP_STRING_OPTS_MAXLEN<br>
+		 *         ERR_NOMEM when the buffer is too small<br>
+		 *         After an error the builder stays in the error state and finish() fails.
+		 */
+		int add_option( CoapOptionNum option_number, const block_data_t *value, size_t length );
+
+		/**
+		 * Appends a uint option in its shortest encoding
+		 */
+		int add_option( CoapOptionNum option_number, uint32_t value )
+		{
+			if( option_number > COAP_LARGEST_OPTION_NUMBER )
+				return fail( ERR_UNKNOWN_OPT );
+			if( COAP_OPTION_FORMAT[option_number] != COAP_FORMAT_UINT )
+				return fail( ERR_WRONG_TYPE );
+			block_data_t serial[4];
+			size_t length = 0;
+			for( int shift = 24; shift >= 0; shift -= 8 )
+			{
+				block_data_t byte = (block_data_t) ( value >> shift );
+				if( byte != 0 || length > 0 )
+					serial[length++] = byte;
+			}
+			return add_option( option_number, serial, length );
+		}
+
+		int add_option( CoapOptionNum option_number, const OpaqueData &value )
+		{
+			return add_option( option_number, value.value(), value.length() );
+		}
+
+		/**
+		 * Appends one option per segment of a delimited string, e.g. "sensors/temp"
+		 * with '/' for COAP_OPT_URI_PATH or "a=1&b=2" with '&' for COAP_OPT_URI_QUERY.
+		 * A trailing delimiter is ignored, empty segments are not allowed.
+		 */
+		int add_segments( CoapOptionNum option_number, const char *cstr, char delimiter );
+
+		/**
+		 * Sets the payload. The data is not copied before finish(), so it has to stay valid until then.
+		 */
+		void set_data( const block_data_t *data, size_t length )
+		{
+			payload_ = data;
+			data_length_ = length;
+		}
+
+		/**
+		 * Writes the header and the payload, call it once per message
+		 * @return length of the serialized message, 0 if the message doesn't fit into the buffer or an option was rejected
+		 */
+		size_t finish();
+
+		/**
+		 * First error that occurred since init(), SUCCESS if there was none
+		 */
+		int status() const
+		{
+			return status_;
+		}
+
+		/**
+		 * Bytes written so far, not counting the payload
+		 */
+		size_t length() const
+		{
+			return position_;
+		}
+
+	private:
+		int fail( int error )
+		{
+			if( status_ == SUCCESS )
+				status_ = error;
+			return error;
+		}
+
+		int put_option_header( uint8_t delta, size_t length );
+
+		block_data_t *buffer_;
+		size_t capacity_;
+		size_t position_;
+		const block_data_t *payload_;
+		size_t data_length_;
+		int status_;
+		coap_msg_id_t msg_id_;
+		uint8_t option_count_;
+		uint8_t previous_;
+		uint8_t type_;
+		uint8_t code_;
+	};
+
+	template<typename OsModel_P,
+	typename Radio_P>
+	int CoapPacketBuilder<OsModel_P, Radio_P>::add_option( CoapOptionNum option_number, const block_data_t *value, size_t length )
+	{
+		if( status_ != SUCCESS )
+			return status_;
+		if( option_number > COAP_LARGEST_OPTION_NUMBER || option_number == COAP_OPT_FENCEPOST )
+			return fail( ERR_UNKNOWN_OPT );
+		if( option_number < previous_ )
+			return fail( ERR_OPTION_ORDER );
+		if( option_number == previous_ && option_count_ > 0 && !COAP_OPT_CAN_OCCUR_MULTIPLE[option_number] )
+			return fail( ERR_MULTIPLE_OCCURENCES_OF_OPTION );
+		if( length > COAP_STRING_OPTS_MAXLEN )
+			return fail( ERR_OPT_TOO_LONG );
+
+		// deltas of 15 are avoided altogether, a delta of 15 with an empty value
+		// would look like the end of options marker once there are 15 options
+		while( option_number - previous_ > COAP_MAX_DELTA_UNLIMITED )
+		{
+			uint8_t fencepost = COAP_OPT_FENCEPOST - ( previous_ % COAP_OPT_FENCEPOST );
+			if( put_option_header( fencepost, 0 ) != SUCCESS )
+				return status_;
+			previous_ += fencepost;
+		}
+
+		if( put_option_header( option_number - previous_, length ) != SUCCESS )
+			return status_;
+		if( position_ + length > capacity_ )
+			return fail( ERR_NOMEM );
+		memcpy( buffer_ + position_, value, length );
+		position_ += length;
+		previous_ = option_number;
+		return SUCCESS;
+	}
+
+	template<typename OsModel_P,
+	typename Radio_P>
+	int CoapPacketBuilder<OsModel_P, Radio_P>::put_option_header( uint8_t delta, size_t length )
+	{
+		size_t header_length = ( length >= COAP_LONG_OPTION ) ? 2 : 1;
+		if( position_ + header_length > capacity_ )
+			return fail( ERR_NOMEM );
+		if( length >= COAP_LONG_OPTION )
+		{
+			buffer_[position_++] = ( delta << 4 ) | COAP_LONG_OPTION;
+			buffer_[position_++] = (block_data_t) ( length - COAP_LONG_OPTION );
+		}
+		else
+		{
+			buffer_[position_++] = ( delta << 4 ) | (block_data_t) length;
+		}
+		++option_count_;
+		return SUCCESS;
+	}
+
+	template<typename OsModel_P,
+	typename Radio_P>
+	int CoapPacketBuilder<OsModel_P, Radio_P>::add_segments( CoapOptionNum option_number, const char *cstr, char delimiter )
+	{
+		if( status_ != SUCCESS )
+			return status_;
+		size_t segment_start = 0;
+		for( size_t position = 0; ; ++position )
+		{
+			if( cstr[position] == delimiter || cstr[position] == '\0' )
+			{
+				// a trailing delimiter (or an empty string) ends the list
+				if( cstr[position] == '\0' && position == segment_start && position > 0 )
+					return SUCCESS;
+				if( position == segment_start )
+					return fail( ERR_EMPTY_STRING_OPTION );
+				int status = add_option( option_number, (const block_data_t*) cstr + segment_start, position - segment_start );
+				if( status != SUCCESS )
+					return status;
+				if( cstr[position] == '\0' )
+					return SUCCESS;
+				segment_start = position + 1;
+			}
+		}
+	}
+
+	template<typename OsModel_P,
+	typename Radio_P>
+	size_t CoapPacketBuilder<OsModel_P, Radio_P>::finish()
+	{
+		if( status_ != SUCCESS )
+			return 0;
+
+		if( option_count_ >= COAP_UNLIMITED_OPTIONS )
+		{
+			if( position_ + 1 > capacity_ )
+			{
+				fail( ERR_NOMEM );
+				return 0;
+			}
+			buffer_[position_++] = COAP_END_OF_OPTIONS_MARKER;
+			buffer_[0] = ( COAP_VERSION << 6 ) | ( ( type_ & 0x03 ) << 4 ) | COAP_UNLIMITED_OPTIONS;
+		}
+		else
+		{
+			buffer_[0] = ( COAP_VERSION << 6 ) | ( ( type_ & 0x03 ) << 4 ) | option_count_;
+		}
+		buffer_[1] = code_;
+		buffer_[2] = ( msg_id_ & 0xff00 ) >> 8;
+		buffer_[3] = ( msg_id_ & 0x00ff );
+
+		if( position_ + data_length_ > capacity_ )
+		{
+			fail( ERR_NOMEM );
+			return 0;
+		}
+		if( data_length_ > 0 )
+			memcpy( buffer_ + position_, payload_, data_length_ );
+
+		return position_ + data_length_;
+	}
+}
+
+#endif // COAP_PACKET_BUILDER_H
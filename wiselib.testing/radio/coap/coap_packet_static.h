@@ -21,6 +21,7 @@
 #define COAP_PACKET_STATIC_H
 
 #include "coap.h"
+#include "coap_packet_view.h"
 
 static const size_t SINGLE_OPTION_NO_HEADER = 0;
 
@@ -42,28 +43,30 @@ namespace wiselib
 		typedef CoapPacketStatic<OsModel_P, Radio_P, String_T, storage_size_> self_type;
 		typedef self_type* self_pointer_t;
 		typedef self_type coap_packet_t;
+		typedef CoapPacketView<OsModel_P, Radio_P> view_t;
 
+		// parsing is done by view_t, so both share the error codes
 		enum error_code
 		{
 			// inherited from concepts::BasicReturnValues_concept
-			SUCCESS = OsModel::SUCCESS,
-			ERR_NOMEM = OsModel::ERR_NOMEM,
-			ERR_UNSPEC = OsModel::ERR_UNSPEC,
-			ERR_NOTIMPL = OsModel::ERR_NOTIMPL,
+			SUCCESS = view_t::SUCCESS,
+			ERR_NOMEM = view_t::ERR_NOMEM,
+			ERR_UNSPEC = view_t::ERR_UNSPEC,
+			ERR_NOTIMPL = view_t::ERR_NOTIMPL,
 			// coap_packet_t errors
-			ERR_WRONG_TYPE,
-			ERR_UNKNOWN_OPT,
-			ERR_OPT_NOT_SET,
-			ERR_OPT_TOO_LONG,
-			ERR_METHOD_NOT_APPLICABLE,
-			ERR_MULTIPLE_OCCURENCES_OF_OPTION,
+			ERR_WRONG_TYPE = view_t::ERR_WRONG_TYPE,
+			ERR_UNKNOWN_OPT = view_t::ERR_UNKNOWN_OPT,
+			ERR_OPT_NOT_SET = view_t::ERR_OPT_NOT_SET,
+			ERR_OPT_TOO_LONG = view_t::ERR_OPT_TOO_LONG,
+			ERR_METHOD_NOT_APPLICABLE = view_t::ERR_METHOD_NOT_APPLICABLE,
+			ERR_MULTIPLE_OCCURENCES_OF_OPTION = view_t::ERR_MULTIPLE_OCCURENCES_OF_OPTION,
 			// packet parsing errors
-			ERR_OPTIONS_EXCEED_PACKET_LENGTH,
-			ERR_UNKNOWN_CRITICAL_OPTION,
-			ERR_MULTIPLE_OCCURENCES_OF_CRITICAL_OPTION,
-			ERR_EMPTY_STRING_OPTION,
-			ERR_NOT_COAP,
-			ERR_WRONG_COAP_VERSION
+			ERR_OPTIONS_EXCEED_PACKET_LENGTH = view_t::ERR_OPTIONS_EXCEED_PACKET_LENGTH,
+			ERR_UNKNOWN_CRITICAL_OPTION = view_t::ERR_UNKNOWN_CRITICAL_OPTION,
+			ERR_MULTIPLE_OCCURENCES_OF_CRITICAL_OPTION = view_t::ERR_MULTIPLE_OCCURENCES_OF_CRITICAL_OPTION,
+			ERR_EMPTY_STRING_OPTION = view_t::ERR_EMPTY_STRING_OPTION,
+			ERR_NOT_COAP = view_t::ERR_NOT_COAP,
+			ERR_WRONG_COAP_VERSION = view_t::ERR_WRONG_COAP_VERSION
 		};
 
 		///@name Construction / Destruction
@@ -93,6 +96,16 @@ namespace wiselib
 		 */
 		int parse_message( block_data_t *datastream, size_t length );
 
+		/**
+		 * Makes an owned copy of a message that was parsed in place, e.g. because
+		 * it has to be kept after the radio buffer it was parsed from is gone.
+		 * Only the used part of the message is copied.
+		 * @param view the parsed message
+		 * @return the view's parsing status, or CoapPacketStatic::ERR_NOMEM if the message is too large to be stored.
+		 *         On ERR_NOMEM the header fields are copied nevertheless.
+		 */
+		int parse_message( const view_t &view );
+
 		/**
 		 * Returns the CoAP version number of the packet
 		 * @return CoAP version number
@@ -425,7 +438,6 @@ namespace wiselib
 		void remove_end_of_opts_marker();
 		bool is_end_of_opts_marker( block_data_t *option_header);
 		void scan_opts( block_data_t *start, uint8_t prev );
-		int initial_scan_opts( size_t num_of_opts, size_t message_length );
 		uint8_t next_fencepost_delta(uint8_t previous_opt_number) const;
 		bool is_fencepost( uint8_t optnum) const;
 		bool is_critical( uint8_t option_number ) const;
@@ -445,13 +457,19 @@ namespace wiselib
 	{
 		if( &rhs != this )
 		{
-			memcpy( storage_, rhs.storage_, storage_size_ );
+			// only the options and the payload are copied, not the whole storage
+			memcpy( storage_, rhs.storage_, (size_t) ( rhs.end_of_options_ - rhs.storage_ ) );
+			memcpy( storage_ + ( rhs.payload_ - rhs.storage_ ), rhs.payload_, rhs.data_length_ );
 			for( size_t i = 0; i < COAP_OPTION_ARRAY_SIZE; ++i)
 			{
 				if(rhs.options_[i] != NULL )
 				{
 					options_[i] = storage_ + ( rhs.options_[i] - rhs.storage_ );
 				}
+				else
+				{
+					options_[i] = NULL;
+				}
 			}
 			payload_ = storage_ + ( rhs.payload_ - rhs.storage_ );
 			end_of_options_ = storage_ + ( rhs.end_of_options_ - rhs.storage_ );
@@ -524,35 +542,60 @@ namespace wiselib
 	typename String_T,
 	size_t storage_size_>
 	int CoapPacketStatic<OsModel_P, Radio_P, String_T, storage_size_>::parse_message( block_data_t *datastream, size_t length )
+	{
+		view_t view;
+		view.parse( datastream, length );
+		return parse_message( view );
+	}
+
+	template<typename OsModel_P,
+	typename Radio_P,
+	typename String_T,
+	size_t storage_size_>
+	int CoapPacketStatic<OsModel_P, Radio_P, String_T, storage_size_>::parse_message( const view_t &view )
 	{
 		// clear everything
 		init();
 
-		// can this possibly be a coap packet?
-		if( length >= COAP_START_OF_OPTIONS )
-		{
-			if( ( length - COAP_START_OF_OPTIONS ) > storage_size_ )
-				return ERR_NOMEM;
-			uint8_t coap_first_byte = read<OsModel , block_data_t , uint8_t >( datastream );
-			version_ = coap_first_byte >> 6 ;
-			if( version_ != COAP_VERSION )
-			{
-				error_code_ = COAP_CODE_NOT_IMPLEMENTED;
-				error_option_ = COAP_OPT_NOOPT;
-				return ERR_WRONG_COAP_VERSION;
-			}
-			type_ = ( coap_first_byte & 0x30 ) >> 4 ;
-			size_t option_count = coap_first_byte & 0x0f;
-			code_ = read<OsModel , block_data_t , uint8_t >( datastream +1 );
-			msg_id_ = read<OsModel , block_data_t , coap_msg_id_t >( datastream + 2 );
+		if( view.status() == ERR_NOT_COAP )
+			return ERR_NOT_COAP;
+
+		version_ = view.version();
+		type_ = view.type();
+		code_ = view.code();
+		msg_id_ = view.msg_id();
+		CoapCode error_code;
+		CoapOptionNum error_option;
+		view.get_error_context( error_code, error_option );
+		error_code_ = error_code;
+		error_option_ = error_option;
 
-			memcpy( storage_, datastream + COAP_START_OF_OPTIONS, length - COAP_START_OF_OPTIONS );
+		if( view.status() == ERR_WRONG_COAP_VERSION )
+			return ERR_WRONG_COAP_VERSION;
 
-			int status = initial_scan_opts( option_count, length - COAP_START_OF_OPTIONS );
-			return status;
+		size_t options_length = (size_t) ( view.options_end() - view.options_begin() );
+		if( options_length + view.data_length() > storage_size_ )
+			return ERR_NOMEM;
+
+		memcpy( storage_, view.options_begin(), options_length );
+		end_of_options_ = storage_ + options_length;
+		for( size_t i = 0; i < COAP_OPTION_ARRAY_SIZE; ++i )
+		{
+			const block_data_t *option = view.option( (CoapOptionNum) i );
+			if( option != NULL )
+				options_[i] = storage_ + ( option - view.options_begin() );
 		}
-		// can't make any sense of it
-		return ERR_NOT_COAP;
+		option_count_ = view.option_count();
+
+		// Rest is data
+		if( view.data_length() > 0 )
+		{
+			data_length_ = view.data_length();
+			payload_ = storage_ + storage_size_ - data_length_;
+			memcpy( payload_, view.data(), data_length_ );
+		}
+
+		return view.status();
 	}
 
 	template<typename OsModel_P,
@@ -1222,9 +1265,12 @@ namespace wiselib
 		size_t num_segments = 0;
 		size_t curr_segment_len;
 		uint8_t max_delta = COAP_MAX_DELTA_DEFAULT;
+		// the End of Options marker stays behind the last option
+		block_data_t *end_of_values = end_of_options_;
 		if( option_count_ >= COAP_UNLIMITED_OPTIONS )
 		{
 			max_delta = COAP_MAX_DELTA_UNLIMITED;
+			--end_of_values;
 		}
 
 		if( removal_start != NULL )
@@ -1237,7 +1283,7 @@ namespace wiselib
 				curr_segment_len = *(removal_start + removal_len) & 0x0f;
 				if( curr_segment_len == COAP_LONG_OPTION )
 				{
-					curr_segment_len += *(removal_start + 1) + 2;
+					curr_segment_len += *(removal_start + removal_len + 1) + 2;
 				}
 				else
 				{
@@ -1245,20 +1291,23 @@ namespace wiselib
 				}
 
 				removal_len += curr_segment_len;
-			} while( (removal_start + removal_len) < end_of_options_
+			} while( (removal_start + removal_len) < end_of_values
 			         && ( *(removal_start + removal_len) & 0xf0 ) == 0 );
 
 			// if the removed option is the last option and the one
 			// before is a fencepost, remove the fencepost
-			if( (removal_start + removal_len) >= end_of_options_ )
+			if( (removal_start + removal_len) >= end_of_values )
 			{
 				if(is_fencepost( prev ))
 				{
 					removal_start = options_[ prev ];
-					removal_len = (size_t) (end_of_options_ - removal_start);
+					removal_len = (size_t) (end_of_values - removal_start);
 					options_[ prev ] = NULL;
 					++num_segments;
 				}
+				memmove( removal_start,
+				         removal_start + removal_len,
+				         size_t (end_of_options_ - (removal_start + removal_len) ) );
 			}
 			else
 			{
@@ -1274,6 +1323,7 @@ namespace wiselib
 					--removal_len;
 					--num_segments;
 					prev += fencepost_delta;
+					options_[ prev ] = removal_start - 1;
 				}
 
 				// move following options
@@ -1286,9 +1336,9 @@ namespace wiselib
 			options_[ option_number ] = NULL;
 
 			end_of_options_ -= removal_len;
-			option_count_ -= num_segments;
-
+			// scanned while the marker is still recognized
 			scan_opts( removal_start, prev );
+			option_count_ -= num_segments;
 
 			// remove End of Options marker if there are fewer than 15 options
 			// now, OR if there are exactly 15 and one of them is a fencepost
@@ -1438,8 +1488,12 @@ namespace wiselib
 		}
 
 		size_t fenceposts_omitted_len = 0;
+		bool omitted_fencepost = false;
 
+		// new last options go in front of the End of Options marker
 		block_data_t *put_here = end_of_options_;
+		if( option_count_ >= COAP_UNLIMITED_OPTIONS )
+			--put_here;
 		block_data_t *next_opt_start = put_here;
 		// there are options set
 		if( put_here > storage_ )
@@ -1470,6 +1524,8 @@ namespace wiselib
 						if( nextnext - num <= max_delta )
 						{
 							options_[next] = NULL;
+							omitted_fencepost = true;
+							--option_count_;
 							next = nextnext;
 						}
 					}
@@ -1480,7 +1536,8 @@ namespace wiselib
 			}
 
 			// look for previous option - can be the same option we're inserting
-			if( next != 0 )
+			// the header of next can't be used if the fencepost in front of it was omitted
+			if( next != 0 && !omitted_fencepost )
 			{
 				prev = (CoapOptionNum) ( next - (CoapOptionNum) ( ( *(options_[next]) & 0xf0 ) >> 4 ));
 			}
@@ -1501,11 +1558,12 @@ namespace wiselib
 				// if the delta to the option before the fencepost is
 				// small enough, we can ommit the fencepost
 				CoapOptionNum prevprev = (CoapOptionNum) ( prev -
-						( ( *( options_[prev] ) && 0xf0) >> 4 ) );
+						( ( *( options_[prev] ) & 0xf0) >> 4 ) );
 				if( num - prevprev <= max_delta )
 				{
 					put_here = options_[prev];
 					options_[prev] = NULL;
+					--option_count_;
 					prev = prevprev;
 				}
 			}
@@ -1526,21 +1584,24 @@ namespace wiselib
 		if( put_here < end_of_options_ )
 		{
 			// correcting delta of following option
-			*next_opt_start = ( *next_opt_start & 0x0f )
-			                  | (block_data_t) ((next - num) << 4);
+			if( next != 0 )
+				*next_opt_start = ( *next_opt_start & 0x0f )
+				                  | (block_data_t) ((next - num) << 4);
 
 			memmove( next_opt_start + bytes_needed,
 			        next_opt_start,
 			        (size_t) (end_of_options_ - next_opt_start));
 		}
 
-		memcpy( put_here + (bytes_needed - len), serial_opt, len );
+		// the headers go in front of the value, omitted fenceposts are overwritten
+		memcpy( put_here + overhead_len, serial_opt, len );
 		end_of_options_ += bytes_needed;
 		if( fencepost != 0)
 		{
 			*put_here = fencepost << 4;
-			prev = (CoapOptionNum) fencepost;
-			options_[fencepost] = put_here;
+			// fencepost is a delta, the fencepost's number is relative to prev
+			prev = (CoapOptionNum) ( prev + fencepost );
+			options_[prev] = put_here;
 			++put_here;
 			++option_count_;
 		}
@@ -1559,12 +1620,7 @@ namespace wiselib
 			}
 		}
 
-		// if we just appended we don't want to overwrite the option's pointer
-		if( prev == num )
-		{
-			put_here += len;
-		}
-
+		// a repeated option has a zero delta, the scan keeps its first occurrence
 		scan_opts( put_here, prev );
 
 		if( num_of_opts == SINGLE_OPTION_NO_HEADER )
@@ -1664,10 +1720,10 @@ namespace wiselib
 			}
 		}
 
-		scan_opts( storage_, 0 );
-
 		// remove COAP_END_OF_OPTIONS_MARKER
 		--end_of_options_;
+
+		scan_opts( storage_, 0 );
 	}
 
 	template<typename OsModel_P,
@@ -1709,116 +1765,6 @@ namespace wiselib
 		}
 	}
 
-	template<typename OsModel_P,
-	typename Radio_P,
-	typename String_T,
-	size_t storage_size_>
-	int CoapPacketStatic<OsModel_P, Radio_P, String_T, storage_size_>::initial_scan_opts( size_t num_of_opts, size_t message_length )
-	{
-		block_data_t *curr_position = storage_;
-		option_count_ = 0;
-		uint8_t current = 0;
-		uint8_t previous = 0;
-		size_t opt_length;
-		while( ( option_count_ < num_of_opts  || num_of_opts == COAP_UNLIMITED_OPTIONS ) )
-		{
-			// end of options
-			if( is_end_of_opts_marker( curr_position ) )
-				break;
-
-			current = previous + ( ( *curr_position & 0xf0) >> 4);
-
-			// length of option plus header
-			opt_length = *curr_position & 0x0f;
-			if( opt_length == COAP_LONG_OPTION )
-				opt_length = *(curr_position + 1) + 17;
-			else
-				++opt_length;
-
-			if( current == previous
-			    && !COAP_OPT_CAN_OCCUR_MULTIPLE[current] )
-			{
-				// option is critical
-				if ( is_critical( current ) )
-				{
-					error_code_ = COAP_CODE_BAD_OPTION;
-					error_option_ = current;
-					return ERR_MULTIPLE_OCCURENCES_OF_CRITICAL_OPTION;
-				}
-				// otherwise ignore
-				++option_count_;
-				previous = current;
-				curr_position += opt_length;
-				continue;
-			}
-
-			// check for unknown options
-			if ( ( current > COAP_LARGEST_OPTION_NUMBER )
-			     || ( COAP_OPTION_FORMAT[current] == COAP_FORMAT_UNKNOWN ) )
-			{
-				// option is critical
-				if ( is_critical( current ) )
-				{
-					error_code_ = COAP_CODE_BAD_OPTION;
-					error_option_ = current;
-					return ERR_UNKNOWN_CRITICAL_OPTION;
-				}
-				// otherwise ignore
-				++option_count_;
-				previous = current;
-				curr_position += opt_length;
-				continue;
-			}
-
-			if( COAP_OPTION_FORMAT[current] == COAP_FORMAT_STRING
-			    && opt_length == 0 )
-			{
-				if ( is_critical( current ) )
-				{
-					error_code_ = COAP_CODE_BAD_OPTION;
-					error_option_ = current;
-					return ERR_EMPTY_STRING_OPTION;
-				}
-				// otherwise ignore
-				++option_count_;
-				previous = current;
-				curr_position += opt_length;
-				continue;
-			}
-
-			if( current != previous )
-			{
-				options_[ current ] = curr_position;
-			}
-
-			++option_count_;
-			previous = current;
-			curr_position += opt_length;
-
-			if( (curr_position >= (storage_ + storage_size_)
-			    || curr_position >= ( storage_ + message_length ))
-			    && ( option_count_ < num_of_opts ) )
-			{
-				error_code_ = COAP_CODE_BAD_REQUEST;
-				error_option_ = current;
-				return ERR_OPTIONS_EXCEED_PACKET_LENGTH;
-			}
-		}
-
-		end_of_options_ = curr_position;
-
-		// Rest is data
-		if( curr_position < ( storage_ + message_length ) )
-		{
-			int status = set_data(curr_position,
-					message_length - ( curr_position - storage_ ) );
-			if( status != SUCCESS )
-				return status;
-		}
-
-		return SUCCESS;
-	}
-
 	template<typename OsModel_P,
 	typename Radio_P,
 	typename String_T,
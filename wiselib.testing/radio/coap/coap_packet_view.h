@@ -0,0 +1,423 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+#ifndef COAP_PACKET_VIEW_H
+#define COAP_PACKET_VIEW_H
+
+#include "coap.h"
+
+namespace wiselib
+{
+	/**
+	 * \brief Read-only view of a serialized CoAP message.
+	 * The message is parsed once, the view only keeps pointers to the
+	 * option headers and the payload inside the parsed buffer, nothing is copied.
+	 * The buffer has to outlive the view, so use CoapPacketStatic::parse_message()
+	 * to make an owned copy if the message has to be kept after the radio
+	 * callback returned.
+	 */
+	template<typename OsModel_P,
+	typename Radio_P>
+	class CoapPacketView
+	{
+	public:
+		typedef OsModel_P OsModel;
+		typedef Radio_P Radio;
+		typedef typename Radio::block_data_t block_data_t;
+
+		typedef CoapPacketView<OsModel_P, Radio_P> self_type;
+
+		enum error_code
+		{
+			// inherited from concepts::BasicReturnValues_concept
+			SUCCESS = OsModel::SUCCESS,
+			ERR_NOMEM = OsModel::ERR_NOMEM,
+			ERR_UNSPEC = OsModel::ERR_UNSPEC,
+			ERR_NOTIMPL = OsModel::ERR_NOTIMPL,
+			// coap_packet_t errors
+			ERR_WRONG_TYPE,
+			ERR_UNKNOWN_OPT,
+			ERR_OPT_NOT_SET,
+			ERR_OPT_TOO_LONG,
+			ERR_METHOD_NOT_APPLICABLE,
+			ERR_MULTIPLE_OCCURENCES_OF_OPTION,
+			// packet parsing errors
+			ERR_OPTIONS_EXCEED_PACKET_LENGTH,
+			ERR_UNKNOWN_CRITICAL_OPTION,
+			ERR_MULTIPLE_OCCURENCES_OF_CRITICAL_OPTION,
+			ERR_EMPTY_STRING_OPTION,
+			ERR_NOT_COAP,
+			ERR_WRONG_COAP_VERSION
+		};
+
+		CoapPacketView()
+		{
+			init();
+		}
+
+		void init()
+		{
+			datastream_ = NULL;
+			length_ = 0;
+			status_ = ERR_NOT_COAP;
+			end_of_options_ = NULL;
+			payload_ = NULL;
+			data_length_ = 0;
+			option_count_ = 0;
+			version_ = COAP_VERSION;
+			type_ = COAP_MSG_TYPE_NON;
+			code_ = COAP_CODE_EMPTY;
+			msg_id_ = 0;
+			error_code_ = 0;
+			error_option_ = 0;
+			for( size_t i = 0; i < COAP_OPTION_ARRAY_SIZE; ++i )
+				options_[i] = NULL;
+		}
+
+		/**
+		 * Parses a serialized message in place
+		 * @param datastream the serial data to be parsed, has to stay valid as long as the view is used
+		 * @param length length of the datastream
+		 * @return the same codes as CoapPacketStatic::parse_message(), except ERR_NOMEM.
+		 *         After a parsing error the header fields and the options in front of the
+		 *         faulty one are still available, get_error_context() tells what went wrong.
+		 */
+		int parse( const block_data_t *datastream, size_t length );
+
+		/**
+		 * Result of the last call to parse()
+		 */
+		int status() const
+		{
+			return status_;
+		}
+
+		uint8_t version() const
+		{
+			return version_;
+		}
+
+		CoapType type() const
+		{
+			return (CoapType) type_;
+		}
+
+		CoapCode code() const
+		{
+			return (CoapCode) code_;
+		}
+
+		bool is_request() const
+		{
+			return( code_ >= COAP_REQUEST_CODE_RANGE_MIN && code_ <= COAP_REQUEST_CODE_RANGE_MAX );
+		}
+
+		bool is_response() const
+		{
+			return( code_ >= COAP_RESPONSE_CODE_RANGE_MIN && code_ <= COAP_RESPONSE_CODE_RANGE_MAX );
+		}
+
+		coap_msg_id_t msg_id() const
+		{
+			return msg_id_;
+		}
+
+		/**
+		 * Number of options including fenceposts and ignored options, as counted in the header
+		 */
+		uint8_t option_count() const
+		{
+			return option_count_;
+		}
+
+		/**
+		 * First option header of the given option number
+		 * @return pointer into the parsed buffer, NULL if the option is not set
+		 */
+		const block_data_t* option( CoapOptionNum option_number ) const
+		{
+			if( option_number > COAP_LARGEST_OPTION_NUMBER )
+				return NULL;
+			return options_[option_number];
+		}
+
+		/**
+		 * Bitmask of the set options, bit i stands for option number i
+		 */
+		uint32_t what_options_are_set() const
+		{
+			uint32_t result = 0;
+			for( size_t i = 0; i < COAP_OPTION_ARRAY_SIZE; ++i )
+			{
+				if( options_[i] != NULL )
+					result |= 1 << i;
+			}
+			return result;
+		}
+
+		/**
+		 * Retrieves the value of a uint option
+		 * @return SUCCESS, ERR_OPT_NOT_SET or ERR_OPT_TOO_LONG
+		 */
+		int get_option( CoapOptionNum option_number, uint32_t &value ) const
+		{
+			const block_data_t *raw = option( option_number );
+			if( raw == NULL )
+				return ERR_OPT_NOT_SET;
+			size_t len = value_length( raw );
+			if( len > sizeof( uint32_t ) )
+				return ERR_OPT_TOO_LONG;
+			value = 0;
+			for( size_t i = 0; i < len; ++i )
+				value = ( value << 8 ) | raw[1 + i];
+			return SUCCESS;
+		}
+
+		/**
+		 * Retrieves the value of an option as opaque data. For options
+		 * occurring multiple times only the first occurrence is returned.
+		 * @return SUCCESS or ERR_OPT_NOT_SET
+		 */
+		int get_option( CoapOptionNum option_number, OpaqueData &value ) const
+		{
+			const block_data_t *raw = option( option_number );
+			if( raw == NULL )
+				return ERR_OPT_NOT_SET;
+			value.set( value_start( raw ), value_length( raw ) );
+			return SUCCESS;
+		}
+
+		void token( OpaqueData &token ) const
+		{
+			if( get_option( COAP_OPT_TOKEN, token ) != SUCCESS )
+				token = OpaqueData();
+		}
+
+		const block_data_t* data() const
+		{
+			return payload_;
+		}
+
+		size_t data_length() const
+		{
+			return data_length_;
+		}
+
+		/**
+		 * The parsed buffer and its length, i.e. the serialized message
+		 */
+		const block_data_t* buffer() const
+		{
+			return datastream_;
+		}
+
+		size_t length() const
+		{
+			return length_;
+		}
+
+		/**
+		 * Start of the serialized options (directly behind the header)
+		 */
+		const block_data_t* options_begin() const
+		{
+			return datastream_ + COAP_START_OF_OPTIONS;
+		}
+
+		/**
+		 * End of the serialized options including the end of options marker, if any
+		 */
+		const block_data_t* options_end() const
+		{
+			return end_of_options_;
+		}
+
+		void get_error_context( CoapCode &error_code, CoapOptionNum &error_option ) const
+		{
+			error_code = (CoapCode) error_code_;
+			error_option = (CoapOptionNum) error_option_;
+		}
+
+		/**
+		 * Length of an option value
+		 * @param option_header pointer to the option header
+		 */
+		static size_t value_length( const block_data_t *option_header )
+		{
+			size_t len = *option_header & 0x0f;
+			if( len == COAP_LONG_OPTION )
+				len += *(option_header + 1);
+			return len;
+		}
+
+		/**
+		 * Start of an option value
+		 * @param option_header pointer to the option header
+		 */
+		static const block_data_t* value_start( const block_data_t *option_header )
+		{
+			return option_header + ( ( ( *option_header & 0x0f ) == COAP_LONG_OPTION ) ? 2 : 1 );
+		}
+
+	private:
+		int fail( int error, CoapCode error_code, uint8_t error_option, const block_data_t *position );
+
+		static bool is_critical( uint8_t option_number )
+		{
+			// odd option numbers are critical
+			return( option_number & 0x01 );
+		}
+
+		const block_data_t *datastream_;
+		size_t length_;
+		int status_;
+		const block_data_t *options_[COAP_OPTION_ARRAY_SIZE];
+		const block_data_t *end_of_options_;
+		const block_data_t *payload_;
+		size_t data_length_;
+		uint8_t option_count_;
+		uint8_t version_;
+		uint8_t type_;
+		uint8_t code_;
+		coap_msg_id_t msg_id_;
+		uint8_t error_code_;
+		uint8_t error_option_;
+	};
+
+	template<typename OsModel_P,
+	typename Radio_P>
+	int CoapPacketView<OsModel_P, Radio_P>::parse( const block_data_t *datastream, size_t length )
+	{
+		init();
+
+		// can this possibly be a coap packet?
+		if( length < COAP_START_OF_OPTIONS )
+		{
+			status_ = ERR_NOT_COAP;
+			return status_;
+		}
+
+		datastream_ = datastream;
+		length_ = length;
+		end_of_options_ = datastream + COAP_START_OF_OPTIONS;
+
+		uint8_t coap_first_byte = datastream[0];
+		version_ = coap_first_byte >> 6;
+		if( version_ != COAP_VERSION )
+		{
+			error_code_ = COAP_CODE_NOT_IMPLEMENTED;
+			error_option_ = COAP_OPT_NOOPT;
+			status_ = ERR_WRONG_COAP_VERSION;
+			return status_;
+		}
+		type_ = ( coap_first_byte & 0x30 ) >> 4;
+		size_t num_of_opts = coap_first_byte & 0x0f;
+		code_ = datastream[1];
+		msg_id_ = read<OsModel, block_data_t, coap_msg_id_t>( (block_data_t*) datastream + 2 );
+
+		const block_data_t *end = datastream + length;
+		const block_data_t *curr_position = datastream + COAP_START_OF_OPTIONS;
+		uint8_t current = 0;
+		uint8_t previous = 0;
+		size_t opt_length;
+		while( option_count_ < num_of_opts || num_of_opts == COAP_UNLIMITED_OPTIONS )
+		{
+			if( curr_position >= end )
+				return fail( ERR_OPTIONS_EXCEED_PACKET_LENGTH, COAP_CODE_BAD_REQUEST, current, curr_position );
+
+			// end of options
+			if( num_of_opts == COAP_UNLIMITED_OPTIONS && *curr_position == COAP_END_OF_OPTIONS_MARKER )
+			{
+				++curr_position;
+				break;
+			}
+
+			current = previous + ( ( *curr_position & 0xf0 ) >> 4 );
+
+			// length of option plus header
+			opt_length = *curr_position & 0x0f;
+			if( opt_length == COAP_LONG_OPTION )
+			{
+				if( curr_position + 1 >= end )
+					return fail( ERR_OPTIONS_EXCEED_PACKET_LENGTH, COAP_CODE_BAD_REQUEST, current, curr_position );
+				opt_length = *(curr_position + 1) + 17;
+			}
+			else
+				++opt_length;
+
+			if( current > COAP_LARGEST_OPTION_NUMBER
+			    || COAP_OPTION_FORMAT[current] == COAP_FORMAT_UNKNOWN )
+			{
+				// unknown options are ignored, unless they are critical
+				if( is_critical( current ) )
+					return fail( ERR_UNKNOWN_CRITICAL_OPTION, COAP_CODE_BAD_OPTION, current, curr_position );
+			}
+			else if( current == previous )
+			{
+				// undue repetitions are ignored, unless the option is critical
+				if( !COAP_OPT_CAN_OCCUR_MULTIPLE[current] && is_critical( current ) )
+					return fail( ERR_MULTIPLE_OCCURENCES_OF_CRITICAL_OPTION, COAP_CODE_BAD_OPTION, current, curr_position );
+			}
+			else
+			{
+				options_[current] = curr_position;
+			}
+
+			if( curr_position + opt_length > end
+			    || ( curr_position + opt_length == end && option_count_ + 1 < num_of_opts ) )
+				return fail( ERR_OPTIONS_EXCEED_PACKET_LENGTH, COAP_CODE_BAD_REQUEST, current, curr_position );
+
+			++option_count_;
+			previous = current;
+			curr_position += opt_length;
+		}
+
+		end_of_options_ = curr_position;
+
+		// Rest is data
+		if( curr_position < end )
+		{
+			payload_ = curr_position;
+			data_length_ = (size_t) ( end - curr_position );
+		}
+
+		status_ = SUCCESS;
+		return status_;
+	}
+
+	// Cuts the options off in front of the faulty one, so the options that were
+	// parsed so far stay usable and never point behind the end of the buffer
+	template<typename OsModel_P,
+	typename Radio_P>
+	int CoapPacketView<OsModel_P, Radio_P>::fail( int error, CoapCode error_code, uint8_t error_option, const block_data_t *position )
+	{
+		error_code_ = error_code;
+		error_option_ = error_option;
+		end_of_options_ = position;
+		for( size_t i = 0; i < COAP_OPTION_ARRAY_SIZE; ++i )
+		{
+			if( options_[i] >= position )
+				options_[i] = NULL;
+		}
+		status_ = error;
+		return status_;
+	}
+}
+
+#endif // COAP_PACKET_VIEW_H
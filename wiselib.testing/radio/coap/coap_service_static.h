@@ -22,6 +22,9 @@
 
 #include "coap.h"
 #include "coap_packet_static.h"
+#include "coap_packet_view.h"
+#include "coap_message_index.h"
+#include "algorithms/hash/fnv.h"
 #include "util/delegates/delegate.hpp"
 #include "util/pstl/vector_static.h"
 #include "util/pstl/static_string.h"
@@ -65,7 +68,7 @@ namespace wiselib {
  * \tparam preface_msg_id_ Determines whether a CoAP Packet starts with the message ID <br>
  * 		CoapMsgId - as defined in <a href="https://github.com/ibr-alg/wiselib/wiki/Reserved-message-ids">the Wiselib's Reserved Message IDs</a>
  * \tparam human_readable_errors_ if set to true errors will return a human readable error message in the body. Otherwise the body will contain two int16_t that detail the nature of the error and the option number of the option that caused the error.
- * \tparam coap_packet_t_ type of the coap_packet. Write your own implementation if you like ;) Mainly this parameter is meant to be used for controlling the storage_size_ parameter of CoapPacketStatic
+ * \tparam coap_packet_t_ type of the coap_packet. Write your own implementation if you like ;) Mainly this parameter is meant to be used for controlling the storage_size_ parameter of CoapPacketStatic. It has to be able to copy a CoapPacketView with parse_message().
  * \tparam sent_list_size_ size of the message buffer that holds messages sent by CoapServiceStatic
  * \tparam received_list_size_ size of the message buffer that holds messages received by CoapServiceStatic
  * \tparam resources_list_size_ determines how many resources can be registered at CoapServiceStatic
@@ -109,6 +112,8 @@ template<typename OsModel_P,
 		typedef self_t CoapServiceStatic_t;
 
 		typedef coap_packet_t_ coap_packet_t;
+		typedef CoapPacketView<OsModel_P, Radio_P> packet_view_t;
+		typedef Fnv1a<OsModel, uint32_t> path_hash_t;
 
 		enum error_codes
 		{
@@ -241,13 +246,30 @@ template<typename OsModel_P,
 		};
 
 		typedef delegate1<void, ReceivedMessage&> coapreceiver_delegate_t;
+		// block-wise resources: ( request, offset, buffer, length ), returns the number of bytes written to buffer
+		typedef delegate4<size_t, ReceivedMessage&, size_t, block_data_t*, size_t> block_read_delegate_t;
+		// ( request, offset, data, length, more ), returns the code of the final response
+		typedef delegate5<CoapCode, ReceivedMessage&, size_t, block_data_t*, size_t, bool> block_write_delegate_t;
+		// block-wise downloads: ( status, offset, block )
+		typedef delegate3<void, int, size_t, ReceivedMessage*> block_delegate_t;
+
+		enum block_status
+		{
+			// block holds the data at offset
+			BLOCK_DATA,
+			// all blocks were delivered, offset is the total length, block is NULL
+			BLOCK_DONE,
+			// the transfer was aborted, block is the error response or NULL on timeout
+			BLOCK_FAILED
+		};
 
 		class CoapResource
 		{
 		public:
 			bool operator==( const CoapResource &other ) const
 			{
-				return ( this->resource_path() == other.resource_path() && this->callback() == other.callback() );
+				return ( this->resource_path() == other.resource_path() && this->callback() == other.callback()
+					&& this->block_read() == other.block_read() );
 			}
 
 			bool operator!=( const CoapResource &other ) const
@@ -259,12 +281,20 @@ template<typename OsModel_P,
 			{
 				resource_path_ = string_t();
 				callback_ = coapreceiver_delegate_t();
+				block_read_ = block_read_delegate_t();
+				block_write_ = block_write_delegate_t();
+				content_type_ = COAP_CONTENT_TYPE_NONE;
+				upload_active_ = false;
 			}
 
 			CoapResource( string_t path, coapreceiver_delegate_t callback)
 			{
 				set_resource_path( path );
 				set_callback( callback );
+				block_read_ = block_read_delegate_t();
+				block_write_ = block_write_delegate_t();
+				content_type_ = COAP_CONTENT_TYPE_NONE;
+				upload_active_ = false;
 			}
 
 			void set_resource_path( string_t path)
@@ -287,10 +317,75 @@ template<typename OsModel_P,
 				return callback_;
 			}
 
+			void set_block_read( block_read_delegate_t block_read, CoapContentType content_type )
+			{
+				block_read_ = block_read;
+				content_type_ = content_type;
+			}
+
+			block_read_delegate_t block_read() const
+			{
+				return block_read_;
+			}
+
+			void set_block_write( block_write_delegate_t block_write )
+			{
+				block_write_ = block_write;
+			}
+
+			block_write_delegate_t block_write() const
+			{
+				return block_write_;
+			}
+
+			CoapContentType content_type() const
+			{
+				return content_type_;
+			}
+
+			/**
+			 * Block-wise resources are served by the service itself, block by block
+			 */
+			bool is_blockwise() const
+			{
+				return ( block_read() && block_read().obj_ptr() != NULL )
+					|| ( block_write() && block_write().obj_ptr() != NULL );
+			}
+
+			/**
+			 * Whether the Block1 upload in progress continues with the given block
+			 * @param client correspondent of the block
+			 * @param offset offset of the block
+			 */
+			bool upload_expects( node_id_t client, size_t offset ) const
+			{
+				return upload_active_ && upload_client_ == client && upload_next_ == offset;
+			}
+
+			void set_upload( node_id_t client, size_t next_offset )
+			{
+				upload_active_ = true;
+				upload_client_ = client;
+				upload_next_ = next_offset;
+			}
+
+			void end_upload()
+			{
+				upload_active_ = false;
+			}
+
 		private:
 			string_t resource_path_;
 
 			coapreceiver_delegate_t callback_;
+			block_read_delegate_t block_read_;
+			block_write_delegate_t block_write_;
+			CoapContentType content_type_;
+
+			// one Block1 upload at a time: its client and the offset of the next block
+			bool upload_active_;
+			node_id_t upload_client_;
+			size_t upload_next_;
 		};
 
 		CoapServiceStatic();
@@ -336,6 +431,19 @@ template<typename OsModel_P,
 		 */
 		template<class T, void (T::*TMethod)(ReceivedMessage&)>
 		coap_packet_t* send_coap_gen_msg_id_token(node_id_t receiver, coap_packet_t & message, T *callback);
+
+		/**
+		 * Generates a MessageID, writes it into an already serialized message and sends it.
+		 * Meant for sending the same message to many receivers without serializing it for each of them.
+		 * The message is kept for retransmissions and response matching like any other sent message.
+		 * @param receiver node ID of the receiver
+		 * @param data serialized message, its message ID is overwritten
+		 * @param length length of the serialized message
+		 * @param callback delegate for responses from the receiver
+		 * @return packet sent, NULL if data isn't a valid message or sending failed
+		 */
+		template<class T, void (T::*TMethod)(ReceivedMessage&)>
+		coap_packet_t* send_coap_serialized_gen_msg_id(node_id_t receiver, block_data_t *data, size_t length, T *callback);
 		
 		/**
 		 * Sends an RST in response to the MessageID passed
@@ -364,6 +472,59 @@ template<typename OsModel_P,
 		 */
 		int unreg_resource_callback( int idx );
 
+		/**
+		 * Registers a resource that is too large to be sent in one message.
+		 * GET requests for exactly this path are answered block-wise
+		 * (Block2 option), every block is read from the callback on demand,
+		 * so the representation never has to be in memory as a whole.
+		 * The callback has to write up to length bytes of the representation,
+		 * starting at offset, to buffer and return the number of bytes written.
+		 * Returning less than length means the end of the representation was reached.
+		 * @param resource_path path of the resource
+		 * @param callback object to call the method on
+		 * @param content_type content type of the representation
+		 * @return index for unregistering the resource, -1 if there is no free slot
+		 */
+		template<class T, size_t (T::*TMethod)(ReceivedMessage&, size_t, block_data_t*, size_t)>
+		int reg_block_resource_callback( string_t resource_path, T *callback, CoapContentType content_type = COAP_CONTENT_TYPE_NONE );
+
+		/**
+		 * Accepts PUT and POST requests for a resource block-wise (Block1 option).
+		 * The callback is called for every block with its offset and payload,
+		 * more is false for the last block. For all but the last block the
+		 * client gets a 2.31 Continue unless an error code is returned, the code
+		 * returned for the last block is sent as final response.
+		 * The blocks have to arrive in order, block 0 starts a new upload and
+		 * takes the resource over from an unfinished one. Any other block that
+		 * does not continue the upload of its client is answered with
+		 * 4.08 Request Entity Incomplete without calling the callback.
+		 * @param idx index of a resource registered with reg_block_resource_callback()
+		 * @return CoapServiceStatic::SUCCESS, CoapServiceStatic::ERR_UNSPEC if idx is no block-wise resource
+		 */
+		template<class T, CoapCode (T::*TMethod)(ReceivedMessage&, size_t, block_data_t*, size_t, bool)>
+		int set_block_write_callback( int idx, T *callback );
+
+		/**
+		 * Downloads a resource block-wise. The first block is requested alone
+		 * to agree on the block size, afterwards up to COAP_BLOCK_WINDOW blocks
+		 * are requested at a time. Blocks are passed to the callback as they
+		 * arrive, which is not necessarily in order, followed by BLOCK_DONE
+		 * or BLOCK_FAILED. See block_status.
+		 * @param receiver server to send the requests to
+		 * @param uri_path path of the resource
+		 * @param uri_query query of the resource
+		 * @param callback object to call the method on
+		 * @return index of the transfer for cancel_blockwise(), -1 if COAP_BLOCK_TRANSFERS downloads are running already
+		 */
+		template<class T, void (T::*TMethod)(int, size_t, ReceivedMessage*)>
+		int get_blockwise( node_id_t receiver, const string_t &uri_path, const string_t &uri_query, T *callback );
+
+		/**
+		 * Stops a block-wise download without calling its callback again
+		 * @param transfer index returned by get_blockwise()
+		 */
+		void cancel_blockwise( int transfer );
+
 		/**
 		 * Sends a GET request
 		 * @param receiver server to send the request to
@@ -607,6 +768,35 @@ template<typename OsModel_P,
 
 		typedef list_static<OsModel, ReceivedMessage, received_list_size_> received_list_t;
 		typedef list_static<OsModel, SentMessage, sent_list_size_> sent_list_t;
+		typedef CoapMessageIndex<OsModel, ReceivedMessage, node_id_t, received_list_size_> received_index_t;
+		typedef CoapMessageIndex<OsModel, SentMessage, node_id_t, sent_list_size_> sent_index_t;
+		typedef int16_t resource_slot_t;
+
+		static const uint32_t NO_BLOCK = 0xffffffffUL;
+
+		struct BlockTransfer
+		{
+			node_id_t receiver;
+			string_t uri_path;
+			string_t uri_query;
+			block_delegate_t callback;
+			// requests in flight, identified by their token
+			coap_token_t tokens[COAP_BLOCK_WINDOW];
+			uint32_t nums[COAP_BLOCK_WINDOW];
+			bool pending[COAP_BLOCK_WINDOW];
+			uint32_t next_num;
+			// number of blocks, NO_BLOCK until the last block is known
+			uint32_t end_num;
+			uint32_t delivered;
+			size_t length;
+			// compared by block_timeout() to detect stalled transfers
+			uint16_t progress;
+			uint16_t watched_progress;
+			uint8_t szx;
+			// the block size is fixed once the first block arrived
+			bool szx_fixed;
+			bool active;
+		};
 
 		Radio *radio_;
 		Timer *timer_;
@@ -615,23 +805,28 @@ template<typename OsModel_P,
 		int recv_callback_id_; // callback for receive function
 		sent_list_t sent_;
 		received_list_t received_;
+		// message ID and token lookup for sent_ and received_
+		sent_index_t sent_index_;
+		received_index_t received_index_;
 		vector_static<OsModel, CoapResource, resources_list_size_> resources_;
+		// hash index of the registered resources by path, the chains are kept in index order
+		resource_slot_t resource_bucket_[resources_list_size_];
+		resource_slot_t resource_next_[resources_list_size_];
+		uint32_t resource_hash_[resources_list_size_];
 
 		coap_msg_id_t msg_id_;
 		coap_token_t token_;
 
+		BlockTransfer transfers_[COAP_BLOCK_TRANSFERS];
+		bool block_timer_set_;
+
 		CoapServiceStatic( const self_type &rhs );
 
 		coap_msg_id_t msg_id();
 		coap_token_t token();
 
-		template <typename T, list_size_t N>
-		T * queue_message(T message, list_static<OsModel_P, T, N> &queue);
-
-		template <typename T, list_size_t N>
-		T* find_message_by_id (node_id_t correspondent, coap_msg_id_t id, list_static<OsModel_P, T, N> &queue);
-		template <typename T, list_size_t N>
-		T* find_message_by_token (node_id_t correspondent, const OpaqueData& token, const list_static<OsModel_P, T, N> &queue);
+		template <typename T, list_size_t N, typename Index_T>
+		T * queue_message(T message, list_static<OsModel_P, T, N> &queue, Index_T &index);
 
 		void handle_response( ReceivedMessage& message, SentMessage *request = NULL );
 
@@ -648,8 +843,23 @@ template<typename OsModel_P,
 
 		void resource_discovery_callback(ReceivedMessage& message);
 
+		int add_resource( const CoapResource &resource );
+
+		void block_read_response( ReceivedMessage& message, CoapResource &resource );
+		void block_write_response( ReceivedMessage& message, CoapResource &resource );
+
+		int send_block_request( BlockTransfer &transfer, size_t slot );
+		void fill_block_window( BlockTransfer &transfer );
+		void finish_blockwise( BlockTransfer &transfer, int status, ReceivedMessage *message );
+		void block_response( ReceivedMessage& message );
+		void block_timeout( void * );
+
 		int path_cmp( const string_t &lhs, const string_t &rhs);
 
+		static uint32_t path_hash( const string_t &path );
+		void index_resource( resource_slot_t idx );
+		void unindex_resource( resource_slot_t idx );
+
 	};
 
 
@@ -659,6 +869,14 @@ template<typename OsModel_P,
 	COAP_SERVICE_T::CoapServiceStatic()
 	{
 		//init();
+		for( size_t i = 0; i < resources_list_size_; ++i )
+		{
+			resource_bucket_[i] = -1;
+			resource_hash_[i] = 0;
+		}
+		for( size_t i = 0; i < COAP_BLOCK_TRANSFERS; ++i )
+			transfers_[i].active = false;
+		block_timer_set_ = false;
 	}
 
 	COAP_SERVICE_TEMPLATE_PREFIX
@@ -746,9 +964,10 @@ template<typename OsModel_P,
 		if(status != SUCCESS )
 			return NULL;
 
-		SentMessage & sent = *( queue_message(SentMessage(), sent_) );
+		SentMessage & sent = *( queue_message(SentMessage(), sent_, sent_index_) );
 		sent.set_correspondent( receiver );
 		sent.set_message( message );
+		sent_index_.insert( &sent );
 		sent.set_sender_callback( coapreceiver_delegate_t::template from_method<T, TMethod>( callback ) );
 		uint16_t response_timeout = (uint16_t) ((*rand_)( (COAP_MAX_RESPONSE_TIMEOUT - COAP_RESPONSE_TIMEOUT) ) + COAP_RESPONSE_TIMEOUT);
 		sent.set_retransmit_timeout( response_timeout );
@@ -780,6 +999,38 @@ template<typename OsModel_P,
 		return send_coap_gen_msg_id<T, TMethod>( receiver, message, callback );
 	}
 
+	COAP_SERVICE_TEMPLATE_PREFIX
+	template <class T, void (T::*TMethod)( typename COAP_SERVICE_T::ReceivedMessage& ) >
+	coap_packet_t_ * COAP_SERVICE_T::send_coap_serialized_gen_msg_id(node_id_t receiver, block_data_t *data, size_t length, T *callback)
+	{
+		coap_msg_id_t id = this->msg_id();
+		data[2] = ( id & 0xff00 ) >> 8;
+		data[3] = ( id & 0x00ff );
+
+		// only sent if it can be kept for retransmissions
+		packet_view_t view;
+		coap_packet_t message;
+		if( view.parse( data, length ) != SUCCESS || message.parse_message( view ) != SUCCESS )
+			return NULL;
+		if( send( receiver, length, data ) != SUCCESS )
+			return NULL;
+
+		SentMessage & sent = *( queue_message(SentMessage(), sent_, sent_index_) );
+		sent.set_correspondent( receiver );
+		sent.set_message( message );
+		sent_index_.insert( &sent );
+		sent.set_sender_callback( coapreceiver_delegate_t::template from_method<T, TMethod>( callback ) );
+		uint16_t response_timeout = (uint16_t) ((*rand_)( (COAP_MAX_RESPONSE_TIMEOUT - COAP_RESPONSE_TIMEOUT) ) + COAP_RESPONSE_TIMEOUT);
+		sent.set_retransmit_timeout( response_timeout );
+
+		if( message.type() == COAP_MSG_TYPE_CON )
+		{
+			timer_->template set_timer<self_type, &self_type::retransmit_timeout>( sent.retransmit_timeout(), this, &sent );
+		}
+
+		return &(sent.message());
+	}
+
 	COAP_SERVICE_TEMPLATE_PREFIX
 	void COAP_SERVICE_T::receive(node_id_t from, size_t len, block_data_t * data)
 	{
@@ -799,30 +1050,39 @@ template<typename OsModel_P,
 			}
 			if( ( preface_msg_id_ && msg_id == CoapMsgId ) || !preface_msg_id_ )
 			{
-				coap_packet_t packet;
-
-				int err_code = packet.parse_message( data + msg_id_t_size, len - msg_id_t_size );
+				// parse in place, the message is only copied once it is known to be new
+				packet_view_t view;
+				int err_code = view.parse( data + msg_id_t_size, len - msg_id_t_size );
 
 				if( err_code == SUCCESS )
 				{
 					ReceivedMessage *deduplication;
 					// Only act if this message hasn't been received yet
-					if( (deduplication = find_message_by_id(from, packet.msg_id(), received_)) == NULL )
+					if( (deduplication = received_index_.find_by_id( from, view.msg_id() )) == NULL )
 					{
-						ReceivedMessage& received_message = *( queue_message( ReceivedMessage( packet, from ), received_ ) );
+						ReceivedMessage& received_message = *( queue_message( ReceivedMessage(), received_, received_index_ ) );
+						received_message.set_correspondent( from );
+						err_code = received_message.message().parse_message( view );
+						received_index_.insert( &received_message );
+						if( err_code != SUCCESS )
+						{
+							error_response( err_code, received_message );
+							return;
+						}
+						coap_packet_t &packet = received_message.message();
 
 						SentMessage *request;
 
 						if ( packet.type() == COAP_MSG_TYPE_RST )
 						{
-							request = find_message_by_id( from, packet.msg_id(), sent_ );
+							request = sent_index_.find_by_id( from, packet.msg_id() );
 							if( request != NULL )
 								(*request).sender_callback()( received_message );
 							return;
 						}
 						else if( packet.type() == COAP_MSG_TYPE_ACK )
 						{
-							request = find_message_by_id( from, packet.msg_id(), sent_ );
+							request = sent_index_.find_by_id( from, packet.msg_id() );
 
 							if ( request != NULL )
 							{
@@ -867,7 +1127,7 @@ template<typename OsModel_P,
 					else
 					{
 						// if it's confirmable we might want to hurry sending an ACK
-						if( packet.type() == COAP_MSG_TYPE_CON )
+						if( view.type() == COAP_MSG_TYPE_CON )
 							ack( *deduplication );
 						// if the response was piggybacked it was already resent by the line above
 						if( deduplication->response_sent() != NULL
@@ -889,7 +1149,10 @@ template<typename OsModel_P,
 				}
 				else
 				{
-					ReceivedMessage& received_error = *( queue_message( ReceivedMessage( packet, from ), received_ ) );
+					ReceivedMessage& received_error = *( queue_message( ReceivedMessage(), received_, received_index_ ) );
+					received_error.set_correspondent( from );
+					received_error.message().parse_message( view );
+					received_index_.insert( &received_error );
 					error_response( err_code, received_error );
 				}
 			}
@@ -909,25 +1172,26 @@ template<typename OsModel_P,
 	template <class T, void (T::*TMethod)( typename COAP_SERVICE_T::ReceivedMessage& ) >
 	int COAP_SERVICE_T::reg_resource_callback( string_t resource_path, T *callback, CoapResource *resource )
 	{
+		return add_resource( CoapResource( resource_path, coapreceiver_delegate_t::template from_method<T, TMethod>( callback ) ) );
+	}
 
-		if ( resources_.empty() )
-			resources_.assign( COAPRADIO_RESOURCES_SIZE, CoapResource() );
-
-		for ( unsigned int i = 0; i < resources_.size(); ++i )
-		{
-			CoapResource &curr = resources_.at(i);
-			if ( curr == CoapResource() )
-			{
-				curr.set_resource_path( resource_path );
-				curr.set_callback( coapreceiver_delegate_t::template from_method<T, TMethod>( callback ) );
-				resource = &curr;
-				DBG_COAP("Registered new resource under \"%s\"", resource_path.c_str() );
-				return i;
-			}
-		}
+	COAP_SERVICE_TEMPLATE_PREFIX
+	template <class T, typename COAP_SERVICE_T::size_t (T::*TMethod)( typename COAP_SERVICE_T::ReceivedMessage&, typename COAP_SERVICE_T::size_t, typename COAP_SERVICE_T::block_data_t*, typename COAP_SERVICE_T::size_t ) >
+	int COAP_SERVICE_T::reg_block_resource_callback( string_t resource_path, T *callback, CoapContentType content_type )
+	{
+		CoapResource resource( resource_path, coapreceiver_delegate_t() );
+		resource.set_block_read( block_read_delegate_t::template from_method<T, TMethod>( callback ), content_type );
+		return add_resource( resource );
+	}
 
-		DBG_COAP("Maximum number of %d resources reached. Dropping \"%s\"", resources_.size(), resource_path.c_str() );
-		return -1;
+	COAP_SERVICE_TEMPLATE_PREFIX
+	template <class T, CoapCode (T::*TMethod)( typename COAP_SERVICE_T::ReceivedMessage&, typename COAP_SERVICE_T::size_t, typename COAP_SERVICE_T::block_data_t*, typename COAP_SERVICE_T::size_t, bool ) >
+	int COAP_SERVICE_T::set_block_write_callback( int idx, T *callback )
+	{
+		if( idx < 0 || (size_t) idx >= resources_.size() || !resources_.at(idx).is_blockwise() )
+			return ERR_UNSPEC;
+		resources_.at(idx).set_block_write( block_write_delegate_t::template from_method<T, TMethod>( callback ) );
+		return SUCCESS;
 	}
 
 	COAP_SERVICE_TEMPLATE_PREFIX
@@ -955,9 +1219,35 @@ template<typename OsModel_P,
 		reply(message, (uint8_t*) res.c_str(), res.length(), COAP_CODE_CONTENT, COAP_CONTENT_TYPE_APPLICATION_LINK_FORMAT);
 	}
 
+	COAP_SERVICE_TEMPLATE_PREFIX
+	int COAP_SERVICE_T::add_resource( const CoapResource &resource )
+	{
+		if ( resources_.empty() )
+			resources_.assign( resources_list_size_, CoapResource() );
+
+		for ( unsigned int i = 0; i < resources_.size(); ++i )
+		{
+			CoapResource &curr = resources_.at(i);
+			if ( curr == CoapResource() )
+			{
+				curr = resource;
+				index_resource( i );
+				DBG_COAP("Registered new resource under \"%s\"", resource.resource_path().c_str() );
+				return i;
+			}
+		}
+
+		DBG_COAP("Maximum number of %d resources reached. Dropping \"%s\"", resources_.size(), resource.resource_path().c_str() );
+		return -1;
+	}
+
 	COAP_SERVICE_TEMPLATE_PREFIX
 	int COAP_SERVICE_T::unreg_resource_callback( int idx )
 	{
+		// never registered (or already unregistered): not in the index
+		if( idx < 0 || (size_t) idx >= resources_.size() || resources_.at(idx) == CoapResource() )
+			return SUCCESS;
+		unindex_resource( idx );
 		resources_.at(idx) = CoapResource();
 		return SUCCESS;
 	}
@@ -1121,56 +1411,20 @@ template<typename OsModel_P,
 	}
 
 	COAP_SERVICE_TEMPLATE_PREFIX
-	template <typename T, list_size_t N>
-	T * COAP_SERVICE_T::queue_message(T message, list_static<OsModel_P, T, N> &queue)
+	template <typename T, list_size_t N, typename Index_T>
+	T * COAP_SERVICE_T::queue_message(T message, list_static<OsModel_P, T, N> &queue, Index_T &index)
 	{
 		if( queue.full() )
 		{
+			index.erase( &(queue.back()) );
 			queue.pop_back();
 		}
 		queue.push_front( message );
 		return &(queue.front());
 	}
 
-	COAP_SERVICE_TEMPLATE_PREFIX
-	template <typename T, list_size_t N>
-	T* COAP_SERVICE_T::find_message_by_id
-			(node_id_t correspondent, coap_msg_id_t id, list_static<OsModel_P, T, N> &queue)
-	{
-		typename list_static<OsModel_P, T, N>::iterator it = queue.begin();
-		for(; it != queue.end(); ++it)
-		{
-			if( (*it).message().msg_id() == id && (*it).correspondent() == correspondent )
-				return &(*it);
-		}
-
-		return NULL;
-
-	}
-
-	COAP_SERVICE_TEMPLATE_PREFIX
-	template <typename T, list_size_t N>
-	T* COAP_SERVICE_T::find_message_by_token
-		(node_id_t correspondent, const OpaqueData &token, const list_static<OsModel_P, T, N> &queue)
-	{
-		OpaqueData current_token;
-		typename list_static<OsModel_P, T, N>::iterator it = queue.begin();
-		for(; it != queue.end(); ++it)
-		{
-			if( (*it).correspondent() == correspondent )
-			{
-				(*it).message().token( current_token );
-				if( current_token == token )
-				{
-					return &(*it);
-				}
-			}
-		}
-		return NULL;
-	}
-
 	// the request-pointer can be a candidate for a matching request, determined by a previous search by message id.
-	// If it doesn't turn out to be matching, find_message_by_token has to be called
+	// If it doesn't turn out to be matching, the request has to be looked up by token
 	COAP_SERVICE_TEMPLATE_PREFIX
 	void COAP_SERVICE_T::handle_response( ReceivedMessage& message, SentMessage *request )
 	{
@@ -1185,7 +1439,7 @@ template<typename OsModel_P,
 
 		if( request == NULL || request_token != response_token )
 		{
-			request = find_message_by_token( message.correspondent(), response_token, sent_ );
+			request = sent_index_.find_by_token( message.correspondent(), response_token );
 			if( request == NULL )
 			{
 				// can't match response
@@ -1234,23 +1488,72 @@ template<typename OsModel_P,
 
 			bool resource_found = false;
 
-			for(size_t i = 0; i < resources_.size(); ++i )
+			// in order to match a resource, the requested uri must match a resource, or it must be a sub-element of a resource,
+			// which means the next symbol in the request must be a slash. So only the request path and the parts of it
+			// ending before a slash are looked up in the index.
+			resource_slot_t matches[resources_list_size_];
+			size_t match_count = 0;
+			typename path_hash_t::state_t state;
+			path_hash_t::init( state );
+			size_t request_length = request_res.length();
+			for( size_t pos = 0; pos <= request_length; ++pos )
 			{
-				if( resources_.at(i) != CoapResource() && resources_.at(i).callback() && resources_.at(i).callback().obj_ptr() != NULL )
+				if( pos == request_length || request_res[pos] == '/' )
 				{
-					available_res = resources_.at(i).resource_path();
-					// in order to match a resource, the requested uri must match a resource, or it must be a sub-element of a resource,
-					// which means the next symbol in the request must be a slash
-					int path_compare = path_cmp( request_res, available_res );
-					if( path_compare == EQUAL || path_compare == LHS_IS_SUBRESOURCE )
+					uint32_t hash = path_hash_t::final( state );
+					for( resource_slot_t i = resource_bucket_[hash % resources_list_size_]; i != -1; i = resource_next_[i] )
 					{
-						resources_.at(i).callback()( message );
-						resource_found = true;
-
-						// TODO: subresources should be handled by their parents only. Currently parent and directly registered subresource get called
-						//break;
+						if( resource_hash_[i] != hash )
+							continue;
+						available_res = resources_.at(i).resource_path();
+						if( (size_t) available_res.length() != pos )
+							continue;
+						int path_compare = path_cmp( request_res, available_res );
+						if( path_compare == EQUAL || path_compare == LHS_IS_SUBRESOURCE )
+						{
+							// keep the order of resources_
+							size_t m = match_count++;
+							for( ; m > 0 && matches[m - 1] > i; --m )
+								matches[m] = matches[m - 1];
+							matches[m] = i;
+						}
 					}
 				}
+				if( pos < request_length )
+				{
+					typename path_hash_t::block_data_t c = (uint8_t) request_res[pos];
+					path_hash_t::update( state, &c, 1 );
+				}
+			}
+
+			// block-wise resources are answered by the service, for their own path only
+			for( size_t m = 0; m < match_count; ++m )
+			{
+				CoapResource &resource = resources_.at( matches[m] );
+				if( resource.is_blockwise() && (size_t) resource.resource_path().length() == request_length )
+				{
+					CoapCode code = message.message().code();
+					if( code == COAP_CODE_GET && resource.block_read() && resource.block_read().obj_ptr() != NULL )
+						block_read_response( message, resource );
+					else if( ( code == COAP_CODE_PUT || code == COAP_CODE_POST )
+							&& resource.block_write() && resource.block_write().obj_ptr() != NULL )
+						block_write_response( message, resource );
+					else
+						reply( message, NULL, 0, COAP_CODE_METHOD_NOT_ALLOWED );
+					return;
+				}
+			}
+			for( size_t m = 0; m < match_count; ++m )
+			{
+				// a callback might have unregistered the resource
+				if( resources_.at( matches[m] ).callback() && resources_.at( matches[m] ).callback().obj_ptr() != NULL )
+				{
+					resources_.at( matches[m] ).callback()( message );
+					resource_found = true;
+
+					// TODO: subresources should be handled by their parents only. Currently parent and directly registered subresource get called
+					//break;
+				}
 			}
 			if( !resource_found )
 			{
@@ -1327,7 +1630,7 @@ template<typename OsModel_P,
 	COAP_SERVICE_TEMPLATE_PREFIX
 	void COAP_SERVICE_T::error_response( int error, ReceivedMessage& message )
 	{
-		coap_packet_t packet = message.message();
+		coap_packet_t &packet = message.message();
 		CoapCode err_coap_code;
 		CoapOptionNum err_optnum;
 		packet.get_error_context( err_coap_code, err_optnum);
@@ -1379,6 +1682,316 @@ template<typename OsModel_P,
 		reply( message, error_description, len, err_coap_code, ctype );
 	}
 
+	COAP_SERVICE_TEMPLATE_PREFIX
+	template <class T, void (T::*TMethod)( int, typename COAP_SERVICE_T::size_t, typename COAP_SERVICE_T::ReceivedMessage* ) >
+	int COAP_SERVICE_T::get_blockwise( node_id_t receiver, const string_t &uri_path, const string_t &uri_query, T *callback )
+	{
+		for( size_t i = 0; i < COAP_BLOCK_TRANSFERS; ++i )
+		{
+			BlockTransfer &transfer = transfers_[i];
+			if( transfer.active )
+				continue;
+
+			transfer.receiver = receiver;
+			transfer.uri_path = uri_path;
+			transfer.uri_query = uri_query;
+			transfer.callback = block_delegate_t::template from_method<T, TMethod>( callback );
+			for( size_t slot = 0; slot < COAP_BLOCK_WINDOW; ++slot )
+				transfer.pending[slot] = false;
+			transfer.next_num = 0;
+			transfer.end_num = NO_BLOCK;
+			transfer.delivered = 0;
+			transfer.length = 0;
+			transfer.progress = 0;
+			transfer.watched_progress = transfer.progress - 1;
+			transfer.szx = COAP_BLOCK_SZX;
+			transfer.szx_fixed = false;
+
+			if( send_block_request( transfer, 0 ) != SUCCESS )
+				return -1;
+			transfer.active = true;
+
+			if( !block_timer_set_ )
+			{
+				block_timer_set_ = true;
+				timer_->template set_timer<self_type, &self_type::block_timeout>( COAP_BLOCK_TIMEOUT, this, NULL );
+			}
+			return i;
+		}
+		return -1;
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	void COAP_SERVICE_T::cancel_blockwise( int transfer )
+	{
+		if( transfer >= 0 && (size_t) transfer < COAP_BLOCK_TRANSFERS )
+			transfers_[transfer].active = false;
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	void COAP_SERVICE_T::block_read_response( ReceivedMessage& message, CoapResource &resource )
+	{
+		coap_packet_t &request = message.message();
+		CoapBlockOption block( 0, false, COAP_BLOCK_SZX );
+		uint32_t value;
+		bool requested = ( request.get_option( COAP_OPT_BLOCK2, value ) == coap_packet_t::SUCCESS );
+		if( requested )
+		{
+			CoapBlockOption asked( value );
+			if( !CoapBlockOption::is_valid( value ) )
+			{
+				reply( message, NULL, 0, COAP_CODE_BAD_OPTION );
+				return;
+			}
+			if( asked.szx() == 7 )
+			{
+				reply( message, NULL, 0, COAP_CODE_BAD_REQUEST );
+				return;
+			}
+			// larger blocks than ours are answered with the first of our blocks they contain
+			if( asked.szx() > COAP_BLOCK_SZX )
+				block = CoapBlockOption( asked.num() << ( asked.szx() - COAP_BLOCK_SZX ), false, COAP_BLOCK_SZX );
+			else
+				block = CoapBlockOption( asked.num(), false, asked.szx() );
+		}
+
+		// one byte more than a block is read to find out whether more blocks follow
+		block_data_t buffer[ ( 1 << ( COAP_BLOCK_SZX + 4 ) ) + 1 ];
+		size_t length = resource.block_read()( message, block.offset(), buffer, block.size() + 1 );
+		if( length == 0 && block.num() > 0 )
+		{
+			// behind the end of the representation
+			reply( message, NULL, 0, COAP_CODE_BAD_OPTION );
+			return;
+		}
+		bool more = length > block.size();
+		if( more )
+			length = block.size();
+
+		coap_packet_t response;
+		if( requested || more )
+			response.set_option( COAP_OPT_BLOCK2, CoapBlockOption( block.num(), more, block.szx() ).value() );
+		reply( message, buffer, length, COAP_CODE_CONTENT, resource.content_type(), response );
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	void COAP_SERVICE_T::block_write_response( ReceivedMessage& message, CoapResource &resource )
+	{
+		coap_packet_t &request = message.message();
+		CoapBlockOption block( 0, false, COAP_BLOCK_SZX );
+		uint32_t value;
+		bool blockwise = ( request.get_option( COAP_OPT_BLOCK1, value ) == coap_packet_t::SUCCESS );
+		coap_packet_t response;
+		if( blockwise )
+		{
+			if( !CoapBlockOption::is_valid( value ) )
+			{
+				reply( message, NULL, 0, COAP_CODE_BAD_OPTION );
+				return;
+			}
+			block = CoapBlockOption( value );
+			if( block.szx() > COAP_BLOCK_SZX )
+			{
+				// tell the client which block size to use
+				response.set_option( COAP_OPT_BLOCK1, CoapBlockOption( 0, block.more(), COAP_BLOCK_SZX ).value() );
+				reply( message, NULL, 0, COAP_CODE_REQUEST_ENTITY_TOO_LARGE, COAP_CONTENT_TYPE_NONE, response );
+				return;
+			}
+			if( block.more() && request.data_length() != block.size() )
+			{
+				reply( message, NULL, 0, COAP_CODE_BAD_REQUEST );
+				return;
+			}
+			// a block which does not continue the upload of its client, e.g. after a lost block
+			if( block.num() > 0 && !resource.upload_expects( message.correspondent(), block.offset() ) )
+			{
+				reply( message, NULL, 0, COAP_CODE_REQUEST_ENTITY_INCOMPLETE );
+				return;
+			}
+		}
+
+		CoapCode code = resource.block_write()( message, block.offset(), request.data(), request.data_length(), block.more() );
+		if( blockwise )
+		{
+			if( block.more() && code < COAP_CODE_BAD_REQUEST )
+			{
+				code = COAP_CODE_CONTINUE;
+				resource.set_upload( message.correspondent(), block.offset() + block.size() );
+			}
+			else
+				resource.end_upload();
+			response.set_option( COAP_OPT_BLOCK1, block.value() );
+		}
+		else
+			resource.end_upload();
+		reply( message, NULL, 0, code, COAP_CONTENT_TYPE_NONE, response );
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	int COAP_SERVICE_T::send_block_request( BlockTransfer &transfer, size_t slot )
+	{
+		coap_packet_t pack;
+		pack.set_code( COAP_CODE_GET );
+		pack.set_type( COAP_MSG_TYPE_CON );
+		pack.set_uri_path( transfer.uri_path );
+		pack.set_uri_query( transfer.uri_query );
+		pack.set_option( COAP_OPT_BLOCK2, CoapBlockOption( transfer.next_num, false, transfer.szx ).value() );
+		coap_packet_t *sent = send_coap_gen_msg_id_token<self_type, &self_type::block_response>( transfer.receiver, pack, this );
+		if( sent == NULL )
+			return ERR_UNSPEC;
+
+		OpaqueData token;
+		sent->token( token );
+		memcpy( &transfer.tokens[slot], token.value(), sizeof( coap_token_t ) );
+		transfer.nums[slot] = transfer.next_num++;
+		transfer.pending[slot] = true;
+		return SUCCESS;
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	void COAP_SERVICE_T::fill_block_window( BlockTransfer &transfer )
+	{
+		// until the first block arrived only block 0 is requested
+		if( !transfer.szx_fixed )
+			return;
+		for( size_t slot = 0; slot < COAP_BLOCK_WINDOW; ++slot )
+		{
+			if( transfer.pending[slot] )
+				continue;
+			if( transfer.next_num >= transfer.end_num )
+				return;
+			if( send_block_request( transfer, slot ) != SUCCESS )
+				return;
+		}
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	void COAP_SERVICE_T::finish_blockwise( BlockTransfer &transfer, int status, ReceivedMessage *message )
+	{
+		// the callback may start a new transfer in this slot
+		block_delegate_t callback = transfer.callback;
+		transfer.active = false;
+		if( callback && callback.obj_ptr() != NULL )
+			callback( status, transfer.length, message );
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	void COAP_SERVICE_T::block_response( ReceivedMessage& message )
+	{
+		OpaqueData token;
+		message.message().token( token );
+		if( token.length() != sizeof( coap_token_t ) )
+			return;
+		coap_token_t raw_token;
+		memcpy( &raw_token, token.value(), sizeof( coap_token_t ) );
+
+		BlockTransfer *transfer = NULL;
+		size_t slot = 0;
+		for( size_t i = 0; i < COAP_BLOCK_TRANSFERS && transfer == NULL; ++i )
+		{
+			if( !transfers_[i].active || transfers_[i].receiver != message.correspondent() )
+				continue;
+			for( slot = 0; slot < COAP_BLOCK_WINDOW; ++slot )
+			{
+				if( transfers_[i].pending[slot] && transfers_[i].tokens[slot] == raw_token )
+				{
+					transfer = &transfers_[i];
+					break;
+				}
+			}
+		}
+		if( transfer == NULL )
+			return;
+
+		transfer->pending[slot] = false;
+		++transfer->progress;
+		uint32_t num = transfer->nums[slot];
+		coap_packet_t &packet = message.message();
+
+		if( num < transfer->end_num )
+		{
+			if( packet.code() == COAP_CODE_BAD_OPTION && num > 0 )
+			{
+				// requested behind the end, the block with the more flag cleared is still on its way
+				transfer->end_num = num;
+			}
+			else if( packet.code() != COAP_CODE_CONTENT )
+			{
+				finish_blockwise( *transfer, BLOCK_FAILED, &message );
+				return;
+			}
+			else
+			{
+				uint32_t value;
+				// a response without Block2 option holds the whole representation
+				CoapBlockOption block( 0, false, transfer->szx );
+				if( packet.get_option( COAP_OPT_BLOCK2, value ) == coap_packet_t::SUCCESS )
+					block = CoapBlockOption( value );
+				if( transfer->szx_fixed ? ( block.szx() != transfer->szx || block.num() != num ) : ( block.num() != 0 || block.szx() == 7 ) )
+				{
+					finish_blockwise( *transfer, BLOCK_FAILED, &message );
+					return;
+				}
+				if( !transfer->szx_fixed )
+				{
+					// the server may have chosen smaller blocks
+					transfer->szx = block.szx();
+					transfer->szx_fixed = true;
+				}
+				if( !block.more() && block.num() + 1 < transfer->end_num )
+					transfer->end_num = block.num() + 1;
+
+				++transfer->delivered;
+				transfer->length += packet.data_length();
+				if( transfer->callback && transfer->callback.obj_ptr() != NULL )
+					transfer->callback( BLOCK_DATA, block.offset(), &message );
+				// cancelled by the callback
+				if( !transfer->active )
+					return;
+			}
+		}
+
+		if( transfer->end_num != NO_BLOCK && transfer->delivered >= transfer->end_num )
+		{
+			finish_blockwise( *transfer, BLOCK_DONE, NULL );
+			return;
+		}
+
+		fill_block_window( *transfer );
+		for( slot = 0; slot < COAP_BLOCK_WINDOW; ++slot )
+		{
+			if( transfer->pending[slot] )
+				return;
+		}
+		// nothing in flight and no way to request more
+		finish_blockwise( *transfer, BLOCK_FAILED, NULL );
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	void COAP_SERVICE_T::block_timeout( void * )
+	{
+		for( size_t i = 0; i < COAP_BLOCK_TRANSFERS; ++i )
+		{
+			BlockTransfer &transfer = transfers_[i];
+			if( !transfer.active )
+				continue;
+			if( transfer.progress == transfer.watched_progress )
+				finish_blockwise( transfer, BLOCK_FAILED, NULL );
+			else
+				transfer.watched_progress = transfer.progress;
+		}
+
+		// the callbacks may have started new transfers
+		bool active = false;
+		for( size_t i = 0; i < COAP_BLOCK_TRANSFERS; ++i )
+			active = active || transfers_[i].active;
+
+		if( active )
+			timer_->template set_timer<self_type, &self_type::block_timeout>( COAP_BLOCK_TIMEOUT, this, NULL );
+		else
+			block_timer_set_ = false;
+	}
+
 	COAP_SERVICE_TEMPLATE_PREFIX
 	void COAP_SERVICE_T::receive_coap(ReceivedMessage& message)
 	{
@@ -1412,6 +2025,46 @@ template<typename OsModel_P,
 				return NOT_EQUAL;
 		}
 	}
+
+	// FNV-1a hash of a resource path, handle_request() computes it incrementally for the parent paths
+	COAP_SERVICE_TEMPLATE_PREFIX
+	uint32_t COAP_SERVICE_T::path_hash( const string_t &path )
+	{
+		typename path_hash_t::state_t state;
+		path_hash_t::init( state );
+		for( size_t i = 0; i < (size_t) path.length(); ++i )
+		{
+			typename path_hash_t::block_data_t c = (uint8_t) path[i];
+			path_hash_t::update( state, &c, 1 );
+		}
+		return path_hash_t::final( state );
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	void COAP_SERVICE_T::index_resource( resource_slot_t idx )
+	{
+		resource_hash_[idx] = path_hash( resources_.at(idx).resource_path() );
+		resource_slot_t *link = &resource_bucket_[resource_hash_[idx] % resources_list_size_];
+		while( *link != -1 && *link < idx )
+			link = &resource_next_[*link];
+		resource_next_[idx] = *link;
+		*link = idx;
+	}
+
+	COAP_SERVICE_TEMPLATE_PREFIX
+	void COAP_SERVICE_T::unindex_resource( resource_slot_t idx )
+	{
+		resource_slot_t *link = &resource_bucket_[resource_hash_[idx] % resources_list_size_];
+		while( *link != -1 )
+		{
+			if( *link == idx )
+			{
+				*link = resource_next_[idx];
+				return;
+			}
+			link = &resource_next_[*link];
+		}
+	}
 }
 
 
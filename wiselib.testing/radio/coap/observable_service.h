@@ -24,6 +24,7 @@
 
 #include "coap_service.h"
 #include "coap_packet_static.h"
+#include "coap_packet_builder.h"
 #include "coap_service_static.h"
 #include "coap_conditional_observe.h"
 #include "coap.h"
@@ -60,6 +61,7 @@ public:
 	typedef delegate1<void, coap_message_t&> coapreceiver_delegate_t;
 	typedef ObservableService self_type;
 	typedef CoapService<Os, Radio, string_t, value_t> coap_service_t;
+	typedef CoapPacketBuilder<Os, Radio> builder_t;
 	// --------------------------------------------------------------------------
 	struct message_data
 	{
@@ -76,6 +78,12 @@ public:
 		uint32_t timestamp;
 		value_t last_value;
 		list_static<Os, coap_condition, COAP_MAX_CONDITIONS> condition_list;
+		/** minimum time between two notifications in ms */
+		uint32_t min_interval;
+		/** time of the last notification in ms */
+		uint32_t last_notification;
+		/** an update is waiting for min_interval to pass */
+		bool pending;
 
 		bool operator==(const observer& rhs) const
 		{
@@ -88,6 +96,9 @@ public:
     typedef typename observer_vector_t::iterator observer_iterator_t;
 	// --------------------------------------------------------------------------
 	ObservableService(string_t path, coap_service_t& service, bool conditional_support = true):
+		timer_(NULL),
+		debug_(NULL),
+		clock_(NULL),
 		updateNotificationConfirmable_(true),
 		maxAge_(COAP_DEFAULT_MAX_AGE),
 		service_(&service),
@@ -95,12 +106,24 @@ public:
 		max_age_notifications_(0),
 		radio_reg_id_(-1),
 		request_callback_(coapreceiver_delegate_t()),
-		status_(service.status())
+		status_(service.status()),
+		min_interval_(COAP_OBSERVE_MIN_INTERVAL),
+		flush_timer_set_(false)
 	{
 		service_->template add_status_listener<self_type, &self_type::set_status >( this );
 		conditional_support_ = conditional_support;
 	}
 	// --------------------------------------------------------------------------
+	/**
+	 * Sets the timer and the clock used for rate limiting notifications, call before register_at_radio()
+	 */
+	void init(Timer& timer, Clock& clock, Debug& debug)
+	{
+		timer_ = &timer;
+		clock_ = &clock;
+		debug_ = &debug;
+	}
+	// --------------------------------------------------------------------------
 	/**
 	 * Registers this service at the radio to be the first handler for messages
 	 */
@@ -167,6 +190,23 @@ public:
 		maxAge_ = maxAge;
 	}
 	// --------------------------------------------------------------------------
+	uint32_t min_interval()
+	{
+		return min_interval_;
+	}
+	// --------------------------------------------------------------------------
+	/**
+	 * Sets the minimum time between two notifications to the same observer.
+	 * Updates arriving faster are coalesced, the observer gets the latest status
+	 * once the interval passed. A Minimum-Response-Time condition of an observer
+	 * raises its interval. Applies to observers registered afterwards.
+	 * @param min_interval interval in ms, 0 notifies on every update
+	 */
+	void set_min_interval(uint32_t min_interval)
+	{
+		min_interval_ = min_interval;
+	}
+	// --------------------------------------------------------------------------
 	bool is_update_notification_confirmable()
 	{
 		return updateNotificationConfirmable_;
@@ -177,7 +217,7 @@ public:
 		updateNotificationConfirmable_ = updateNotificationConfirmable;
 	}
 	// --------------------------------------------------------------------------
-	CoapType message_type_for_notification(observer_t observer)
+	CoapType message_type_for_notification(const observer_t& observer)
 	{
 		CoapType result = updateNotificationConfirmable_ ? COAP_MSG_TYPE_CON : COAP_MSG_TYPE_NON;
 		if ( conditional_support_
@@ -201,24 +241,20 @@ public:
 	// --------------------------------------------------------------------------
 	/**
 	 * Send out a notification to all registered observers. Checks conditions if any registered.
+	 * Observers notified less than their minimum interval ago get the notification later.
 	 */
 	void notify_observers() {
 		observe_counter_++;
 		max_age_notifications_++;
 		for (observer_iterator_t it = observers_.begin(); it != observers_.end(); it++)
 		{
-			if ( it->condition_list.size() == 0 ||
-					coap_satisfies_conditions<
-						list_static<Os, coap_condition, COAP_MAX_CONDITIONS>,
-						value_t,
-						observer_t
-					>( status_, (*it), time() )
-				)
+			if ( satisfies_conditions(*it) )
 			{
-				send_notification(*it);
+				it->pending = true;
 			}
 
 		}
+		send_pending_notifications();
 	}
 	// --------------------------------------------------------------------------
 	/**
@@ -255,6 +291,10 @@ private:
 	uint8_t max_age_notifications_;
 	coapreceiver_delegate_t request_callback_;
 	int radio_reg_id_;
+	/** default minimum time between two notifications to an observer in ms */
+	uint32_t min_interval_;
+	/** flush_notifications() is scheduled */
+	bool flush_timer_set_;
 	// --------------------------------------------------------------------------
 	void schedule_max_age_notifications(void*)
 	{
@@ -307,6 +347,10 @@ private:
 			new_observer.timestamp = time();
 			new_observer.last_value = status_;
 			new_observer.condition_list = condition_list;
+			new_observer.min_interval = observer_min_interval(condition_list);
+			// backdated by one interval, so the first update goes out at once
+			new_observer.last_notification = time_ms() - new_observer.min_interval;
+			new_observer.pending = false;
 			observers_.push_back(new_observer);
 
 			DBG_OBS("OBSERVE: Added host %x", new_observer.host_id);
@@ -342,7 +386,9 @@ private:
 		answer.set_token(observer.token);
 		answer.set_code(COAP_CODE_CONTENT);
 
+		block_data_t buffer[COAP_OBSERVE_VALUE_SIZE];
 		message_data payload;
+		payload.data = buffer;
 		convert(status_, payload);
 		answer.set_data(payload.data, payload.length);
 
@@ -363,18 +409,177 @@ private:
 					&self_type::got_ack>(observer.host_id, answer, this);
 		}
 
+		// the registration response doesn't count against min_interval
+		notification_sent(observer, sent, !first_notification);
+		return sent;
+	}
+	// --------------------------------------------------------------------------
+	/**
+	 * Sends the current status to every observer with a pending update whose
+	 * minimum interval passed and schedules flush_notifications() for the others.
+	 * The notification is serialized once, only type, message ID and token
+	 * are patched for each observer.
+	 */
+	void send_pending_notifications()
+	{
+		uint32_t now = time_ms();
+		// time until the next observer may be notified, 0 if nobody waits
+		uint32_t wait = 0;
+		block_data_t notification[COAP_OBSERVE_NOTIFICATION_SIZE];
+		size_t options_end = 0;
+		size_t length = 0;
+
+		size_t i = 0;
+		while (i < observers_.size())
+		{
+			observer_t& observer = observers_[i];
+			if (!observer.pending)
+			{
+				++i;
+				continue;
+			}
+			uint32_t elapsed = now - observer.last_notification;
+			if (elapsed < observer.min_interval)
+			{
+				if (wait == 0 || observer.min_interval - elapsed < wait)
+					wait = observer.min_interval - elapsed;
+				++i;
+				continue;
+			}
+			// the status may have changed since the update was coalesced
+			if (!satisfies_conditions(observer))
+			{
+				observer.pending = false;
+				++i;
+				continue;
+			}
+			if (length == 0)
+			{
+				length = serialize_notification(notification, options_end);
+				if (length == 0)
+				{
+					DBG_OBS("OBSERVE: Status too large for a notification");
+					return;
+				}
+			}
+			// a failed send removes the observer, i is the next one then
+			if (send_serialized_notification(observer, notification, options_end, length))
+				++i;
+		}
+
+		if (wait != 0 && !flush_timer_set_)
+		{
+			flush_timer_set_ = true;
+			timer_->template set_timer<self_type,
+					&self_type::flush_notifications>(wait, this, 0);
+		}
+	}
+	// --------------------------------------------------------------------------
+	void flush_notifications(void*)
+	{
+		flush_timer_set_ = false;
+		send_pending_notifications();
+	}
+	// --------------------------------------------------------------------------
+	/**
+	 * Serializes a notification of the current status without token and message ID.
+	 * Observe is its last option, so the token can be inserted in front of the payload.
+	 * @param buffer COAP_OBSERVE_NOTIFICATION_SIZE bytes
+	 * @param options_end set to the position where the token goes
+	 * @return length of the notification, 0 if it doesn't fit into buffer
+	 */
+	size_t serialize_notification(block_data_t* buffer, size_t& options_end)
+	{
+		block_data_t value[COAP_OBSERVE_VALUE_SIZE];
+		message_data payload;
+		payload.data = value;
+		convert(status_, payload);
+
+		builder_t builder(buffer, COAP_OBSERVE_NOTIFICATION_SIZE);
+		builder.init(COAP_MSG_TYPE_NON, COAP_CODE_CONTENT, 0);
+		builder.add_option(COAP_OPT_OBSERVE, observe_counter_);
+		options_end = builder.length();
+		builder.set_data(payload.data, payload.length);
+		return builder.finish();
+	}
+	// --------------------------------------------------------------------------
+	bool send_serialized_notification(observer_t& observer,
+			const block_data_t* notification, size_t options_end, size_t length)
+	{
+		block_data_t buffer[COAP_OBSERVE_NOTIFICATION_SIZE + 1 + COAP_OPT_MAXLEN_TOKEN];
+		size_t token_length = observer.token.length();
+		uint8_t option_count = (notification[0] & 0x0f) + (token_length > 0 ? 1 : 0);
+
+		buffer[0] = (notification[0] & 0xc0)
+				| ((message_type_for_notification(observer) & 0x03) << 4)
+				| option_count;
+		memcpy(buffer + 1, notification + 1, options_end - 1);
+		size_t position = options_end;
+		if (token_length > 0)
+		{
+			buffer[position++] = ((COAP_OPT_TOKEN - COAP_OPT_OBSERVE) << 4) | token_length;
+			memcpy(buffer + position, observer.token.value(), token_length);
+			position += token_length;
+		}
+		memcpy(buffer + position, notification + options_end, length - options_end);
+		position += length - options_end;
+
+		coap_packet_t *sent = service_->radio()->template send_coap_serialized_gen_msg_id<self_type,
+				&self_type::got_ack>(observer.host_id, buffer, position, this);
+		return notification_sent(observer, sent);
+	}
+	// --------------------------------------------------------------------------
+	/**
+	 * Bookkeeping after a notification, removes the observer if it couldn't be sent
+	 * @param rate_limited the next notification has to wait for min_interval
+	 * @return true if the notification was sent
+	 */
+	bool notification_sent(observer_t& observer, coap_packet_t* sent,
+			bool rate_limited = true)
+	{
 		if ( sent != NULL )
 		{
 			observer.last_mid = sent->msg_id();
 			observer.timestamp = time();
+			if (rate_limited)
+				observer.last_notification = time_ms();
 			observer.last_value = status_;
-		} else {
-			// can't reach observer we need to remove him
-			cout << "OBSERVE: Deleted Observer\n";
-			observers_.erase(observers_.find(observer));
-
+			observer.pending = false;
+			return true;
 		}
-		return sent;
+		// can't reach observer we need to remove him
+		DBG_OBS("OBSERVE: Deleted Observer");
+		observers_.erase(observers_.find(observer));
+		return false;
+	}
+	// --------------------------------------------------------------------------
+	bool satisfies_conditions(observer_t& observer)
+	{
+		return observer.condition_list.size() == 0 ||
+				coap_satisfies_conditions<
+					list_static<Os, coap_condition, COAP_MAX_CONDITIONS>,
+					value_t,
+					observer_t
+				>( status_, observer, time() );
+	}
+	// --------------------------------------------------------------------------
+	/**
+	 * Minimum interval of an observer, raised by a Minimum-Response-Time condition
+	 */
+	uint32_t observer_min_interval(list_static<Os, coap_condition, COAP_MAX_CONDITIONS>& condition_list)
+	{
+		uint32_t interval = min_interval_;
+		typename list_static<Os, coap_condition, COAP_MAX_CONDITIONS>::iterator it = condition_list.begin();
+		for(; it != condition_list.end(); ++it)
+		{
+			if ( it->type == ConditionalObserveType::MINIMUM_RESPONSE_TIME )
+			{
+				uint32_t seconds = convert_condition_value<uint32_t>(it->condition_value_raw, it->value_type);
+				if ( seconds * 1000 > interval )
+					interval = seconds * 1000;
+			}
+		}
+		return interval;
 	}
 	// --------------------------------------------------------------------------
 	void got_ack(coap_message_t& message)
@@ -388,6 +593,12 @@ private:
 		return clock_->seconds(clock_->time());
 	}
 	// --------------------------------------------------------------------------
+	uint32_t time_ms()
+	{
+		typename Clock::time_t now = clock_->time();
+		return clock_->seconds(now) * 1000 + clock_->milliseconds(now);
+	}
+	// --------------------------------------------------------------------------
 	/**
 	 *
 	 */
@@ -397,27 +608,27 @@ private:
 		conv<V>(value, payload);
 	}
 	// --------------------------------------------------------------------------
+	// numbers are printed to payload.data, which has COAP_OBSERVE_VALUE_SIZE bytes
 	template<typename V>
 	void conv(uint16_t value, message_data& payload)
 	{
-		char data[10];
-		payload.length = sprintf(data, "%d", value);
-		payload.data = (block_data_t*) data;
+		payload.length = sprintf((char*) payload.data, "%d", value);
 	}
 	// --------------------------------------------------------------------------
 	template<typename V>
 	void conv(float value, message_data& payload)
 	{
-		char data[10];
-		payload.length = sprintf(data, "%f", value);
-		payload.data = (block_data_t*) data;
+		payload.length = sprintf((char*) payload.data, "%f", value);
 	}
 	// --------------------------------------------------------------------------
+	// the string is a copy which is gone after convert(), so its characters are copied too
 	template<typename V>
 	void conv(string_t value, message_data& payload)
 	{
 		payload.length = value.length();
-		payload.data = (block_data_t*) value.c_str();
+		if( payload.length > COAP_OBSERVE_VALUE_SIZE )
+			payload.length = COAP_OBSERVE_VALUE_SIZE;
+		memcpy(payload.data, value.c_str(), payload.length);
 	}
 	// --------------------------------------------------------------------------
 	template<typename V>
@@ -2,6 +2,7 @@
 #define	__RELIABLE_RADIO_MESSAGE_H__
 
 #include "reliable_radio_source_config.h"
+#include "util/serialization/message_layout.h"
 
 namespace wiselib
 {
@@ -19,6 +20,11 @@ namespace wiselib
 		typedef typename Radio::node_id_t node_id_t;
 		typedef typename Radio::size_t size_t;
 		typedef ReliableRadioMessage_Type<Os, Radio, Debug> self_t;
+		typedef LayoutField<uint32_t> MessageIdField;
+		typedef LayoutField<uint8_t, MessageIdField> CounterField;
+		typedef LayoutField<size_t, CounterField> PayloadSizeField;
+		typedef LayoutCheck<PayloadSizeField, Radio::MAX_MESSAGE_LENGTH> Header;
+		enum { HEADER_SIZE = Header::SIZE };
 		// --------------------------------------------------------------------
 		ReliableRadioMessage_Type() :
 			message_id				( 0 ),
@@ -128,36 +134,26 @@ namespace wiselib
 		// --------------------------------------------------------------------
 		block_data_t* serialize( block_data_t* _buff, size_t _offset = 0 )
 		{
-			size_t MSG_ID_POS = 0;
-			size_t COUNTER_POS = MSG_ID_POS + sizeof(uint32_t);
-			size_t DATA_LEN_POS = COUNTER_POS + sizeof(uint8_t);
-			size_t DATA_POS = DATA_LEN_POS + sizeof(size_t);
-			write<Os, block_data_t, uint32_t>( _buff + MSG_ID_POS + _offset,  message_id );
-			write<Os, block_data_t, uint8_t>( _buff + COUNTER_POS + _offset, counter );
-			write<Os, block_data_t, size_t>( _buff + DATA_LEN_POS + _offset, payload_size );
-			memcpy( _buff + DATA_POS + _offset, payload, payload_size );
+			block_data_t* buff = _buff + _offset;
+			write_field<Os, MessageIdField>( buff, message_id );
+			write_field<Os, CounterField>( buff, counter );
+			write_field<Os, PayloadSizeField>( buff, payload_size );
+			memcpy( buff + HEADER_SIZE, payload, payload_size );
 			return _buff;
 		}
 		// --------------------------------------------------------------------
 		void de_serialize( block_data_t* _buff, size_t _offset = 0 )
 		{
-			size_t MSG_ID_POS = 0;
-			size_t COUNTER_POS = MSG_ID_POS + sizeof(uint32_t);
-			size_t DATA_LEN_POS = COUNTER_POS + sizeof(uint8_t);
-			size_t DATA_POS = DATA_LEN_POS + sizeof(size_t);
-			message_id = read<Os, block_data_t, uint32_t>( _buff + MSG_ID_POS + _offset );
-			counter = read<Os, block_data_t, uint8_t>( _buff + COUNTER_POS + _offset );
-			payload_size = read<Os, block_data_t, size_t>( _buff + DATA_LEN_POS + _offset );
-			memcpy( payload, _buff + DATA_POS + _offset, payload_size );
+			block_data_t* buff = _buff + _offset;
+			message_id = read_field<Os, MessageIdField>( buff );
+			counter = read_field<Os, CounterField>( buff );
+			payload_size = read_field<Os, PayloadSizeField>( buff );
+			memcpy( payload, buff + HEADER_SIZE, payload_size );
 		}
 		// --------------------------------------------------------------------
 		size_t serial_size()
 		{
-			size_t MSG_ID_POS = 0;
-			size_t COUNTER_POS = MSG_ID_POS + sizeof(uint32_t);
-			size_t DATA_LEN_POS = COUNTER_POS + sizeof(uint8_t);
-			size_t DATA_POS = DATA_LEN_POS + sizeof(size_t);
-			return DATA_POS + payload_size;
+			return HEADER_SIZE + payload_size;
 		}
 		// --------------------------------------------------------------------
 #ifdef DEBUG_RELIABLE_RADIO_H
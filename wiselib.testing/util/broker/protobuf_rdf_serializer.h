@@ -12,6 +12,7 @@
 
 #include "util/protobuf/varint.h"
 #include "util/protobuf/string.h"
+#include "util/protobuf/field_reader.h"
 //#include "util/protobuf/buffer_dynamic.h"
 
 namespace wiselib
@@ -29,9 +30,69 @@ namespace wiselib
 
         typedef wiselib::protobuf::Message<OsModel, buffer_t, int_t> dynamic_message_t;
         typedef wiselib::protobuf::Message<OsModel, typename OsModel::Radio::block_data_t*, int_t> static_message_t;
+		typedef wiselib::protobuf::FieldReader<OsModel, int_t> field_reader_t;
+
+		enum { MAX_STRING_LENGTH = 200 };
 
     public:
 		
+		/**
+		 * Reads the statements of a buffer written by fill_buffer() one by
+		 * one. The nested messages are walked in place, only the strings
+		 * handed to the tuple are copied.
+		 */
+		class Reader {
+			public:
+				Reader(block_data_t* buffer, size_type buffer_size) :
+					message_(buffer, buffer + buffer_size), in_description_(false) {
+				}
+				
+				/**
+				 * @return true iff a statement was read into tuple, false at
+				 * the end of the buffer or on malformed data.
+				 */
+				template<typename Tuple>
+				bool read_tuple(Tuple& tuple) {
+					for( ; ; ) {
+						if(in_description_ && description_.find(1)) {
+							if(description_.wire_type() != field_reader_t::WIRE_LENGTH_DELIMITED) { return false; }
+							
+							field_reader_t statement = description_.message();
+							while(statement.next()) {
+								int_t field = statement.field();
+								if(field < 1 || field > 3 || statement.wire_type() != field_reader_t::WIRE_LENGTH_DELIMITED) {
+									continue;
+								}
+								char s[MAX_STRING_LENGTH];
+								size_type l = statement.length();
+								if(l >= MAX_STRING_LENGTH) { l = MAX_STRING_LENGTH - 1; }
+								memcpy(s, statement.data(), l);
+								s[l] = '\0';
+								tuple.set_deep(field - 1, (block_data_t*)s);
+							}
+							return !statement.error();
+						}
+						if(description_.error()) { return false; }
+						in_description_ = false;
+						
+						if(!message_.find(4)) { return false; }
+						if(message_.wire_type() != field_reader_t::WIRE_LENGTH_DELIMITED) { return false; }
+						description_ = message_.message();
+						in_description_ = true;
+					}
+				}
+				
+				/// Bytes of the buffer consumed so far.
+				size_type position() { return message_.position(); }
+				
+				bool done() { return !in_description_ && message_.done(); }
+				
+			private:
+				field_reader_t message_;
+				field_reader_t description_;
+				bool in_description_;
+		};
+		
 		void reset() {
 		}
 
@@ -64,37 +125,16 @@ namespace wiselib
         }
 
 		
+		/**
+		 * Reads the first statement of the buffer into tuple.
+		 * 
+		 * @return bytes of the buffer consumed, 0 on failure.
+		 */
 		template<typename Tuple>
 		size_type read_buffer(Tuple& tuple, block_data_t* buffer, size_type buffer_size) {
-			int_t field;
-			block_data_t *buf = buffer, *end = buffer + buffer_size;
-			
-			do {
-				block_data_t description[1000], *descr=description, *descr_end = description + 1000;
-				switch(static_message_t::field_number(buf, end)) {
-					case 4:
-						if(!static_message_t::read(buf, end, field, description)) { return 0; }
-						do {
-							block_data_t statement[200], *stmt=statement, *statement_end = statement + 200;
-							switch(static_message_t::field_number(buf, end)) {
-								case 1:
-									if(!static_message_t::read(buf, end, field, statement)) { return 0; }
-									//do {
-										char s[200];
-										for(size_type i=0; i<3;i++) {
-											int_t field2 = static_message_t::field_number(stmt, end);
-											if(!static_message_t::read(stmt, statement_end, field, s)) { return 0; }
-											tuple.set_deep(field2 - 1, (block_data_t*)s);
-										}
-										return buf - buffer;
-									//} while(buf < end);
-							} // switch
-						} while(buf < end);
-						break;
-				} // switch
-			} while(buf < end);
-			
-			return 0;
+			Reader reader(buffer, buffer_size);
+			if(!reader.read_tuple(tuple)) { return 0; }
+			return reader.position();
 		}
 		
     }; // class ProtobufRdfSerializer
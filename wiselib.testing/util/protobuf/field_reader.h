@@ -0,0 +1,175 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+
+#ifndef FIELD_READER_H
+#define FIELD_READER_H
+
+#include "util/protobuf/varint.h"
+
+namespace wiselib {
+   namespace protobuf {
+
+/**
+ * Walks the fields of an encoded message in place. Nothing is copied,
+ * length delimited fields (strings, nested messages, packed repeated
+ * fields) are handed out as pointer and length into the buffer, message()
+ * returns a reader over a nested message.
+ * 
+ * \code
+ * FieldReader<Os> reader(buffer, buffer + length);
+ * while(reader.next()) {
+ *    switch(reader.field()) {
+ *       case 1: x = reader.value(); break;
+ *       case 2: walk(reader.message()); break;
+ *    }
+ * }
+ * if(reader.error()) { ... }
+ * \endcode
+ * 
+ * \tparam Integer_P Unsigned integer type for field numbers, lengths and
+ * varint values.
+ */
+template<
+   typename OsModel_P,
+   typename Integer_P = uint32_t
+>
+class FieldReader {
+   public:
+      typedef OsModel_P Os;
+      typedef typename Os::block_data_t block_data_t;
+      typedef Integer_P int_t;
+      typedef block_data_t* buffer_t;
+      typedef FieldReader<Os, int_t> self_type;
+      
+      typedef VarInt<Os, buffer_t, int_t> varint_t;
+      
+      enum WireTypes {
+         WIRE_VARINT = 0,
+         WIRE_FIXED64 = 1,
+         WIRE_LENGTH_DELIMITED = 2,
+         WIRE_FIXED32 = 5
+      };
+      
+      FieldReader() : start_(0), current_(0), end_(0), data_(0), length_(0), value_(0),
+         field_(0), wire_type_(0), error_(false) {
+      }
+      
+      FieldReader(buffer_t buffer, buffer_t buffer_end) : start_(buffer), current_(buffer), end_(buffer_end),
+         data_(0), length_(0), value_(0), field_(0), wire_type_(0), error_(false) {
+      }
+      
+      /**
+       * Moves to the next field.
+       * 
+       * \return false at the end of the buffer or if the field is truncated
+       * or has an unsupported wire type (error() is set then).
+       */
+      bool next() {
+         if(current_ >= end_ || error_) { return false; }
+         
+         int_t tag;
+         if(!varint_t::read(current_, end_, tag)) { return fail(); }
+         field_ = tag >> 3;
+         wire_type_ = tag & 0x7;
+         value_ = 0;
+         
+         switch(wire_type_) {
+            case WIRE_VARINT:
+               if(!varint_t::read(current_, end_, value_)) { return fail(); }
+               data_ = 0;
+               length_ = 0;
+               return true;
+            case WIRE_LENGTH_DELIMITED:
+               if(!varint_t::read(current_, end_, length_)) { return fail(); }
+               break;
+            case WIRE_FIXED64:
+               length_ = 8;
+               break;
+            case WIRE_FIXED32:
+               length_ = 4;
+               break;
+            default:
+               // groups are deprecated and not supported
+               return fail();
+         }
+         if((size_t)(end_ - current_) < (size_t)length_) { return fail(); }
+         data_ = current_;
+         current_ += length_;
+         return true;
+      }
+      
+      /**
+       * Moves to the next field with the given number, skipping all others.
+       */
+      bool find(int_t field) {
+         while(next()) {
+            if(field_ == field) { return true; }
+         }
+         return false;
+      }
+      
+      int_t field() { return field_; }
+      uint8_t wire_type() { return wire_type_; }
+      
+      /// Value of a varint field.
+      int_t value() { return value_; }
+      
+      /// Start of the payload of a length delimited or fixed size field.
+      block_data_t* data() { return data_; }
+      int_t length() { return length_; }
+      
+      /// Reader over the nested message in the current field.
+      self_type message() { return self_type(data_, data_ + length_); }
+      
+      /**
+       * Decodes the current field as packed repeated varints.
+       */
+      bool packed(int_t* out, size_t max_count, size_t& count) {
+         buffer_t p = data_, p_end = data_ + length_;
+         return varint_t::codec_t::read_packed(p, p_end, out, max_count, count);
+      }
+      
+      /// Bytes consumed so far.
+      size_t position() { return current_ - start_; }
+      bool done() { return current_ >= end_; }
+      bool error() { return error_; }
+      
+   private:
+      bool fail() {
+         error_ = true;
+         return false;
+      }
+      
+      buffer_t start_;
+      buffer_t current_;
+      buffer_t end_;
+      buffer_t data_;
+      int_t length_;
+      int_t value_;
+      int_t field_;
+      uint8_t wire_type_;
+      bool error_;
+};
+
+   }
+}
+
+#endif // FIELD_READER_H
+// vim: set ts=3 sw=3 expandtab:
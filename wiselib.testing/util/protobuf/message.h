@@ -85,6 +85,28 @@ class Message {
          return RWSelect<Os, buffer_t, int_t, T>::rw_t::read(buffer, buffer_end, out);
       }
       
+      /**
+       * Writes count values as one packed repeated field.
+       */
+      static bool write_packed(buffer_t& buffer, buffer_t& buffer_end, int_t field, const int_t* values, size_t count) {
+         if(!varint_t::write(buffer, buffer_end, field << 3 | WIRE_TYPE)) {
+            return false;
+         }
+         return varint_t::write_packed(buffer, buffer_end, values, count);
+      }
+      
+      /**
+       * Reads a packed repeated field of at most max_count values into out,
+       * count is set to the number of values read. Only for pointer buffers.
+       */
+      static bool read_packed(buffer_t& buffer, buffer_t& buffer_end, int_t& field, int_t* out, size_t max_count, size_t& count) {
+         int_t r;
+         if(!varint_t::read(buffer, buffer_end, r)) { return false; }
+         field = r >> 3;
+         if((r & 0x7) != WIRE_TYPE) { return false; }
+         return varint_t::read_packed(buffer, buffer_end, out, max_count, count);
+      }
+      
       static int_t field_number(buffer_t buffer, buffer_t end) {
          int_t r;
          varint_t::read(buffer, end, r);
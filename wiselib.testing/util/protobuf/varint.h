@@ -22,10 +22,151 @@
 #define VARINT_H
 
 #include "util/protobuf/byte.h"
+#include <string.h>
 
 namespace wiselib {
    namespace protobuf {
 
+/**
+ * Varint coding with a bounds check for every byte, works on any buffer
+ * iterator.
+ */
+template<
+   typename OsModel_P,
+   typename Buffer_P,
+   typename Integer_P
+>
+class VarIntChecked {
+   public:
+      typedef OsModel_P Os;
+      typedef Buffer_P buffer_t;
+      typedef typename Os::block_data_t block_data_t;
+      typedef Integer_P int_t;
+      
+      typedef Byte<Os, buffer_t> byterw_t;
+      
+      enum {
+         MAX_SIZE = (sizeof(int_t) * 8 + 6) / 7, ///< bytes of the longest int_t
+         MAX_WIRE_SIZE = 10 ///< bytes of the longest varint on the wire
+      };
+      
+      static bool write(buffer_t& buffer, buffer_t& buffer_end, int_t v) {
+         for(size_t i = 1; i < MAX_SIZE && (v >> 7) != 0; i++) {
+            if(!byterw_t::write(buffer, buffer_end, (block_data_t)((v & DATA) | CONTINUATION))) { return false; }
+            v >>= 7;
+         }
+         return byterw_t::write(buffer, buffer_end, (block_data_t)(v & DATA));
+      }
+      
+      static bool read(buffer_t& buffer, buffer_t& buffer_end, int_t& out) {
+         int_t v = 0;
+         block_data_t b;
+         for(uint8_t shift = 0; shift < MAX_WIRE_SIZE * 7; shift += 7) {
+            if(!byterw_t::read(buffer, buffer_end, b)) { return false; }
+            // bits beyond int_t are dropped
+            if(shift < sizeof(int_t) * 8) {
+               v |= (int_t)(b & DATA) << shift;
+            }
+            if(!(b & CONTINUATION)) {
+               out = v;
+               return true;
+            }
+         }
+         return false;
+      }
+      
+   protected:
+      static const uint8_t DATA = 0x7f, CONTINUATION = 0x80;
+};
+
+/**
+ * Coding of the varints, buffers that are plain pointers get the fast path
+ * below.
+ */
+template<
+   typename OsModel_P,
+   typename Buffer_P,
+   typename Integer_P
+>
+class VarIntCodec : public VarIntChecked<OsModel_P, Buffer_P, Integer_P> {
+};
+
+/**
+ * As long as the longest varint fits in front of buffer_end no byte is
+ * checked on its own. The loops have a fixed trip count and are unrolled by
+ * the compiler, one byte values take a single test.
+ */
+template<
+   typename OsModel_P,
+   typename T,
+   typename Integer_P
+>
+class VarIntCodec<OsModel_P, T*, Integer_P> : public VarIntChecked<OsModel_P, T*, Integer_P> {
+   public:
+      typedef VarIntChecked<OsModel_P, T*, Integer_P> base_type;
+      typedef T* buffer_t;
+      typedef Integer_P int_t;
+      
+      enum {
+         MAX_SIZE = base_type::MAX_SIZE,
+         MAX_WIRE_SIZE = base_type::MAX_WIRE_SIZE
+      };
+      
+      static bool write(buffer_t& buffer, buffer_t& buffer_end, int_t v) {
+         if(buffer_end - buffer < (long)MAX_SIZE) {
+            return base_type::write(buffer, buffer_end, v);
+         }
+         buffer_t p = buffer;
+         for(size_t i = 1; i < MAX_SIZE && (v >> 7) != 0; i++) {
+            *p++ = (T)((v & DATA) | CONTINUATION);
+            v >>= 7;
+         }
+         *p++ = (T)(v & DATA);
+         buffer = p;
+         return true;
+      }
+      
+      static bool read(buffer_t& buffer, buffer_t& buffer_end, int_t& out) {
+         if(buffer != buffer_end && !(*buffer & CONTINUATION)) {
+            out = (uint8_t)*buffer;
+            ++buffer;
+            return true;
+         }
+         if(buffer_end - buffer < (long)MAX_WIRE_SIZE) {
+            return base_type::read(buffer, buffer_end, out);
+         }
+         // The continuation bit of the previous byte is masked out when the
+         // next group is added
+         const uint8_t *p = (const uint8_t*)buffer;
+         int_t v = p[0];
+         for(uint8_t i = 1; i < MAX_SIZE; i++) {
+            v = (v & (((int_t)1 << (7 * i)) - 1)) | ((int_t)p[i] << (7 * i));
+            if(!(p[i] & CONTINUATION)) {
+               out = v;
+               buffer += i + 1;
+               return true;
+            }
+         }
+         // longer than int_t, only the checked loop knows how to skip it
+         return base_type::read(buffer, buffer_end, out);
+      }
+      
+      /**
+       * Decodes varints until buffer_end, at most max_count of them.
+       */
+      static bool read_packed(buffer_t& buffer, buffer_t& buffer_end, int_t* out, size_t max_count, size_t& count) {
+         count = 0;
+         while(buffer != buffer_end && count < max_count) {
+            if(!read(buffer, buffer_end, out[count])) { return false; }
+            count++;
+         }
+         return buffer == buffer_end;
+      }
+      
+   protected:
+      static const uint8_t DATA = 0x7f, CONTINUATION = 0x80;
+};
+
 /**
  * Implements the ProtobufRW Concept.
  * 
@@ -51,38 +192,57 @@ class VarInt {
       typedef Integer_P int_t;
       
       typedef Byte<Os, buffer_t> byterw_t;
+      typedef VarIntCodec<Os, buffer_t, int_t> codec_t;
       
       enum { WIRE_TYPE = 0 };
       
-      static bool write(buffer_t& buffer, buffer_t& buffer_end, int_t v_, size_t sz=0) {
-         unsigned v = (unsigned)v_;
-         bool continuation = (v >> 7) != 0;
-         
-         if(!byterw_t::write(buffer, buffer_end, (int_t)((v & DATA) | (continuation << 7)))) { return false; }
-         if(continuation) {
-            if(!write(buffer, buffer_end, v >> 7)) { return false; }
-         }
-         return true;
+      static bool write(buffer_t& buffer, buffer_t& buffer_end, int_t v, size_t sz=0) {
+         return codec_t::write(buffer, buffer_end, v);
       }
       
       static bool read(buffer_t& buffer, buffer_t& buffer_end, int_t& out) {
-         int_t v;
-         block_data_t b;
-         if(!byterw_t::read(buffer, buffer_end, b)) { return false; }
-         v = b;
-         bool continuation = (v >> 7) != 0;
-         v &= DATA;
-         
-         if(continuation) {
-            int_t v2;
-            if(!read(buffer, buffer_end, v2)) { return false; }
-            out = v | (v2 << 7);
+         return codec_t::read(buffer, buffer_end, out);
+      }
+      
+      /**
+       * \return number of bytes v takes on the wire.
+       */
+      static size_t size(int_t v) {
+         size_t s = 1;
+         for( ; s < codec_t::MAX_SIZE && (v >> 7) != 0; s++) {
+            v >>= 7;
          }
-         else {
-            out = v;
+         return s;
+      }
+      
+      /**
+       * Writes the payload of a packed repeated field: the length in bytes
+       * followed by the values.
+       */
+      static bool write_packed(buffer_t& buffer, buffer_t& buffer_end, const int_t* values, size_t count) {
+         size_t l = 0;
+         for(size_t i = 0; i < count; i++) {
+            l += size(values[i]);
+         }
+         if(!write(buffer, buffer_end, (int_t)l)) { return false; }
+         for(size_t i = 0; i < count; i++) {
+            if(!write(buffer, buffer_end, values[i])) { return false; }
          }
          return true;
       }
+      
+      /**
+       * Reads the payload of a packed repeated field written by
+       * write_packed() into out. Fails if the field holds more than
+       * max_count values. Only for pointer buffers.
+       */
+      static bool read_packed(buffer_t& buffer, buffer_t& buffer_end, int_t* out, size_t max_count, size_t& count) {
+         int_t l;
+         if(!read(buffer, buffer_end, l)) { return false; }
+         if((size_t)(buffer_end - buffer) < (size_t)l) { return false; }
+         buffer_t field_end = buffer + l;
+         return codec_t::read_packed(buffer, field_end, out, max_count, count);
+      }
          
    private:
       static const uint8_t DATA = 0x7f, CONTINUATION = 0x80;
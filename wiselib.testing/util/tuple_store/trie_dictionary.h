@@ -0,0 +1,472 @@
+/***************************************************************************
+ ** This file is part of the generic algorithm library Wiselib.           **
+ ** Copyright (C) 2008,2009 by the Wisebed (www.wisebed.eu) project.      **
+ **                                                                       **
+ ** The Wiselib is free software: you can redistribute it and/or modify   **
+ ** it under the terms of the GNU Lesser General Public License as        **
+ ** published by the Free Software Foundation, either version 3 of the    **
+ ** License, or (at your option) any later version.                       **
+ **                                                                       **
+ ** The Wiselib is distributed in the hope that it will be useful,        **
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+ ** GNU Lesser General Public License for more details.                   **
+ **                                                                       **
+ ** You should have received a copy of the GNU Lesser General Public      **
+ ** License along with the Wiselib.                                       **
+ ** If not, see <http://www.gnu.org/licenses/>.                           **
+ ***************************************************************************/
+
+#ifndef TRIE_DICTIONARY_H
+#define TRIE_DICTIONARY_H
+
+#include <util/meta.h>
+
+namespace wiselib {
+
+	/**
+	 * @brief Dictionary for zero-terminated strings based on a byte-wise
+	 * compressed (radix) trie.
+	 *
+	 * Common prefixes (e.g. URI namespaces) are stored only once. Each node
+	 * holds its edge label inline (path compression, up to 255 bytes per
+	 * node) and refers to a single child block that contains the sorted
+	 * first bytes of all children followed by the child pointers. Lookup thus
+	 * touches the node, a small contiguous byte array and the selected
+	 * pointer per level. Child blocks grow adaptively (1, 2, 4, ..., 255
+	 * entries).
+	 *
+	 * Keys are node addresses. A node never moves while it holds a value,
+	 * so keys stay valid when the trie is restructured by inserting
+	 * (splitting edges, growing child blocks) or erasing other values.
+	 *
+	 * Compared to PrescillaDictionary this works on bytes instead of bits,
+	 * i.e. needs far fewer nodes and no bit array allocations, compared to
+	 * AvlDictionary / UnbalancedTreeDictionary shared prefixes are not
+	 * duplicated.
+	 *
+	 * @ingroup Dictionary_concept
+	 */
+	template<
+		typename OsModel_P
+	>
+	class TrieDictionary {
+
+		public:
+			typedef OsModel_P OsModel;
+			typedef typename OsModel::block_data_t block_data_t;
+			typedef typename OsModel::size_t size_type;
+			typedef TrieDictionary<OsModel_P> self_type;
+			typedef self_type* self_pointer_t;
+
+		private:
+			struct Node {
+				// {{{
+				enum { MAX_LABEL_LENGTH = 255, MAX_CHILDREN = 255 };
+
+				/**
+				 * @return new node with room for a label of length @a l,
+				 * the first @a copy bytes of which are taken from @a label.
+				 */
+				static Node* make(const block_data_t *label, size_type l, size_type copy) {
+					// over-allocates by the one label byte already in Node
+					block_data_t* p = get_allocator().template allocate_array<block_data_t>(sizeof(Node) + l).raw();
+					Node *n = reinterpret_cast<Node*>(p);
+					n->parent = 0;
+					n->children = 0;
+					n->refcount = 0;
+					n->label_length = l;
+					n->child_count = 0;
+					n->child_capacity = 0;
+					if(copy) { memcpy(n->label, label, copy); }
+					return n;
+				}
+
+				static Node* make(const block_data_t *label, size_type l) {
+					return make(label, l, l);
+				}
+
+				static void destroy(Node *n) {
+					if(n->children) {
+						get_allocator().free_array(n->children);
+					}
+					get_allocator().free_array(reinterpret_cast<block_data_t*>(n));
+				}
+
+				/// Sorted first label bytes of the children.
+				block_data_t* child_bytes() { return children; }
+
+				/// Child pointers, in the same order as child_bytes().
+				Node** child_pointers() {
+					return reinterpret_cast<Node**>(children + pointer_offset(child_capacity));
+				}
+
+				static size_type pointer_offset(size_type capacity) {
+					return (capacity + sizeof(Node*) - 1) & ~(sizeof(Node*) - 1);
+				}
+
+				/**
+				 * @return index of child starting with @a c or the index
+				 * where it would have to be inserted (and found = false).
+				 */
+				size_type find_child(block_data_t c, bool& found) {
+					block_data_t *b = child_bytes();
+					size_type lo = 0, hi = child_count;
+					while(lo < hi) {
+						size_type mid = (lo + hi) / 2;
+						if(b[mid] < c) { lo = mid + 1; }
+						else { hi = mid; }
+					}
+					found = (lo < child_count && b[lo] == c);
+					return lo;
+				}
+
+				Node* child(block_data_t c) {
+					bool found;
+					size_type i = find_child(c, found);
+					return found ? child_pointers()[i] : 0;
+				}
+
+				void insert_child(Node *c) {
+					if(child_count == child_capacity) { grow(); }
+
+					bool found;
+					size_type i = find_child(c->label[0], found);
+					assert(!found);
+
+					block_data_t *b = child_bytes();
+					Node **p = child_pointers();
+					memmove(b + i + 1, b + i, child_count - i);
+					memmove(p + i + 1, p + i, (child_count - i) * sizeof(Node*));
+					b[i] = c->label[0];
+					p[i] = c;
+					child_count++;
+					c->parent = this;
+				}
+
+				void replace_child(Node *old, Node *c) {
+					bool found;
+					size_type i = find_child(old->label[0], found);
+					assert(found);
+					child_pointers()[i] = c;
+					c->parent = this;
+				}
+
+				void remove_child(Node *c) {
+					bool found;
+					size_type i = find_child(c->label[0], found);
+					assert(found);
+
+					block_data_t *b = child_bytes();
+					Node **p = child_pointers();
+					memmove(b + i, b + i + 1, child_count - i - 1);
+					memmove(p + i, p + i + 1, (child_count - i - 1) * sizeof(Node*));
+					child_count--;
+
+					if(child_count == 0) {
+						get_allocator().free_array(children);
+						children = 0;
+						child_capacity = 0;
+					}
+				}
+
+				void grow() {
+					size_type capacity = child_capacity ? 2 * child_capacity : 1;
+					if(capacity > MAX_CHILDREN) { capacity = MAX_CHILDREN; }
+
+					block_data_t *b = get_allocator().template allocate_array<block_data_t>(
+							pointer_offset(capacity) + capacity * sizeof(Node*)).raw();
+					if(children) {
+						memcpy(b, child_bytes(), child_count);
+						memcpy(b + pointer_offset(capacity), child_pointers(), child_count * sizeof(Node*));
+						get_allocator().free_array(children);
+					}
+					children = b;
+					child_capacity = capacity;
+				}
+
+				Node *parent;
+				block_data_t *children;
+				// 32 bits cost no space over 16 (the node is padded to
+				// pointer alignment anyway) and hot keys can't wrap them.
+				::uint32_t refcount;
+				::uint8_t label_length;
+				::uint8_t child_count;
+				::uint8_t child_capacity;
+				// actually label_length bytes, see make()
+				block_data_t label[1];
+				// }}}
+			};
+
+		public:
+			typedef typename Uint<sizeof(Node*)>::t key_type;
+			typedef block_data_t* mapped_type;
+
+			enum { SUCCESS = OsModel::SUCCESS, ERR_UNSPEC = OsModel::ERR_UNSPEC };
+			enum { NULL_KEY = 0 };
+			enum { ABSTRACT_KEYS = false };
+
+			/**
+			 * Iterates over all keys in lexicographic order of their values.
+			 */
+			class iterator {
+				public:
+					iterator(Node* node) : node_(node) {
+						if(node_ && !node_->refcount) { forward(); }
+					}
+					iterator(const iterator& other) { node_ = other.node_; }
+
+					bool operator==(const iterator& other) { return node_ == other.node_; }
+					bool operator!=(const iterator& other) { return !(*this == other); }
+
+					key_type operator*() { return to_key(node_); }
+
+					iterator& operator++() {
+						forward();
+						return *this;
+					}
+
+				private:
+					/**
+					 * Pre-order traversal to the next node holding a value.
+					 */
+					void forward() {
+						do {
+							if(node_->child_count) {
+								node_ = node_->child_pointers()[0];
+								continue;
+							}
+
+							while(node_->parent) {
+								Node *parent = node_->parent;
+								bool found;
+								size_type i = parent->find_child(node_->label[0], found);
+								if(i + 1 < parent->child_count) {
+									node_ = parent->child_pointers()[i + 1];
+									break;
+								}
+								node_ = parent;
+							}
+							if(!node_->parent) { node_ = 0; return; }
+						} while(!node_->refcount);
+					}
+
+					Node *node_;
+			};
+
+			TrieDictionary() : root_(0), size_(0) {
+			}
+
+			~TrieDictionary() {
+				destruct();
+			}
+
+			int init() {
+				if(!root_) {
+					root_ = Node::make(0, 0);
+				}
+				size_ = 0;
+				return SUCCESS;
+			}
+
+			template<typename Debug>
+			void init(Debug*) {
+				init();
+			}
+
+			/**
+			 * Free all nodes.
+			 */
+			void destruct() {
+				Node *n = root_;
+				while(n) {
+					if(n->child_count) {
+						n = n->child_pointers()[n->child_count - 1];
+						continue;
+					}
+					Node *parent = n->parent;
+					if(parent) { parent->child_count--; }
+					Node::destroy(n);
+					n = parent;
+				}
+				root_ = 0;
+				size_ = 0;
+			}
+
+			/**
+			 * value will be copied into the dictionary (non-shallowly, i.e.
+			 * you may remove the original value afterwards!)
+			 */
+			key_type insert(mapped_type v) {
+				Node *n = root_;
+				const block_data_t *p = v;
+
+				while(*p) {
+					Node *c = n->child(*p);
+					if(!c) {
+						n = append_chain(n, p);
+						break;
+					}
+
+					size_type m = 0;
+					while(m < c->label_length && p[m] == c->label[m]) { m++; }
+
+					if(m < c->label_length) {
+						c = split(c, m);
+					}
+					n = c;
+					p += m;
+				}
+
+				n->refcount++;
+				if(n->refcount == 1) { size_++; }
+				return to_key(n);
+			}
+
+			key_type find(mapped_type v) {
+				Node *n = find_node(v);
+				return (n && n->refcount) ? to_key(n) : (key_type)NULL_KEY;
+			}
+
+			size_type erase(key_type k) {
+				Node *n = to_node(k);
+				if(n->refcount > 1) {
+					n->refcount--;
+					return 1;
+				}
+				n->refcount = 0;
+				size_--;
+
+				// remove now unused leaves
+				while(n != root_ && !n->refcount && !n->child_count) {
+					Node *parent = n->parent;
+					parent->remove_child(n);
+					Node::destroy(n);
+					n = parent;
+				}
+
+				// n might now be an unused node with a single child, try to
+				// merge them.
+				if(n != root_ && !n->refcount && n->child_count == 1) {
+					merge(n);
+				}
+				return 1;
+			}
+
+			iterator begin_keys() { return iterator(root_); }
+			iterator end_keys() { return iterator(0); }
+
+			size_type count(key_type k) {
+				return to_node(k)->refcount;
+			}
+
+			size_type size() { return size_; }
+
+			/**
+			 * @return copy of the value of @a k, to be freed with
+			 * @a free_value().
+			 */
+			mapped_type get_value(key_type k) {
+				size_type l = 0;
+				for(Node *n = to_node(k); n; n = n->parent) {
+					l += n->label_length;
+				}
+
+				block_data_t *r = get_allocator().template allocate_array<block_data_t>(l + 1).raw();
+				r[l] = '\0';
+				for(Node *n = to_node(k); n; n = n->parent) {
+					l -= n->label_length;
+					memcpy(r + l, n->label, n->label_length);
+				}
+				return r;
+			}
+
+			void free_value(mapped_type v) {
+				get_allocator().free_array(v);
+			}
+
+		private:
+
+			Node* find_node(const block_data_t *p) {
+				Node *n = root_;
+				while(n && *p) {
+					n = n->child(*p);
+					if(!n) { return 0; }
+					for(size_type i = 0; i < n->label_length; i++, p++) {
+						// p ends before the label does -> mismatch at '\0'
+						if(*p != n->label[i]) { return 0; }
+					}
+				}
+				return n;
+			}
+
+			/**
+			 * Append chain of nodes for zero-terminated @a p below @a n.
+			 * @return last node of the chain.
+			 */
+			Node* append_chain(Node *n, const block_data_t *p) {
+				size_type l = strlen((const char*)p);
+				while(l) {
+					size_type chunk = (l > Node::MAX_LABEL_LENGTH) ? (size_type)Node::MAX_LABEL_LENGTH : l;
+					Node *c = Node::make(p, chunk);
+					n->insert_child(c);
+					n = c;
+					p += chunk;
+					l -= chunk;
+				}
+				return n;
+			}
+
+			/**
+			 * Split the label of @a c after @a m bytes by inserting a new
+			 * node in between @a c and its parent. @a c keeps its address.
+			 * @return the new node.
+			 */
+			Node* split(Node *c, size_type m) {
+				Node *s = Node::make(c->label, m);
+				c->parent->replace_child(c, s);
+
+				c->label_length -= m;
+				memmove(c->label, c->label + m, c->label_length);
+				s->insert_child(c);
+				return s;
+			}
+
+			/**
+			 * Merge unused node @a n with its only child by prepending its
+			 * label. As this moves the child in memory this is only done if
+			 * the child does not hold a value.
+			 */
+			void merge(Node *n) {
+				Node *c = n->child_pointers()[0];
+				if(c->refcount || n->label_length + c->label_length > Node::MAX_LABEL_LENGTH) {
+					return;
+				}
+
+				Node *r = Node::make(n->label, n->label_length + c->label_length, n->label_length);
+				memcpy(r->label + n->label_length, c->label, c->label_length);
+				r->children = c->children;
+				r->child_count = c->child_count;
+				r->child_capacity = c->child_capacity;
+				for(size_type i = 0; i < r->child_count; i++) {
+					r->child_pointers()[i]->parent = r;
+				}
+				n->parent->replace_child(n, r);
+
+				c->children = 0;
+				Node::destroy(c);
+				Node::destroy(n);
+			}
+
+			static key_type to_key(Node *p) { return reinterpret_cast<key_type>(p); }
+			static Node* to_node(key_type p) { return reinterpret_cast<Node*>(p); }
+
+			Node *root_;
+			size_type size_;
+
+	}; // TrieDictionary
+}
+
+#endif // TRIE_DICTIONARY_H
+
+/* vim: set ts=4 sw=4 tw=78 noexpandtab :*/